@@ -55,7 +55,7 @@ int main(int argc, char **argv)
         sleep(1);
         sprintf(buf, "[%4d] %s", idx, value);
         printf("Writing Data ('%s': '%s')...\n", uri, buf);
-        zn_write_ext(s, zn_rname(uri), (const uint8_t *)buf, strlen(buf), Z_ENCODING_DEFAULT, Z_DATA_KIND_DEFAULT, zn_congestion_control_t_BLOCK);
+        zn_write_ext(s, zn_rname(uri), (const uint8_t *)buf, strlen(buf), Z_ENCODING_DEFAULT, Z_DATA_KIND_DEFAULT, zn_congestion_control_t_BLOCK, ZN_PRIORITY_DEFAULT);
     }
 
     znp_stop_read_task(s);
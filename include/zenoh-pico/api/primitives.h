@@ -116,12 +116,71 @@ zn_subscriber_t *zn_declare_subscriber(zn_session_t *zn,
                                        zn_data_handler_t callback,
                                        void *arg);
 
+/**
+ * Declare a :c:type:`zn_subscriber_t` for the given resource key whose data is not
+ * delivered through a callback but queued in a ring of **capacity** samples, to be
+ * received by the application with :c:func:`zn_subscriber_recv` or :c:func:`zn_subscriber_try_recv`.
+ * No user code runs on the thread dispatching the data.
+ *
+ * The storage of the samples is allocated here, such that the dispatch of the data does not
+ * allocate memory: samples whose resource name is longer than ``ZN_RING_SUBSCRIBER_MAX_KEY_LEN``
+ * or whose payload is larger than ``ZN_RING_SUBSCRIBER_MAX_PAYLOAD_LEN`` bytes are dropped.
+ *
+ * Parameters:
+ *     zn: The zenoh-net session. The caller keeps its ownership.
+ *     reskey: The resource key to subscribe. The callee gets the ownership
+ *             of any allocated value.
+ *     sub_info: The :c:type:`zn_subinfo_t` to configure the :c:type:`zn_subscriber_t`.
+ *               The callee gets the ownership of any allocated value.
+ *     capacity: The number of samples the ring holds.
+ *     policy: The :c:type:`zn_ring_policy_t` applied when the ring is full.
+ *
+ * Returns:
+ *    The created :c:type:`zn_subscriber_t` or null if the declaration failed.
+ */
+zn_subscriber_t *zn_declare_ring_subscriber(zn_session_t *zn,
+                                            zn_reskey_t reskey,
+                                            zn_subinfo_t sub_info,
+                                            size_t capacity,
+                                            zn_ring_policy_t policy);
+
+/**
+ * Receive the oldest sample queued for a :c:type:`zn_subscriber_t` declared with
+ * :c:func:`zn_declare_ring_subscriber`, waiting for one if the ring is empty.
+ * It must not be called concurrently with or after :c:func:`zn_undeclare_subscriber`,
+ * nor concurrently with another call receiving from the same subscriber.
+ *
+ * Parameters:
+ *     sub: The :c:type:`zn_subscriber_t` to receive from.
+ *     sample: The received :c:type:`zn_sample_t`. It is loaned by the ring and must not be
+ *             freed: it is valid until the next sample is received from the subscriber or
+ *             until the subscriber is undeclared.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` in case of failure.
+ */
+int zn_subscriber_recv(zn_subscriber_t *sub, zn_sample_t *sample);
+
+/**
+ * Same as :c:func:`zn_subscriber_recv` without waiting.
+ *
+ * Parameters:
+ *     sub: The :c:type:`zn_subscriber_t` to receive from.
+ *     sample: The received :c:type:`zn_sample_t`, loaned as by :c:func:`zn_subscriber_recv`.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` if the ring is empty or in case of failure.
+ */
+int zn_subscriber_try_recv(zn_subscriber_t *sub, zn_sample_t *sample);
+
 /**
  * Undeclare a :c:type:`zn_subscriber_t`.
  *
  * Parameters:
  *     sub: The :c:type:`zn_subscriber_t` to undeclare. The callee releases the
- *          subscriber upon successful return.
+ *          subscriber upon successful return. It waits for the callbacks already
+ *          being invoked by other threads to return, such that the callback
+ *          argument can be released afterwards. It can be called from the
+ *          callback itself, which is not invoked again.
+ *          The samples queued by a ring subscriber and not received are dropped.
  */
 void zn_undeclare_subscriber(zn_subscriber_t *sub);
 
@@ -150,7 +209,10 @@ zn_queryable_t *zn_declare_queryable(zn_session_t *zn,
  *
  * Parameters:
  *     qle: The :c:type:`zn_queryable_t` to undeclare. The callee releases the
- *          queryable upon successful return.
+ *          queryable upon successful return. It waits for the callbacks already
+ *          being invoked by other threads to return, such that the callback
+ *          argument can be released afterwards. It can be called from the
+ *          callback itself, which is not invoked again.
  */
 void zn_undeclare_queryable(zn_queryable_t *qle);
 
@@ -183,10 +245,62 @@ int zn_write(zn_session_t *zn, const zn_reskey_t reskey, const uint8_t *payload,
  *     kind: The kind of the value.
  *     cong_ctrl: The congestion control of this write. Possible values defined
  *                in :c:type:`zn_congestion_control_t`.
+ *     priority: The priority of this write. Possible values defined in
+ *               :c:type:`zn_priority_t`. Higher priorities are transmitted first
+ *               and, on transports supporting QoS, on their own conduit.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` in case of failure.
+ */
+int zn_write_ext(zn_session_t *zn, const zn_reskey_t reskey, const uint8_t *payload, const size_t len, uint8_t encoding, const uint8_t kind, const zn_congestion_control_t cong_ctrl, const zn_priority_t priority);
+
+/**
+ * Loan a buffer inside the transmission batch where the value to write for a given
+ * resource key can be serialized in place, without any intermediate copy.
+ * The transmission path remains locked until :c:func:`zn_write_commit` or
+ * :c:func:`zn_write_abort` is called, hence the value should be written and committed
+ * as soon as possible. Calling any other ``zn_*`` function that sends a message from
+ * the same thread in between deadlocks.
+ *
+ * The loan holds the transmission mutex of the session, hence :c:func:`zn_write_commit`
+ * or :c:func:`zn_write_abort` must be called from the thread that loaned the buffer.
+ * While the loan is outstanding, every other transmission blocks: the writes of the
+ * other threads, the keep-alives and lease handling of the lease task, and the
+ * acknowledgments sent by the read task.
+ *
+ * Parameters:
+ *     zn: The zenoh-net session. The caller keeps its ownership.
+ *     reskey: The resource key to write. The caller keeps its ownership.
+ *     len: The length of the value to write.
+ * Returns:
+ *     A pointer to ``len`` writable bytes in case of success, ``NULL`` if the value
+ *     does not fit in a single batch, has been dropped by congestion control, or if
+ *     the session queues its messages for a TX writer task (``tx_queue`` > 0).
+ */
+uint8_t *zn_write_loan(zn_session_t *zn, const zn_reskey_t reskey, const size_t len);
+
+/**
+ * Send the value written in the buffer returned by :c:func:`zn_write_loan`.
+ * It must be called once, and only after a successful :c:func:`zn_write_loan`,
+ * from the thread that loaned the buffer.
+ *
+ * Parameters:
+ *     zn: The zenoh-net session. The caller keeps its ownership.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` in case of failure.
+ */
+int zn_write_commit(zn_session_t *zn);
+
+/**
+ * Drop the value loaned by :c:func:`zn_write_loan` without sending it.
+ * It must be called once, and only after a successful :c:func:`zn_write_loan`,
+ * from the thread that loaned the buffer and in place of :c:func:`zn_write_commit`.
+ *
+ * Parameters:
+ *     zn: The zenoh-net session. The caller keeps its ownership.
  * Returns:
  *     ``0`` in case of success, ``-1`` in case of failure.
  */
-int zn_write_ext(zn_session_t *zn, const zn_reskey_t reskey, const uint8_t *payload, const size_t len, uint8_t encoding, const uint8_t kind, const zn_congestion_control_t cong_ctrl);
+int zn_write_abort(zn_session_t *zn);
 
 /**
  * Pull data for a pull mode :c:type:`zn_subscriber_t`. The pulled data will be provided
@@ -16,6 +16,8 @@
 #define ZENOH_PICO_SESSION_API_H
 
 #include "zenoh-pico/session/session.h"
+#include "zenoh-pico/transport/link/task/reactor.h"
+#include "zenoh-pico/protocol/utils.h"
 #include "zenoh-pico/utils/properties.h"
 
 /**
@@ -23,7 +25,18 @@
  */
 typedef struct
 {
-    z_mutex_t mutex_inner;
+    // Each table is protected on its own, lookups and dispatches only take read locks.
+    // When nested, the locks are always taken in the following order:
+    //  - mutex_queries
+    //  - rwlock_resources
+    //  - rwlock_subscriptions or rwlock_queryables
+    //  - mutex_refcount
+    z_rwlock_t rwlock_resources;
+    z_rwlock_t rwlock_subscriptions;
+    z_rwlock_t rwlock_queryables;
+    z_mutex_t mutex_queries;
+    z_mutex_t mutex_refcount; // Reference counts of the subscriptions and queryables
+    struct _zn_dispatch_snapshot_t *dispatches; // The dispatches in progress, protected by mutex_refcount
 
     // Session counters // FIXME: move to transport check
     z_zint_t resource_id;
@@ -31,18 +44,30 @@ typedef struct
     z_zint_t pull_id;
     z_zint_t query_id;
 
-    // Session declarations
-    _zn_resource_list_t *local_resources;
-    _zn_resource_list_t *remote_resources;
+    // Session declarations, indexed by RID and by (RID, suffix) key
+    _zn_resource_intmap_t local_resources;
+    _zn_resource_intmap_t remote_resources;
+    _z_int_void_map_t local_resources_by_key;
+    _z_int_void_map_t remote_resources_by_key;
+    _zn_resource_list_t *local_resources_pending; // Declared with a RID that is not known yet
+    _zn_resource_list_t *remote_resources_pending;
 
     // Session subscriptions
     _zn_subscriber_list_t *local_subscriptions;
     _zn_subscriber_list_t *remote_subscriptions;
+    _zn_rname_index_t local_subscriptions_index;
 
     // Session queryables
     _zn_queryable_list_t *local_queryables;
+    _zn_rname_index_t local_queryables_index;
     _zn_pending_query_list_t *pending_queries;
 
+    // Session RX workers, none unless ZN_CONFIG_RX_WORKERS_KEY is set
+    _zn_rx_workers_t rx_workers;
+
+    // Session TX queue, disabled unless ZN_CONFIG_TX_QUEUE_KEY is set
+    _zn_tx_queue_t tx_queue;
+
     // Session transport.
     // Zenoh-pico is considering a single transport per session.
     _zn_transport_t *tp;
@@ -103,6 +128,23 @@ int znp_read(zn_session_t *z);
  */
 int znp_send_keep_alive(zn_session_t *z);
 
+/**
+ * Push out any zenoh message that is pending in the transmission batch.
+ * This is a no-op unless TX batching is enabled (i.e. ``ZN_TX_BATCHING == 1``).
+ *
+ * The batch is pushed out after ``ZN_TX_BATCH_LINGER_MS`` by the lease task, or
+ * by the reactor processing the session. Under a reactor, a batch opened by
+ * another task waits for the next round of the reactor. A session with neither
+ * a lease task nor a reactor keeps its last batched message until the next
+ * write or an explicit call to this function.
+ *
+ * Parameters:
+ *     session: The zenoh-net session. The caller keeps its ownership.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` in case of failure.
+ */
+int znp_flush(zn_session_t *z);
+
 /**
  * Start a separate task to read from the network and process the messages
  * as soon as they are received. Note that the task can be implemented in
@@ -153,4 +195,92 @@ int znp_start_lease_task(zn_session_t *z);
  */
 int znp_stop_lease_task(zn_session_t *z);
 
+/**
+ * Get the counters of the TX queue, i.e. the number of zenoh messages queued
+ * and dropped so far. The messages written while the queue is full are dropped
+ * according to ``ZN_CONFIG_TX_QUEUE_POLICY_KEY``.
+ *
+ * Parameters:
+ *     session: The zenoh-net session. The caller keeps its ownership.
+ *     queued: The number of queued messages.
+ *     dropped: The number of dropped messages.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` in case of failure, i.e. if the session has no TX queue.
+ */
+int znp_tx_queue_counters(zn_session_t *z, size_t *queued, size_t *dropped);
+
+#if defined(Z_EVENT_LOOP)
+/*------------------ Zenoh-Pico Event Loop ------------------*/
+
+/**
+ * A single-threaded event loop reading from and handling the leases of several
+ * zenoh-net sessions, in place of their read and lease tasks. It is not thread-safe.
+ */
+typedef _znp_reactor_t znp_reactor_t;
+
+/**
+ * Create an event loop driving no session yet.
+ *
+ * Returns:
+ *     A pointer to the new :c:type:`znp_reactor_t` or null if the creation did not succeed.
+ */
+znp_reactor_t *znp_reactor_new(void);
+
+/**
+ * Free an event loop. The sessions it drives are left open.
+ *
+ * Parameters:
+ *     reactor: The event loop. The callee releases it.
+ */
+void znp_reactor_free(znp_reactor_t **reactor);
+
+/**
+ * Get the file descriptor of an event loop. It becomes readable whenever
+ * :c:func:`znp_process_events` has something to do, such that it can be
+ * watched by the event loop of the application.
+ *
+ * Parameters:
+ *     reactor: The event loop. The caller keeps its ownership.
+ * Returns:
+ *     The file descriptor of the event loop.
+ */
+int znp_reactor_fd(const znp_reactor_t *reactor);
+
+/**
+ * Drive a session with an event loop. Only client sessions, i.e. on unicast
+ * links, are supported. The read and lease tasks of the session must not be started.
+ *
+ * Parameters:
+ *     reactor: The event loop. The caller keeps its ownership.
+ *     session: The zenoh-net session. The caller keeps its ownership.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` in case of failure.
+ */
+int znp_reactor_add(znp_reactor_t *reactor, zn_session_t *session);
+
+/**
+ * Stop driving a session with an event loop. This must be done before closing the session.
+ *
+ * Parameters:
+ *     reactor: The event loop. The caller keeps its ownership.
+ *     session: The zenoh-net session. The caller keeps its ownership.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` in case of failure.
+ */
+int znp_reactor_remove(znp_reactor_t *reactor, zn_session_t *session);
+
+/**
+ * Read the messages received by the sessions of an event loop, and send their
+ * keep alive messages or close them upon lease expiration. Must not be called
+ * from the callbacks of the sessions.
+ *
+ * Parameters:
+ *     reactor: The event loop. The caller keeps its ownership.
+ *     timeout: How long to wait for an event, in milliseconds. ``0`` does not wait, ``-1`` waits forever.
+ * Returns:
+ *     ``0`` in case of success, ``-1`` in case of failure.
+ */
+int znp_process_events(znp_reactor_t *reactor, int timeout);
+#endif
+
 #endif /* ZENOH_PICO_SESSION_API_H */
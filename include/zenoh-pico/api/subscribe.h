@@ -24,6 +24,7 @@ typedef struct
 {
     void *zn; // FIXME: zn_session_t *zn;
     z_zint_t id;
+    void *ring; // FIXME: _zn_sample_ring_t *ring; NULL unless declared with zn_declare_ring_subscriber
 } zn_subscriber_t;
 
 /**
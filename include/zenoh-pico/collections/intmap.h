@@ -36,7 +36,8 @@ typedef struct
 } _z_int_void_map_entry_t;
 
 /**
- * An hashmap with integer keys.
+ * An hashmap with integer keys. The capacity of the hashmap doubles
+ * whenever its length exceeds it, keeping the buckets short.
  *
  * Members:
  *   z_intmap_t **vals: the linked intmap containing the values
@@ -46,6 +47,7 @@ typedef struct
 typedef struct
 {
     size_t capacity;
+    size_t len;
     _z_list_t **vals;
 } _z_int_void_map_t;
 
@@ -106,6 +106,49 @@
 #define ZN_CONFIG_ADD_TIMESTAMP_KEY 0x4A
 #define ZN_CONFIG_ADD_TIMESTAMP_DEFAULT "false"
 
+/**
+ * The number of worker tasks dispatching the received data to the subscriptions.
+ * With 0 workers, the data is dispatched by the read task itself.
+ * String key : `"rx_workers"`.
+ * Accepted values : `<int>`.
+ * Default value : `"0"`.
+ */
+#define ZN_CONFIG_RX_WORKERS_KEY 0x4B
+#define ZN_CONFIG_RX_WORKERS_DEFAULT "0"
+
+/**
+ * The number of zenoh messages queued for transmission by a dedicated writer task.
+ * With 0, the messages are transmitted by the task writing them.
+ * String key : `"tx_queue"`.
+ * Accepted values : `<int>`.
+ * Default value : `"0"`.
+ */
+#define ZN_CONFIG_TX_QUEUE_KEY 0x4C
+#define ZN_CONFIG_TX_QUEUE_DEFAULT "0"
+
+/**
+ * What to do with the droppable data written while the TX queue is full: block until
+ * there is room for it, drop it, or drop the oldest droppable data in the queue.
+ * String key : `"tx_queue_policy"`.
+ * Accepted values : `"block"`, `"drop_newest"`, `"drop_oldest"`.
+ * Default value : `"block"`.
+ */
+#define ZN_CONFIG_TX_QUEUE_POLICY_KEY 0x4D
+#define ZN_CONFIG_TX_QUEUE_POLICY_BLOCK "block"
+#define ZN_CONFIG_TX_QUEUE_POLICY_DROP_NEWEST "drop_newest"
+#define ZN_CONFIG_TX_QUEUE_POLICY_DROP_OLDEST "drop_oldest"
+#define ZN_CONFIG_TX_QUEUE_POLICY_DEFAULT ZN_CONFIG_TX_QUEUE_POLICY_BLOCK
+
+/**
+ * How long the droppable data waits for room in the TX queue with the `"block"` policy
+ * before being dropped, in milliseconds.
+ * String key : `"tx_queue_timeout"`.
+ * Accepted values : `<int>`.
+ * Default value : `"1000"`.
+ */
+#define ZN_CONFIG_TX_QUEUE_TIMEOUT_KEY 0x4E
+#define ZN_CONFIG_TX_QUEUE_TIMEOUT_DEFAULT "1000"
+
 /*------------------ Configuration properties ------------------*/
 #define ZN_ATTACHMENT_BUF_LEN 16384
 #define ZN_PID_LENGTH 8
@@ -122,6 +165,25 @@
  */
 #define ZN_JOIN_INTERVAL 2500
 
+/**
+ * Default number of samples queued for each RX worker before the read task blocks
+ */
+#define ZN_RX_WORKER_QUEUE_LEN 64
+
+/**
+ * Size in bytes of the storage of each sample queued for an RX worker, allocated when the
+ * workers are started. Resource names and payloads that do not fit are allocated on the heap.
+ */
+#define ZN_RX_WORKER_SLOT_SIZE 256
+
+/**
+ * Maximum resource name length and payload size in bytes of the samples queued by a ring
+ * subscriber. The storage of the samples is allocated when the subscriber is declared,
+ * larger samples are dropped.
+ */
+#define ZN_RING_SUBSCRIBER_MAX_KEY_LEN 128
+#define ZN_RING_SUBSCRIBER_MAX_PAYLOAD_LEN 1024
+
 /**
  * Default socket timeout: 2 seconds
  */
@@ -137,10 +199,71 @@
 
 #define ZN_CONGESTION_CONTROL_DEFAULT zn_congestion_control_t_DROP
 
+/**
+ * Negotiate QoS on the transports: each priority is then transmitted on its own
+ * conduit, with its own sequence numbers, and frames carry a priority decorator.
+ * QoS is not negotiated on unicast transports doing retransmissions.
+ */
+#define ZN_TRANSPORT_QOS 0
+
+/**
+ * Enable TX batching on unicast transports: consecutive zenoh messages with the
+ * same reliability are appended to the open frame until the batch is full or
+ * the linger time expires. Pending data can be pushed out with znp_flush().
+ */
+#ifndef ZN_TX_BATCHING
+#define ZN_TX_BATCHING 0
+#endif
+
+/**
+ * Maximum time in milliseconds a batched message may wait before being flushed.
+ */
+#ifndef ZN_TX_BATCH_LINGER_MS
+#define ZN_TX_BATCH_LINGER_MS 1
+#endif
+
+/**
+ * Payloads larger than this size in bytes are not copied into the TX batch if the link
+ * supports vectored writes: they are handed over to the socket straight from the user buffer.
+ */
+#define ZN_TX_VECTORED_THRESHOLD 1024
+
+/**
+ * Acknowledge and retransmit reliable frames on unicast transports established over unreliable
+ * links (e.g. UDP unicast) by means of SYNC and ACK_NACK messages. The remote end must implement
+ * the same mechanism, hence it is disabled by default.
+ */
+#define ZN_UDP_UNICAST_RELIABILITY 0
+
+/**
+ * Number of unacknowledged reliable frames kept for retransmission, and number of out-of-order
+ * reliable frames kept for reordering. At most the number of bits of a z_zint_t.
+ */
+#define ZN_TX_RETRANSMISSION_WINDOW 16
+#define ZN_RX_REORDERING_WINDOW 16
+
+/**
+ * Interval in milliseconds between SYNC messages while reliable frames are unacknowledged: 100 ms
+ */
+#define ZN_SYNC_INTERVAL 100
+
+/**
+ * Number of datagrams received at once by the read tasks of the links supporting batched reads
+ * (e.g. recvmmsg on Linux). A read buffer of ZN_BATCH_SIZE bytes is allocated for each of them.
+ */
+#define ZN_RX_DATAGRAM_BATCH 8
+
 #define ZN_LINK_TCP 1
 #define ZN_LINK_UDP_MULTICAST 1
 #define ZN_LINK_UDP_UNICAST 1
 #define ZN_LINK_BLUETOOTH 0
+#define ZN_LINK_SHM 1
+
+/**
+ * Size in bytes of each of the two rings (one per direction) of a shared memory link between two
+ * sessions of the same host. It must be a power of two, and at most 2^31.
+ */
+#define ZN_LINK_SHM_RING_SIZE (1 << 20)
 
 #define ZN_SCOUTING_UDP 1
 
@@ -149,4 +272,18 @@
 #define ZN_FRAG_MAX_SIZE 300000
 #define ZN_DYNAMIC_MEMORY_ALLOCATION 0
 
+/**
+ * Defragmentation buffers are checked out of a pool shared by all the peers of a session when
+ * the first fragment of a zenoh message is received, and returned once the message is reassembled.
+ * Fragmented messages are dropped if no slot is available or if they do not fit in a slot.
+ */
+#define ZN_DEFRAG_POOL_SLOTS 4
+#define ZN_DEFRAG_POOL_SLOT_SIZE ZN_FRAG_MAX_SIZE
+
+/**
+ * Initial number of slots of the table indexing the peers of a multicast session by address. The
+ * table doubles whenever it is half full, so it must be a power of two.
+ */
+#define ZN_MULTICAST_PEER_TABLE_CAPACITY 16
+
 #endif /* ZENOH_PICO_CONFIG_H */
@@ -31,6 +31,9 @@
 #if ZN_LINK_BLUETOOTH == 1
 #define BT_SCHEMA "bt"
 #endif
+#if ZN_LINK_SHM == 1
+#define SHM_SCHEMA "shm"
+#endif
 
 #define LOCATOR_PROTOCOL_SEPARATOR '/'
 #define LOCATOR_METADATA_SEPARATOR '?'
@@ -71,4 +74,27 @@ _zn_endpoint_result_t _zn_endpoint_from_str(const z_str_t s);
 void _zn_endpoint_clear(_zn_endpoint_t *ep);
 void _zn_endpoint_free(_zn_endpoint_t **ep);
 
+/*------------------ Address ------------------*/
+// Large enough for an IPv6 address followed by a port
+#define _ZN_LINK_ADDR_SIZE 18
+
+/**
+ * The address of the remote end of a link, e.g. the sender of a multicast datagram.
+ * It is held inline, so that it can be read and looked up without any allocation.
+ *
+ * Members:
+ *   uint8_t val[]: the encoded address, its format is up to the link
+ *   uint8_t len: the length of the encoded address, 0 if it is not known
+ */
+typedef struct
+{
+    uint8_t val[_ZN_LINK_ADDR_SIZE];
+    uint8_t len;
+} _zn_link_addr_t;
+
+void _zn_link_addr_reset(_zn_link_addr_t *addr);
+void _zn_link_addr_append(_zn_link_addr_t *addr, const void *val, size_t len);
+int _zn_link_addr_eq(const _zn_link_addr_t *left, const _zn_link_addr_t *right);
+size_t _zn_link_addr_hash(const _zn_link_addr_t *addr);
+
 #endif /* ZENOH_PICO_LINK_ENDPOINT_H */
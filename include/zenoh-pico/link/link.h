@@ -32,6 +32,10 @@
 #include "zenoh-pico/system/link/bt.h"
 #endif
 
+#if ZN_LINK_SHM == 1 && defined(Z_LINK_SHM)
+#include "zenoh-pico/system/link/shm.h"
+#endif
+
 #include "zenoh-pico/utils/result.h"
 
 /*------------------ Link ------------------*/
@@ -40,9 +44,19 @@ typedef int (*_zn_f_link_listen)(void *arg);
 typedef void (*_zn_f_link_close)(void *arg);
 typedef size_t (*_zn_f_link_write)(const void *arg, const uint8_t *ptr, size_t len);
 typedef size_t (*_zn_f_link_write_all)(const void *arg, const uint8_t *ptr, size_t len);
-typedef size_t (*_zn_f_link_read)(const void *arg, uint8_t *ptr, size_t len, z_bytes_t *addr);
-typedef size_t (*_zn_f_link_read_exact)(const void *arg, uint8_t *ptr, size_t len, z_bytes_t *addr);
+typedef size_t (*_zn_f_link_writev)(const void *arg, const z_bytes_t *iov, size_t iovcnt);
+typedef size_t (*_zn_f_link_read)(const void *arg, uint8_t *ptr, size_t len, _zn_link_addr_t *addr);
+typedef size_t (*_zn_f_link_read_exact)(const void *arg, uint8_t *ptr, size_t len, _zn_link_addr_t *addr);
 typedef void (*_zn_f_link_free)(void *arg);
+typedef int (*_zn_f_link_fd)(const void *arg);
+typedef size_t (*_zn_f_link_read_batch)(const void *arg, uint8_t **bufs, size_t len, size_t *lens, size_t n, _zn_link_addr_t *addrs);
+typedef size_t (*_zn_f_link_writev_batch)(const void *arg, const z_bytes_t *iov, const size_t *iovcnts, size_t n);
+
+#if defined(Z_LINK_BATCH)
+#define _ZN_LINK_BATCH_MAX Z_LINK_BATCH_MAX
+#else
+#define _ZN_LINK_BATCH_MAX 1
+#endif
 
 typedef struct
 {
@@ -58,6 +72,9 @@ typedef struct
 #endif
 #if ZN_LINK_BLUETOOTH == 1
         _zn_bt_socket_t bt;
+#endif
+#if ZN_LINK_SHM == 1 && defined(Z_LINK_SHM)
+        _zn_shm_socket_t shm;
 #endif
     } socket;
 
@@ -66,9 +83,13 @@ typedef struct
     _zn_f_link_close close_f;
     _zn_f_link_write write_f;
     _zn_f_link_write_all write_all_f;
+    _zn_f_link_writev writev_f; // Optional, NULL if not supported
     _zn_f_link_read read_f;
     _zn_f_link_read_exact read_exact_f;
     _zn_f_link_free free_f;
+    _zn_f_link_fd fd_f; // Optional, NULL if the link cannot be polled for readiness
+    _zn_f_link_read_batch read_batch_f; // Optional, NULL if datagrams can only be read one at a time
+    _zn_f_link_writev_batch writev_batch_f; // Optional, NULL if datagrams can only be written one at a time
 
     uint16_t mtu;
     uint8_t is_reliable;
@@ -84,7 +105,21 @@ _zn_link_p_result_t _zn_open_link(const z_str_t locator);
 _zn_link_p_result_t _zn_listen_link(const z_str_t locator);
 
 int _zn_link_send_wbuf(const _zn_link_t *link, const _z_wbuf_t *wbf);
-size_t _zn_link_recv_zbuf(const _zn_link_t *link, _z_zbuf_t *zbf, z_bytes_t *addr);
-size_t _zn_link_recv_exact_zbuf(const _zn_link_t *link, _z_zbuf_t *zbf, size_t len, z_bytes_t *addr);
+int _zn_link_send_wbufs(const _zn_link_t *link, const _z_wbuf_t *wbfs, size_t n);
+size_t _zn_link_recv_zbuf(const _zn_link_t *link, _z_zbuf_t *zbf, _zn_link_addr_t *addr);
+size_t _zn_link_recv_exact_zbuf(const _zn_link_t *link, _z_zbuf_t *zbf, size_t len, _zn_link_addr_t *addr);
+
+/*------------------ Batched reads ------------------*/
+typedef struct
+{
+    uint8_t *bufs[ZN_RX_DATAGRAM_BATCH];
+    size_t lens[ZN_RX_DATAGRAM_BATCH];
+    _zn_link_addr_t addrs[ZN_RX_DATAGRAM_BATCH];
+    size_t len; // The number of datagrams received by the last read
+} _zn_link_rx_batch_t;
+
+_zn_link_rx_batch_t *_zn_link_rx_batch_make(void);
+void _zn_link_rx_batch_free(_zn_link_rx_batch_t **batch);
+size_t _zn_link_recv_batch(const _zn_link_t *link, _zn_link_rx_batch_t *batch, int is_addr);
 
 #endif /* ZENOH_PICO_LINK_H */
\ No newline at end of file
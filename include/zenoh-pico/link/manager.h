@@ -39,5 +39,8 @@ _zn_link_t *_zn_new_link_udp_unicast(_zn_endpoint_t endpoint);
 #if ZN_LINK_UDP_MULTICAST == 1
 _zn_link_t *_zn_new_link_udp_multicast(_zn_endpoint_t endpoint);
 #endif
+#if ZN_LINK_SHM == 1 && defined(Z_LINK_SHM)
+_zn_link_t *_zn_new_link_shm(_zn_endpoint_t endpoint);
+#endif
 
 #endif /* ZENOH_PICO_LINK_MANAGER_H */
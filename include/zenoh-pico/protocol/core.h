@@ -221,6 +221,36 @@ typedef enum
     zn_congestion_control_t_DROP,
 } zn_congestion_control_t;
 
+/**
+ * The priority of the data, from the highest to the lowest one. On transports supporting QoS,
+ * each priority is transmitted on its own conduit and higher priorities are sent first.
+ *
+ *     - **zn_priority_t_CONTROL**
+ *     - **zn_priority_t_REAL_TIME**
+ *     - **zn_priority_t_INTERACTIVE_HIGH**
+ *     - **zn_priority_t_INTERACTIVE_LOW**
+ *     - **zn_priority_t_DATA_HIGH**
+ *     - **zn_priority_t_DATA**
+ *     - **zn_priority_t_DATA_LOW**
+ *     - **zn_priority_t_BACKGROUND**
+ */
+typedef enum
+{
+    zn_priority_t_CONTROL = 0,
+    zn_priority_t_REAL_TIME = 1,
+    zn_priority_t_INTERACTIVE_HIGH = 2,
+    zn_priority_t_INTERACTIVE_LOW = 3,
+    zn_priority_t_DATA_HIGH = 4,
+    zn_priority_t_DATA = 5,
+    zn_priority_t_DATA_LOW = 6,
+    zn_priority_t_BACKGROUND = 7,
+} zn_priority_t;
+
+/**
+ * The priority of the frames without priority decorator.
+ */
+#define ZN_PRIORITY_DEFAULT zn_priority_t_DATA
+
 /**
  * The subscription period.
  *
@@ -248,6 +278,18 @@ typedef enum
     zn_submode_t_PULL,
 } zn_submode_t;
 
+/**
+ * The policy of a ring subscriber when its ring is full.
+ *
+ *     - **zn_ring_policy_t_DROP_OLDEST**: The oldest sample is dropped to make room.
+ *     - **zn_ring_policy_t_BLOCK**: Data dispatch blocks until a sample is received.
+ */
+typedef enum
+{
+    zn_ring_policy_t_DROP_OLDEST,
+    zn_ring_policy_t_BLOCK,
+} zn_ring_policy_t;
+
 /**
  * Informations to be passed to :c:func:`zn_declare_subscriber` to configure the created :c:type:`zn_subscriber_t`.
  *
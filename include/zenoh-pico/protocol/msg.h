@@ -239,7 +239,10 @@ void _zn_z_msg_clear_reply_context(_zn_reply_context_t *rc);
 // | ID  |  Prio   |
 // +-+-+-+---------+
 //
-// WARNING: zenoh-pico does not support priorities and QoS.
+// NOTE: zenoh-pico only decorates the frames, and only when their priority is not the default one.
+//
+#define _ZN_PRIORITY(h) (zn_priority_t)(_ZN_FLAGS(h) >> 5)
+#define _ZN_PRIORITY_HEADER(p) (uint8_t)(_ZN_MID_PRIORITY | ((p) << 5))
 
 /*=============================*/
 /*       Zenoh Messages        */
@@ -972,6 +975,7 @@ typedef union
 typedef struct
 {
     z_zint_t sn;
+    zn_priority_t priority; // Carried by the priority decorator, if any
     _zn_frame_payload_t payload;
 } _zn_frame_t;
 void _zn_t_msg_clear_frame(_zn_frame_t *msg, uint8_t header);
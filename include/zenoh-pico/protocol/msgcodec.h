@@ -93,11 +93,14 @@ _ZN_DECLARE_DECODE(hello);
 
 _ZN_DECLARE_ENCODE_NOH(transport_message);
 _ZN_DECLARE_DECODE_NOH(transport_message);
+void _zn_transport_message_decode_streamed_na(_z_zbuf_t *zbf, _zn_transport_message_result_t *r);
 
 /*------------------ Zenoh Message ------------------*/
 _ZN_DECLARE_ENCODE_NOH(zenoh_message);
 _ZN_DECLARE_DECODE_NOH(zenoh_message);
 
+int _zn_zenoh_message_encode_loan(_z_wbuf_t *wbf, const _zn_zenoh_message_t *msg, uint8_t **payload);
+
 #endif /* ZENOH_PICO_MSGCODEC_H */
 
 // NOTE: the following headers are for unit testing only
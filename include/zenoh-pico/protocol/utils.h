@@ -17,6 +17,8 @@
 
 #include "zenoh-pico/protocol/core.h"
 #include "zenoh-pico/collections/string.h"
+#include "zenoh-pico/collections/list.h"
+#include "zenoh-pico/collections/intmap.h"
 
 /**
  * Intersects two resource names. This function compares two resource names
@@ -31,6 +33,49 @@
  */
 int zn_rname_intersect(const z_str_t left, const z_str_t right);
 
+/*------------------ Resource name index ------------------*/
+/**
+ * A node of the resource name index. Each edge is labelled with a chunk of
+ * a resource name, i.e. the characters between two consecutive ``/``.
+ *
+ * Members:
+ *   z_str_t chunk: The chunk labelling the edge to this node.
+ *   _z_int_void_map_t children: The children with literal chunks, by chunk hash.
+ *   _z_list_t *wilds: The children with chunks containing a ``*``, except ``**``.
+ *   struct _zn_rname_node_t *dwild: The child with the ``**`` chunk, if any.
+ *   struct _zn_rname_node_t *next: The next literal sibling with the same chunk hash.
+ *   _z_list_t *vals: The values indexed by the resource name ending in this node.
+ */
+typedef struct _zn_rname_node_t
+{
+    z_str_t chunk;
+    _z_int_void_map_t children;
+    _z_list_t *wilds;
+    struct _zn_rname_node_t *dwild;
+    struct _zn_rname_node_t *next;
+    _z_list_t *vals;
+} _zn_rname_node_t;
+
+/**
+ * An index of values by resource name. Resource names are compiled into a
+ * trie of chunks with ``*`` and ``**`` edges, such that all the values whose
+ * resource name intersects a concrete resource name are found in a single
+ * traversal instead of being matched one by one.
+ *
+ * The index does not own its values.
+ */
+typedef struct
+{
+    _zn_rname_node_t *root;
+} _zn_rname_index_t;
+
+void _zn_rname_index_init(_zn_rname_index_t *idx);
+void _zn_rname_index_insert(_zn_rname_index_t *idx, const z_str_t rname, void *val);
+void _zn_rname_index_remove(_zn_rname_index_t *idx, const z_str_t rname, void *val);
+int _zn_rname_index_can_match(const z_str_t rname);
+_z_list_t *_zn_rname_index_match(const _zn_rname_index_t *idx, const z_str_t rname);
+void _zn_rname_index_clear(_zn_rname_index_t *idx);
+
 /*------------------ clone/Copy/Free helpers ------------------*/
 zn_reskey_t _zn_reskey_duplicate(const zn_reskey_t *resky);
 z_timestamp_t z_timestamp_duplicate(const z_timestamp_t *tstamp);
@@ -18,7 +18,10 @@
 #include "zenoh-pico/protocol/core.h"
 #include "zenoh-pico/transport/manager.h"
 #include "zenoh-pico/collections/list.h"
+#include "zenoh-pico/collections/intmap.h"
+#include "zenoh-pico/collections/vec.h"
 #include "zenoh-pico/collections/string.h"
+#include "zenoh-pico/system/collections.h"
 
 #define _ZN_RESOURCE_REMOTE 0
 #define _ZN_RESOURCE_IS_LOCAL 1
@@ -102,6 +105,9 @@ typedef struct
 {
     z_zint_t id;
     zn_reskey_t key;
+    z_str_t rname;     // Fully-expanded name, NULL while the RID of a prefix is unknown
+    _z_vec_t subs;     // Memoized matching local subscriptions, not owned
+    int is_subs_valid; // Whether subs is up to date with the local subscriptions
 } _zn_resource_t;
 
 int _zn_resource_eq(const _zn_resource_t *one, const _zn_resource_t *two);
@@ -109,6 +115,7 @@ void _zn_resource_clear(_zn_resource_t *res);
 
 _Z_ELEM_DEFINE(_zn_resource, _zn_resource_t, _zn_noop_size, _zn_resource_clear, _zn_noop_copy)
 _Z_LIST_DEFINE(_zn_resource, _zn_resource_t)
+_Z_INT_MAP_DEFINE(_zn_resource, _zn_resource_t)
 
 /**
  * The callback signature of the functions handling data messages.
@@ -123,6 +130,9 @@ typedef struct
     zn_subinfo_t info;
     zn_data_handler_t callback;
     void *arg;
+    void (*arg_drop)(void *arg); // Releases the arg once the subscription is freed, may be NULL
+    size_t refcount;             // Held by the session and by each dispatch in progress, protected by zn->mutex_refcount
+    z_condvar_t *drained;        // Signaled on release while being unregistered, protected by zn->mutex_refcount
 } _zn_subscriber_t;
 
 int _zn_subscriber_eq(const _zn_subscriber_t *one, const _zn_subscriber_t *two);
@@ -143,6 +153,8 @@ typedef struct
     unsigned int kind;
     zn_queryable_handler_t callback;
     void *arg;
+    size_t refcount;      // Held by the session and by each dispatch in progress, protected by zn->mutex_refcount
+    z_condvar_t *drained; // Signaled on release while being unregistered, protected by zn->mutex_refcount
 } _zn_queryable_t;
 
 int _zn_queryable_eq(const _zn_queryable_t *one, const _zn_queryable_t *two);
@@ -199,4 +211,97 @@ typedef struct
     _zn_reply_data_list_t *replies;
 } _zn_pending_query_collect_t;
 
+/**
+ * The samples received by a ring subscriber, waiting to be received by the application.
+ * The samples are stored in slots allocated along with the ring, one more than its
+ * capacity for the sample loaned to the application. The slots are passed by pointer
+ * between the queue of the free slots and the queue of the received samples.
+ * The ring is owned by the subscription and freed along with it.
+ */
+typedef struct
+{
+    z_mqueue_t *queue; // The received samples, the oldest first
+    z_mqueue_t *free;  // The slots available to the dispatch of the data
+    zn_sample_t *slots;
+    uint8_t *storage;  // The resource names and payloads of the slots
+    zn_sample_t *held; // The sample loaned to the application, NULL if none
+    zn_ring_policy_t policy;
+} _zn_sample_ring_t;
+
+/**
+ * A sample queued for an RX worker. Its resource name and payload are stored in the
+ * storage of the slot when they fit in it, and allocated otherwise.
+ */
+typedef struct
+{
+    zn_reskey_t key;
+    z_bytes_t payload;
+    uint8_t *storage; // ZN_RX_WORKER_SLOT_SIZE bytes
+} _zn_rx_sample_t;
+
+/**
+ * The samples of a worker move by pointer from the queue of its free slots to the
+ * queue of the samples to dispatch, and back.
+ */
+typedef struct
+{
+    void *zn; // FIXME: zn_session_t *zn;
+    z_mqueue_t *queue;
+    z_mqueue_t *free;
+    _zn_rx_sample_t *slots;
+    uint8_t *storage;
+    z_task_t task;
+} _zn_rx_worker_t;
+
+typedef struct
+{
+    _zn_rx_worker_t *workers;
+    size_t len;
+} _zn_rx_workers_t;
+
+typedef enum
+{
+    _ZN_TX_QUEUE_POLICY_BLOCK,
+    _ZN_TX_QUEUE_POLICY_DROP_NEWEST,
+    _ZN_TX_QUEUE_POLICY_DROP_OLDEST,
+} _zn_tx_queue_policy_t;
+
+typedef struct
+{
+    _zn_zenoh_message_t *z_msg;
+    zn_reliability_t reliability;
+    zn_congestion_control_t cong_ctrl;
+    zn_priority_t priority;
+    z_condvar_t *done; // NULL if the message is owned by the queue, otherwise signaled once it is sent
+    int is_done;
+    int res;
+} _zn_tx_entry_t;
+
+/**
+ * The zenoh messages waiting to be sent by the TX writer task, in a bounded ring.
+ * The ring is handled by hand rather than by a :c:type:`z_mqueue_t` such that the
+ * drop-oldest policy only evicts the messages that can be dropped.
+ */
+typedef struct
+{
+    void *zn; // FIXME: zn_session_t *zn;
+    _zn_tx_entry_t **entries;
+    size_t capacity; // 0 if the queue is disabled
+    size_t head;
+    size_t len;
+    _zn_tx_queue_policy_t policy;
+    z_zint_t timeout;
+
+    // Counters
+    size_t queued;
+    size_t dropped;
+
+    int is_closed;
+    int is_running;
+    z_mutex_t mutex;
+    z_condvar_t can_push;
+    z_condvar_t can_pull;
+    z_task_t task;
+} _zn_tx_queue_t;
+
 #endif /* ZENOH_PICO_SESSION_TYPES_H */
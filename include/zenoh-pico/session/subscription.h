@@ -27,6 +27,13 @@ int _zn_trigger_subscriptions(zn_session_t *zn, const zn_reskey_t reskey, const
 void _zn_unregister_subscription(zn_session_t *zn, int is_local, _zn_subscriber_t *sub);
 void _zn_flush_subscriptions(zn_session_t *zn);
 
+/*------------------ Sample ring ------------------*/
+_zn_sample_ring_t *_zn_sample_ring_make(size_t capacity, zn_ring_policy_t policy);
+void _zn_sample_ring_close(_zn_sample_ring_t *ring);
+void _zn_sample_ring_free(void *arg);
+void _zn_sample_ring_handler(const zn_sample_t *sample, const void *arg);
+int _zn_sample_ring_recv(_zn_sample_ring_t *ring, zn_sample_t *sample, int is_blocking);
+
 /*------------------ Pull ------------------*/
 z_zint_t _zn_get_pull_id(zn_session_t *zn);
 
@@ -25,6 +25,37 @@ int _zn_session_close(zn_session_t *zn, uint8_t reason);
 void _zn_session_free(zn_session_t **zn);
 
 int _zn_handle_zenoh_message(zn_session_t *zn, _zn_zenoh_message_t *z_msg);
-int _zn_send_z_msg(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl);
+int _zn_send_z_msg(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl, zn_priority_t priority);
+int __zn_send_z_msg(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl, zn_priority_t priority);
+uint8_t *_zn_loan_z_msg(zn_session_t *zn, const _zn_zenoh_message_t *z_msg, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl, zn_priority_t priority);
+int _zn_commit_z_msg(zn_session_t *zn);
+int _zn_abort_z_msg(zn_session_t *zn);
+
+/*------------------ Dispatch ------------------*/
+#define _ZN_DISPATCH_SNAPSHOT_LEN 8
+#define _ZN_DISPATCH_KEY_LEN 64
+
+/**
+ * The subscriptions or queryables matched by an incoming message. Each entry holds
+ * a reference so that the callbacks can run without any session lock being held,
+ * even if the entry is undeclared in the meantime. Small snapshots do not allocate.
+ */
+typedef struct _zn_dispatch_snapshot_t
+{
+    void *stack[_ZN_DISPATCH_SNAPSHOT_LEN];
+    void **val;
+    size_t len;
+    size_t capacity;
+    z_task_t task;                        // The task running the callbacks
+    struct _zn_dispatch_snapshot_t *next; // The other dispatches in progress
+} _zn_dispatch_snapshot_t;
+
+void _zn_dispatch_snapshot_init(_zn_dispatch_snapshot_t *ds);
+void _zn_dispatch_snapshot_append(_zn_dispatch_snapshot_t *ds, void *e);
+void _zn_dispatch_snapshot_clear(_zn_dispatch_snapshot_t *ds);
+void __unsafe_zn_dispatch_begin(zn_session_t *zn, _zn_dispatch_snapshot_t *ds);
+void __unsafe_zn_dispatch_end(zn_session_t *zn, _zn_dispatch_snapshot_t *ds);
+size_t __unsafe_zn_dispatch_drop(zn_session_t *zn, const void *e);
+void __unsafe_zn_wait_dispatches(zn_session_t *zn, const void *e, size_t *refcount, z_condvar_t **drained);
 
 #endif /* ZENOH_PICO_SESSION_UTILS_H */
@@ -0,0 +1,32 @@
+//
+// Copyright (c) 2022 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+#ifndef ZENOH_PICO_SESSION_WORKERS_H
+#define ZENOH_PICO_SESSION_WORKERS_H
+
+#include "zenoh-pico/api/session.h"
+
+/*------------------ RX workers ------------------*/
+int _zn_rx_workers_start(zn_session_t *zn, size_t len);
+void _zn_rx_workers_stop(zn_session_t *zn);
+void _zn_rx_workers_clear(zn_session_t *zn);
+int _zn_rx_workers_push(zn_session_t *zn, const zn_reskey_t *reskey, const z_bytes_t *payload);
+
+/*------------------ TX queue ------------------*/
+int _zn_tx_queue_start(zn_session_t *zn, size_t capacity, _zn_tx_queue_policy_t policy, z_zint_t timeout);
+void _zn_tx_queue_stop(zn_session_t *zn);
+void _zn_tx_queue_clear(zn_session_t *zn);
+int _zn_tx_queue_push(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl, zn_priority_t priority);
+
+#endif /* ZENOH_PICO_SESSION_WORKERS_H */
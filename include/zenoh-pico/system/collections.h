@@ -34,4 +34,32 @@ z_mvar_t *z_mvar_of(void *e);
 void *z_mvar_get(z_mvar_t *mv);
 void z_mvar_put(z_mvar_t *mv, void *e);
 
+/*-------- Mqueue --------*/
+/**
+ * A bounded FIFO queue shared by any number of producers and consumers.
+ * Producers block while it is full and consumers block while it is empty,
+ * until the queue is closed. z_mqueue_push_force never blocks and returns the
+ * element left to the caller: the evicted oldest one, or the pushed one once closed.
+ */
+typedef struct
+{
+    void **elems;
+    size_t capacity;
+    size_t head;
+    size_t len;
+    int is_closed;
+    z_mutex_t mtx;
+    z_condvar_t can_push;
+    z_condvar_t can_pull;
+} z_mqueue_t;
+
+z_mqueue_t *z_mqueue_make(size_t capacity);
+void z_mqueue_free(z_mqueue_t **mq);
+
+int z_mqueue_push(z_mqueue_t *mq, void *e);
+void *z_mqueue_push_force(z_mqueue_t *mq, void *e);
+void *z_mqueue_pull(z_mqueue_t *mq);
+void *z_mqueue_try_pull(z_mqueue_t *mq);
+void z_mqueue_close(z_mqueue_t *mq);
+
 #endif /* ZENOH_PICO_SYSTEM_COLLECTIONS_H */
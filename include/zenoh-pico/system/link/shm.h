@@ -0,0 +1,40 @@
+//
+// Copyright (c) 2022 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+#ifndef ZENOH_PICO_SYSTEM_LINK_SHM_H
+#define ZENOH_PICO_SYSTEM_LINK_SHM_H
+
+#include <stdint.h>
+#include "zenoh-pico/config.h"
+#include "zenoh-pico/collections/bytes.h"
+#include "zenoh-pico/collections/string.h"
+#include "zenoh-pico/system/platform.h"
+
+#if ZN_LINK_SHM == 1 && defined(Z_LINK_SHM)
+
+typedef struct
+{
+    void *sock;
+} _zn_shm_socket_t;
+
+void *_zn_open_shm(const z_str_t name, unsigned long tout);
+void *_zn_listen_shm(const z_str_t name, unsigned long tout);
+void _zn_close_shm(void *sock_arg);
+size_t _zn_read_exact_shm(void *sock_arg, uint8_t *ptr, size_t len);
+size_t _zn_read_shm(void *sock_arg, uint8_t *ptr, size_t len);
+size_t _zn_send_shm(void *sock_arg, const uint8_t *ptr, size_t len);
+size_t _zn_sendv_shm(void *sock_arg, const z_bytes_t *iov, size_t iovcnt);
+#endif
+
+#endif /* ZENOH_PICO_SYSTEM_LINK_SHM_H */
@@ -16,7 +16,9 @@
 #define ZENOH_PICO_SYSTEM_LINK_TCP_H
 
 #include <stdint.h>
+#include "zenoh-pico/collections/bytes.h"
 #include "zenoh-pico/collections/string.h"
+#include "zenoh-pico/system/platform.h"
 
 #if ZN_LINK_TCP == 1
 
@@ -35,6 +37,12 @@ void _zn_close_tcp(void *sock_arg);
 size_t _zn_read_exact_tcp(void *sock_arg, uint8_t *ptr, size_t len);
 size_t _zn_read_tcp(void *sock_arg, uint8_t *ptr, size_t len);
 size_t _zn_send_tcp(void *sock_arg, const uint8_t *ptr, size_t len);
+#if defined(Z_LINK_SENDV)
+size_t _zn_sendv_tcp(void *sock_arg, const z_bytes_t *iov, size_t iovcnt);
+#endif
+#if defined(Z_EVENT_LOOP)
+int _zn_get_fd_tcp(void *sock_arg);
+#endif
 #endif
 
 #endif /* ZENOH_PICO_SYSTEM_LINK_TCP_H */
@@ -16,7 +16,10 @@
 #define ZENOH_PICO_SYSTEM_LINK_UDP_H
 
 #include <stdint.h>
+#include "zenoh-pico/collections/bytes.h"
 #include "zenoh-pico/collections/string.h"
+#include "zenoh-pico/link/endpoint.h"
+#include "zenoh-pico/system/platform.h"
 
 #if ZN_LINK_UDP_UNICAST == 1 || ZN_LINK_UDP_MULTICAST == 1
 
@@ -38,14 +41,31 @@ void _zn_close_udp_unicast(void *sock_arg);
 size_t _zn_read_exact_udp_unicast(void *sock_arg, uint8_t *ptr, size_t len);
 size_t _zn_read_udp_unicast(void *sock_arg, uint8_t *ptr, size_t len);
 size_t _zn_send_udp_unicast(void *sock_arg, const uint8_t *ptr, size_t len, void *raddr_arg);
+#if defined(Z_LINK_SENDV)
+size_t _zn_sendv_udp_unicast(void *sock_arg, const z_bytes_t *iov, size_t iovcnt, void *raddr_arg);
+#endif
+#if defined(Z_LINK_BATCH)
+size_t _zn_read_batch_udp_unicast(void *sock_arg, uint8_t **bufs, size_t len, size_t *lens, size_t n);
+size_t _zn_sendv_batch_udp_unicast(void *sock_arg, const z_bytes_t *iov, const size_t *iovcnts, size_t n, void *raddr_arg);
+#endif
+#if defined(Z_EVENT_LOOP)
+int _zn_get_fd_udp_unicast(void *sock_arg);
+#endif
 
 // Multicast
 void *_zn_open_udp_multicast(void *raddr_arg, void **laddr_arg, unsigned long tout, const z_str_t iface);
 void *_zn_listen_udp_multicast(void *raddr_arg, unsigned long tout, const z_str_t iface);
 void _zn_close_udp_multicast(void *sockrecv_arg, void *socksend_arg, void *raddr_arg);
-size_t _zn_read_exact_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *laddr_arg, z_bytes_t *addr);
-size_t _zn_read_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *laddr_arg, z_bytes_t *addr);
+size_t _zn_read_exact_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *laddr_arg, _zn_link_addr_t *addr);
+size_t _zn_read_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *laddr_arg, _zn_link_addr_t *addr);
 size_t _zn_send_udp_multicast(void *sock_arg, const uint8_t *ptr, size_t len, void *raddr_arg);
+#if defined(Z_LINK_SENDV)
+size_t _zn_sendv_udp_multicast(void *sock_arg, const z_bytes_t *iov, size_t iovcnt, void *raddr_arg);
+#endif
+#if defined(Z_LINK_BATCH)
+size_t _zn_read_batch_udp_multicast(void *sock_arg, uint8_t **bufs, size_t len, size_t *lens, size_t n, void *laddr_arg, _zn_link_addr_t *addrs);
+size_t _zn_sendv_batch_udp_multicast(void *sock_arg, const z_bytes_t *iov, const size_t *iovcnts, size_t n, void *raddr_arg);
+#endif
 #endif
 
 #endif /* ZENOH_PICO_SYSTEM_LINK_UDP_H */
@@ -50,6 +50,10 @@ int z_task_join(z_task_t *task);
 int z_task_cancel(z_task_t *task);
 void z_task_free(z_task_t **task);
 
+// Only tasks returned by z_task_self can be compared
+z_task_t z_task_self(void);
+int z_task_eq(const z_task_t *left, const z_task_t *right);
+
 /*------------------ Mutex ------------------*/
 int z_mutex_init(z_mutex_t *m);
 int z_mutex_free(z_mutex_t *m);
@@ -58,12 +62,22 @@ int z_mutex_lock(z_mutex_t *m);
 int z_mutex_trylock(z_mutex_t *m);
 int z_mutex_unlock(z_mutex_t *m);
 
+/*------------------ RWLock ------------------*/
+int z_rwlock_init(z_rwlock_t *rw);
+int z_rwlock_free(z_rwlock_t *rw);
+
+int z_rwlock_rdlock(z_rwlock_t *rw);
+int z_rwlock_wrlock(z_rwlock_t *rw);
+int z_rwlock_unlock(z_rwlock_t *rw);
+
 /*------------------ CondVar ------------------*/
 int z_condvar_init(z_condvar_t *cv);
 int z_condvar_free(z_condvar_t *cv);
 
 int z_condvar_signal(z_condvar_t *cv);
 int z_condvar_wait(z_condvar_t *cv, z_mutex_t *m);
+// Returns 0 once signaled, non-zero if the time in milliseconds elapsed first
+int z_condvar_timedwait(z_condvar_t *cv, z_mutex_t *m, unsigned int time);
 
 /*------------------ Sleep ------------------*/
 int z_sleep_us(unsigned int time);
@@ -82,4 +96,16 @@ unsigned long z_time_elapsed_us(z_time_t *time);
 unsigned long z_time_elapsed_ms(z_time_t *time);
 unsigned long z_time_elapsed_s(z_time_t *time);
 
+#if defined(Z_EVENT_LOOP)
+/*------------------ Poller ------------------*/
+int z_poller_init(z_poller_t *p);
+int z_poller_free(z_poller_t *p);
+int z_poller_fd(const z_poller_t *p);
+
+int z_poller_add(z_poller_t *p, int fd, void *arg);
+int z_poller_remove(z_poller_t *p, int fd);
+int z_poller_set_timer(z_poller_t *p, unsigned long time);
+int z_poller_wait(z_poller_t *p, void **args, size_t len, int timeout);
+#endif
+
 #endif /* ZENOH_PICO_SYSTEM_COMMON_H */
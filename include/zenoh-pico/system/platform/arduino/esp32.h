@@ -22,6 +22,7 @@
 typedef TaskHandle_t z_task_t;
 typedef void *z_task_attr_t; // Not used in ESP32
 typedef pthread_mutex_t z_mutex_t;
+typedef pthread_mutex_t z_rwlock_t; // Readers are serialized, no rwlock in every ESP-IDF release
 typedef pthread_cond_t z_condvar_t;
 
 typedef struct timespec z_clock_t;
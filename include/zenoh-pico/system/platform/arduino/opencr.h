@@ -21,6 +21,7 @@
 typedef void *z_task_t;
 typedef void *z_task_attr_t;
 typedef void *z_mutex_t;
+typedef void *z_rwlock_t;
 typedef void *z_condvar_t;
 
 typedef struct timespec z_clock_t;
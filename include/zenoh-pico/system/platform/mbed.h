@@ -23,6 +23,7 @@ typedef int _zn_socket_t;
 typedef void *z_task_t;         // Workaround as MBED is a C++ library
 typedef void *z_task_attr_t;    // Workaround as MBED is a C++ library
 typedef void *z_mutex_t;        // Workaround as MBED is a C++ library
+typedef void *z_rwlock_t;       // Workaround as MBED is a C++ library
 typedef void *z_condvar_t;      // Workaround as MBED is a C++ library
 
 typedef void *z_clock_t;        // Not defined
@@ -22,9 +22,32 @@
 typedef pthread_t z_task_t;
 typedef pthread_attr_t z_task_attr_t;
 typedef pthread_mutex_t z_mutex_t;
+typedef pthread_rwlock_t z_rwlock_t;
 typedef pthread_cond_t z_condvar_t;
 
 typedef struct timespec z_clock_t;
 typedef struct timeval z_time_t;
 
+// Vectored socket writes (i.e. sendmsg) are supported on this platform
+#define Z_LINK_SENDV 1
+#define Z_LINK_SENDV_IOV_MAX 16
+
+#if defined(ZENOH_LINUX)
+// Batched datagram reads and writes (i.e. recvmmsg, sendmmsg and UDP_SEGMENT) are supported on this platform
+#define Z_LINK_BATCH 1
+#define Z_LINK_BATCH_MAX 16
+
+// Readiness notifications on the link sockets (i.e. epoll) are supported on this platform
+#define Z_EVENT_LOOP 1
+
+// Links through POSIX shared memory, waiting on futexes, are supported on this platform
+#define Z_LINK_SHM 1
+
+typedef struct
+{
+    int epoll_fd;
+    int timer_fd;
+} z_poller_t;
+#endif
+
 #endif /* ZENOH_PICO_SYSTEM_UNIX_TYPES_H */
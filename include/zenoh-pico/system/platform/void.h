@@ -18,6 +18,7 @@
 typedef void *z_task_t;
 typedef void *z_task_attr_t;
 typedef void *z_mutex_t;
+typedef void *z_rwlock_t;
 typedef void *z_condvar_t;
 
 typedef void *z_clock_t;
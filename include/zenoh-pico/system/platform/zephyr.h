@@ -21,6 +21,7 @@
 typedef pthread_t z_task_t;
 typedef pthread_attr_t z_task_attr_t;
 typedef pthread_mutex_t z_mutex_t;
+typedef pthread_rwlock_t z_rwlock_t;
 typedef pthread_cond_t z_condvar_t;
 
 typedef struct timespec z_clock_t;
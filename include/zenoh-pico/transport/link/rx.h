@@ -21,14 +21,17 @@
 
 /*------------------ Transmission and Reception helpers ------------------*/
 _zn_transport_message_result_t _zn_unicast_recv_t_msg(_zn_transport_unicast_t *ztu);
-_zn_transport_message_result_t _zn_multicast_recv_t_msg(_zn_transport_multicast_t *ztm, z_bytes_t *addr);
+_zn_transport_message_result_t _zn_multicast_recv_t_msg(_zn_transport_multicast_t *ztm, _zn_link_addr_t *addr);
 
 _zn_transport_message_result_t _zn_link_recv_t_msg(const _zn_link_t *zl);
 
 void _zn_unicast_recv_t_msg_na(_zn_transport_unicast_t *ztu, _zn_transport_message_result_t *r);
-void _zn_multicast_recv_t_msg_na(_zn_transport_multicast_t *ztm, _zn_transport_message_result_t *r, z_bytes_t *addr);
+void _zn_multicast_recv_t_msg_na(_zn_transport_multicast_t *ztm, _zn_transport_message_result_t *r, _zn_link_addr_t *addr);
 
 int _zn_unicast_handle_transport_message(_zn_transport_unicast_t *ztu, _zn_transport_message_t *t_msg);
-int _zn_multicast_handle_transport_message(_zn_transport_multicast_t *ztm, _zn_transport_message_t *t_msg, z_bytes_t *addr);
+int _zn_multicast_handle_transport_message(_zn_transport_multicast_t *ztm, _zn_transport_message_t *t_msg, _zn_link_addr_t *addr);
+
+int _zn_unicast_handle_streamed_transport_message(_zn_transport_unicast_t *ztu, _zn_transport_message_t *t_msg, _z_zbuf_t *zbf);
+int _zn_multicast_handle_streamed_transport_message(_zn_transport_multicast_t *ztm, _zn_transport_message_t *t_msg, _z_zbuf_t *zbf, _zn_link_addr_t *addr);
 
 #endif /* ZENOH_PICO_TRANSPORT_LINK_RX_H */
\ No newline at end of file
@@ -17,6 +17,37 @@
 
 #include "zenoh-pico/transport/transport.h"
 
+/**
+ * The time left until the lease events of a unicast transport, in milliseconds.
+ */
+typedef struct
+{
+    z_zint_t next_lease;
+    z_zint_t next_keep_alive;
+    z_zint_t next_sync;
+} _znp_unicast_lease_timers_t;
+
+void _znp_unicast_lease_init(_zn_transport_unicast_t *ztu, _znp_unicast_lease_timers_t *timers);
+int _znp_unicast_lease_process(_zn_transport_unicast_t *ztu, _znp_unicast_lease_timers_t *timers, z_zint_t *interval);
+void _znp_unicast_lease_elapse(_zn_transport_unicast_t *ztu, _znp_unicast_lease_timers_t *timers, z_zint_t elapsed);
+
+/**
+ * The deadlines of the periodic messages of a multicast transport, in milliseconds since its
+ * lease epoch. The lease deadlines of the peers are kept in the lease heap of the transport.
+ */
+typedef struct
+{
+    z_zint_t next_keep_alive;
+    z_zint_t next_join;
+} _znp_multicast_lease_timers_t;
+
+z_zint_t _znp_multicast_lease_now(_zn_transport_multicast_t *ztm);
+void _znp_multicast_lease_init(_zn_transport_multicast_t *ztm, _znp_multicast_lease_timers_t *timers);
+void __unsafe_znp_multicast_lease_process(_zn_transport_multicast_t *ztm, _znp_multicast_lease_timers_t *timers, z_zint_t now, z_zint_t *interval);
+int __unsafe_znp_multicast_lease_add(_zn_transport_multicast_t *ztm, _zn_transport_peer_entry_t *entry);
+void __unsafe_znp_multicast_lease_set(_zn_transport_multicast_t *ztm, _zn_transport_peer_entry_t *entry, z_zint_t lease);
+void __unsafe_znp_multicast_lease_remove(_zn_transport_multicast_t *ztm, _zn_transport_peer_entry_t *entry);
+
 int _znp_send_keep_alive(_zn_transport_t *zt);
 int _znp_unicast_send_keep_alive(_zn_transport_unicast_t *ztu);
 int _znp_multicast_send_keep_alive(_zn_transport_multicast_t *ztm);
@@ -0,0 +1,75 @@
+//
+// Copyright (c) 2022 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+#ifndef ZENOH_PICO_TRANSPORT_LINK_TASK_REACTOR_H
+#define ZENOH_PICO_TRANSPORT_LINK_TASK_REACTOR_H
+
+#include "zenoh-pico/transport/transport.h"
+#include "zenoh-pico/transport/link/task/lease.h"
+
+#if defined(Z_EVENT_LOOP)
+
+/**
+ * A unicast transport driven by a reactor instead of its read and lease tasks.
+ *
+ * Members:
+ *   _zn_transport_unicast_t *ztu: The transport.
+ *   _znp_unicast_lease_timers_t timers: The time left until its lease events.
+ *   z_zint_t last: The reactor time its timers were last advanced at, in milliseconds.
+ *   int fd: The descriptor its link is polled on.
+ *   int is_polled: Whether its link is still polled, i.e. it has not been closed.
+ *   int is_expired: Whether its lease has expired, i.e. the transport has been closed.
+ */
+typedef struct
+{
+    _zn_transport_unicast_t *ztu;
+    _znp_unicast_lease_timers_t timers;
+    z_zint_t last;
+    int fd;
+    int is_polled;
+    int is_expired;
+    int is_rx_task; // The task processing the reactor has been recorded as the RX task of the transport
+} _znp_reactor_entry_t;
+
+int _znp_reactor_entry_eq(const _znp_reactor_entry_t *left, const _znp_reactor_entry_t *right);
+_Z_ELEM_DEFINE(_znp_reactor_entry, _znp_reactor_entry_t, _zn_noop_size, _zn_noop_clear, _zn_noop_copy)
+_Z_LIST_DEFINE(_znp_reactor_entry, _znp_reactor_entry_t)
+
+/**
+ * A single-threaded event loop multiplexing the links and the lease timers of
+ * several unicast transports. It is not thread-safe: all its functions are to
+ * be called from the same task.
+ *
+ * Members:
+ *   z_poller_t poller: The poller of the links, it also carries the lease timer.
+ *   _znp_reactor_entry_list_t *entries: The transports driven by the reactor.
+ *   z_clock_t start: The origin of the reactor time.
+ */
+typedef struct
+{
+    z_poller_t poller;
+    _znp_reactor_entry_list_t *entries;
+    z_clock_t start;
+} _znp_reactor_t;
+
+int _znp_reactor_init(_znp_reactor_t *r);
+void _znp_reactor_clear(_znp_reactor_t *r);
+
+int _znp_reactor_add(_znp_reactor_t *r, _zn_transport_t *zt);
+int _znp_reactor_remove(_znp_reactor_t *r, _zn_transport_t *zt);
+int _znp_reactor_process(_znp_reactor_t *r, int timeout);
+
+#endif
+
+#endif /* ZENOH_PICO_TRANSPORT_LINK_TASK_REACTOR_H */
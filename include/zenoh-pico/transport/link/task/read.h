@@ -20,6 +20,7 @@
 int _znp_read(_zn_transport_t *zt);
 int _znp_unicast_read(_zn_transport_unicast_t *ztu);
 int _znp_multicast_read(_zn_transport_multicast_t *ztm);
+int _znp_unicast_read_ready(_zn_transport_unicast_t *ztu);
 
 void *_znp_read_task(void *arg);
 void *_znp_unicast_read_task(void *arg);
@@ -21,12 +21,38 @@
 
 void __unsafe_zn_prepare_wbuf(_z_wbuf_t *buf, int is_streamed);
 void __unsafe_zn_finalize_wbuf(_z_wbuf_t *buf, int is_streamed);
-_zn_transport_message_t __zn_frame_header(zn_reliability_t reliability, int is_fragment, int is_final, z_zint_t sn);
-int __unsafe_zn_serialize_zenoh_fragment(_z_wbuf_t *dst, _z_wbuf_t *src, zn_reliability_t reliability, size_t sn);
+_zn_transport_message_t __zn_frame_header(zn_reliability_t reliability, zn_priority_t priority, int is_fragment, int is_final, z_zint_t sn);
+int __zn_zenoh_message_exceeds(const _zn_zenoh_message_t *z_msg, size_t space);
+int __zn_siphon_fragment(_z_wbuf_t *dst, _z_wbuf_t *src, size_t length);
+int __unsafe_zn_serialize_zenoh_fragment(_z_wbuf_t *dst, _z_wbuf_t *src, zn_reliability_t reliability, zn_priority_t priority, size_t sn, size_t mtu);
+int __zn_link_can_send_vectored(const _zn_link_t *zl, const _zn_zenoh_message_t *z_msg);
+int __unsafe_zn_serialize_zenoh_frame_vectored(_z_wbuf_t *dst, const _zn_transport_message_t *f_hdr, const _zn_zenoh_message_t *z_msg, int is_streamed, size_t mtu);
+int __zn_link_can_batch_fragments(const _zn_link_t *zl);
+
+/*------------------ Fragment batching helpers ------------------*/
+typedef struct
+{
+    _z_wbuf_t bufs[_ZN_LINK_BATCH_MAX]; // The fragments serialized but not sent yet
+    size_t len;
+    size_t made; // The buffers allocated so far, kept across batches
+} _zn_fragment_batch_t;
+
+void _zn_fragment_batch_init(_zn_fragment_batch_t *fb);
+_z_wbuf_t *_zn_fragment_batch_next(_zn_fragment_batch_t *fb);
+int _zn_fragment_batch_is_full(const _zn_fragment_batch_t *fb);
+int _zn_fragment_batch_send(_zn_fragment_batch_t *fb, const _zn_link_t *zl);
+void _zn_fragment_batch_clear(_zn_fragment_batch_t *fb);
 
 /*------------------ Transmission and Reception helpers ------------------*/
-int _zn_unicast_send_z_msg(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl);
-int _zn_multicast_send_z_msg(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl);
+int _zn_unicast_send_z_msg(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl, zn_priority_t priority);
+int _zn_multicast_send_z_msg(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl, zn_priority_t priority);
+
+uint8_t *_zn_unicast_loan_z_msg(zn_session_t *zn, const _zn_zenoh_message_t *z_msg, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl, zn_priority_t priority);
+uint8_t *_zn_multicast_loan_z_msg(zn_session_t *zn, const _zn_zenoh_message_t *z_msg, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl, zn_priority_t priority);
+int _zn_unicast_commit_z_msg(zn_session_t *zn);
+int _zn_multicast_commit_z_msg(zn_session_t *zn);
+int _zn_unicast_abort_z_msg(zn_session_t *zn);
+int _zn_multicast_abort_z_msg(zn_session_t *zn);
 
 int _zn_send_t_msg(_zn_transport_t *zt, const _zn_transport_message_t *t_msg);
 int _zn_unicast_send_t_msg(_zn_transport_unicast_t *ztu, const _zn_transport_message_t *t_msg);
@@ -34,4 +60,17 @@ int _zn_multicast_send_t_msg(_zn_transport_multicast_t *ztm, const _zn_transport
 
 int _zn_link_send_t_msg(const _zn_link_t *zl, const _zn_transport_message_t *t_msg);
 
+/*------------------ Batching helpers ------------------*/
+int __unsafe_zn_unicast_flush(_zn_transport_unicast_t *ztu);
+int _zn_unicast_flush(_zn_transport_unicast_t *ztu);
+int _zn_unicast_flush_lingering(_zn_transport_unicast_t *ztu);
+int _zn_unicast_is_batch_open(_zn_transport_unicast_t *ztu);
+void _zn_unicast_wait_batch(_zn_transport_unicast_t *ztu, unsigned int time);
+int _zn_flush(_zn_transport_t *zt);
+
+/*------------------ Retransmission helpers ------------------*/
+int _zn_unicast_sync(_zn_transport_unicast_t *ztu);
+void _zn_unicast_set_rx_task(_zn_transport_unicast_t *ztu, int is_rx_task);
+int _zn_unicast_handle_ack_nack(_zn_transport_unicast_t *ztu, const _zn_ack_nack_t *ack_nack);
+
 #endif /* ZENOH_PICO_TRANSPORT_LINK_TX_H */
\ No newline at end of file
@@ -19,12 +19,13 @@
 #include "zenoh-pico/protocol/msg.h"
 #include "zenoh-pico/link/link.h"
 #include "zenoh-pico/collections/bytes.h"
+#include "zenoh-pico/transport/utils.h"
 
 typedef struct
 {
-    // Defragmentation buffers
-    _z_wbuf_t dbuf_reliable;
-    _z_wbuf_t dbuf_best_effort;
+    // Defragmentation buffers, per priority
+    _zn_defrag_buf_t dbuf_reliable[ZN_PRIORITIES_NUM];
+    _zn_defrag_buf_t dbuf_best_effort[ZN_PRIORITIES_NUM];
 
     // SN numbers
     z_zint_t sn_resolution;
@@ -32,10 +33,11 @@ typedef struct
     _zn_conduit_sn_list_t sn_rx_sns;
 
     z_bytes_t remote_pid;
-    z_bytes_t remote_addr;
+    _zn_link_addr_t remote_addr;
 
     volatile z_zint_t lease;
-    volatile z_zint_t next_lease;
+    z_zint_t next_lease; // Deadline of the lease, in milliseconds since the lease epoch of the transport
+    size_t lease_index;  // Position in the lease heap of the transport
     volatile int received;
 } _zn_transport_peer_entry_t;
 
@@ -44,7 +46,77 @@ void _zn_transport_peer_entry_clear(_zn_transport_peer_entry_t *src);
 void _zn_transport_peer_entry_copy(_zn_transport_peer_entry_t *dst, const _zn_transport_peer_entry_t *src);
 int _zn_transport_peer_entry_eq(const _zn_transport_peer_entry_t *left, const _zn_transport_peer_entry_t *right);
 _Z_ELEM_DEFINE(_zn_transport_peer_entry, _zn_transport_peer_entry_t, _zn_transport_peer_entry_size, _zn_transport_peer_entry_clear, _zn_transport_peer_entry_copy)
-_Z_LIST_DEFINE(_zn_transport_peer_entry, _zn_transport_peer_entry_t)
+
+/**
+ * A slot of the peer table, keyed by the inline address of the peer.
+ *
+ * Members:
+ *   _zn_link_addr_t addr: the address of the peer in the slot
+ *   _zn_transport_peer_entry_t *entry: the peer, NULL if the slot is free or was removed
+ *   uint8_t is_used: whether the slot has ever been used, removed slots keep the probe chains going
+ */
+typedef struct
+{
+    _zn_link_addr_t addr;
+    _zn_transport_peer_entry_t *entry;
+    uint8_t is_used;
+} _zn_transport_peer_slot_t;
+
+/**
+ * An open-addressing hashmap of the peers with linear probing. Looking up a peer neither
+ * allocates nor walks the other peers, and removing a peer does not move the other slots,
+ * so the table can be iterated while peers are removed.
+ *
+ * Members:
+ *   _zn_transport_peer_slot_t *slots: the slots of the table
+ *   size_t capacity: the number of slots, a power of two
+ *   size_t len: the number of peers in the table
+ *   size_t used: the number of used slots, including the removed ones
+ */
+typedef struct
+{
+    _zn_transport_peer_slot_t *slots;
+    size_t capacity;
+    size_t len;
+    size_t used;
+} _zn_transport_peer_table_t;
+
+_zn_transport_peer_table_t _zn_transport_peer_table_make(size_t capacity);
+void _zn_transport_peer_table_clear(_zn_transport_peer_table_t *t);
+
+_zn_transport_peer_entry_t *_zn_transport_peer_table_get(const _zn_transport_peer_table_t *t, const _zn_link_addr_t *addr);
+int _zn_transport_peer_table_insert(_zn_transport_peer_table_t *t, _zn_transport_peer_entry_t *entry);
+void _zn_transport_peer_table_remove(_zn_transport_peer_table_t *t, _zn_transport_peer_entry_t *entry);
+
+size_t _zn_transport_peer_table_len(const _zn_transport_peer_table_t *t);
+size_t _zn_transport_peer_table_capacity(const _zn_transport_peer_table_t *t);
+_zn_transport_peer_entry_t *_zn_transport_peer_table_at(const _zn_transport_peer_table_t *t, size_t i);
+
+/**
+ * A binary min-heap of the peers ordered by lease deadline. Each peer records its position in
+ * the heap, so it is rescheduled or removed in O(log N) without being searched for.
+ *
+ * Members:
+ *   _zn_transport_peer_entry_t **vals: the peers, the one whose lease expires first at the top
+ *   size_t capacity: the number of peers the heap can hold before growing
+ *   size_t len: the number of peers in the heap
+ */
+typedef struct
+{
+    _zn_transport_peer_entry_t **vals;
+    size_t capacity;
+    size_t len;
+} _zn_transport_peer_heap_t;
+
+_zn_transport_peer_heap_t _zn_transport_peer_heap_make(size_t capacity);
+void _zn_transport_peer_heap_clear(_zn_transport_peer_heap_t *h);
+
+int _zn_transport_peer_heap_push(_zn_transport_peer_heap_t *h, _zn_transport_peer_entry_t *entry);
+void _zn_transport_peer_heap_update(_zn_transport_peer_heap_t *h, _zn_transport_peer_entry_t *entry);
+void _zn_transport_peer_heap_remove(_zn_transport_peer_heap_t *h, _zn_transport_peer_entry_t *entry);
+
+_zn_transport_peer_entry_t *_zn_transport_peer_heap_top(const _zn_transport_peer_heap_t *h);
+size_t _zn_transport_peer_heap_len(const _zn_transport_peer_heap_t *h);
 
 typedef struct
 {
@@ -55,17 +127,30 @@ typedef struct
     z_mutex_t mutex_rx;
     z_mutex_t mutex_tx;
 
-    // Defragmentation buffers
-    _z_wbuf_t dbuf_reliable;
-    _z_wbuf_t dbuf_best_effort;
+    // Order in which the zenoh messages get the TX mutex
+    _zn_tx_scheduler_t tx_scheduler;
 
-    // SN numbers
+    // Defragmentation buffers, per priority
+    _zn_defrag_pool_t dbuf_pool;
+    _zn_defrag_buf_t dbuf_reliable[ZN_PRIORITIES_NUM];
+    _zn_defrag_buf_t dbuf_best_effort[ZN_PRIORITIES_NUM];
+
+    // SN numbers, per priority if QoS is enabled
     z_zint_t sn_resolution;
     z_zint_t sn_resolution_half;
-    z_zint_t sn_tx_reliable;
-    z_zint_t sn_tx_best_effort;
-    z_zint_t sn_rx_reliable;
-    z_zint_t sn_rx_best_effort;
+    _zn_conduit_sn_list_t sn_tx_sns;
+    _zn_conduit_sn_list_t sn_rx_sns;
+
+    // Reliability over unreliable links
+    int is_retransmitting;
+    _zn_frame_window_t tx_window; // Unacknowledged reliable frames, from the oldest one
+    _zn_frame_window_t rx_window; // Out-of-order reliable frames, from the next expected one
+    z_zint_t sn_rx_acked;         // Next expected reliable SN last acknowledged to the remote
+    z_condvar_t cond_tx_window;   // Signaled with mutex_tx when acknowledgments make room in tx_window
+
+    // The task handling the received messages, including the acknowledgments, protected by mutex_tx
+    z_task_t rx_task;
+    int has_rx_task;
 
     z_bytes_t remote_pid;
 
@@ -74,10 +159,28 @@ typedef struct
     const _zn_link_t *link;
     _z_wbuf_t wbuf;
     _z_zbuf_t zbuf;
+    _zn_link_rx_batch_t *rx_batch; // NULL if the datagrams are read one at a time
 
     volatile int received;
     volatile int transmitted;
 
+    // Reliability, priority and SN of the frame being serialized in the wbuf
+    zn_reliability_t batch_reliability;
+    zn_priority_t batch_priority;
+    z_zint_t batch_sn;
+
+    // State restored if the loaned message is aborted
+    size_t loan_wpos;
+    _zn_coundit_sn_t loan_sns;
+
+#if ZN_TX_BATCHING == 1
+    // Open batch state
+    int batch_is_open;
+    z_clock_t batch_opened;
+    int loan_batch_is_open;
+    z_condvar_t cond_batch_open; // Signaled to the lease task when a batch is opened
+#endif
+
     volatile int read_task_running;
     z_task_t *read_task;
 
@@ -95,23 +198,39 @@ typedef struct
     z_mutex_t mutex_rx;
     z_mutex_t mutex_tx;
 
+    // Order in which the zenoh messages get the TX mutex
+    _zn_tx_scheduler_t tx_scheduler;
+
     // Peer list mutex
     z_mutex_t mutex_peer;
 
-    // Known valid peers
-    _zn_transport_peer_entry_list_t *peers;
+    // Known valid peers, indexed by address
+    _zn_transport_peer_table_t peers;
+
+    // Known valid peers, ordered by lease deadline
+    _zn_transport_peer_heap_t lease_heap;
+    z_clock_t lease_epoch;
+    z_zint_t peers_min_lease; // Shortest lease of the peers, to be recomputed if stale
+    int is_peers_min_lease_stale;
 
-    // SN initial numbers
+    // Defragmentation buffers shared by the peers
+    _zn_defrag_pool_t dbuf_pool;
+
+    // SN initial numbers, per priority if QoS is enabled
     z_zint_t sn_resolution;
     z_zint_t sn_resolution_half;
-    z_zint_t sn_tx_reliable;
-    z_zint_t sn_tx_best_effort;
+    _zn_conduit_sn_list_t sn_tx_sns;
 
     // ----------- Link related -----------
     // TX and RX buffers
     const _zn_link_t *link;
     _z_wbuf_t wbuf;
     _z_zbuf_t zbuf;
+    _zn_link_rx_batch_t *rx_batch; // NULL if the datagrams are read one at a time
+
+    // State restored if the loaned message is aborted
+    zn_priority_t loan_priority;
+    _zn_coundit_sn_t loan_sns;
 
     volatile int transmitted;
 
@@ -16,13 +16,124 @@
 #define ZENOH_PICO_TRANSPORT_UTILS_H
 
 #include "zenoh-pico/protocol/core.h"
+#include "zenoh-pico/protocol/iobuf.h"
 #include "zenoh-pico/protocol/msg.h"
+#include "zenoh-pico/system/platform.h"
 
 /*------------------ SN helpers ------------------*/
 int _zn_sn_precedes(const z_zint_t sn_resolution_half, const z_zint_t sn_left, const z_zint_t sn_right);
 z_zint_t _zn_sn_increment(const z_zint_t sn_resolution, const z_zint_t sn);
 z_zint_t _zn_sn_decrement(const z_zint_t sn_resolution, const z_zint_t sn);
+z_zint_t _zn_sn_distance(const z_zint_t sn_resolution, const z_zint_t sn_left, const z_zint_t sn_right);
+_zn_conduit_sn_list_t _zn_conduit_sn_list_make(uint8_t is_qos, const z_zint_t sn);
+_zn_coundit_sn_t *_zn_conduit_sn_list_get(_zn_conduit_sn_list_t *sns, zn_priority_t priority);
 void _zn_conduit_sn_list_copy(_zn_conduit_sn_list_t *dst, const _zn_conduit_sn_list_t *src);
 void _zn_conduit_sn_list_decrement(const z_zint_t sn_resolution, _zn_conduit_sn_list_t *sns);
 
+/*------------------ Frame window ------------------*/
+/**
+ * A bounded window of serialized frames indexed by consecutive SNs, starting from the base SN.
+ *
+ * Members:
+ *   z_bytes_t *slots: The serialized frames, empty if not present.
+ *   size_t capacity: The number of slots.
+ *   size_t head: The index of the slot holding the frame with the base SN.
+ *   z_zint_t base: The SN of the first frame of the window.
+ */
+typedef struct
+{
+    z_bytes_t *slots;
+    size_t capacity;
+    size_t head;
+    z_zint_t base;
+} _zn_frame_window_t;
+
+_zn_frame_window_t _zn_frame_window_make(size_t capacity, z_zint_t base);
+z_bytes_t *_zn_frame_window_get(const _zn_frame_window_t *w, const z_zint_t sn_resolution, const z_zint_t sn);
+int _zn_frame_window_put(_zn_frame_window_t *w, const z_zint_t sn_resolution, const z_zint_t sn, const _z_wbuf_t *wbf);
+void _zn_frame_window_advance(_zn_frame_window_t *w, const z_zint_t sn_resolution, const z_zint_t count);
+void _zn_frame_window_clear(_zn_frame_window_t *w);
+
+/*------------------ Defragmentation pool ------------------*/
+/**
+ * A bounded pool of defragmentation buffers. The buffers are allocated the first time they are
+ * checked out, so idle peers do not hold any defragmentation memory.
+ *
+ * Members:
+ *   z_mutex_t mutex: The mutex protecting the slots.
+ *   _z_wbuf_t *slots: The defragmentation buffers.
+ *   uint8_t *states: The state of each slot, see _ZN_DEFRAG_SLOT_* values.
+ *   size_t capacity: The number of slots.
+ */
+typedef struct
+{
+    z_mutex_t mutex;
+    _z_wbuf_t *slots;
+    uint8_t *states;
+    size_t capacity;
+} _zn_defrag_pool_t;
+
+#define _ZN_DEFRAG_SLOT_UNALLOCATED 0x00
+#define _ZN_DEFRAG_SLOT_FREE 0x01
+#define _ZN_DEFRAG_SLOT_USED 0x02
+
+/**
+ * The defragmentation buffer of a conduit, holding a pool slot only while a fragmented zenoh
+ * message is being reassembled.
+ *
+ * Members:
+ *   _zn_defrag_pool_t *pool: The pool the slots are checked out from.
+ *   _z_wbuf_t *wbuf: The checked out slot, NULL if none.
+ *   int is_dropping: Whether the fragments are being dropped until the last one.
+ */
+typedef struct
+{
+    _zn_defrag_pool_t *pool;
+    _z_wbuf_t *wbuf;
+    int is_dropping;
+} _zn_defrag_buf_t;
+
+_zn_defrag_pool_t _zn_defrag_pool_make(size_t capacity);
+void _zn_defrag_pool_clear(_zn_defrag_pool_t *pool);
+
+_zn_defrag_buf_t _zn_defrag_buf_make(_zn_defrag_pool_t *pool);
+int _zn_defrag_buf_push(_zn_defrag_buf_t *dbuf, const z_bytes_t *fragment);
+
+/**
+ * Get a decoding buffer over the reassembled zenoh message, which is decoded in place. The decoding
+ * buffer must be cleared before resetting the defragmentation buffer.
+ */
+_z_zbuf_t _zn_defrag_buf_to_zbuf(const _zn_defrag_buf_t *dbuf);
+void _zn_defrag_buf_reset(_zn_defrag_buf_t *dbuf);
+
+/*------------------ TX scheduler ------------------*/
+/**
+ * Grants the transmission to one writer at a time in strict priority order: a writer only takes
+ * its turn when no writer of a higher priority is waiting for it.
+ *
+ * Members:
+ *   z_mutex_t mutex: The mutex protecting the scheduler state.
+ *   z_condvar_t turn[ZN_PRIORITIES_NUM]: Signaled when the writers of a priority may take their turn.
+ *   size_t waiting[ZN_PRIORITIES_NUM]: The number of writers waiting for their turn, per priority.
+ *   int is_busy: Whether a writer holds the turn.
+ */
+typedef struct
+{
+    z_mutex_t mutex;
+    z_condvar_t turn[ZN_PRIORITIES_NUM];
+    size_t waiting[ZN_PRIORITIES_NUM];
+    int is_busy;
+} _zn_tx_scheduler_t;
+
+void _zn_tx_scheduler_init(_zn_tx_scheduler_t *s);
+void _zn_tx_scheduler_clear(_zn_tx_scheduler_t *s);
+void _zn_tx_scheduler_acquire(_zn_tx_scheduler_t *s, zn_priority_t priority);
+
+/**
+ * Take the turn only if it is free and no writer of the same or a higher priority is waiting for it.
+ * Returns 0 if the turn has been taken.
+ */
+int _zn_tx_scheduler_try_acquire(_zn_tx_scheduler_t *s, zn_priority_t priority);
+void _zn_tx_scheduler_release(_zn_tx_scheduler_t *s);
+
 #endif /* ZENOH_PICO_TRANSPORT_UTILS_H */
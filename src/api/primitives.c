@@ -32,6 +32,9 @@ z_zint_t zn_declare_resource(zn_session_t *zn, zn_reskey_t reskey)
     _zn_resource_t *r = (_zn_resource_t *)z_malloc(sizeof(_zn_resource_t));
     r->id = _zn_get_resource_id(zn);
     r->key = reskey;
+    r->rname = NULL;
+    r->subs = _z_vec_make(0);
+    r->is_subs_valid = 0;
 
     // FIXME: remove when resource declaration is implemented for multicast transport
     if (zn->tp->type == _ZN_TRANSPORT_MULTICAST_TYPE)
@@ -47,7 +50,7 @@ z_zint_t zn_declare_resource(zn_session_t *zn, zn_reskey_t reskey)
     // Build the declare message to send on the wire
     _zn_zenoh_message_t z_msg = _zn_z_msg_make_declare(declarations);
 
-    if (_zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK) != 0)
+    if (_zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, zn_priority_t_CONTROL) != 0)
     {
         // @TODO: retransmission
     }
@@ -73,7 +76,7 @@ void zn_undeclare_resource(zn_session_t *zn, const z_zint_t rid)
     // Build the declare message to send on the wire
     _zn_zenoh_message_t z_msg = _zn_z_msg_make_declare(declarations);
 
-    if (_zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK) != 0)
+    if (_zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, zn_priority_t_CONTROL) != 0)
     {
         // @TODO: retransmission
     }
@@ -96,7 +99,7 @@ zn_publisher_t *zn_declare_publisher(zn_session_t *zn, zn_reskey_t reskey)
     // Build the declare message to send on the wire
     _zn_zenoh_message_t z_msg = _zn_z_msg_make_declare(declarations);
 
-    if (_zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK) != 0)
+    if (_zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, zn_priority_t_CONTROL) != 0)
     {
         // @TODO: retransmission
     }
@@ -114,7 +117,7 @@ void zn_undeclare_publisher(zn_publisher_t *pub)
     // Build the declare message to send on the wire
     _zn_zenoh_message_t z_msg = _zn_z_msg_make_declare(declarations);
 
-    if (_zn_send_z_msg(pub->zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK) != 0)
+    if (_zn_send_z_msg(pub->zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, zn_priority_t_CONTROL) != 0)
     {
         // @TODO: retransmission
     }
@@ -123,7 +126,7 @@ void zn_undeclare_publisher(zn_publisher_t *pub)
 }
 
 /*------------------ Subscriber Declaration ------------------*/
-zn_subscriber_t *zn_declare_subscriber(zn_session_t *zn, zn_reskey_t reskey, zn_subinfo_t sub_info, zn_data_handler_t callback, void *arg)
+zn_subscriber_t *__zn_declare_subscriber(zn_session_t *zn, zn_reskey_t reskey, zn_subinfo_t sub_info, zn_data_handler_t callback, void *arg, void (*arg_drop)(void *arg))
 {
     _zn_subscriber_t *rs = (_zn_subscriber_t *)z_malloc(sizeof(_zn_subscriber_t));
     rs->id = _zn_get_entity_id(zn);
@@ -132,6 +135,7 @@ zn_subscriber_t *zn_declare_subscriber(zn_session_t *zn, zn_reskey_t reskey, zn_
     rs->info = sub_info;
     rs->callback = callback;
     rs->arg = arg;
+    rs->arg_drop = arg_drop;
 
     int res = _zn_register_subscription(zn, _ZN_RESOURCE_IS_LOCAL, rs);
     if (res != 0)
@@ -143,7 +147,7 @@ zn_subscriber_t *zn_declare_subscriber(zn_session_t *zn, zn_reskey_t reskey, zn_
     // Build the declare message to send on the wire
     _zn_zenoh_message_t z_msg = _zn_z_msg_make_declare(declarations);
 
-    if (_zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK) != 0)
+    if (_zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, zn_priority_t_CONTROL) != 0)
     {
         // @TODO: retransmission
     }
@@ -153,6 +157,7 @@ zn_subscriber_t *zn_declare_subscriber(zn_session_t *zn, zn_reskey_t reskey, zn_
     zn_subscriber_t *subscriber = (zn_subscriber_t *)z_malloc(sizeof(zn_subscriber_t));
     subscriber->zn = zn;
     subscriber->id = rs->id;
+    subscriber->ring = NULL;
 
     return subscriber;
 
@@ -162,12 +167,38 @@ ERR:
     return NULL;
 }
 
+zn_subscriber_t *zn_declare_subscriber(zn_session_t *zn, zn_reskey_t reskey, zn_subinfo_t sub_info, zn_data_handler_t callback, void *arg)
+{
+    return __zn_declare_subscriber(zn, reskey, sub_info, callback, arg, NULL);
+}
+
+zn_subscriber_t *zn_declare_ring_subscriber(zn_session_t *zn, zn_reskey_t reskey, zn_subinfo_t sub_info, size_t capacity, zn_ring_policy_t policy)
+{
+    if (capacity == 0)
+        return NULL;
+
+    // The ring is filled by the dispatch of the data and owned by the subscription
+    _zn_sample_ring_t *ring = _zn_sample_ring_make(capacity, policy);
+    zn_subscriber_t *subscriber = __zn_declare_subscriber(zn, reskey, sub_info, _zn_sample_ring_handler, ring, _zn_sample_ring_free);
+    if (subscriber == NULL)
+    {
+        _zn_sample_ring_free(ring);
+        return NULL;
+    }
+
+    subscriber->ring = ring;
+    return subscriber;
+}
+
 void zn_undeclare_subscriber(zn_subscriber_t *sub)
 {
     _zn_subscriber_t *s = _zn_get_subscription_by_id(sub->zn, _ZN_RESOURCE_IS_LOCAL, sub->id);
     if (s == NULL)
         return;
 
+    if (sub->ring != NULL)
+        _zn_sample_ring_close((_zn_sample_ring_t *)sub->ring);
+
     _zn_declaration_array_t declarations = _zn_declaration_array_make(1);
     zn_reskey_t key;
     key.rid = ZN_RESOURCE_ID_NONE;
@@ -177,7 +208,7 @@ void zn_undeclare_subscriber(zn_subscriber_t *sub)
     // Build the declare message to send on the wire
     _zn_zenoh_message_t z_msg = _zn_z_msg_make_declare(declarations);
 
-    if (_zn_send_z_msg(sub->zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK) != 0)
+    if (_zn_send_z_msg(sub->zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, zn_priority_t_CONTROL) != 0)
     {
         // @TODO: retransmission
     }
@@ -191,7 +222,7 @@ zn_queryable_t *zn_declare_queryable(zn_session_t *zn, zn_reskey_t reskey, unsig
 {
     _zn_queryable_t *rq = (_zn_queryable_t *)z_malloc(sizeof(_zn_queryable_t));
     rq->id = _zn_get_entity_id(zn);
-    rq->rname = __unsafe_zn_get_resource_name_from_key(zn, _ZN_RESOURCE_IS_LOCAL, &reskey);
+    rq->rname = _zn_get_resource_name_from_key(zn, _ZN_RESOURCE_IS_LOCAL, &reskey);
     rq->kind = kind;
     rq->callback = callback;
     rq->arg = arg;
@@ -206,7 +237,7 @@ zn_queryable_t *zn_declare_queryable(zn_session_t *zn, zn_reskey_t reskey, unsig
     // Build the declare message to send on the wire
     _zn_zenoh_message_t z_msg = _zn_z_msg_make_declare(declarations);
 
-    if (_zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK) != 0)
+    if (_zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, zn_priority_t_CONTROL) != 0)
     {
         // @TODO: retransmission
     }
@@ -240,7 +271,7 @@ void zn_undeclare_queryable(zn_queryable_t *qle)
     // Build the declare message to send on the wire
     _zn_zenoh_message_t z_msg = _zn_z_msg_make_declare(declarations);
 
-    if (_zn_send_z_msg(qle->zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK) != 0)
+    if (_zn_send_z_msg(qle->zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, zn_priority_t_CONTROL) != 0)
     {
         // @TODO: retransmission
     }
@@ -276,7 +307,7 @@ void zn_send_reply(zn_query_t *query, const z_str_t key, const uint8_t *payload,
 
     _zn_zenoh_message_t z_msg = _zn_z_msg_make_reply(reskey, di, pld, can_be_dropped, rctx);
 
-    if (_zn_send_z_msg(query->zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK) != 0)
+    if (_zn_send_z_msg(query->zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, ZN_PRIORITY_DEFAULT) != 0)
     {
         // @TODO: retransmission
     }
@@ -308,10 +339,10 @@ int zn_write(zn_session_t *zn, const zn_reskey_t reskey, const uint8_t *payload,
 
     _zn_zenoh_message_t z_msg = _zn_z_msg_make_data(reskey, info, pld, can_be_dropped);
 
-    return _zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, ZN_CONGESTION_CONTROL_DEFAULT);
+    return _zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, ZN_CONGESTION_CONTROL_DEFAULT, ZN_PRIORITY_DEFAULT);
 }
 
-int zn_write_ext(zn_session_t *zn, const zn_reskey_t reskey, const uint8_t *payload, const size_t len, uint8_t encoding, const uint8_t kind, const zn_congestion_control_t cong_ctrl)
+int zn_write_ext(zn_session_t *zn, const zn_reskey_t reskey, const uint8_t *payload, const size_t len, uint8_t encoding, const uint8_t kind, const zn_congestion_control_t cong_ctrl, const zn_priority_t priority)
 {
     // @TODO: Need to verify that I have declared a publisher with the same resource key.
     //        Then, need to verify there are active subscriptions matching the publisher.
@@ -336,7 +367,36 @@ int zn_write_ext(zn_session_t *zn, const zn_reskey_t reskey, const uint8_t *payl
 
     _zn_zenoh_message_t z_msg = _zn_z_msg_make_data(reskey, info, pld, can_be_dropped);
 
-    return _zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, cong_ctrl);
+    return _zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, cong_ctrl, priority);
+}
+
+uint8_t *zn_write_loan(zn_session_t *zn, const zn_reskey_t reskey, const size_t len)
+{
+    // Empty data info
+    _zn_data_info_t info;
+    info.flags = 0;
+
+    // Payload to be written in place by the caller
+    _zn_payload_t pld;
+    pld.len = len;
+    pld.val = NULL;
+
+    // Congestion control
+    int can_be_dropped = ZN_CONGESTION_CONTROL_DEFAULT == zn_congestion_control_t_DROP;
+
+    _zn_zenoh_message_t z_msg = _zn_z_msg_make_data(reskey, info, pld, can_be_dropped);
+
+    return _zn_loan_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, ZN_CONGESTION_CONTROL_DEFAULT, ZN_PRIORITY_DEFAULT);
+}
+
+int zn_write_commit(zn_session_t *zn)
+{
+    return _zn_commit_z_msg(zn);
+}
+
+int zn_write_abort(zn_session_t *zn)
+{
+    return _zn_abort_z_msg(zn);
 }
 
 /*------------------ Query ------------------*/
@@ -358,7 +418,7 @@ void zn_query(zn_session_t *zn, zn_reskey_t reskey, const z_str_t predicate, con
 
     _zn_zenoh_message_t z_msg = _zn_z_msg_make_query(pq->key, pq->predicate, pq->id, pq->target, pq->consolidation);
 
-    int res = _zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK);
+    int res = _zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, ZN_PRIORITY_DEFAULT);
     if (res != 0)
         _zn_unregister_pending_query(zn, pq);
 }
@@ -423,6 +483,25 @@ zn_reply_data_array_t zn_query_collect(zn_session_t *zn,
     return rda;
 }
 
+/*------------------ Ring subscriber ------------------*/
+int __zn_subscriber_recv(zn_subscriber_t *sub, zn_sample_t *sample, int is_blocking)
+{
+    if (sub->ring == NULL)
+        return -1;
+
+    return _zn_sample_ring_recv((_zn_sample_ring_t *)sub->ring, sample, is_blocking);
+}
+
+int zn_subscriber_recv(zn_subscriber_t *sub, zn_sample_t *sample)
+{
+    return __zn_subscriber_recv(sub, sample, 1);
+}
+
+int zn_subscriber_try_recv(zn_subscriber_t *sub, zn_sample_t *sample)
+{
+    return __zn_subscriber_recv(sub, sample, 0);
+}
+
 /*------------------ Pull ------------------*/
 int zn_pull(const zn_subscriber_t *sub)
 {
@@ -436,7 +515,7 @@ int zn_pull(const zn_subscriber_t *sub)
 
     _zn_zenoh_message_t z_msg = _zn_z_msg_make_pull(s->key, pull_id, max_samples, is_final);
 
-    if (_zn_send_z_msg(sub->zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK) != 0)
+    if (_zn_send_z_msg(sub->zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, ZN_PRIORITY_DEFAULT) != 0)
     {
         // @TODO: retransmission
     }
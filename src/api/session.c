@@ -17,8 +17,10 @@
 #include "zenoh-pico/api/session.h"
 #include "zenoh-pico/api/memory.h"
 #include "zenoh-pico/session/utils.h"
+#include "zenoh-pico/session/workers.h"
 #include "zenoh-pico/transport/link/task/lease.h"
 #include "zenoh-pico/transport/link/task/read.h"
+#include "zenoh-pico/transport/link/tx.h"
 #include "zenoh-pico/utils/logging.h"
 
 zn_session_t *_zn_open(z_str_t locator, int mode)
@@ -97,8 +99,47 @@ zn_session_t *zn_open(zn_properties_t *config)
         mode = 1;
 
     zn_session_t *zn = _zn_open(locator, mode);
-
     z_free(locator);
+    if (zn == NULL)
+        return NULL;
+
+    // Start the RX workers, if any
+    z_str_t s_workers = zn_properties_get(config, ZN_CONFIG_RX_WORKERS_KEY).val;
+    if (s_workers == NULL)
+        s_workers = ZN_CONFIG_RX_WORKERS_DEFAULT;
+    size_t workers = strtoul(s_workers, NULL, 10);
+    if (workers > 0 && _zn_rx_workers_start(zn, workers) != 0)
+    {
+        _zn_session_close(zn, _ZN_CLOSE_GENERIC);
+        return NULL;
+    }
+
+    // Start the TX writer, if any
+    z_str_t s_capacity = zn_properties_get(config, ZN_CONFIG_TX_QUEUE_KEY).val;
+    if (s_capacity == NULL)
+        s_capacity = ZN_CONFIG_TX_QUEUE_DEFAULT;
+    size_t capacity = strtoul(s_capacity, NULL, 10);
+
+    z_str_t s_policy = zn_properties_get(config, ZN_CONFIG_TX_QUEUE_POLICY_KEY).val;
+    if (s_policy == NULL)
+        s_policy = ZN_CONFIG_TX_QUEUE_POLICY_DEFAULT;
+    _zn_tx_queue_policy_t policy = _ZN_TX_QUEUE_POLICY_BLOCK;
+    if (_z_str_eq(s_policy, ZN_CONFIG_TX_QUEUE_POLICY_DROP_NEWEST))
+        policy = _ZN_TX_QUEUE_POLICY_DROP_NEWEST;
+    else if (_z_str_eq(s_policy, ZN_CONFIG_TX_QUEUE_POLICY_DROP_OLDEST))
+        policy = _ZN_TX_QUEUE_POLICY_DROP_OLDEST;
+
+    z_str_t s_timeout = zn_properties_get(config, ZN_CONFIG_TX_QUEUE_TIMEOUT_KEY).val;
+    if (s_timeout == NULL)
+        s_timeout = ZN_CONFIG_TX_QUEUE_TIMEOUT_DEFAULT;
+    z_zint_t timeout = strtoul(s_timeout, NULL, 10);
+
+    if (capacity > 0 && _zn_tx_queue_start(zn, capacity, policy, timeout) != 0)
+    {
+        _zn_session_close(zn, _ZN_CLOSE_GENERIC);
+        return NULL;
+    }
+
     return zn;
 }
 
@@ -118,13 +159,12 @@ zn_properties_t *zn_info(zn_session_t *zn)
     }
     else if (zn->tp->type == _ZN_TRANSPORT_MULTICAST_TYPE)
     {
-        _zn_transport_peer_entry_list_t *xs = zn->tp->transport.multicast.peers;
-        while (xs != NULL)
+        _zn_transport_peer_table_t *peers = &zn->tp->transport.multicast.peers;
+        for (size_t i = 0; i < _zn_transport_peer_table_capacity(peers); i++)
         {
-            _zn_transport_peer_entry_t *peer = _zn_transport_peer_entry_list_head(xs);
-            zn_properties_insert(ps, ZN_INFO_PEER_PID_KEY, _z_string_from_bytes(&peer->remote_pid));
-
-            xs = _zn_transport_peer_entry_list_tail(xs);
+            _zn_transport_peer_entry_t *peer = _zn_transport_peer_table_at(peers, i);
+            if (peer != NULL)
+                zn_properties_insert(ps, ZN_INFO_PEER_PID_KEY, _z_string_from_bytes(&peer->remote_pid));
         }
     }
     return ps;
@@ -140,6 +180,11 @@ int znp_send_keep_alive(zn_session_t *zn)
     return _znp_send_keep_alive(zn->tp);
 }
 
+int znp_flush(zn_session_t *zn)
+{
+    return _zn_flush(zn->tp);
+}
+
 int znp_start_read_task(zn_session_t *zn)
 {
     z_task_t *task = (z_task_t *)z_malloc(sizeof(z_task_t));
@@ -205,3 +250,60 @@ int znp_stop_lease_task(zn_session_t *zn)
 
     return 0;
 }
+
+int znp_tx_queue_counters(zn_session_t *zn, size_t *queued, size_t *dropped)
+{
+    _zn_tx_queue_t *q = &zn->tx_queue;
+    if (q->capacity == 0)
+        return -1;
+
+    z_mutex_lock(&q->mutex);
+    *queued = q->queued;
+    *dropped = q->dropped;
+    z_mutex_unlock(&q->mutex);
+
+    return 0;
+}
+
+#if defined(Z_EVENT_LOOP)
+znp_reactor_t *znp_reactor_new(void)
+{
+    znp_reactor_t *reactor = (znp_reactor_t *)z_malloc(sizeof(znp_reactor_t));
+    if (_znp_reactor_init(reactor) != 0)
+    {
+        z_free(reactor);
+        return NULL;
+    }
+
+    return reactor;
+}
+
+void znp_reactor_free(znp_reactor_t **reactor)
+{
+    znp_reactor_t *ptr = *reactor;
+    _znp_reactor_clear(ptr);
+
+    z_free(ptr);
+    *reactor = NULL;
+}
+
+int znp_reactor_fd(const znp_reactor_t *reactor)
+{
+    return z_poller_fd(&reactor->poller);
+}
+
+int znp_reactor_add(znp_reactor_t *reactor, zn_session_t *zn)
+{
+    return _znp_reactor_add(reactor, zn->tp);
+}
+
+int znp_reactor_remove(znp_reactor_t *reactor, zn_session_t *zn)
+{
+    return _znp_reactor_remove(reactor, zn->tp);
+}
+
+int znp_process_events(znp_reactor_t *reactor, int timeout)
+{
+    return _znp_reactor_process(reactor, timeout);
+}
+#endif
@@ -25,6 +25,7 @@ int _z_int_void_map_entry_key_eq(const void *left, const void *right)
 void _z_int_void_map_init(_z_int_void_map_t *map, size_t capacity)
 {
     map->capacity = capacity;
+    map->len = 0;
     map->vals = NULL;
 }
 
@@ -42,15 +43,7 @@ size_t _z_int_void_map_capacity(const _z_int_void_map_t *map)
 
 size_t _z_int_void_map_len(const _z_int_void_map_t *map)
 {
-    size_t len = 0;
-
-    if (map->vals == NULL)
-        return len;
-
-    for (size_t idx = 0; idx < map->capacity; idx++)
-        len += _z_list_len(map->vals[idx]);
-
-    return len;
+    return map->len;
 }
 
 int _z_int_void_map_is_empty(const _z_int_void_map_t *map)
@@ -68,7 +61,38 @@ void _z_int_void_map_remove(_z_int_void_map_t *map, size_t k, z_element_free_f f
     e.key = k;
     e.val = NULL;
 
+    if (_z_list_find(map->vals[idx], _z_int_void_map_entry_key_eq, &e) == NULL)
+        return;
+
     map->vals[idx] = _z_list_drop_filter(map->vals[idx], f, _z_int_void_map_entry_key_eq, &e);
+    map->len--;
+}
+
+void __z_int_void_map_rehash(_z_int_void_map_t *map, size_t capacity)
+{
+    _z_list_t **vals = (_z_list_t **)z_malloc(capacity * sizeof(_z_list_t *));
+    for (size_t idx = 0; idx < capacity; idx++)
+        vals[idx] = NULL;
+
+    // Move the entries to the new buckets, only the list nodes are reallocated
+    for (size_t idx = 0; idx < map->capacity; idx++)
+    {
+        _z_list_t *xs = map->vals[idx];
+        while (xs != NULL)
+        {
+            _z_int_void_map_entry_t *entry = (_z_int_void_map_entry_t *)_z_list_head(xs);
+            size_t n_idx = entry->key % capacity;
+            vals[n_idx] = _z_list_push(vals[n_idx], entry);
+
+            xs = _z_list_tail(xs);
+        }
+
+        _z_list_free(&map->vals[idx], _zn_noop_free);
+    }
+
+    z_free(map->vals);
+    map->vals = vals;
+    map->capacity = capacity;
 }
 
 void *_z_int_void_map_insert(_z_int_void_map_t *map, size_t k, void *v, z_element_free_f f_f)
@@ -93,6 +117,11 @@ void *_z_int_void_map_insert(_z_int_void_map_t *map, size_t k, void *v, z_elemen
 
     size_t idx = k % map->capacity;
     map->vals[idx] = _z_list_push(map->vals[idx], entry);
+    map->len++;
+
+    // Grow the hashmap to keep the lookups in constant time
+    if (map->len > map->capacity)
+        __z_int_void_map_rehash(map, 2 * map->capacity);
 
     return v;
 }
@@ -128,6 +157,7 @@ void _z_int_void_map_clear(_z_int_void_map_t *map, z_element_free_f f_f)
 
     z_free(map->vals);
     map->vals = NULL;
+    map->len = 0;
 }
 
 void _z_int_void_map_free(_z_int_void_map_t **map, z_element_free_f f)
@@ -0,0 +1,135 @@
+//
+// Copyright (c) 2022 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+#include <string.h>
+#include "zenoh-pico/system/collections.h"
+
+/*-------- mqueue --------*/
+z_mqueue_t *z_mqueue_make(size_t capacity)
+{
+    z_mqueue_t *mq = (z_mqueue_t *)z_malloc(sizeof(z_mqueue_t));
+    memset(mq, 0, sizeof(z_mqueue_t));
+    mq->elems = (void **)z_malloc(capacity * sizeof(void *));
+    mq->capacity = capacity;
+    z_mutex_init(&mq->mtx);
+    z_condvar_init(&mq->can_push);
+    z_condvar_init(&mq->can_pull);
+    return mq;
+}
+
+void z_mqueue_free(z_mqueue_t **mq)
+{
+    z_mqueue_t *ptr = *mq;
+    z_condvar_free(&ptr->can_pull);
+    z_condvar_free(&ptr->can_push);
+    z_mutex_free(&ptr->mtx);
+    z_free(ptr->elems);
+    z_free(ptr);
+    *mq = NULL;
+}
+
+int z_mqueue_push(z_mqueue_t *mq, void *e)
+{
+    z_mutex_lock(&mq->mtx);
+    while (mq->len == mq->capacity && !mq->is_closed)
+        z_condvar_wait(&mq->can_push, &mq->mtx);
+
+    if (mq->is_closed)
+    {
+        // Pass the wake up on to the other blocked producers
+        z_condvar_signal(&mq->can_push);
+        z_mutex_unlock(&mq->mtx);
+        return -1;
+    }
+
+    mq->elems[(mq->head + mq->len) % mq->capacity] = e;
+    mq->len++;
+    z_condvar_signal(&mq->can_pull);
+    z_mutex_unlock(&mq->mtx);
+    return 0;
+}
+
+void *z_mqueue_push_force(z_mqueue_t *mq, void *e)
+{
+    z_mutex_lock(&mq->mtx);
+    if (mq->is_closed)
+    {
+        z_mutex_unlock(&mq->mtx);
+        return e;
+    }
+
+    // Never block: make room by evicting the oldest element
+    void *evicted = NULL;
+    if (mq->len == mq->capacity)
+    {
+        evicted = mq->elems[mq->head];
+        mq->head = (mq->head + 1) % mq->capacity;
+        mq->len--;
+    }
+
+    mq->elems[(mq->head + mq->len) % mq->capacity] = e;
+    mq->len++;
+    z_condvar_signal(&mq->can_pull);
+    z_mutex_unlock(&mq->mtx);
+    return evicted;
+}
+
+void *z_mqueue_pull(z_mqueue_t *mq)
+{
+    z_mutex_lock(&mq->mtx);
+    while (mq->len == 0 && !mq->is_closed)
+        z_condvar_wait(&mq->can_pull, &mq->mtx);
+
+    // The elements pushed before closing are still delivered
+    if (mq->len == 0)
+    {
+        // Pass the wake up on to the other blocked consumers
+        z_condvar_signal(&mq->can_pull);
+        z_mutex_unlock(&mq->mtx);
+        return NULL;
+    }
+
+    void *e = mq->elems[mq->head];
+    mq->head = (mq->head + 1) % mq->capacity;
+    mq->len--;
+    z_condvar_signal(&mq->can_push);
+    z_mutex_unlock(&mq->mtx);
+    return e;
+}
+
+void *z_mqueue_try_pull(z_mqueue_t *mq)
+{
+    z_mutex_lock(&mq->mtx);
+    if (mq->len == 0)
+    {
+        z_mutex_unlock(&mq->mtx);
+        return NULL;
+    }
+
+    void *e = mq->elems[mq->head];
+    mq->head = (mq->head + 1) % mq->capacity;
+    mq->len--;
+    z_condvar_signal(&mq->can_push);
+    z_mutex_unlock(&mq->mtx);
+    return e;
+}
+
+void z_mqueue_close(z_mqueue_t *mq)
+{
+    z_mutex_lock(&mq->mtx);
+    mq->is_closed = 1;
+    z_condvar_signal(&mq->can_push);
+    z_condvar_signal(&mq->can_pull);
+    z_mutex_unlock(&mq->mtx);
+}
@@ -114,9 +114,9 @@ void _z_vec_set(_z_vec_t *v, size_t i, void *e, z_element_free_f free_f)
 void _z_vec_remove(_z_vec_t *v, size_t pos, z_element_free_f free_f)
 {
     free_f(&v->val[pos]);
-    for (size_t i = pos; i < v->len; i++)
-        v->val[pos] = v->val[pos + 1];
+    for (size_t i = pos; i + 1 < v->len; i++)
+        v->val[i] = v->val[i + 1];
 
-    v->val[v->len] = NULL;
     v->len--;
+    v->val[v->len] = NULL;
 }
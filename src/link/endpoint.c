@@ -24,6 +24,9 @@
 #if ZN_LINK_BLUETOOTH == 1
 #include "zenoh-pico/link/config/bt.h"
 #endif
+#if ZN_LINK_SHM == 1
+#include "zenoh-pico/link/config/shm.h"
+#endif
 
 /*------------------ Locator ------------------*/
 void _zn_locator_init(_zn_locator_t *locator)
@@ -305,6 +308,11 @@ _z_str_intmap_result_t _zn_endpoint_config_from_str(const z_str_t s, const z_str
     if (_z_str_eq(proto, BT_SCHEMA))
         res = _zn_bt_config_from_str(p_start);
     else
+#endif
+#if ZN_LINK_SHM == 1
+    if (_z_str_eq(proto, SHM_SCHEMA))
+        res = _zn_shm_config_from_str(p_start);
+    else
 #endif
         goto ERR;
 
@@ -335,6 +343,11 @@ size_t _zn_endpoint_config_strlen(const _z_str_intmap_t *s, const z_str_t proto)
     if (_z_str_eq(proto, BT_SCHEMA))
         len = _zn_bt_config_strlen(s);
     else
+#endif
+#if ZN_LINK_SHM == 1
+    if (_z_str_eq(proto, SHM_SCHEMA))
+        len = _zn_shm_config_strlen(s);
+    else
 #endif
         goto ERR;
 
@@ -364,6 +377,11 @@ z_str_t _zn_endpoint_config_to_str(const _z_str_intmap_t *s, const z_str_t proto
     if (_z_str_eq(proto, BT_SCHEMA))
         res = _zn_bt_config_to_str(s);
     else
+#endif
+#if ZN_LINK_SHM == 1
+    if (_z_str_eq(proto, SHM_SCHEMA))
+        res = _zn_shm_config_to_str(s);
+    else
 #endif
         goto ERR;
 
@@ -425,3 +443,37 @@ z_str_t _zn_endpoint_to_str(const _zn_endpoint_t *endpoint)
 ERR:
     return NULL;
 }
+
+/*------------------ Address ------------------*/
+void _zn_link_addr_reset(_zn_link_addr_t *addr)
+{
+    addr->len = 0;
+}
+
+void _zn_link_addr_append(_zn_link_addr_t *addr, const void *val, size_t len)
+{
+    // Addresses longer than the inline buffer are truncated
+    size_t room = (size_t)(_ZN_LINK_ADDR_SIZE - addr->len);
+    if (len > room)
+        len = room;
+
+    memcpy(addr->val + addr->len, val, len);
+    addr->len += len;
+}
+
+int _zn_link_addr_eq(const _zn_link_addr_t *left, const _zn_link_addr_t *right)
+{
+    return left->len == right->len && memcmp(left->val, right->val, left->len) == 0;
+}
+
+size_t _zn_link_addr_hash(const _zn_link_addr_t *addr)
+{
+    // FNV-1a, the addresses are short and mostly differ in their last bytes
+    uint32_t h = 2166136261U;
+    for (size_t i = 0; i < addr->len; i++)
+    {
+        h ^= addr->val[i];
+        h *= 16777619U;
+    }
+    return h;
+}
@@ -12,6 +12,7 @@
 //   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
 //
 
+#include <string.h>
 #include "zenoh-pico/config.h"
 #include "zenoh-pico/link/link.h"
 #include "zenoh-pico/link/manager.h"
@@ -46,6 +47,13 @@ _zn_link_p_result_t _zn_open_link(const z_str_t locator)
         r.value.link = _zn_new_link_bt(endpoint);
     }
     else
+#endif
+#if ZN_LINK_SHM == 1 && defined(Z_LINK_SHM)
+    if (_z_str_eq(endpoint.locator.protocol, SHM_SCHEMA))
+    {
+        r.value.link = _zn_new_link_shm(endpoint);
+    }
+    else
 #endif
         goto ERR2;
 
@@ -78,7 +86,7 @@ _zn_link_p_result_t _zn_listen_link(const z_str_t locator)
     _ASSURE_RESULT(ep_res, r, _zn_err_t_INVALID_LOCATOR)
     _zn_endpoint_t endpoint = ep_res.value.endpoint;
 
-    // @TODO: for now listening is only supported for UDP multicast
+    // @TODO: for now listening is only supported for UDP multicast and shared memory
     // Create transport link
 #if ZN_LINK_UDP_MULTICAST == 1
     if (_z_str_eq(endpoint.locator.protocol, UDP_SCHEMA))
@@ -93,6 +101,13 @@ _zn_link_p_result_t _zn_listen_link(const z_str_t locator)
         r.value.link = _zn_new_link_bt(endpoint);
     }
     else
+#endif
+#if ZN_LINK_SHM == 1 && defined(Z_LINK_SHM)
+    if (_z_str_eq(endpoint.locator.protocol, SHM_SCHEMA))
+    {
+        r.value.link = _zn_new_link_shm(endpoint);
+    }
+    else
 #endif
         goto ERR2;
 
@@ -130,7 +145,7 @@ void _zn_link_free(_zn_link_t **zn)
     *zn = NULL;
 }
 
-size_t _zn_link_recv_zbuf(const _zn_link_t *link, _z_zbuf_t *zbf, z_bytes_t *addr)
+size_t _zn_link_recv_zbuf(const _zn_link_t *link, _z_zbuf_t *zbf, _zn_link_addr_t *addr)
 {
     size_t rb = link->read_f(link, _z_zbuf_get_wptr(zbf), _z_zbuf_space_left(zbf), addr);
     if (rb != SIZE_MAX)
@@ -138,7 +153,7 @@ size_t _zn_link_recv_zbuf(const _zn_link_t *link, _z_zbuf_t *zbf, z_bytes_t *add
     return rb;
 }
 
-size_t _zn_link_recv_exact_zbuf(const _zn_link_t *link, _z_zbuf_t *zbf, size_t len, z_bytes_t *addr)
+size_t _zn_link_recv_exact_zbuf(const _zn_link_t *link, _z_zbuf_t *zbf, size_t len, _zn_link_addr_t *addr)
 {
     size_t rb = link->read_exact_f(link, _z_zbuf_get_wptr(zbf), len, addr);
     if (rb != SIZE_MAX)
@@ -146,11 +161,120 @@ size_t _zn_link_recv_exact_zbuf(const _zn_link_t *link, _z_zbuf_t *zbf, size_t l
     return rb;
 }
 
+#if defined(Z_LINK_SENDV)
+int __zn_link_send_wbuf_vectored(const _zn_link_t *link, const _z_wbuf_t *wbf)
+{
+    z_bytes_t iov[Z_LINK_SENDV_IOV_MAX];
+
+    size_t i = 0;
+    size_t n_ios = _z_wbuf_len_iosli(wbf);
+    while (i < n_ios)
+    {
+        // Gather as many non-empty slices as a single write can take
+        size_t iovcnt = 0;
+        for (; i < n_ios && iovcnt < Z_LINK_SENDV_IOV_MAX; i++)
+        {
+            z_bytes_t bs = _z_iosli_to_bytes(_z_wbuf_get_iosli(wbf, i));
+            if (bs.len > 0)
+                iov[iovcnt++] = bs;
+        }
+
+        size_t idx = 0;
+        while (idx < iovcnt)
+        {
+            _Z_DEBUG("Sending wbuf on socket...");
+            size_t wb = link->writev_f(link, &iov[idx], iovcnt - idx);
+            _Z_DEBUG(" sent %d bytes\n", wb);
+            if (wb == SIZE_MAX)
+            {
+                _Z_DEBUG("Error while sending data over socket [%d]\n", wb);
+                return -1;
+            }
+
+            // Skip the slices that have been entirely written
+            while (idx < iovcnt && wb >= iov[idx].len)
+            {
+                wb -= iov[idx].len;
+                idx++;
+            }
+
+            // Resume from the partially written slice, if any
+            if (idx < iovcnt)
+            {
+                iov[idx].val += wb;
+                iov[idx].len -= wb;
+            }
+        }
+    }
+
+    return 0;
+}
+#endif
+
+size_t __zn_link_wbuf_iovcnt(const _z_wbuf_t *wbf)
+{
+    size_t iovcnt = 0;
+    for (size_t i = 0; i < _z_wbuf_len_iosli(wbf); i++)
+    {
+        if (_z_iosli_to_bytes(_z_wbuf_get_iosli(wbf, i)).len > 0)
+            iovcnt++;
+    }
+    return iovcnt;
+}
+
+int __zn_link_send_wbuf_coalesced(const _zn_link_t *link, const _z_wbuf_t *wbf)
+{
+    // Gather the slices in a single buffer, to be written as a single datagram
+    uint8_t *buf = (uint8_t *)z_malloc(_z_wbuf_len(wbf));
+    if (buf == NULL)
+        return -1;
+
+    size_t len = 0;
+    for (size_t i = 0; i < _z_wbuf_len_iosli(wbf); i++)
+    {
+        z_bytes_t bs = _z_iosli_to_bytes(_z_wbuf_get_iosli(wbf, i));
+        memcpy(buf + len, bs.val, bs.len);
+        len += bs.len;
+    }
+
+    _Z_DEBUG("Sending wbuf on socket...");
+    size_t wb = link->write_f(link, buf, len);
+    _Z_DEBUG(" sent %d bytes\n", wb);
+    z_free(buf);
+    if (wb != len)
+    {
+        _Z_DEBUG("Error while sending data over socket [%d]\n", wb);
+        return -1;
+    }
+
+    return 0;
+}
+
 int _zn_link_send_wbuf(const _zn_link_t *link, const _z_wbuf_t *wbf)
 {
+    // A datagram must be written at once: its slices are gathered if a single write cannot take them
+    if (link->is_streamed == 0)
+    {
+        size_t iov_max = 1;
+#if defined(Z_LINK_SENDV)
+        if (link->writev_f != NULL)
+            iov_max = Z_LINK_SENDV_IOV_MAX;
+#endif
+        if (__zn_link_wbuf_iovcnt(wbf) > iov_max)
+            return __zn_link_send_wbuf_coalesced(link, wbf);
+    }
+
+#if defined(Z_LINK_SENDV)
+    if (link->writev_f != NULL)
+        return __zn_link_send_wbuf_vectored(link, wbf);
+#endif
+
     for (size_t i = 0; i < _z_wbuf_len_iosli(wbf); i++)
     {
         z_bytes_t bs = _z_iosli_to_bytes(_z_wbuf_get_iosli(wbf, i));
+        if (bs.len == 0)
+            continue;
+
         size_t n = bs.len;
         size_t wb;
         do
@@ -170,3 +294,114 @@ int _zn_link_send_wbuf(const _zn_link_t *link, const _z_wbuf_t *wbf)
 
     return 0;
 }
+
+// Only the fragments of a single message are sent through here. The frames of distinct
+// messages, e.g. a backlog in the TX queue or the closed TX batches, are still sent one
+// at a time, as each of them is sent while holding the TX mutex as soon as it is closed.
+int _zn_link_send_wbufs(const _zn_link_t *link, const _z_wbuf_t *wbfs, size_t n)
+{
+#if defined(Z_LINK_BATCH)
+    if (link->writev_batch_f != NULL)
+    {
+        z_bytes_t iov[Z_LINK_BATCH_MAX * Z_LINK_SENDV_IOV_MAX];
+        size_t iovcnts[Z_LINK_BATCH_MAX];
+
+        size_t i = 0;
+        while (i < n)
+        {
+            // Gather as many datagrams as a single write can take
+            size_t cnt = 0;
+            size_t iovlen = 0;
+            for (; i < n && cnt < Z_LINK_BATCH_MAX; i++)
+            {
+                size_t n_ios = _z_wbuf_len_iosli(&wbfs[i]);
+                if (n_ios > Z_LINK_SENDV_IOV_MAX)
+                    break;
+
+                iovcnts[cnt] = 0;
+                for (size_t j = 0; j < n_ios; j++)
+                {
+                    z_bytes_t bs = _z_iosli_to_bytes(_z_wbuf_get_iosli(&wbfs[i], j));
+                    if (bs.len > 0)
+                    {
+                        iov[iovlen++] = bs;
+                        iovcnts[cnt]++;
+                    }
+                }
+                cnt++;
+            }
+
+            const z_bytes_t *it = iov;
+            size_t idx = 0;
+            while (idx < cnt)
+            {
+                _Z_DEBUG("Sending %zu datagrams on socket...", cnt - idx);
+                size_t wb = link->writev_batch_f(link, it, &iovcnts[idx], cnt - idx);
+                _Z_DEBUG(" sent %zu datagrams\n", wb);
+                if (wb == SIZE_MAX || wb == 0)
+                {
+                    _Z_DEBUG("Error while sending datagrams over socket\n");
+                    return -1;
+                }
+
+                // Skip the datagrams that have been written
+                for (size_t j = 0; j < wb; j++)
+                    it += iovcnts[idx + j];
+                idx += wb;
+            }
+
+            // Datagrams made of too many slices are written on their own
+            if (i < n && cnt == 0)
+            {
+                if (_zn_link_send_wbuf(link, &wbfs[i]) != 0)
+                    return -1;
+                i++;
+            }
+        }
+
+        return 0;
+    }
+#endif
+
+    for (size_t i = 0; i < n; i++)
+    {
+        if (_zn_link_send_wbuf(link, &wbfs[i]) != 0)
+            return -1;
+    }
+
+    return 0;
+}
+
+/*------------------ Batched reads ------------------*/
+_zn_link_rx_batch_t *_zn_link_rx_batch_make(void)
+{
+    _zn_link_rx_batch_t *batch = (_zn_link_rx_batch_t *)z_malloc(sizeof(_zn_link_rx_batch_t));
+    for (size_t i = 0; i < ZN_RX_DATAGRAM_BATCH; i++)
+    {
+        batch->bufs[i] = (uint8_t *)z_malloc(ZN_BATCH_SIZE);
+        batch->lens[i] = 0;
+        _zn_link_addr_reset(&batch->addrs[i]);
+    }
+    batch->len = 0;
+
+    return batch;
+}
+
+void _zn_link_rx_batch_free(_zn_link_rx_batch_t **batch)
+{
+    _zn_link_rx_batch_t *ptr = *batch;
+
+    for (size_t i = 0; i < ZN_RX_DATAGRAM_BATCH; i++)
+        z_free(ptr->bufs[i]);
+
+    z_free(ptr);
+    *batch = NULL;
+}
+
+size_t _zn_link_recv_batch(const _zn_link_t *link, _zn_link_rx_batch_t *batch, int is_addr)
+{
+    // The buffers may be handed back in a different order, they are all the same
+    size_t n = link->read_batch_f(link, batch->bufs, ZN_BATCH_SIZE, batch->lens, ZN_RX_DATAGRAM_BATCH, is_addr ? batch->addrs : NULL);
+    batch->len = n == SIZE_MAX ? 0 : n;
+    return n;
+}
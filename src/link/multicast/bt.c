@@ -85,29 +85,29 @@ size_t _zn_f_link_write_all_bt(const void *arg, const uint8_t *ptr, size_t len)
     return _zn_send_bt(self->socket.bt.sock, ptr, len);
 }
 
-size_t _zn_f_link_read_bt(const void *arg, uint8_t *ptr, size_t len, z_bytes_t *addr)
+size_t _zn_f_link_read_bt(const void *arg, uint8_t *ptr, size_t len, _zn_link_addr_t *addr)
 {
     const _zn_link_t *self = (const _zn_link_t *)arg;
 
     size_t rb  = _zn_read_bt(self->socket.bt.sock, ptr, len);
     if (rb > 0 && addr != NULL)
     {
-        *addr = _z_bytes_make(strlen(self->socket.bt.gname));
-        memcpy((void *)addr->val, self->socket.bt.gname, addr->len);
+        _zn_link_addr_reset(addr);
+        _zn_link_addr_append(addr, self->socket.bt.gname, strlen(self->socket.bt.gname));
     }
 
     return rb;
 }
 
-size_t _zn_f_link_read_exact_bt(const void *arg, uint8_t *ptr, size_t len, z_bytes_t *addr)
+size_t _zn_f_link_read_exact_bt(const void *arg, uint8_t *ptr, size_t len, _zn_link_addr_t *addr)
 {
     const _zn_link_t *self = (const _zn_link_t *)arg;
 
     size_t rb  = _zn_read_exact_bt(self->socket.bt.sock, ptr, len);
     if (rb == len && addr != NULL)
     {
-        *addr = _z_bytes_make(strlen(self->socket.bt.gname));
-        memcpy((void *)addr->val, self->socket.bt.gname, addr->len);
+        _zn_link_addr_reset(addr);
+        _zn_link_addr_append(addr, self->socket.bt.gname, strlen(self->socket.bt.gname));
     }
 
     return rb;
@@ -138,8 +138,12 @@ _zn_link_t *_zn_new_link_bt(_zn_endpoint_t endpoint)
 
     lt->write_f = _zn_f_link_write_bt;
     lt->write_all_f = _zn_f_link_write_all_bt;
+    lt->writev_f = NULL;
     lt->read_f = _zn_f_link_read_bt;
     lt->read_exact_f = _zn_f_link_read_exact_bt;
+    lt->fd_f = NULL;
+    lt->read_batch_f = NULL;
+    lt->writev_batch_f = NULL;
 
     return lt;
 }
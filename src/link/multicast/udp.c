@@ -143,20 +143,45 @@ size_t _zn_f_link_write_all_udp_multicast(const void *arg, const uint8_t *ptr, s
     return _zn_send_udp_multicast(self->socket.udp.msock, ptr, len, self->socket.udp.raddr);
 }
 
-size_t _zn_f_link_read_udp_multicast(const void *arg, uint8_t *ptr, size_t len, z_bytes_t *addr)
+#if defined(Z_LINK_SENDV)
+size_t _zn_f_link_writev_udp_multicast(const void *arg, const z_bytes_t *iov, size_t iovcnt)
+{
+    const _zn_link_t *self = (const _zn_link_t *)arg;
+
+    return _zn_sendv_udp_multicast(self->socket.udp.msock, iov, iovcnt, self->socket.udp.raddr);
+}
+#endif
+
+size_t _zn_f_link_read_udp_multicast(const void *arg, uint8_t *ptr, size_t len, _zn_link_addr_t *addr)
 {
     const _zn_link_t *self = (const _zn_link_t *)arg;
 
     return _zn_read_udp_multicast(self->socket.udp.sock, ptr, len, self->socket.udp.laddr, addr);
 }
 
-size_t _zn_f_link_read_exact_udp_multicast(const void *arg, uint8_t *ptr, size_t len, z_bytes_t *addr)
+size_t _zn_f_link_read_exact_udp_multicast(const void *arg, uint8_t *ptr, size_t len, _zn_link_addr_t *addr)
 {
     const _zn_link_t *self = (const _zn_link_t *)arg;
 
     return _zn_read_exact_udp_multicast(self->socket.udp.sock, ptr, len, self->socket.udp.laddr, addr);
 }
 
+#if defined(Z_LINK_BATCH)
+size_t _zn_f_link_read_batch_udp_multicast(const void *arg, uint8_t **bufs, size_t len, size_t *lens, size_t n, _zn_link_addr_t *addrs)
+{
+    const _zn_link_t *self = (const _zn_link_t *)arg;
+
+    return _zn_read_batch_udp_multicast(self->socket.udp.sock, bufs, len, lens, n, self->socket.udp.laddr, addrs);
+}
+
+size_t _zn_f_link_writev_batch_udp_multicast(const void *arg, const z_bytes_t *iov, const size_t *iovcnts, size_t n)
+{
+    const _zn_link_t *self = (const _zn_link_t *)arg;
+
+    return _zn_sendv_batch_udp_multicast(self->socket.udp.msock, iov, iovcnts, n, self->socket.udp.raddr);
+}
+#endif
+
 uint16_t _zn_get_link_mtu_udp_multicast(void)
 {
     // @TODO: the return value should change depending on the target platform.
@@ -190,8 +215,21 @@ _zn_link_t *_zn_new_link_udp_multicast(_zn_endpoint_t endpoint)
 
     lt->write_f = _zn_f_link_write_udp_multicast;
     lt->write_all_f = _zn_f_link_write_all_udp_multicast;
+#if defined(Z_LINK_SENDV)
+    lt->writev_f = _zn_f_link_writev_udp_multicast;
+#else
+    lt->writev_f = NULL;
+#endif
     lt->read_f = _zn_f_link_read_udp_multicast;
     lt->read_exact_f = _zn_f_link_read_exact_udp_multicast;
+    lt->fd_f = NULL;
+#if defined(Z_LINK_BATCH)
+    lt->read_batch_f = _zn_f_link_read_batch_udp_multicast;
+    lt->writev_batch_f = _zn_f_link_writev_batch_udp_multicast;
+#else
+    lt->read_batch_f = NULL;
+    lt->writev_batch_f = NULL;
+#endif
 
     return lt;
 }
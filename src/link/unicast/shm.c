@@ -0,0 +1,149 @@
+//
+// Copyright (c) 2022 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+#include <stdlib.h>
+#include "zenoh-pico/config.h"
+#include "zenoh-pico/link/manager.h"
+#include "zenoh-pico/link/config/shm.h"
+#include "zenoh-pico/system/link/shm.h"
+
+#if ZN_LINK_SHM == 1 && defined(Z_LINK_SHM)
+
+unsigned long _zn_get_link_tout_shm(const _zn_link_t *self)
+{
+    unsigned long timeout = ZN_CONFIG_SOCKET_TIMEOUT_DEFAULT;
+    z_str_t tout = _z_str_intmap_get(&self->endpoint.config, SHM_CONFIG_TOUT_KEY);
+    if (tout != NULL)
+        timeout = strtol(tout, NULL, 10);
+
+    return timeout;
+}
+
+int _zn_f_link_open_shm(void *arg)
+{
+    _zn_link_t *self = (_zn_link_t *)arg;
+
+    // Attach to the segment created by the listening end
+    self->socket.shm.sock = _zn_open_shm(self->endpoint.locator.address, _zn_get_link_tout_shm(self));
+    if (self->socket.shm.sock == NULL)
+        goto ERR;
+
+    return 0;
+
+ERR:
+    return -1;
+}
+
+int _zn_f_link_listen_shm(void *arg)
+{
+    _zn_link_t *self = (_zn_link_t *)arg;
+
+    // Create the segment, the other end attaches to it by name
+    self->socket.shm.sock = _zn_listen_shm(self->endpoint.locator.address, _zn_get_link_tout_shm(self));
+    if (self->socket.shm.sock == NULL)
+        goto ERR;
+
+    return 0;
+
+ERR:
+    return -1;
+}
+
+void _zn_f_link_close_shm(void *arg)
+{
+    _zn_link_t *self = (_zn_link_t *)arg;
+
+    _zn_close_shm(self->socket.shm.sock);
+    self->socket.shm.sock = NULL;
+}
+
+void _zn_f_link_free_shm(void *arg)
+{
+    (void)(arg);
+}
+
+size_t _zn_f_link_write_shm(const void *arg, const uint8_t *ptr, size_t len)
+{
+    const _zn_link_t *self = (const _zn_link_t *)arg;
+
+    return _zn_send_shm(self->socket.shm.sock, ptr, len);
+}
+
+size_t _zn_f_link_write_all_shm(const void *arg, const uint8_t *ptr, size_t len)
+{
+    const _zn_link_t *self = (const _zn_link_t *)arg;
+
+    return _zn_send_shm(self->socket.shm.sock, ptr, len);
+}
+
+size_t _zn_f_link_writev_shm(const void *arg, const z_bytes_t *iov, size_t iovcnt)
+{
+    const _zn_link_t *self = (const _zn_link_t *)arg;
+
+    return _zn_sendv_shm(self->socket.shm.sock, iov, iovcnt);
+}
+
+size_t _zn_f_link_read_shm(const void *arg, uint8_t *ptr, size_t len, _zn_link_addr_t *addr)
+{
+    (void)(addr);
+    const _zn_link_t *self = (const _zn_link_t *)arg;
+
+    return _zn_read_shm(self->socket.shm.sock, ptr, len);
+}
+
+size_t _zn_f_link_read_exact_shm(const void *arg, uint8_t *ptr, size_t len, _zn_link_addr_t *addr)
+{
+    (void)(addr);
+    const _zn_link_t *self = (const _zn_link_t *)arg;
+
+    return _zn_read_exact_shm(self->socket.shm.sock, ptr, len);
+}
+
+uint16_t _zn_get_link_mtu_shm(void)
+{
+    // The batches are streamed through the rings, as for TCP
+    return 65535;
+}
+
+_zn_link_t *_zn_new_link_shm(_zn_endpoint_t endpoint)
+{
+    _zn_link_t *lt = (_zn_link_t *)z_malloc(sizeof(_zn_link_t));
+
+    lt->is_reliable = 1;
+    lt->is_streamed = 1;
+    lt->is_multicast = 0;
+    lt->mtu = _zn_get_link_mtu_shm();
+
+    lt->endpoint = endpoint;
+
+    lt->socket.shm.sock = NULL;
+
+    lt->open_f = _zn_f_link_open_shm;
+    lt->listen_f = _zn_f_link_listen_shm;
+    lt->close_f = _zn_f_link_close_shm;
+    lt->free_f = _zn_f_link_free_shm;
+
+    lt->write_f = _zn_f_link_write_shm;
+    lt->write_all_f = _zn_f_link_write_all_shm;
+    lt->writev_f = _zn_f_link_writev_shm;
+    lt->read_f = _zn_f_link_read_shm;
+    lt->read_exact_f = _zn_f_link_read_exact_shm;
+    // The rings are waited on through futexes, which cannot be polled for readiness
+    lt->fd_f = NULL;
+    lt->read_batch_f = NULL;
+    lt->writev_batch_f = NULL;
+
+    return lt;
+}
+#endif
@@ -130,7 +130,16 @@ size_t _zn_f_link_write_all_tcp(const void *arg, const uint8_t *ptr, size_t len)
     return _zn_send_tcp(self->socket.tcp.sock, ptr, len);
 }
 
-size_t _zn_f_link_read_tcp(const void *arg, uint8_t *ptr, size_t len, z_bytes_t *addr)
+#if defined(Z_LINK_SENDV)
+size_t _zn_f_link_writev_tcp(const void *arg, const z_bytes_t *iov, size_t iovcnt)
+{
+    const _zn_link_t *self = (const _zn_link_t *)arg;
+
+    return _zn_sendv_tcp(self->socket.tcp.sock, iov, iovcnt);
+}
+#endif
+
+size_t _zn_f_link_read_tcp(const void *arg, uint8_t *ptr, size_t len, _zn_link_addr_t *addr)
 {
     (void)(addr);
     const _zn_link_t *self = (const _zn_link_t *)arg;
@@ -138,7 +147,7 @@ size_t _zn_f_link_read_tcp(const void *arg, uint8_t *ptr, size_t len, z_bytes_t
     return _zn_read_tcp(self->socket.tcp.sock, ptr, len);
 }
 
-size_t _zn_f_link_read_exact_tcp(const void *arg, uint8_t *ptr, size_t len, z_bytes_t *addr)
+size_t _zn_f_link_read_exact_tcp(const void *arg, uint8_t *ptr, size_t len, _zn_link_addr_t *addr)
 {
     (void)(addr);
     const _zn_link_t *self = (const _zn_link_t *)arg;
@@ -146,6 +155,15 @@ size_t _zn_f_link_read_exact_tcp(const void *arg, uint8_t *ptr, size_t len, z_by
     return _zn_read_exact_tcp(self->socket.tcp.sock, ptr, len);
 }
 
+#if defined(Z_EVENT_LOOP)
+int _zn_f_link_fd_tcp(const void *arg)
+{
+    const _zn_link_t *self = (const _zn_link_t *)arg;
+
+    return _zn_get_fd_tcp(self->socket.tcp.sock);
+}
+#endif
+
 uint16_t _zn_get_link_mtu_tcp(void)
 {
     // Maximum MTU for TCP
@@ -177,8 +195,20 @@ _zn_link_t *_zn_new_link_tcp(_zn_endpoint_t endpoint)
 
     lt->write_f = _zn_f_link_write_tcp;
     lt->write_all_f = _zn_f_link_write_all_tcp;
+#if defined(Z_LINK_SENDV)
+    lt->writev_f = _zn_f_link_writev_tcp;
+#else
+    lt->writev_f = NULL;
+#endif
     lt->read_f = _zn_f_link_read_tcp;
     lt->read_exact_f = _zn_f_link_read_exact_tcp;
+#if defined(Z_EVENT_LOOP)
+    lt->fd_f = _zn_f_link_fd_tcp;
+#else
+    lt->fd_f = NULL;
+#endif
+    lt->read_batch_f = NULL;
+    lt->writev_batch_f = NULL;
 
     return lt;
 }
@@ -133,7 +133,16 @@ size_t _zn_f_link_write_all_udp_unicast(const void *arg, const uint8_t *ptr, siz
     return _zn_send_udp_unicast(self->socket.udp.sock, ptr, len, self->socket.udp.raddr);
 }
 
-size_t _zn_f_link_read_udp_unicast(const void *arg, uint8_t *ptr, size_t len, z_bytes_t *addr)
+#if defined(Z_LINK_SENDV)
+size_t _zn_f_link_writev_udp_unicast(const void *arg, const z_bytes_t *iov, size_t iovcnt)
+{
+    const _zn_link_t *self = (const _zn_link_t *)arg;
+
+    return _zn_sendv_udp_unicast(self->socket.udp.sock, iov, iovcnt, self->socket.udp.raddr);
+}
+#endif
+
+size_t _zn_f_link_read_udp_unicast(const void *arg, uint8_t *ptr, size_t len, _zn_link_addr_t *addr)
 {
     (void)(addr);
     const _zn_link_t *self = (const _zn_link_t *)arg;
@@ -141,7 +150,7 @@ size_t _zn_f_link_read_udp_unicast(const void *arg, uint8_t *ptr, size_t len, z_
     return _zn_read_udp_unicast(self->socket.udp.sock, ptr, len);
 }
 
-size_t _zn_f_link_read_exact_udp_unicast(const void *arg, uint8_t *ptr, size_t len, z_bytes_t *addr)
+size_t _zn_f_link_read_exact_udp_unicast(const void *arg, uint8_t *ptr, size_t len, _zn_link_addr_t *addr)
 {
     (void)(addr);
     const _zn_link_t *self = (const _zn_link_t *)arg;
@@ -149,6 +158,32 @@ size_t _zn_f_link_read_exact_udp_unicast(const void *arg, uint8_t *ptr, size_t l
     return _zn_read_exact_udp_unicast(self->socket.udp.sock, ptr, len);
 }
 
+#if defined(Z_EVENT_LOOP)
+int _zn_f_link_fd_udp_unicast(const void *arg)
+{
+    const _zn_link_t *self = (const _zn_link_t *)arg;
+
+    return _zn_get_fd_udp_unicast(self->socket.udp.sock);
+}
+#endif
+
+#if defined(Z_LINK_BATCH)
+size_t _zn_f_link_read_batch_udp_unicast(const void *arg, uint8_t **bufs, size_t len, size_t *lens, size_t n, _zn_link_addr_t *addrs)
+{
+    (void)(addrs);
+    const _zn_link_t *self = (const _zn_link_t *)arg;
+
+    return _zn_read_batch_udp_unicast(self->socket.udp.sock, bufs, len, lens, n);
+}
+
+size_t _zn_f_link_writev_batch_udp_unicast(const void *arg, const z_bytes_t *iov, const size_t *iovcnts, size_t n)
+{
+    const _zn_link_t *self = (const _zn_link_t *)arg;
+
+    return _zn_sendv_batch_udp_unicast(self->socket.udp.sock, iov, iovcnts, n, self->socket.udp.raddr);
+}
+#endif
+
 uint16_t _zn_get_link_mtu_udp_unicast(void)
 {
     // @TODO: the return value should change depending on the target platform.
@@ -182,8 +217,25 @@ _zn_link_t *_zn_new_link_udp_unicast(_zn_endpoint_t endpoint)
 
     lt->write_f = _zn_f_link_write_udp_unicast;
     lt->write_all_f = _zn_f_link_write_all_udp_unicast;
+#if defined(Z_LINK_SENDV)
+    lt->writev_f = _zn_f_link_writev_udp_unicast;
+#else
+    lt->writev_f = NULL;
+#endif
     lt->read_f = _zn_f_link_read_udp_unicast;
     lt->read_exact_f = _zn_f_link_read_exact_udp_unicast;
+#if defined(Z_EVENT_LOOP)
+    lt->fd_f = _zn_f_link_fd_udp_unicast;
+#else
+    lt->fd_f = NULL;
+#endif
+#if defined(Z_LINK_BATCH)
+    lt->read_batch_f = _zn_f_link_read_batch_udp_unicast;
+    lt->writev_batch_f = _zn_f_link_writev_batch_udp_unicast;
+#else
+    lt->read_batch_f = NULL;
+    lt->writev_batch_f = NULL;
+#endif
 
     return lt;
 }
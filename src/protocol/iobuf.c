@@ -260,7 +260,7 @@ void _z_zbuf_compact(_z_zbuf_t *zbf)
         return;
 
     size_t len = _z_iosli_readable(&zbf->ios);
-    memcpy(zbf->ios.buf, _z_zbuf_get_rptr(zbf), len * sizeof(uint8_t));
+    memmove(zbf->ios.buf, _z_zbuf_get_rptr(zbf), len * sizeof(uint8_t));
     _z_zbuf_set_rpos(zbf, 0);
     _z_zbuf_set_wpos(zbf, len);
 }
@@ -466,12 +466,13 @@ int _z_wbuf_wrap_bytes(_z_wbuf_t *wbf, const uint8_t *bs, size_t offset, size_t
     _z_iosli_t *ios = _z_wbuf_get_iosli(wbf, wbf->w_idx);
     size_t writable = _z_iosli_writable(ios);
     ios->capacity = ios->w_pos; // Block writing on this ioslice
-                                // The remaining space is allocated in a new ioslice
+                                // The remaining space is exposed by a view placed after the wrapped bytes
 
     _z_iosli_t wios = _z_iosli_wrap(bs, length, offset, offset + length);
     _z_wbuf_add_iosli(wbf, _z_iosli_clone(&wios));
 
-    _z_wbuf_add_iosli(wbf, __z_wbuf_new_iosli(writable));
+    _z_iosli_t vios = _z_iosli_wrap(ios->buf + ios->w_pos, writable, 0, 0);
+    _z_wbuf_add_iosli(wbf, _z_iosli_clone(&vios));
     return 0;
 }
 
@@ -580,11 +581,25 @@ _z_zbuf_t _z_wbuf_to_zbuf(const _z_wbuf_t *wbf)
 
 int _z_wbuf_siphon(_z_wbuf_t *dst, _z_wbuf_t *src, size_t length)
 {
-    for (size_t i = 0; i < length; i++)
+    while (length > 0)
     {
-        int res = _z_wbuf_write(dst, __z_wbuf_read(src));
+        assert(src->r_idx <= src->w_idx);
+        _z_iosli_t *ios = _z_wbuf_get_iosli(src, src->r_idx);
+        size_t readable = _z_iosli_readable(ios);
+        if (readable == 0)
+        {
+            src->r_idx++;
+            continue;
+        }
+
+        // Copy as many bytes as possible at once from the current slice
+        size_t to_copy = readable <= length ? readable : length;
+        int res = _z_wbuf_write_bytes(dst, ios->buf, ios->r_pos, to_copy);
         if (res != 0)
             return -1;
+
+        ios->r_pos += to_copy;
+        length -= to_copy;
     }
     return 0;
 }
@@ -604,13 +619,23 @@ void _z_wbuf_reset(_z_wbuf_t *wbf)
     wbf->w_idx = 0;
 
     // Reset to default iosli allocation
-    for (size_t i = 0; i < _z_wbuf_len_iosli(wbf); i++)
+    _z_iosli_t *last = NULL;
+    size_t i = 0;
+    while (i < _z_wbuf_len_iosli(wbf))
     {
         _z_iosli_t *ios = _z_wbuf_get_iosli(wbf, i);
-        if (ios->is_alloc == 0)
-            _z_iosli_vec_remove(&wbf->ioss, i);
-        else
+        if (ios->is_alloc == 1)
+        {
             _z_iosli_reset(ios);
+            last = ios;
+            i++;
+            continue;
+        }
+
+        // Give back the space blocked by _z_wbuf_wrap_bytes to the ioslice owning it
+        if (last != NULL && ios->buf == last->buf + last->capacity)
+            last->capacity += ios->capacity;
+        _z_iosli_vec_remove(&wbf->ioss, i);
     }
 }
 
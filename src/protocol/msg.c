@@ -845,6 +845,7 @@ _zn_transport_message_t _zn_t_msg_make_frame_header(z_zint_t sn, int is_reliable
     _zn_transport_message_t msg;
 
     msg.body.frame.sn = sn;
+    msg.body.frame.priority = ZN_PRIORITY_DEFAULT;
 
     // Reset payload content
     memset(&msg.body.frame.payload, 0, sizeof(_zn_frame_payload_t));
@@ -869,6 +870,7 @@ _zn_transport_message_t _zn_t_msg_make_frame(z_zint_t sn, _zn_frame_payload_t pa
     _zn_transport_message_t msg;
 
     msg.body.frame.sn = sn;
+    msg.body.frame.priority = ZN_PRIORITY_DEFAULT;
     msg.body.frame.payload = payload;
 
     msg.header = _ZN_MID_FRAME;
@@ -1167,6 +1167,35 @@ int _zn_zenoh_message_encode(_z_wbuf_t *wbf, const _zn_zenoh_message_t *msg)
     }
 }
 
+int _zn_zenoh_message_encode_loan(_z_wbuf_t *wbf, const _zn_zenoh_message_t *msg, uint8_t **payload)
+{
+    // Only data messages without decorators can be loaned
+    if (_ZN_MID(msg->header) != _ZN_MID_DATA || msg->attachment || msg->reply_context)
+        return -1;
+
+    // Encode the header
+    _ZN_EC(_z_wbuf_write(wbf, msg->header))
+
+    // Encode the body up to the payload length
+    _ZN_EC(_zn_reskey_encode(wbf, msg->header, &msg->body.data.key))
+
+    if (_ZN_HAS_FLAG(msg->header, _ZN_FLAG_Z_I))
+        _ZN_EC(_zn_data_info_encode(wbf, &msg->body.data.info))
+
+    size_t len = msg->body.data.payload.len;
+    _ZN_EC(_z_zint_encode(wbf, len))
+
+    // Reserve the payload, which needs to be contiguous in memory
+    _z_iosli_t *ios = _z_wbuf_get_iosli(wbf, wbf->w_idx);
+    if (_z_iosli_writable(ios) < len)
+        return -1;
+
+    *payload = ios->buf + ios->w_pos;
+    ios->w_pos += len;
+
+    return 0;
+}
+
 void _zn_zenoh_message_decode_na(_z_zbuf_t *zbf, _zn_zenoh_message_result_t *r)
 {
     r->tag = _z_res_t_OK;
@@ -1797,7 +1826,7 @@ int _zn_frame_encode(_z_wbuf_t *wbf, uint8_t header, const _zn_frame_t *msg)
     }
 }
 
-void _zn_frame_decode_na(_z_zbuf_t *zbf, uint8_t header, _zn_frame_result_t *r)
+void __zn_frame_decode_na(_z_zbuf_t *zbf, uint8_t header, int is_streamed, _zn_frame_result_t *r)
 {
     _Z_DEBUG("Decoding _ZN_MID_FRAME\n");
     r->tag = _z_res_t_OK;
@@ -1806,6 +1835,7 @@ void _zn_frame_decode_na(_z_zbuf_t *zbf, uint8_t header, _zn_frame_result_t *r)
     _z_zint_result_t r_zint = _z_zint_decode(zbf);
     _ASSURE_P_RESULT(r_zint, r, _z_err_t_PARSE_ZINT)
     r->value.frame.sn = r_zint.value.zint;
+    r->value.frame.priority = ZN_PRIORITY_DEFAULT;
 
     // Decode the payload
     if (_ZN_HAS_FLAG(header, _ZN_FLAG_T_F))
@@ -1816,6 +1846,11 @@ void _zn_frame_decode_na(_z_zbuf_t *zbf, uint8_t header, _zn_frame_result_t *r)
         // We need to manually move the r_pos to w_pos, we have read it all
         _z_zbuf_set_rpos(zbf, _z_zbuf_get_wpos(zbf));
     }
+    else if (is_streamed == 1)
+    {
+        // Leave the zenoh messages in the buffer, they are decoded one by one by the caller
+        memset(&r->value.frame.payload, 0, sizeof(_zn_frame_payload_t));
+    }
     else
     {
         r->value.frame.payload.messages = _zn_zenoh_message_vec_make(_ZENOH_PICO_FRAME_MESSAGES_VEC_SIZE);
@@ -1840,6 +1875,11 @@ void _zn_frame_decode_na(_z_zbuf_t *zbf, uint8_t header, _zn_frame_result_t *r)
     }
 }
 
+void _zn_frame_decode_na(_z_zbuf_t *zbf, uint8_t header, _zn_frame_result_t *r)
+{
+    __zn_frame_decode_na(zbf, header, 0, r);
+}
+
 _zn_frame_result_t _zn_frame_decode(_z_zbuf_t *zbf, uint8_t header)
 {
     _zn_frame_result_t r;
@@ -1853,6 +1893,8 @@ int _zn_transport_message_encode(_z_wbuf_t *wbf, const _zn_transport_message_t *
     // Encode the decorators if present
     if (msg->attachment)
         _ZN_EC(_zn_attachment_encode(wbf, msg->attachment))
+    if (_ZN_MID(msg->header) == _ZN_MID_FRAME && msg->body.frame.priority != ZN_PRIORITY_DEFAULT)
+        _ZN_EC(_z_wbuf_write(wbf, _ZN_PRIORITY_HEADER(msg->body.frame.priority)))
 
     // Encode the header
     _ZN_EC(_z_wbuf_write(wbf, msg->header))
@@ -1888,10 +1930,11 @@ int _zn_transport_message_encode(_z_wbuf_t *wbf, const _zn_transport_message_t *
     }
 }
 
-void _zn_transport_message_decode_na(_z_zbuf_t *zbf, _zn_transport_message_result_t *r)
+void __zn_transport_message_decode_na(_z_zbuf_t *zbf, int is_streamed, _zn_transport_message_result_t *r)
 {
     r->tag = _z_res_t_OK;
     r->value.transport_message.attachment = NULL;
+    zn_priority_t priority = ZN_PRIORITY_DEFAULT;
 
     do
     {
@@ -1906,9 +1949,11 @@ void _zn_transport_message_decode_na(_z_zbuf_t *zbf, _zn_transport_message_resul
         {
         case _ZN_MID_FRAME:
         {
-            _zn_frame_result_t r_fr = _zn_frame_decode(zbf, r->value.transport_message.header);
+            _zn_frame_result_t r_fr;
+            __zn_frame_decode_na(zbf, r->value.transport_message.header, is_streamed, &r_fr);
             _ASSURE_P_RESULT(r_fr, r, _zn_err_t_PARSE_TRANSPORT_MESSAGE)
             r->value.transport_message.body.frame = r_fr.value.frame;
+            r->value.transport_message.body.frame.priority = priority;
             return;
         }
         case _ZN_MID_ATTACHMENT:
@@ -1990,10 +2035,9 @@ void _zn_transport_message_decode_na(_z_zbuf_t *zbf, _zn_transport_message_resul
         }
         case _ZN_MID_PRIORITY:
         {
-            _Z_DEBUG("WARNING: Priorities are not supported in zenoh-pico\n");
-            r->tag = _z_res_t_ERR;
-            r->value.error = _zn_err_t_PARSE_TRANSPORT_MESSAGE;
-            return;
+            // The decorator applies to the frame that follows
+            priority = _ZN_PRIORITY(r->value.transport_message.header);
+            break;
         }
         default:
         {
@@ -2006,6 +2050,18 @@ void _zn_transport_message_decode_na(_z_zbuf_t *zbf, _zn_transport_message_resul
     } while (1);
 }
 
+void _zn_transport_message_decode_na(_z_zbuf_t *zbf, _zn_transport_message_result_t *r)
+{
+    __zn_transport_message_decode_na(zbf, 0, r);
+}
+
+// The zenoh messages of a non-fragmented FRAME are left in the buffer: on return, its
+// read position points at the first of them.
+void _zn_transport_message_decode_streamed_na(_z_zbuf_t *zbf, _zn_transport_message_result_t *r)
+{
+    __zn_transport_message_decode_na(zbf, 1, r);
+}
+
 _zn_transport_message_result_t _zn_transport_message_decode(_z_zbuf_t *zbf)
 {
     _zn_transport_message_result_t r;
@@ -12,8 +12,11 @@
 //   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
 //
 
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include "zenoh-pico/collections/string.h"
+#include "zenoh-pico/protocol/utils.h"
 
 #define CEND(str) (str[0] == 0 || str[0] == '/')
 #define CWILD(str) (str[0] == '*')
@@ -65,3 +68,334 @@ z_str_t next(const z_str_t str)
 }
 
 DEFINE_INTERSECT(zn_rname_intersect, END, WILD, next, chunk_intersect)
+
+/*------------------ Resource name index ------------------*/
+#define CLEN(str) strcspn(str, "/")
+#define CIS_WILD(str, len) (len == 2 && str[0] == '*' && str[1] == '*')
+#define CHAS_WILD(str, len) (memchr(str, '*', len) != NULL)
+
+// Initial capacity of the vector collecting the nodes matched by a resource name
+#define _ZN_RNAME_MATCH_NODES 8
+
+size_t __zn_rname_chunk_hash(const char *chunk, size_t len)
+{
+    // FNV-1a over the chunk characters
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++)
+    {
+        hash ^= (uint8_t)chunk[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+int __zn_rname_node_ptr_eq(const void *left, const void *right)
+{
+    return left == right;
+}
+
+// Orders the matched nodes by address, for qsort
+int __zn_rname_node_ptr_cmp(const void *left, const void *right)
+{
+    uintptr_t l = (uintptr_t)*(void *const *)left;
+    uintptr_t r = (uintptr_t)*(void *const *)right;
+    return l < r ? -1 : l > r;
+}
+
+_zn_rname_node_t *__zn_rname_node_new(const char *chunk, size_t len)
+{
+    _zn_rname_node_t *node = (_zn_rname_node_t *)z_malloc(sizeof(_zn_rname_node_t));
+    node->chunk = (z_str_t)z_malloc(len + 1);
+    memcpy(node->chunk, chunk, len);
+    node->chunk[len] = '\0';
+    _z_int_void_map_init(&node->children, _Z_DEFAULT_INT_MAP_CAPACITY);
+    node->wilds = NULL;
+    node->dwild = NULL;
+    node->next = NULL;
+    node->vals = NULL;
+
+    return node;
+}
+
+int __zn_rname_node_is_empty(const _zn_rname_node_t *node)
+{
+    return node->vals == NULL && node->wilds == NULL && node->dwild == NULL && _z_int_void_map_is_empty(&node->children);
+}
+
+void __zn_rname_node_free(_zn_rname_node_t **node);
+
+void __zn_rname_node_entry_free(void **e)
+{
+    // Free the whole chain of literal siblings sharing the same chunk hash
+    _z_int_void_map_entry_t *ptr = (_z_int_void_map_entry_t *)*e;
+    _zn_rname_node_t *node = (_zn_rname_node_t *)ptr->val;
+    while (node != NULL)
+    {
+        _zn_rname_node_t *next = node->next;
+        __zn_rname_node_free(&node);
+        node = next;
+    }
+
+    z_free(ptr);
+    *e = NULL;
+}
+
+void __zn_rname_node_entry_drop(void **e)
+{
+    // The chain of siblings is relinked by the caller, only drop the entry
+    z_free(*e);
+    *e = NULL;
+}
+
+void __zn_rname_node_elem_free(void **e)
+{
+    _zn_rname_node_t *node = (_zn_rname_node_t *)*e;
+    __zn_rname_node_free(&node);
+    *e = NULL;
+}
+
+void __zn_rname_node_free(_zn_rname_node_t **node)
+{
+    _zn_rname_node_t *ptr = *node;
+
+    _z_int_void_map_clear(&ptr->children, __zn_rname_node_entry_free);
+    _z_list_free(&ptr->wilds, __zn_rname_node_elem_free);
+    if (ptr->dwild != NULL)
+        __zn_rname_node_free(&ptr->dwild);
+    _z_list_free(&ptr->vals, _zn_noop_free);
+    _z_str_clear(ptr->chunk);
+
+    z_free(ptr);
+    *node = NULL;
+}
+
+_zn_rname_node_t *__zn_rname_node_get_child(const _zn_rname_node_t *node, const char *chunk, size_t len)
+{
+    if (CIS_WILD(chunk, len))
+        return node->dwild;
+
+    if (CHAS_WILD(chunk, len))
+    {
+        _z_list_t *xs = node->wilds;
+        while (xs != NULL)
+        {
+            _zn_rname_node_t *child = (_zn_rname_node_t *)_z_list_head(xs);
+            if (strlen(child->chunk) == len && memcmp(child->chunk, chunk, len) == 0)
+                return child;
+
+            xs = _z_list_tail(xs);
+        }
+
+        return NULL;
+    }
+
+    _zn_rname_node_t *child = (_zn_rname_node_t *)_z_int_void_map_get(&node->children, __zn_rname_chunk_hash(chunk, len));
+    while (child != NULL)
+    {
+        if (strlen(child->chunk) == len && memcmp(child->chunk, chunk, len) == 0)
+            return child;
+
+        child = child->next;
+    }
+
+    return NULL;
+}
+
+_zn_rname_node_t *__zn_rname_node_add_child(_zn_rname_node_t *node, const char *chunk, size_t len)
+{
+    _zn_rname_node_t *child = __zn_rname_node_new(chunk, len);
+    if (CIS_WILD(chunk, len))
+    {
+        node->dwild = child;
+    }
+    else if (CHAS_WILD(chunk, len))
+    {
+        node->wilds = _z_list_push(node->wilds, child);
+    }
+    else
+    {
+        size_t hash = __zn_rname_chunk_hash(chunk, len);
+        child->next = (_zn_rname_node_t *)_z_int_void_map_get(&node->children, hash);
+        _z_int_void_map_insert(&node->children, hash, child, __zn_rname_node_entry_drop);
+    }
+
+    return child;
+}
+
+void __zn_rname_node_drop_child(_zn_rname_node_t *node, _zn_rname_node_t *child)
+{
+    size_t len = strlen(child->chunk);
+    if (CIS_WILD(child->chunk, len))
+    {
+        node->dwild = NULL;
+    }
+    else if (CHAS_WILD(child->chunk, len))
+    {
+        node->wilds = _z_list_drop_filter(node->wilds, _zn_noop_free, __zn_rname_node_ptr_eq, child);
+    }
+    else
+    {
+        size_t hash = __zn_rname_chunk_hash(child->chunk, len);
+        _zn_rname_node_t *head = (_zn_rname_node_t *)_z_int_void_map_get(&node->children, hash);
+        if (head == child)
+        {
+            if (child->next != NULL)
+                _z_int_void_map_insert(&node->children, hash, child->next, __zn_rname_node_entry_drop);
+            else
+                _z_int_void_map_remove(&node->children, hash, __zn_rname_node_entry_drop);
+        }
+        else
+        {
+            while (head->next != child)
+                head = head->next;
+            head->next = child->next;
+        }
+    }
+
+    __zn_rname_node_free(&child);
+}
+
+int __zn_rname_node_remove(_zn_rname_node_t *node, const z_str_t rname, void *val)
+{
+    if (END(rname))
+    {
+        if (_z_list_find(node->vals, __zn_rname_node_ptr_eq, val) == NULL)
+            return 0;
+
+        node->vals = _z_list_drop_filter(node->vals, _zn_noop_free, __zn_rname_node_ptr_eq, val);
+        return 1;
+    }
+
+    _zn_rname_node_t *child = __zn_rname_node_get_child(node, rname, CLEN(rname));
+    if (child == NULL)
+        return 0;
+
+    int res = __zn_rname_node_remove(child, next(rname), val);
+
+    // Prune the branches that do not index any value anymore
+    if (res == 1 && __zn_rname_node_is_empty(child))
+        __zn_rname_node_drop_child(node, child);
+
+    return res;
+}
+
+void __zn_rname_node_match(const _zn_rname_node_t *node, const z_str_t rname, _z_vec_t *nodes)
+{
+    if (END(rname))
+    {
+        // A node may be reached through several paths, the duplicates are dropped once at the end
+        if (node->vals != NULL)
+            _z_vec_append(nodes, (void *)node);
+
+        // A trailing ** matches zero chunks
+        if (node->dwild != NULL)
+            __zn_rname_node_match(node->dwild, rname, nodes);
+
+        return;
+    }
+
+    size_t len = CLEN(rname);
+    z_str_t nrname = next(rname);
+
+    _zn_rname_node_t *child = __zn_rname_node_get_child(node, rname, len);
+    if (child != NULL)
+        __zn_rname_node_match(child, nrname, nodes);
+
+    _z_list_t *xs = node->wilds;
+    while (xs != NULL)
+    {
+        _zn_rname_node_t *wild = (_zn_rname_node_t *)_z_list_head(xs);
+        if (chunk_intersect(wild->chunk, rname))
+            __zn_rname_node_match(wild, nrname, nodes);
+
+        xs = _z_list_tail(xs);
+    }
+
+    // A ** matches any number of chunks
+    if (node->dwild != NULL)
+    {
+        z_str_t r = rname;
+        while (1)
+        {
+            __zn_rname_node_match(node->dwild, r, nodes);
+            if (END(r))
+                break;
+            r = next(r);
+        }
+    }
+}
+
+void _zn_rname_index_init(_zn_rname_index_t *idx)
+{
+    idx->root = NULL;
+}
+
+void _zn_rname_index_insert(_zn_rname_index_t *idx, const z_str_t rname, void *val)
+{
+    if (idx->root == NULL)
+        idx->root = __zn_rname_node_new("", 0);
+
+    _zn_rname_node_t *node = idx->root;
+    z_str_t r = rname;
+    while (!END(r))
+    {
+        size_t len = CLEN(r);
+        _zn_rname_node_t *child = __zn_rname_node_get_child(node, r, len);
+        if (child == NULL)
+            child = __zn_rname_node_add_child(node, r, len);
+
+        node = child;
+        r = next(r);
+    }
+
+    node->vals = _z_list_push(node->vals, val);
+}
+
+void _zn_rname_index_remove(_zn_rname_index_t *idx, const z_str_t rname, void *val)
+{
+    if (idx->root == NULL)
+        return;
+
+    __zn_rname_node_remove(idx->root, rname, val);
+}
+
+int _zn_rname_index_can_match(const z_str_t rname)
+{
+    // The index matches concrete resource names only
+    return strchr(rname, '*') == NULL;
+}
+
+_z_list_t *_zn_rname_index_match(const _zn_rname_index_t *idx, const z_str_t rname)
+{
+    _z_list_t *xs = NULL;
+    if (idx->root == NULL)
+        return xs;
+
+    _z_vec_t nodes = _z_vec_make(_ZN_RNAME_MATCH_NODES);
+    __zn_rname_node_match(idx->root, rname, &nodes);
+    qsort(nodes.val, nodes.len, sizeof(void *), __zn_rname_node_ptr_cmp);
+
+    for (size_t i = 0; i < nodes.len; i++)
+    {
+        if (i > 0 && nodes.val[i] == nodes.val[i - 1])
+            continue;
+
+        _zn_rname_node_t *node = (_zn_rname_node_t *)nodes.val[i];
+        _z_list_t *vs = node->vals;
+        while (vs != NULL)
+        {
+            xs = _z_list_push(xs, _z_list_head(vs));
+            vs = _z_list_tail(vs);
+        }
+    }
+
+    _z_vec_clear(&nodes, _zn_noop_free);
+    return xs;
+}
+
+void _zn_rname_index_clear(_zn_rname_index_t *idx)
+{
+    if (idx->root != NULL)
+        __zn_rname_node_free(&idx->root);
+}
@@ -84,7 +84,7 @@ _zn_pending_query_t *__zn_get_pending_query_by_id(_zn_pending_query_list_t *pqls
 /**
  * This function is unsafe because it operates in potentially concurrent data.
  * Make sure that the following mutexes are locked before calling this function:
- *  - zn->mutex_inner
+ *  - zn->mutex_queries
  */
 _zn_pending_query_t *__unsafe_zn_get_pending_query_by_id(zn_session_t *zn, const z_zint_t id)
 {
@@ -94,16 +94,16 @@ _zn_pending_query_t *__unsafe_zn_get_pending_query_by_id(zn_session_t *zn, const
 
 _zn_pending_query_t *_zn_get_pending_query_by_id(zn_session_t *zn, const z_zint_t id)
 {
-    z_mutex_lock(&zn->mutex_inner);
+    z_mutex_lock(&zn->mutex_queries);
     _zn_pending_query_t *pql = __unsafe_zn_get_pending_query_by_id(zn, id);
-    z_mutex_unlock(&zn->mutex_inner);
+    z_mutex_unlock(&zn->mutex_queries);
     return pql;
 }
 
 int _zn_register_pending_query(zn_session_t *zn, _zn_pending_query_t *pen_qry)
 {
     _Z_DEBUG(">>> Allocating query for (%lu,%s,%s)\n", pen_qry->key.rid, pen_qry->key.rname, pen_qry->predicate);
-    z_mutex_lock(&zn->mutex_inner);
+    z_mutex_lock(&zn->mutex_queries);
 
     _zn_pending_query_t *pql = __unsafe_zn_get_pending_query_by_id(zn, pen_qry->id);
     if (pql != NULL) // A query for this id already exists
@@ -112,10 +112,11 @@ int _zn_register_pending_query(zn_session_t *zn, _zn_pending_query_t *pen_qry)
     // Register the query
     zn->pending_queries = _zn_pending_query_list_push(zn->pending_queries, pen_qry);
 
-    z_mutex_unlock(&zn->mutex_inner);
+    z_mutex_unlock(&zn->mutex_queries);
     return 0;
 
 ERR:
+    z_mutex_unlock(&zn->mutex_queries);
     return -1;
 }
 
@@ -125,7 +126,7 @@ int _zn_trigger_query_reply_partial(zn_session_t *zn,
                                     const z_bytes_t payload,
                                     const _zn_data_info_t data_info)
 {
-    z_mutex_lock(&zn->mutex_inner);
+    z_mutex_lock(&zn->mutex_queries);
 
     if (_ZN_HAS_FLAG(reply_context->header, _ZN_FLAG_Z_F))
         goto ERR_1;
@@ -152,7 +153,7 @@ int _zn_trigger_query_reply_partial(zn_session_t *zn,
     if (reskey.rid == ZN_RESOURCE_ID_NONE)
         reply->data.data.key.val = _z_str_clone(reskey.rname);
     else
-        reply->data.data.key.val = __unsafe_zn_get_resource_name_from_key(zn, _ZN_RESOURCE_REMOTE, &reskey);
+        reply->data.data.key.val = _zn_get_resource_name_from_key(zn, _ZN_RESOURCE_REMOTE, &reskey);
     reply->data.data.key.len = strlen(reply->data.data.key.val);
     _z_bytes_copy(&reply->data.replier_id, &reply_context->replier_id);
     reply->data.replier_kind = reply_context->replier_kind;
@@ -197,19 +198,19 @@ int _zn_trigger_query_reply_partial(zn_session_t *zn,
         _zn_reply_free(&reply);
     }
 
-    z_mutex_unlock(&zn->mutex_inner);
+    z_mutex_unlock(&zn->mutex_queries);
     return 0;
 
 ERR_2:
     _zn_reply_free(&reply);
 ERR_1:
-    z_mutex_unlock(&zn->mutex_inner);
+    z_mutex_unlock(&zn->mutex_queries);
     return -1;
 }
 
 int _zn_trigger_query_reply_final(zn_session_t *zn, const _zn_reply_context_t *reply_context)
 {
-    z_mutex_lock(&zn->mutex_inner);
+    z_mutex_lock(&zn->mutex_queries);
 
     // Final reply received with invalid final flag
     if (!_ZN_HAS_FLAG(reply_context->header, _ZN_FLAG_Z_F))
@@ -227,7 +228,7 @@ int _zn_trigger_query_reply_final(zn_session_t *zn, const _zn_reply_context_t *r
     // The reply is the final one, apply consolidation if needed
     if (pen_qry->consolidation.reception == zn_consolidation_mode_t_FULL)
     {
-        z_str_t rname = __unsafe_zn_get_resource_name_from_key(zn, _ZN_RESOURCE_REMOTE, &pen_qry->key);
+        z_str_t rname = _zn_get_resource_name_from_key(zn, _ZN_RESOURCE_REMOTE, &pen_qry->key);
 
         _zn_pending_reply_list_t *pen_rps = pen_qry->pending_replies;
         _zn_pending_reply_t *pen_rep = NULL;
@@ -254,24 +255,24 @@ int _zn_trigger_query_reply_final(zn_session_t *zn, const _zn_reply_context_t *r
 
     zn->pending_queries = _zn_pending_query_list_drop_filter(zn->pending_queries, _zn_pending_query_eq, pen_qry);
 
-    z_mutex_unlock(&zn->mutex_inner);
+    z_mutex_unlock(&zn->mutex_queries);
     return 0;
 
 ERR:
-    z_mutex_unlock(&zn->mutex_inner);
+    z_mutex_unlock(&zn->mutex_queries);
     return -1;
 }
 
 void _zn_unregister_pending_query(zn_session_t *zn, _zn_pending_query_t *pen_qry)
 {
-    z_mutex_lock(&zn->mutex_inner);
+    z_mutex_lock(&zn->mutex_queries);
     zn->pending_queries = _zn_pending_query_list_drop_filter(zn->pending_queries, _zn_pending_query_eq, pen_qry);
-    z_mutex_unlock(&zn->mutex_inner);
+    z_mutex_unlock(&zn->mutex_queries);
 }
 
 void _zn_flush_pending_queries(zn_session_t *zn)
 {
-    z_mutex_lock(&zn->mutex_inner);
+    z_mutex_lock(&zn->mutex_queries);
     _zn_pending_query_list_free(&zn->pending_queries);
-    z_mutex_unlock(&zn->mutex_inner);
+    z_mutex_unlock(&zn->mutex_queries);
 }
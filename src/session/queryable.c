@@ -61,7 +61,7 @@ _zn_queryable_list_t *__zn_get_queryables_by_name(_zn_queryable_list_t *qles, co
 /**
  * This function is unsafe because it operates in potentially concurrent data.
  * Make sure that the following mutexes are locked before calling this function:
- *  - zn->mutex_inner
+ *  - zn->rwlock_queryables (read)
  */
 _zn_queryable_t *__unsafe_zn_get_queryable_by_id(zn_session_t *zn, const z_zint_t id)
 {
@@ -72,37 +72,41 @@ _zn_queryable_t *__unsafe_zn_get_queryable_by_id(zn_session_t *zn, const z_zint_
 /**
  * This function is unsafe because it operates in potentially concurrent data.
  * Make sure that the following mutexes are locked before calling this function:
- *  - zn->mutex_inner
+ *  - zn->rwlock_queryables (read)
  */
 _zn_queryable_list_t *__unsafe_zn_get_queryables_by_name(zn_session_t *zn, const z_str_t rname)
 {
+    // Concrete resource names are matched against all queryables at once
+    if (_zn_rname_index_can_match(rname))
+        return _zn_rname_index_match(&zn->local_queryables_index, rname);
+
     _zn_queryable_list_t *qles = zn->local_queryables;
     return __zn_get_queryables_by_name(qles, rname);
 }
 
 _zn_queryable_t *_zn_get_queryable_by_id(zn_session_t *zn, const z_zint_t id)
 {
-    z_mutex_lock(&zn->mutex_inner);
+    z_rwlock_rdlock(&zn->rwlock_queryables);
     _zn_queryable_t *qle = __unsafe_zn_get_queryable_by_id(zn, id);
-    z_mutex_unlock(&zn->mutex_inner);
+    z_rwlock_unlock(&zn->rwlock_queryables);
     return qle;
 }
 
 _zn_queryable_list_t *_zn_get_queryables_by_name(zn_session_t *zn, const z_str_t rname)
 {
-    z_mutex_lock(&zn->mutex_inner);
+    z_rwlock_rdlock(&zn->rwlock_queryables);
     _zn_queryable_list_t *qles = __unsafe_zn_get_queryables_by_name(zn, rname);
-    z_mutex_unlock(&zn->mutex_inner);
+    z_rwlock_unlock(&zn->rwlock_queryables);
     return qles;
 }
 
 _zn_queryable_list_t *_zn_get_queryables_by_key(zn_session_t *zn, const zn_reskey_t *reskey)
 {
-    z_mutex_lock(&zn->mutex_inner);
-    z_str_t rname = __unsafe_zn_get_resource_name_from_key(zn, _ZN_RESOURCE_IS_LOCAL, reskey);
-    _zn_queryable_list_t *qles = __unsafe_zn_get_queryables_by_name(zn, rname);
-    z_mutex_unlock(&zn->mutex_inner);
+    z_str_t rname = _zn_get_resource_name_from_key(zn, _ZN_RESOURCE_IS_LOCAL, reskey);
+    if (rname == NULL)
+        return NULL;
 
+    _zn_queryable_list_t *qles = _zn_get_queryables_by_name(zn, rname);
     _z_str_clear(rname);
     return qles;
 }
@@ -110,21 +114,65 @@ _zn_queryable_list_t *_zn_get_queryables_by_key(zn_session_t *zn, const zn_reske
 int _zn_register_queryable(zn_session_t *zn, _zn_queryable_t *qle)
 {
     _Z_DEBUG(">>> Allocating queryable for (%s,%u)\n", qle->rname, qle->kind);
-    z_mutex_lock(&zn->mutex_inner);
+    z_rwlock_wrlock(&zn->rwlock_queryables);
 
+    // The session holds the first reference
+    qle->refcount = 1;
+    qle->drained = NULL;
     zn->local_queryables = _zn_queryable_list_push(zn->local_queryables, qle);
+    _zn_rname_index_insert(&zn->local_queryables_index, qle->rname, qle);
 
-    z_mutex_unlock(&zn->mutex_inner);
+    z_rwlock_unlock(&zn->rwlock_queryables);
     return 0;
 }
 
+/**
+ * Release a reference on the queryable, freeing it once it is neither
+ * registered in the session nor being dispatched.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_refcount
+ */
+void __unsafe_zn_release_queryable(_zn_queryable_t *qle)
+{
+    qle->refcount--;
+    if (qle->refcount == 0)
+        _zn_queryable_elem_free((void **)&qle);
+    else if (qle->drained != NULL)
+        z_condvar_signal(qle->drained);
+}
+
 int _zn_trigger_queryables(zn_session_t *zn, const _zn_query_t *query)
 {
-    z_mutex_lock(&zn->mutex_inner);
+    _zn_dispatch_snapshot_t qles;
+    _zn_dispatch_snapshot_init(&qles);
 
-    z_str_t rname = __unsafe_zn_get_resource_name_from_key(zn, _ZN_RESOURCE_REMOTE, &query->key);
+    z_str_t rname = _zn_get_resource_name_from_key(zn, _ZN_RESOURCE_REMOTE, &query->key);
     if (rname == NULL)
-        goto ERR;
+        return -1;
+
+    z_rwlock_rdlock(&zn->rwlock_queryables);
+    _zn_queryable_list_t *xs = __unsafe_zn_get_queryables_by_name(zn, rname);
+
+    z_mutex_lock(&zn->mutex_refcount);
+    _zn_queryable_list_t *it = xs;
+    while (it != NULL)
+    {
+        _zn_queryable_t *qle = _zn_queryable_list_head(it);
+        if (((query->target.kind & ZN_QUERYABLE_ALL_KINDS) | (query->target.kind & qle->kind)) != 0)
+        {
+            qle->refcount++;
+            _zn_dispatch_snapshot_append(&qles, qle);
+        }
+
+        it = _zn_queryable_list_tail(it);
+    }
+    __unsafe_zn_dispatch_begin(zn, &qles);
+    z_mutex_unlock(&zn->mutex_refcount);
+
+    z_rwlock_unlock(&zn->rwlock_queryables);
+    _z_list_free(&xs, _zn_noop_free);
 
     // Build the query
     zn_query_t q;
@@ -133,19 +181,25 @@ int _zn_trigger_queryables(zn_session_t *zn, const _zn_query_t *query)
     q.rname = rname;
     q.predicate = query->predicate;
 
-    _zn_queryable_list_t *qles = __unsafe_zn_get_queryables_by_name(zn, rname);
-    _zn_queryable_list_t *xs = qles;
-    while (xs != NULL)
+    // The callbacks run without holding any lock, the snapshot keeps the queryables alive.
+    // The queryables undeclared by a previous callback have been removed from it.
+    for (size_t i = 0; i < qles.len; i++)
     {
-        _zn_queryable_t *qle = _zn_queryable_list_head(xs);
-        if (((query->target.kind & ZN_QUERYABLE_ALL_KINDS) | (query->target.kind & qle->kind)) != 0)
-        {
-            q.kind = qle->kind;
-            qle->callback(&q, qle->arg);
-        }
+        _zn_queryable_t *qle = (_zn_queryable_t *)qles.val[i];
+        if (qle == NULL)
+            continue;
+        q.kind = qle->kind;
+        qle->callback(&q, qle->arg);
+    }
 
-        xs = _zn_queryable_list_tail(xs);
+    z_mutex_lock(&zn->mutex_refcount);
+    __unsafe_zn_dispatch_end(zn, &qles);
+    for (size_t i = 0; i < qles.len; i++)
+    {
+        if (qles.val[i] != NULL)
+            __unsafe_zn_release_queryable((_zn_queryable_t *)qles.val[i]);
     }
+    z_mutex_unlock(&zn->mutex_refcount);
 
     // Send the final reply
     // Final flagged reply context does not encode the PID or replier kind
@@ -162,32 +216,45 @@ int _zn_trigger_queryables(zn_session_t *zn, const _zn_query_t *query)
     _zn_zenoh_message_t z_msg = _zn_z_msg_make_unit(can_be_dropped);
     z_msg.reply_context = rctx;
 
-    if (_zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK) != 0)
+    if (_zn_send_z_msg(zn, &z_msg, zn_reliability_t_RELIABLE, zn_congestion_control_t_BLOCK, ZN_PRIORITY_DEFAULT) != 0)
     {
         // @TODO: retransmission
     }
     _zn_z_msg_clear(&z_msg);
 
     _z_str_clear(rname);
-    _z_list_free(&qles, _zn_noop_free);
-    z_mutex_unlock(&zn->mutex_inner);
+    _zn_dispatch_snapshot_clear(&qles);
     return 0;
-
-ERR:
-    z_mutex_unlock(&zn->mutex_inner);
-    return -1;
 }
 
 void _zn_unregister_queryable(zn_session_t *zn, _zn_queryable_t *qle)
 {
-    z_mutex_lock(&zn->mutex_inner);
-    zn->local_queryables = _zn_queryable_list_drop_filter(zn->local_queryables, _zn_queryable_eq, qle);
-    z_mutex_unlock(&zn->mutex_inner);
+    z_rwlock_wrlock(&zn->rwlock_queryables);
+
+    // The queryable has already been unregistered
+    int is_registered = __unsafe_zn_get_queryable_by_id(zn, qle->id) == qle;
+    if (is_registered)
+    {
+        _zn_rname_index_remove(&zn->local_queryables_index, qle->rname, qle);
+        zn->local_queryables = _z_list_drop_filter(zn->local_queryables, _zn_noop_free, (z_element_eq_f)_zn_queryable_eq, qle);
+    }
+
+    z_rwlock_unlock(&zn->rwlock_queryables);
+
+    // The queryable is freed once the dispatches in progress are done with it
+    if (is_registered)
+    {
+        z_mutex_lock(&zn->mutex_refcount);
+        __unsafe_zn_wait_dispatches(zn, qle, &qle->refcount, &qle->drained);
+        __unsafe_zn_release_queryable(qle);
+        z_mutex_unlock(&zn->mutex_refcount);
+    }
 }
 
 void _zn_flush_queryables(zn_session_t *zn)
 {
-    z_mutex_lock(&zn->mutex_inner);
+    z_rwlock_wrlock(&zn->rwlock_queryables);
+    _zn_rname_index_clear(&zn->local_queryables_index);
     _zn_queryable_list_free(&zn->local_queryables);
-    z_mutex_unlock(&zn->mutex_inner);
+    z_rwlock_unlock(&zn->rwlock_queryables);
 }
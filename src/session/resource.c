@@ -23,6 +23,10 @@ int _zn_resource_eq(const _zn_resource_t *other, const _zn_resource_t *this)
 void _zn_resource_clear(_zn_resource_t *res)
 {
     _zn_reskey_clear(&res->key);
+    _z_str_clear(res->rname);
+    res->rname = NULL;
+    _z_vec_clear(&res->subs, _zn_noop_free);
+    res->is_subs_valid = 0;
 }
 
 /*------------------ Entity ------------------*/
@@ -37,22 +41,83 @@ z_zint_t _zn_get_resource_id(zn_session_t *zn)
 }
 
 /*------------------ Resource ------------------*/
-_zn_resource_t *__zn_get_resource_by_id(_zn_resource_list_t *xs, const z_zint_t id)
+size_t __zn_resource_key_hash(const zn_reskey_t *reskey)
 {
-    while (xs != NULL)
+    // FNV-1a over the RID and the suffix of the resource key
+    uint32_t hash = 2166136261u;
+
+    z_zint_t rid = reskey->rid;
+    for (size_t i = 0; i < sizeof(z_zint_t); i++)
     {
-        _zn_resource_t *r = _zn_resource_list_head(xs);
-        if (r->id == id)
-            return r;
+        hash ^= (uint8_t)(rid >> (8 * i));
+        hash *= 16777619u;
+    }
 
-        xs = _zn_resource_list_tail(xs);
+    if (reskey->rname != NULL)
+    {
+        for (const char *c = reskey->rname; *c != '\0'; c++)
+        {
+            hash ^= (uint8_t)*c;
+            hash *= 16777619u;
+        }
     }
 
-    return NULL;
+    return hash;
 }
 
-_zn_resource_t *__zn_get_resource_by_key(_zn_resource_list_t *xs, const zn_reskey_t *reskey)
+int __zn_resource_ptr_eq(const void *left, const void *right)
 {
+    return left == right;
+}
+
+void __zn_resource_key_index_entry_free(void **e)
+{
+    // The index does not own the resources, only the buckets
+    _z_int_void_map_entry_t *ptr = (_z_int_void_map_entry_t *)*e;
+    _z_list_t *xs = (_z_list_t *)ptr->val;
+    _z_list_free(&xs, _zn_noop_free);
+
+    z_free(ptr);
+    *e = NULL;
+}
+
+void __zn_resource_key_index_entry_drop(void **e)
+{
+    // The bucket is moved or already freed by the caller, only drop the entry
+    z_free(*e);
+    *e = NULL;
+}
+
+void __zn_resource_key_index_insert(_z_int_void_map_t *index, _zn_resource_t *res)
+{
+    size_t hash = __zn_resource_key_hash(&res->key);
+    _zn_resource_list_t *xs = (_zn_resource_list_t *)_z_int_void_map_get(index, hash);
+    xs = _zn_resource_list_push(xs, res);
+    _z_int_void_map_insert(index, hash, xs, __zn_resource_key_index_entry_drop);
+}
+
+void __zn_resource_key_index_remove(_z_int_void_map_t *index, _zn_resource_t *res)
+{
+    size_t hash = __zn_resource_key_hash(&res->key);
+    _zn_resource_list_t *xs = (_zn_resource_list_t *)_z_int_void_map_get(index, hash);
+    if (xs == NULL)
+        return;
+
+    xs = _z_list_drop_filter(xs, _zn_noop_free, __zn_resource_ptr_eq, res);
+    if (xs == NULL)
+        _z_int_void_map_remove(index, hash, __zn_resource_key_index_entry_drop);
+    else
+        _z_int_void_map_insert(index, hash, xs, __zn_resource_key_index_entry_drop);
+}
+
+_zn_resource_t *__zn_get_resource_by_id(_zn_resource_intmap_t *resources, const z_zint_t id)
+{
+    return _zn_resource_intmap_get(resources, id);
+}
+
+_zn_resource_t *__zn_get_resource_by_key(_z_int_void_map_t *index, const zn_reskey_t *reskey)
+{
+    _zn_resource_list_t *xs = (_zn_resource_list_t *)_z_int_void_map_get(index, __zn_resource_key_hash(reskey));
     while (xs != NULL)
     {
         _zn_resource_t *r = _zn_resource_list_head(xs);
@@ -65,155 +130,278 @@ _zn_resource_t *__zn_get_resource_by_key(_zn_resource_list_t *xs, const zn_reske
     return NULL;
 }
 
-z_str_t __zn_get_resource_name_from_key(_zn_resource_list_t *xs, const zn_reskey_t *reskey)
+z_str_t __zn_resource_expand_name(_zn_resource_intmap_t *resources, _zn_resource_t *res)
 {
-    // Need to build the complete resource name, by recursively look at RIDs
-    // Resource names are looked up from right to left
-    _z_str_list_t *strs = NULL;
-    size_t len = 0;
+    if (res->rname != NULL)
+        return res->rname;
 
-    // Append suffix as the right-most segment
-    if (reskey->rname != NULL)
+    // Resource names are resolved from left to right, memoizing every RID on the way
+    z_str_t prefix = NULL;
+    size_t p_len = 0;
+    if (res->key.rid != ZN_RESOURCE_ID_NONE)
     {
-        len += strlen(reskey->rname);
-        strs = _z_str_list_push(strs, reskey->rname);
+        _zn_resource_t *parent = __zn_get_resource_by_id(resources, res->key.rid);
+        if (parent == NULL)
+            return NULL;
+
+        prefix = __zn_resource_expand_name(resources, parent);
+        if (prefix == NULL)
+            return NULL;
+
+        p_len = strlen(prefix);
     }
 
-    // Recursevely go through all the RIDs
-    z_zint_t id = reskey->rid;
-    while (id != ZN_RESOURCE_ID_NONE)
+    size_t s_len = res->key.rname != NULL ? strlen(res->key.rname) : 0;
+    res->rname = (z_str_t)z_malloc(p_len + s_len + 1);
+    if (p_len > 0)
+        memcpy(res->rname, prefix, p_len);
+    if (s_len > 0)
+        memcpy(res->rname + p_len, res->key.rname, s_len);
+    res->rname[p_len + s_len] = '\0';
+
+    return res->rname;
+}
+
+void __zn_resource_intmap_for_each(_zn_resource_intmap_t *resources, void (*f)(_zn_resource_t *, void *), void *arg)
+{
+    if (resources->vals == NULL)
+        return;
+
+    for (size_t idx = 0; idx < resources->capacity; idx++)
     {
-        _zn_resource_t *res = __zn_get_resource_by_id(xs, id);
-        if (res == NULL)
-            goto ERR;
+        _z_list_t *xs = resources->vals[idx];
+        while (xs != NULL)
+        {
+            _zn_resource_intmap_entry_t *entry = (_zn_resource_intmap_entry_t *)_z_list_head(xs);
+            f((_zn_resource_t *)entry->val, arg);
+
+            xs = _z_list_tail(xs);
+        }
+    }
+}
+
+void __zn_resource_invalidate_subscriptions(_zn_resource_t *res, void *arg)
+{
+    (void)(arg);
+    _z_vec_reset(&res->subs, _zn_noop_free);
+    res->is_subs_valid = 0;
+}
+
+typedef struct
+{
+    _zn_resource_intmap_t *resources;
+    _zn_resource_list_t **pending;
+    z_zint_t rid;
+} __zn_resource_invalidate_arg_t;
 
-        if (res->key.rname != NULL)
+void __zn_resource_invalidate_if_prefixed(_zn_resource_t *res, void *arg)
+{
+    __zn_resource_invalidate_arg_t *ia = (__zn_resource_invalidate_arg_t *)arg;
+    if (res->rname == NULL) // Already waiting for one of its prefixes
+        return;
+
+    // Only the names whose key chain goes through the forgotten RID embed its prefix
+    const _zn_resource_t *r = res;
+    while (r != NULL && r->key.rid != ZN_RESOURCE_ID_NONE)
+    {
+        if (r->key.rid == ia->rid)
         {
-            len += strlen(res->key.rname);
-            strs = _z_str_list_push(strs, res->key.rname);
+            _z_str_free(&res->rname);
+            __zn_resource_invalidate_subscriptions(res, NULL);
+            *ia->pending = _zn_resource_list_push(*ia->pending, res);
+            return;
         }
+        r = __zn_get_resource_by_id(ia->resources, r->key.rid);
+    }
+}
 
-        id = res->key.rid;
+_zn_resource_list_t *__zn_resource_expand_pending(_zn_resource_intmap_t *resources, _zn_resource_list_t *pending)
+{
+    // Expand the resources that were waiting for a prefix, keep the others pending
+    _zn_resource_list_t *xs = pending;
+    while (xs != NULL)
+    {
+        _zn_resource_t *r = _zn_resource_list_head(xs);
+        xs = _zn_resource_list_tail(xs);
+        if (__zn_resource_expand_name(resources, r) != NULL)
+            pending = _z_list_drop_filter(pending, _zn_noop_free, __zn_resource_ptr_eq, r);
     }
 
-    // Concatenate all the partial resource names
-    z_str_t rname = (z_str_t)z_malloc(len + 1);
-    rname[0] = '\0'; // NULL terminator must be set (required to strcat)
+    return pending;
+}
 
-    _z_str_list_t *xstr = strs;
-    while (xstr != NULL)
+z_str_t __zn_get_resource_name_from_key(_zn_resource_intmap_t *resources, const zn_reskey_t *reskey)
+{
+    z_str_t prefix = NULL;
+    size_t p_len = 0;
+    if (reskey->rid != ZN_RESOURCE_ID_NONE)
     {
-        z_str_t s = _z_str_list_head(xstr);
-        strcat(rname, s);
-        xstr = _z_str_list_tail(xstr);
+        _zn_resource_t *res = __zn_get_resource_by_id(resources, reskey->rid);
+        if (res == NULL || res->rname == NULL)
+            return NULL;
+
+        prefix = res->rname;
+
+        p_len = strlen(prefix);
     }
 
-    _z_list_free(&strs, _zn_noop_free);
-    return rname;
+    // Concatenate the expanded prefix and the suffix
+    size_t s_len = reskey->rname != NULL ? strlen(reskey->rname) : 0;
+    z_str_t rname = (z_str_t)z_malloc(p_len + s_len + 1);
+    if (p_len > 0)
+        memcpy(rname, prefix, p_len);
+    if (s_len > 0)
+        memcpy(rname + p_len, reskey->rname, s_len);
+    rname[p_len + s_len] = '\0';
 
-ERR:
-    _z_list_free(&strs, _zn_noop_free);
-    return NULL;
+    return rname;
 }
 
 /**
  * This function is unsafe because it operates in potentially concurrent data.
  * Make sure that the following mutexes are locked before calling this function:
- *  - zn->mutex_inner
+ *  - zn->rwlock_resources (read)
  */
 _zn_resource_t *__unsafe_zn_get_resource_by_id(zn_session_t *zn, int is_local, z_zint_t id)
 {
-    _zn_resource_list_t *decls = is_local ? zn->local_resources : zn->remote_resources;
+    _zn_resource_intmap_t *decls = is_local ? &zn->local_resources : &zn->remote_resources;
     return __zn_get_resource_by_id(decls, id);
 }
 
 /**
  * This function is unsafe because it operates in potentially concurrent data.
  * Make sure that the following mutexes are locked before calling this function:
- *  - zn->mutex_inner
+ *  - zn->rwlock_resources (read)
  */
 _zn_resource_t *__unsafe_zn_get_resource_by_key(zn_session_t *zn, int is_local, const zn_reskey_t *reskey)
 {
-    _zn_resource_list_t *decls = is_local ? zn->local_resources : zn->remote_resources;
-    return __zn_get_resource_by_key(decls, reskey);
+    _z_int_void_map_t *index = is_local ? &zn->local_resources_by_key : &zn->remote_resources_by_key;
+    return __zn_get_resource_by_key(index, reskey);
 }
 
 /**
  * This function is unsafe because it operates in potentially concurrent data.
  * Make sure that the following mutexes are locked before calling this function:
- *  - zn->mutex_inner
+ *  - zn->rwlock_resources (read)
  */
 z_str_t __unsafe_zn_get_resource_name_from_key(zn_session_t *zn, int is_local, const zn_reskey_t *reskey)
 {
-    _zn_resource_list_t *decls = is_local ? zn->local_resources : zn->remote_resources;
+    _zn_resource_intmap_t *decls = is_local ? &zn->local_resources : &zn->remote_resources;
     return __zn_get_resource_name_from_key(decls, reskey);
 }
 
+/**
+ * Return the fully-expanded name of the resource with the given RID.
+ * The returned string is owned by the resource table and must not be freed.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->rwlock_resources (read)
+ */
+z_str_t __unsafe_zn_get_resource_expanded_name(zn_session_t *zn, int is_local, z_zint_t rid)
+{
+    _zn_resource_intmap_t *decls = is_local ? &zn->local_resources : &zn->remote_resources;
+    _zn_resource_t *res = __zn_get_resource_by_id(decls, rid);
+    if (res == NULL)
+        return NULL;
+
+    return res->rname;
+}
+
+/**
+ * Drop the memoized matching subscriptions of all the remote resources.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->rwlock_resources (write)
+ */
+void __unsafe_zn_invalidate_resource_subscriptions(zn_session_t *zn)
+{
+    __zn_resource_intmap_for_each(&zn->remote_resources, __zn_resource_invalidate_subscriptions, NULL);
+}
+
 _zn_resource_t *_zn_get_resource_by_id(zn_session_t *zn, int is_local, z_zint_t rid)
 {
-    z_mutex_lock(&zn->mutex_inner);
+    z_rwlock_rdlock(&zn->rwlock_resources);
     _zn_resource_t *res = __unsafe_zn_get_resource_by_id(zn, is_local, rid);
-    z_mutex_unlock(&zn->mutex_inner);
+    z_rwlock_unlock(&zn->rwlock_resources);
     return res;
 }
 
 _zn_resource_t *_zn_get_resource_by_key(zn_session_t *zn, int is_local, const zn_reskey_t *reskey)
 {
-    z_mutex_lock(&zn->mutex_inner);
+    z_rwlock_rdlock(&zn->rwlock_resources);
     _zn_resource_t *res = __unsafe_zn_get_resource_by_key(zn, is_local, reskey);
-    z_mutex_unlock(&zn->mutex_inner);
+    z_rwlock_unlock(&zn->rwlock_resources);
     return res;
 }
 
 z_str_t _zn_get_resource_name_from_key(zn_session_t *zn, int is_local, const zn_reskey_t *reskey)
 {
-    z_mutex_lock(&zn->mutex_inner);
+    z_rwlock_rdlock(&zn->rwlock_resources);
     z_str_t res = __unsafe_zn_get_resource_name_from_key(zn, is_local, reskey);
-    z_mutex_unlock(&zn->mutex_inner);
+    z_rwlock_unlock(&zn->rwlock_resources);
     return res;
 }
 
 int _zn_register_resource(zn_session_t *zn, int is_local, _zn_resource_t *res)
 {
     _Z_DEBUG(">>> Allocating res decl for (%zu,%lu,%s)\n", res->id, res->key.rid, res->key.rname);
-    z_mutex_lock(&zn->mutex_inner);
+    z_rwlock_wrlock(&zn->rwlock_resources);
 
     _zn_resource_t *r = __unsafe_zn_get_resource_by_id(zn, is_local, res->id);
     if (r != NULL) // Inconsistent declarations have been found
         goto ERR;
 
-    // Register the resource
-    if (is_local)
-        zn->local_resources = _zn_resource_list_push(zn->local_resources, res);
-    else
-        zn->remote_resources = _zn_resource_list_push(zn->remote_resources, res);
+    // Register the resource, names are expanded here so that lookups never update the table
+    _zn_resource_intmap_t *decls = is_local ? &zn->local_resources : &zn->remote_resources;
+    _zn_resource_list_t **pending = is_local ? &zn->local_resources_pending : &zn->remote_resources_pending;
+    _zn_resource_intmap_insert(decls, res->id, res);
+    __zn_resource_key_index_insert(is_local ? &zn->local_resources_by_key : &zn->remote_resources_by_key, res);
+
+    // Only the new resource and the ones waiting for its RID as a prefix need to be expanded
+    if (__zn_resource_expand_name(decls, res) == NULL)
+        *pending = _zn_resource_list_push(*pending, res);
+    else if (*pending != NULL)
+        *pending = __zn_resource_expand_pending(decls, *pending);
 
-    z_mutex_unlock(&zn->mutex_inner);
+    z_rwlock_unlock(&zn->rwlock_resources);
     return 0;
 
 ERR:
-    z_mutex_unlock(&zn->mutex_inner);
+    z_rwlock_unlock(&zn->rwlock_resources);
     return -1;
 }
 
 void _zn_unregister_resource(zn_session_t *zn, int is_local, _zn_resource_t *res)
 {
-    z_mutex_lock(&zn->mutex_inner);
+    z_rwlock_wrlock(&zn->rwlock_resources);
 
-    if (is_local)
-        zn->local_resources = _zn_resource_list_drop_filter(zn->local_resources, _zn_resource_eq, res);
-    else
-        zn->remote_resources = _zn_resource_list_drop_filter(zn->remote_resources, _zn_resource_eq, res);
+    // The key index must be updated before the resource is freed
+    _zn_resource_intmap_t *decls = is_local ? &zn->local_resources : &zn->remote_resources;
+    _zn_resource_list_t **pending = is_local ? &zn->local_resources_pending : &zn->remote_resources_pending;
+    __zn_resource_key_index_remove(is_local ? &zn->local_resources_by_key : &zn->remote_resources_by_key, res);
+    *pending = _z_list_drop_filter(*pending, _zn_noop_free, __zn_resource_ptr_eq, res);
+    z_zint_t rid = res->id;
+    _zn_resource_intmap_remove(decls, rid);
+
+    // The resources prefixed by the forgotten RID wait for it to be declared again
+    __zn_resource_invalidate_arg_t arg = {decls, pending, rid};
+    __zn_resource_intmap_for_each(decls, __zn_resource_invalidate_if_prefixed, &arg);
 
-    z_mutex_unlock(&zn->mutex_inner);
+    z_rwlock_unlock(&zn->rwlock_resources);
 }
 
 void _zn_flush_resources(zn_session_t *zn)
 {
-    z_mutex_lock(&zn->mutex_inner);
+    z_rwlock_wrlock(&zn->rwlock_resources);
 
-    _zn_resource_list_free(&zn->local_resources);
-    _zn_resource_list_free(&zn->remote_resources);
+    _z_int_void_map_clear(&zn->local_resources_by_key, __zn_resource_key_index_entry_free);
+    _z_int_void_map_clear(&zn->remote_resources_by_key, __zn_resource_key_index_entry_free);
+    _z_list_free(&zn->local_resources_pending, _zn_noop_free);
+    _z_list_free(&zn->remote_resources_pending, _zn_noop_free);
+    _zn_resource_intmap_clear(&zn->local_resources);
+    _zn_resource_intmap_clear(&zn->remote_resources);
 
-    z_mutex_unlock(&zn->mutex_inner);
+    z_rwlock_unlock(&zn->rwlock_resources);
 }
@@ -18,6 +18,7 @@
 #include "zenoh-pico/session/queryable.h"
 #include "zenoh-pico/session/resource.h"
 #include "zenoh-pico/session/subscription.h"
+#include "zenoh-pico/session/workers.h"
 #include "zenoh-pico/utils/logging.h"
 
 /*------------------ Handle message ------------------*/
@@ -30,6 +31,8 @@ int _zn_handle_zenoh_message(zn_session_t *zn, _zn_zenoh_message_t *msg)
         _Z_INFO("Received _ZN_MID_DATA message %d\n", msg->header);
         if (msg->reply_context) // This is some data from a query
             _zn_trigger_query_reply_partial(zn, msg->reply_context, msg->body.data.key, msg->body.data.payload, msg->body.data.info);
+        else if (zn->rx_workers.len > 0) // This is pure data, dispatched by the workers
+            _zn_rx_workers_push(zn, &msg->body.data.key, &msg->body.data.payload);
         else // This is pure data
             _zn_trigger_subscriptions(zn, msg->body.data.key, msg->body.data.payload);
 
@@ -56,6 +59,9 @@ int _zn_handle_zenoh_message(zn_session_t *zn, _zn_zenoh_message_t *msg)
                 r->id = id;
                 r->key.rid = key.rid;
                 r->key.rname = _z_str_clone(key.rname);
+                r->rname = NULL;
+                r->subs = _z_vec_make(0);
+                r->is_subs_valid = 0;
 
                 int res = _zn_register_resource(zn, _ZN_RESOURCE_REMOTE, r);
                 if (res != 0)
@@ -93,6 +99,7 @@ int _zn_handle_zenoh_message(zn_session_t *zn, _zn_zenoh_message_t *msg)
                 rs->info = decl.body.sub.subinfo;
                 rs->callback = NULL;
                 rs->arg = NULL;
+                rs->arg_drop = NULL;
                 _zn_register_subscription(zn, _ZN_RESOURCE_REMOTE, rs);
 
                 _z_list_free(&subs, _zn_noop_free);
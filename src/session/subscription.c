@@ -12,9 +12,11 @@
 //   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
 //
 
+#include <string.h>
 #include "zenoh-pico/protocol/utils.h"
 #include "zenoh-pico/session/subscription.h"
 #include "zenoh-pico/session/resource.h"
+#include "zenoh-pico/session/utils.h"
 #include "zenoh-pico/utils/logging.h"
 
 int _zn_subscriber_eq(const _zn_subscriber_t *other, const _zn_subscriber_t *this)
@@ -28,6 +30,124 @@ void _zn_subscriber_clear(_zn_subscriber_t *sub)
     _zn_reskey_clear(&sub->key);
     if (sub->info.period)
         z_free(sub->info.period);
+    if (sub->arg_drop)
+        sub->arg_drop(sub->arg);
+}
+
+/*------------------ Sample ring ------------------*/
+#define _ZN_SAMPLE_RING_SLOT_SIZE (ZN_RING_SUBSCRIBER_MAX_KEY_LEN + 1 + ZN_RING_SUBSCRIBER_MAX_PAYLOAD_LEN)
+
+_zn_sample_ring_t *_zn_sample_ring_make(size_t capacity, zn_ring_policy_t policy)
+{
+    _zn_sample_ring_t *ring = (_zn_sample_ring_t *)z_malloc(sizeof(_zn_sample_ring_t));
+    ring->queue = z_mqueue_make(capacity);
+    ring->free = z_mqueue_make(capacity + 1);
+    ring->slots = (zn_sample_t *)z_malloc((capacity + 1) * sizeof(zn_sample_t));
+    ring->storage = (uint8_t *)z_malloc((capacity + 1) * _ZN_SAMPLE_RING_SLOT_SIZE);
+    ring->held = NULL;
+    ring->policy = policy;
+
+    for (size_t i = 0; i <= capacity; i++)
+    {
+        zn_sample_t *s = &ring->slots[i];
+        uint8_t *storage = &ring->storage[i * _ZN_SAMPLE_RING_SLOT_SIZE];
+        s->key.val = (z_str_t)storage;
+        s->key.len = 0;
+        s->value.val = storage + ZN_RING_SUBSCRIBER_MAX_KEY_LEN + 1;
+        s->value.len = 0;
+        s->value.is_alloc = 0;
+        z_mqueue_push(ring->free, s);
+    }
+
+    return ring;
+}
+
+void _zn_sample_ring_close(_zn_sample_ring_t *ring)
+{
+    // Release the dispatches waiting for room in the ring, no more sample is queued
+    z_mqueue_close(ring->queue);
+    z_mqueue_close(ring->free);
+}
+
+void _zn_sample_ring_free(void *arg)
+{
+    _zn_sample_ring_t *ring = (_zn_sample_ring_t *)arg;
+
+    // The samples that have not been received are dropped along with their slots
+    z_mqueue_free(&ring->queue);
+    z_mqueue_free(&ring->free);
+    z_free(ring->slots);
+    z_free(ring->storage);
+    z_free(ring);
+}
+
+void _zn_sample_ring_handler(const zn_sample_t *sample, const void *arg)
+{
+    _zn_sample_ring_t *ring = (_zn_sample_ring_t *)arg;
+
+    if (sample->key.len > ZN_RING_SUBSCRIBER_MAX_KEY_LEN || sample->value.len > ZN_RING_SUBSCRIBER_MAX_PAYLOAD_LEN)
+    {
+        _Z_INFO("Dropping sample because it does not fit in a ring slot\n");
+        return;
+    }
+
+    zn_sample_t *s = NULL;
+    if (ring->policy == zn_ring_policy_t_BLOCK)
+    {
+        // Wait for the application to release a slot
+        s = (zn_sample_t *)z_mqueue_pull(ring->free);
+    }
+    else
+    {
+        // Reuse the slot of the oldest sample if none is free
+        s = (zn_sample_t *)z_mqueue_try_pull(ring->free);
+        if (s == NULL)
+            s = (zn_sample_t *)z_mqueue_try_pull(ring->queue);
+    }
+
+    // The ring is closed, or its slots are all being filled by other dispatches
+    if (s == NULL)
+        return;
+
+    // The sample only lives for the duration of the callback, it is copied into the slot
+    memcpy(s->key.val, sample->key.val, sample->key.len);
+    s->key.val[sample->key.len] = '\0';
+    s->key.len = sample->key.len;
+    memcpy((uint8_t *)s->value.val, sample->value.val, sample->value.len);
+    s->value.len = sample->value.len;
+
+    zn_sample_t *left = NULL;
+    if (ring->policy == zn_ring_policy_t_BLOCK)
+    {
+        if (z_mqueue_push(ring->queue, s) != 0)
+            left = s;
+    }
+    else
+    {
+        left = (zn_sample_t *)z_mqueue_push_force(ring->queue, s);
+    }
+
+    // Give the slot of the dropped sample back
+    if (left != NULL)
+        z_mqueue_push(ring->free, left);
+}
+
+int _zn_sample_ring_recv(_zn_sample_ring_t *ring, zn_sample_t *sample, int is_blocking)
+{
+    // The sample loaned by the previous call is released
+    if (ring->held != NULL)
+    {
+        z_mqueue_push(ring->free, ring->held);
+        ring->held = NULL;
+    }
+
+    zn_sample_t *s = (zn_sample_t *)(is_blocking ? z_mqueue_pull(ring->queue) : z_mqueue_try_pull(ring->queue));
+    if (s == NULL)
+        return -1;
+
+    ring->held = s;
+    *sample = *s;
+    return 0;
 }
 
 /*------------------ Pull ------------------*/
@@ -69,7 +189,7 @@ _zn_subscriber_list_t *__zn_get_subscriptions_by_name(_zn_subscriber_list_t *sub
 /**
  * This function is unsafe because it operates in potentially concurrent data.
  * Make sure that the following mutexes are locked before calling this function:
- *  - zn->mutex_inner
+ *  - zn->rwlock_subscriptions (read)
  */
 _zn_subscriber_t *__unsafe_zn_get_subscription_by_id(zn_session_t *zn, int is_local, const z_zint_t id)
 {
@@ -80,37 +200,67 @@ _zn_subscriber_t *__unsafe_zn_get_subscription_by_id(zn_session_t *zn, int is_lo
 /**
  * This function is unsafe because it operates in potentially concurrent data.
  * Make sure that the following mutexes are locked before calling this function:
- *  - zn->mutex_inner
+ *  - zn->rwlock_subscriptions (read)
  */
 _zn_subscriber_list_t *__unsafe_zn_get_subscriptions_by_name(zn_session_t *zn, int is_local, const z_str_t rname)
 {
+    // Concrete resource names are matched against all local subscriptions at once
+    if (is_local && _zn_rname_index_can_match(rname))
+        return _zn_rname_index_match(&zn->local_subscriptions_index, rname);
+
     _zn_subscriber_list_t *subs = is_local ? zn->local_subscriptions : zn->remote_subscriptions;
     return __zn_get_subscriptions_by_name(subs, rname);
 }
 
+/**
+ * Memoize in the remote resource the local subscriptions matching its name,
+ * until the local subscriptions or the remote resources change.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->rwlock_resources (write)
+ *  - zn->rwlock_subscriptions (read)
+ */
+void __unsafe_zn_memoize_resource_subscriptions(zn_session_t *zn, _zn_resource_t *res)
+{
+    if (res->is_subs_valid || res->rname == NULL)
+        return;
+
+    _zn_subscriber_list_t *subs = __unsafe_zn_get_subscriptions_by_name(zn, _ZN_RESOURCE_IS_LOCAL, res->rname);
+    _zn_subscriber_list_t *xs = subs;
+    while (xs != NULL)
+    {
+        _z_vec_append(&res->subs, _zn_subscriber_list_head(xs));
+        xs = _zn_subscriber_list_tail(xs);
+    }
+    _z_list_free(&subs, _zn_noop_free);
+
+    res->is_subs_valid = 1;
+}
+
 _zn_subscriber_t *_zn_get_subscription_by_id(zn_session_t *zn, int is_local, const z_zint_t id)
 {
-    z_mutex_lock(&zn->mutex_inner);
+    z_rwlock_rdlock(&zn->rwlock_subscriptions);
     _zn_subscriber_t *sub = __unsafe_zn_get_subscription_by_id(zn, is_local, id);
-    z_mutex_unlock(&zn->mutex_inner);
+    z_rwlock_unlock(&zn->rwlock_subscriptions);
     return sub;
 }
 
 _zn_subscriber_list_t *_zn_get_subscriptions_by_name(zn_session_t *zn, int is_local, const z_str_t rname)
 {
-    z_mutex_lock(&zn->mutex_inner);
+    z_rwlock_rdlock(&zn->rwlock_subscriptions);
     _zn_subscriber_list_t *subs = __unsafe_zn_get_subscriptions_by_name(zn, is_local, rname);
-    z_mutex_unlock(&zn->mutex_inner);
+    z_rwlock_unlock(&zn->rwlock_subscriptions);
     return subs;
 }
 
 _zn_subscriber_list_t *_zn_get_subscription_by_key(zn_session_t *zn, int is_local, const zn_reskey_t *reskey)
 {
-    z_mutex_lock(&zn->mutex_inner);
-    z_str_t rname = __unsafe_zn_get_resource_name_from_key(zn, is_local, reskey);
-    _zn_subscriber_list_t *subs = __unsafe_zn_get_subscriptions_by_name(zn, is_local, rname);
-    z_mutex_unlock(&zn->mutex_inner);
+    z_str_t rname = _zn_get_resource_name_from_key(zn, is_local, reskey);
+    if (rname == NULL)
+        return NULL;
 
+    _zn_subscriber_list_t *subs = _zn_get_subscriptions_by_name(zn, is_local, rname);
     _z_str_clear(rname);
     return subs;
 }
@@ -118,78 +268,208 @@ _zn_subscriber_list_t *_zn_get_subscription_by_key(zn_session_t *zn, int is_loca
 int _zn_register_subscription(zn_session_t *zn, int is_local, _zn_subscriber_t *sub)
 {
     _Z_DEBUG(">>> Allocating sub decl for (%s)\n", sub->rname);
-    z_mutex_lock(&zn->mutex_inner);
+    // Local subscriptions invalidate the matches memoized in the remote resources
+    if (is_local)
+        z_rwlock_wrlock(&zn->rwlock_resources);
+    z_rwlock_wrlock(&zn->rwlock_subscriptions);
 
     _zn_subscriber_list_t *subs = __unsafe_zn_get_subscriptions_by_name(zn, is_local, sub->rname);
     if (subs != NULL) // A subscription for this name already exists
+    {
+        _z_list_free(&subs, _zn_noop_free);
         goto ERR;
+    }
 
-    // Register the subscription
+    // Register the subscription, the session holds the first reference
+    sub->refcount = 1;
+    sub->drained = NULL;
     if (is_local)
+    {
         zn->local_subscriptions = _zn_subscriber_list_push(zn->local_subscriptions, sub);
+        _zn_rname_index_insert(&zn->local_subscriptions_index, sub->rname, sub);
+        __unsafe_zn_invalidate_resource_subscriptions(zn);
+    }
     else
         zn->remote_subscriptions = _zn_subscriber_list_push(zn->remote_subscriptions, sub);
 
-    z_mutex_unlock(&zn->mutex_inner);
+    z_rwlock_unlock(&zn->rwlock_subscriptions);
+    if (is_local)
+        z_rwlock_unlock(&zn->rwlock_resources);
     return 0;
 
 ERR:
-    z_mutex_unlock(&zn->mutex_inner);
+    z_rwlock_unlock(&zn->rwlock_subscriptions);
+    if (is_local)
+        z_rwlock_unlock(&zn->rwlock_resources);
     return -1;
 }
 
+/**
+ * Release a reference on the subscription, freeing it once it is neither
+ * registered in the session nor being dispatched.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_refcount
+ */
+void __unsafe_zn_release_subscription(_zn_subscriber_t *sub)
+{
+    sub->refcount--;
+    if (sub->refcount == 0)
+        _zn_subscriber_elem_free((void **)&sub);
+    else if (sub->drained != NULL)
+        z_condvar_signal(sub->drained);
+}
+
 int _zn_trigger_subscriptions(zn_session_t *zn, const zn_reskey_t reskey, const z_bytes_t payload)
 {
-    z_mutex_lock(&zn->mutex_inner);
+    _zn_dispatch_snapshot_t subs;
+    _zn_dispatch_snapshot_init(&subs);
+    char key_buf[_ZN_DISPATCH_KEY_LEN];
+    z_str_t key = NULL;
 
-    z_str_t rname = __unsafe_zn_get_resource_name_from_key(zn, _ZN_RESOURCE_REMOTE, &reskey);
-    if (rname == NULL)
-        goto ERR;
+    // Keys made of a RID only use the resource name and the memoized matches
+    if (reskey.rname == NULL && reskey.rid != ZN_RESOURCE_ID_NONE)
+    {
+        z_rwlock_rdlock(&zn->rwlock_resources);
+
+        _zn_resource_t *res = __unsafe_zn_get_resource_by_id(zn, _ZN_RESOURCE_REMOTE, reskey.rid);
+        if (res != NULL && !res->is_subs_valid)
+        {
+            // Memoizing the matches updates the resource, it is done once under the write lock
+            z_rwlock_unlock(&zn->rwlock_resources);
+            z_rwlock_wrlock(&zn->rwlock_resources);
+            res = __unsafe_zn_get_resource_by_id(zn, _ZN_RESOURCE_REMOTE, reskey.rid);
+            if (res != NULL)
+            {
+                z_rwlock_rdlock(&zn->rwlock_subscriptions);
+                __unsafe_zn_memoize_resource_subscriptions(zn, res);
+                z_rwlock_unlock(&zn->rwlock_subscriptions);
+            }
+        }
+
+        if (res == NULL || res->rname == NULL)
+        {
+            z_rwlock_unlock(&zn->rwlock_resources);
+            return -1;
+        }
+
+        // The resource may be undeclared once the lock is released, copy its name
+        size_t len = strlen(res->rname);
+        key = len < _ZN_DISPATCH_KEY_LEN ? key_buf : (z_str_t)z_malloc(len + 1);
+        memcpy(key, res->rname, len + 1);
+
+        // The memoized subscriptions stay registered as long as the resources are locked
+        z_mutex_lock(&zn->mutex_refcount);
+        for (size_t i = 0; i < _z_vec_len(&res->subs); i++)
+        {
+            _zn_subscriber_t *sub = (_zn_subscriber_t *)_z_vec_get(&res->subs, i);
+            sub->refcount++;
+            _zn_dispatch_snapshot_append(&subs, sub);
+        }
+        __unsafe_zn_dispatch_begin(zn, &subs);
+        z_mutex_unlock(&zn->mutex_refcount);
+
+        z_rwlock_unlock(&zn->rwlock_resources);
+    }
+    else
+    {
+        key = _zn_get_resource_name_from_key(zn, _ZN_RESOURCE_REMOTE, &reskey);
+        if (key == NULL)
+            return -1;
+
+        z_rwlock_rdlock(&zn->rwlock_subscriptions);
+        _zn_subscriber_list_t *xs = __unsafe_zn_get_subscriptions_by_name(zn, _ZN_RESOURCE_IS_LOCAL, key);
+
+        z_mutex_lock(&zn->mutex_refcount);
+        _zn_subscriber_list_t *it = xs;
+        while (it != NULL)
+        {
+            _zn_subscriber_t *sub = _zn_subscriber_list_head(it);
+            sub->refcount++;
+            _zn_dispatch_snapshot_append(&subs, sub);
+            it = _zn_subscriber_list_tail(it);
+        }
+        __unsafe_zn_dispatch_begin(zn, &subs);
+        z_mutex_unlock(&zn->mutex_refcount);
+
+        z_rwlock_unlock(&zn->rwlock_subscriptions);
+        _z_list_free(&xs, _zn_noop_free);
+    }
 
     // Build the sample
     zn_sample_t s;
-    s.key.val = rname;
-    s.key.len = strlen(s.key.val);
+    s.key.val = key;
+    s.key.len = strlen(key);
     s.value = payload;
 
-    _zn_subscriber_list_t *subs = __unsafe_zn_get_subscriptions_by_name(zn, _ZN_RESOURCE_IS_LOCAL, rname);
-    _zn_subscriber_list_t *xs = subs;
-    while (xs != NULL)
+    // The callbacks run without holding any lock, the snapshot keeps the subscriptions alive.
+    // The subscriptions undeclared by a previous callback have been removed from it.
+    for (size_t i = 0; i < subs.len; i++)
     {
-        _zn_subscriber_t *sub = _zn_subscriber_list_head(xs);
-        sub->callback(&s, sub->arg);
-        xs = _zn_subscriber_list_tail(xs);
+        _zn_subscriber_t *sub = (_zn_subscriber_t *)subs.val[i];
+        if (sub != NULL)
+            sub->callback(&s, sub->arg);
     }
 
-    _z_str_clear(rname);
-    _z_list_free(&subs, _zn_noop_free);
-    z_mutex_unlock(&zn->mutex_inner);
-    return 0;
+    z_mutex_lock(&zn->mutex_refcount);
+    __unsafe_zn_dispatch_end(zn, &subs);
+    for (size_t i = 0; i < subs.len; i++)
+    {
+        if (subs.val[i] != NULL)
+            __unsafe_zn_release_subscription((_zn_subscriber_t *)subs.val[i]);
+    }
+    z_mutex_unlock(&zn->mutex_refcount);
 
-ERR:
-    _z_str_clear(rname);
-    z_mutex_unlock(&zn->mutex_inner);
-    return -1;
+    if (key != key_buf)
+        _z_str_clear(key);
+    _zn_dispatch_snapshot_clear(&subs);
+    return 0;
 }
 
 void _zn_unregister_subscription(zn_session_t *zn, int is_local, _zn_subscriber_t *sub)
 {
-    z_mutex_lock(&zn->mutex_inner);
+    // Local subscriptions invalidate the matches memoized in the remote resources
+    if (is_local)
+        z_rwlock_wrlock(&zn->rwlock_resources);
+    z_rwlock_wrlock(&zn->rwlock_subscriptions);
 
+    // The subscription has already been unregistered
+    int is_registered = __unsafe_zn_get_subscription_by_id(zn, is_local, sub->id) == sub;
+    if (is_registered && is_local)
+    {
+        // Drop the memoized matches before the subscription is released
+        __unsafe_zn_invalidate_resource_subscriptions(zn);
+        _zn_rname_index_remove(&zn->local_subscriptions_index, sub->rname, sub);
+        zn->local_subscriptions = _z_list_drop_filter(zn->local_subscriptions, _zn_noop_free, (z_element_eq_f)_zn_subscriber_eq, sub);
+    }
+    else if (is_registered)
+        zn->remote_subscriptions = _z_list_drop_filter(zn->remote_subscriptions, _zn_noop_free, (z_element_eq_f)_zn_subscriber_eq, sub);
+
+    z_rwlock_unlock(&zn->rwlock_subscriptions);
     if (is_local)
-        zn->local_subscriptions = _zn_subscriber_list_drop_filter(zn->local_subscriptions, _zn_subscriber_eq, sub);
-    else
-        zn->remote_subscriptions = _zn_subscriber_list_drop_filter(zn->remote_subscriptions, _zn_subscriber_eq, sub);
+        z_rwlock_unlock(&zn->rwlock_resources);
 
-    z_mutex_unlock(&zn->mutex_inner);
+    // The subscription is freed once the dispatches in progress are done with it
+    if (is_registered)
+    {
+        z_mutex_lock(&zn->mutex_refcount);
+        __unsafe_zn_wait_dispatches(zn, sub, &sub->refcount, &sub->drained);
+        __unsafe_zn_release_subscription(sub);
+        z_mutex_unlock(&zn->mutex_refcount);
+    }
 }
 
 void _zn_flush_subscriptions(zn_session_t *zn)
 {
-    z_mutex_lock(&zn->mutex_inner);
+    z_rwlock_wrlock(&zn->rwlock_resources);
+    z_rwlock_wrlock(&zn->rwlock_subscriptions);
 
+    __unsafe_zn_invalidate_resource_subscriptions(zn);
+    _zn_rname_index_clear(&zn->local_subscriptions_index);
     _zn_subscriber_list_free(&zn->local_subscriptions);
     _zn_subscriber_list_free(&zn->remote_subscriptions);
 
-    z_mutex_unlock(&zn->mutex_inner);
+    z_rwlock_unlock(&zn->rwlock_subscriptions);
+    z_rwlock_unlock(&zn->rwlock_resources);
 }
@@ -12,17 +12,71 @@
 //   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
 //
 
+#include "zenoh-pico/session/utils.h"
+#include "zenoh-pico/session/workers.h"
 #include "zenoh-pico/transport/link/tx.h"
 #include "zenoh-pico/utils/logging.h"
 
-int _zn_send_z_msg(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl)
+int _zn_send_z_msg(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl, zn_priority_t priority)
+{
+    // Hand the message over to the TX writer task, if any
+    if (zn->tx_queue.capacity > 0)
+        return _zn_tx_queue_push(zn, z_msg, reliability, cong_ctrl, priority);
+
+    return __zn_send_z_msg(zn, z_msg, reliability, cong_ctrl, priority);
+}
+
+int __zn_send_z_msg(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl, zn_priority_t priority)
 {
     _Z_DEBUG(">> send zenoh message\n");
 
     if (zn->tp->type == _ZN_TRANSPORT_UNICAST_TYPE)
-        return _zn_unicast_send_z_msg(zn, z_msg, reliability, cong_ctrl);
+        return _zn_unicast_send_z_msg(zn, z_msg, reliability, cong_ctrl, priority);
+    else if (zn->tp->type == _ZN_TRANSPORT_MULTICAST_TYPE)
+        return _zn_multicast_send_z_msg(zn, z_msg, reliability, cong_ctrl, priority);
+    else
+        return -1;
+}
+
+uint8_t *_zn_loan_z_msg(zn_session_t *zn, const _zn_zenoh_message_t *z_msg, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl, zn_priority_t priority)
+{
+    _Z_DEBUG(">> loan zenoh message\n");
+
+    // A loaned message would overtake the ones waiting in the TX queue
+    if (zn->tx_queue.capacity > 0)
+    {
+        _Z_INFO("Unable to loan a zenoh message while the TX queue is enabled\n");
+        return NULL;
+    }
+
+    if (zn->tp->type == _ZN_TRANSPORT_UNICAST_TYPE)
+        return _zn_unicast_loan_z_msg(zn, z_msg, reliability, cong_ctrl, priority);
+    else if (zn->tp->type == _ZN_TRANSPORT_MULTICAST_TYPE)
+        return _zn_multicast_loan_z_msg(zn, z_msg, reliability, cong_ctrl, priority);
+    else
+        return NULL;
+}
+
+int _zn_commit_z_msg(zn_session_t *zn)
+{
+    _Z_DEBUG(">> commit zenoh message\n");
+
+    if (zn->tp->type == _ZN_TRANSPORT_UNICAST_TYPE)
+        return _zn_unicast_commit_z_msg(zn);
+    else if (zn->tp->type == _ZN_TRANSPORT_MULTICAST_TYPE)
+        return _zn_multicast_commit_z_msg(zn);
+    else
+        return -1;
+}
+
+int _zn_abort_z_msg(zn_session_t *zn)
+{
+    _Z_DEBUG(">> abort zenoh message\n");
+
+    if (zn->tp->type == _ZN_TRANSPORT_UNICAST_TYPE)
+        return _zn_unicast_abort_z_msg(zn);
     else if (zn->tp->type == _ZN_TRANSPORT_MULTICAST_TYPE)
-        return _zn_multicast_send_z_msg(zn, z_msg, reliability, cong_ctrl);
+        return _zn_multicast_abort_z_msg(zn);
     else
         return -1;
 }
@@ -12,10 +12,13 @@
 //   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
 //
 
+#include <string.h>
 #include "zenoh-pico/session/resource.h"
 #include "zenoh-pico/session/subscription.h"
 #include "zenoh-pico/session/queryable.h"
 #include "zenoh-pico/session/query.h"
+#include "zenoh-pico/session/utils.h"
+#include "zenoh-pico/session/workers.h"
 
 /*------------------ clone helpers ------------------*/
 zn_reskey_t _zn_reskey_duplicate(const zn_reskey_t *reskey)
@@ -52,19 +55,35 @@ zn_session_t *_zn_session_init(void)
     zn->pull_id = 1;
 
     // Initialize the data structs
-    zn->local_resources = NULL;
-    zn->remote_resources = NULL;
+    _zn_resource_intmap_init(&zn->local_resources);
+    _zn_resource_intmap_init(&zn->remote_resources);
+    _z_int_void_map_init(&zn->local_resources_by_key, _Z_DEFAULT_INT_MAP_CAPACITY);
+    _z_int_void_map_init(&zn->remote_resources_by_key, _Z_DEFAULT_INT_MAP_CAPACITY);
+    zn->local_resources_pending = NULL;
+    zn->remote_resources_pending = NULL;
     zn->local_subscriptions = NULL;
     zn->remote_subscriptions = NULL;
     zn->local_queryables = NULL;
+    _zn_rname_index_init(&zn->local_subscriptions_index);
+    _zn_rname_index_init(&zn->local_queryables_index);
     zn->pending_queries = NULL;
+    zn->rx_workers.workers = NULL;
+    zn->rx_workers.len = 0;
+    zn->tx_queue.entries = NULL;
+    zn->tx_queue.capacity = 0;
+    zn->tx_queue.is_running = 0;
+    zn->dispatches = NULL;
 
     // Associate a transport with the session
     zn->tp = NULL;
     zn->tp_manager = _zn_transport_manager_init();
 
     // Initialize the mutexes
-    z_mutex_init(&zn->mutex_inner);
+    z_rwlock_init(&zn->rwlock_resources);
+    z_rwlock_init(&zn->rwlock_subscriptions);
+    z_rwlock_init(&zn->rwlock_queryables);
+    z_mutex_init(&zn->mutex_queries);
+    z_mutex_init(&zn->mutex_refcount);
 
     return zn;
 }
@@ -73,10 +92,17 @@ void _zn_session_free(zn_session_t **zn)
 {
     zn_session_t *ptr = *zn;
 
+    // Dispatch the pending samples while the transport is still there,
+    // the samples still received until the read task stops are dropped
+    _zn_rx_workers_stop(ptr);
+    _zn_tx_queue_stop(ptr);
+
     // Clean up transports and manager
     _zn_transport_manager_free(&ptr->tp_manager);
     if (ptr->tp != NULL)
         _zn_transport_free(&ptr->tp);
+    _zn_rx_workers_clear(ptr);
+    _zn_tx_queue_clear(ptr);
 
     // Clean up the entities
     _zn_flush_resources(ptr);
@@ -85,7 +111,11 @@ void _zn_session_free(zn_session_t **zn)
     _zn_flush_pending_queries(ptr);
 
     // Clean up the mutexes
-    z_mutex_free(&ptr->mutex_inner);
+    z_rwlock_free(&ptr->rwlock_resources);
+    z_rwlock_free(&ptr->rwlock_subscriptions);
+    z_rwlock_free(&ptr->rwlock_queryables);
+    z_mutex_free(&ptr->mutex_queries);
+    z_mutex_free(&ptr->mutex_refcount);
 
     z_free(ptr);
     *zn = NULL;
@@ -93,6 +123,9 @@ void _zn_session_free(zn_session_t **zn)
 
 int _zn_session_close(zn_session_t *zn, uint8_t reason)
 {
+    // Send the queued messages before closing the transport
+    _zn_tx_queue_stop(zn);
+
     int res = _zn_transport_close(zn->tp, reason);
 
     // Free the session
@@ -100,3 +133,123 @@ int _zn_session_close(zn_session_t *zn, uint8_t reason)
 
     return res;
 }
+
+/*------------------ Dispatch ------------------*/
+void _zn_dispatch_snapshot_init(_zn_dispatch_snapshot_t *ds)
+{
+    ds->val = ds->stack;
+    ds->len = 0;
+    ds->capacity = _ZN_DISPATCH_SNAPSHOT_LEN;
+}
+
+void _zn_dispatch_snapshot_append(_zn_dispatch_snapshot_t *ds, void *e)
+{
+    if (ds->len == ds->capacity)
+    {
+        // Move to the heap once the stack storage is full
+        size_t capacity = ds->capacity * 2;
+        void **val = (void **)z_malloc(capacity * sizeof(void *));
+        memcpy(val, ds->val, ds->len * sizeof(void *));
+        if (ds->val != ds->stack)
+            z_free(ds->val);
+
+        ds->val = val;
+        ds->capacity = capacity;
+    }
+
+    ds->val[ds->len] = e;
+    ds->len++;
+}
+
+void _zn_dispatch_snapshot_clear(_zn_dispatch_snapshot_t *ds)
+{
+    if (ds->val != ds->stack)
+        z_free(ds->val);
+    _zn_dispatch_snapshot_init(ds);
+}
+
+/**
+ * Register a dispatch in progress on the calling task.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_refcount
+ */
+void __unsafe_zn_dispatch_begin(zn_session_t *zn, _zn_dispatch_snapshot_t *ds)
+{
+    ds->task = z_task_self();
+    ds->next = zn->dispatches;
+    zn->dispatches = ds;
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_refcount
+ */
+void __unsafe_zn_dispatch_end(zn_session_t *zn, _zn_dispatch_snapshot_t *ds)
+{
+    _zn_dispatch_snapshot_t **it = &zn->dispatches;
+    while (*it != ds)
+        it = &(*it)->next;
+    *it = ds->next;
+}
+
+/**
+ * Remove a subscription or a queryable from the dispatches in progress on the
+ * calling task, such that they do not invoke its callback anymore. The caller
+ * gets the ownership of the references held by these dispatches.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_refcount
+ *
+ * Returns:
+ *     The number of references dropped by the dispatches.
+ */
+size_t __unsafe_zn_dispatch_drop(zn_session_t *zn, const void *e)
+{
+    z_task_t self = z_task_self();
+    size_t dropped = 0;
+    for (_zn_dispatch_snapshot_t *ds = zn->dispatches; ds != NULL; ds = ds->next)
+    {
+        if (!z_task_eq(&ds->task, &self))
+            continue;
+
+        for (size_t i = 0; i < ds->len; i++)
+        {
+            if (ds->val[i] == e)
+            {
+                ds->val[i] = NULL;
+                dropped++;
+            }
+        }
+    }
+
+    return dropped;
+}
+
+/**
+ * Wait for the dispatches in progress on the other tasks to release a subscription
+ * or a queryable that is not registered anymore. The ones in progress on the calling
+ * task are done with it right away, it may be unregistered from its own callback.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->mutex_refcount
+ */
+void __unsafe_zn_wait_dispatches(zn_session_t *zn, const void *e, size_t *refcount, z_condvar_t **drained)
+{
+    // The session reference is released by the caller
+    *refcount -= __unsafe_zn_dispatch_drop(zn, e);
+    if (*refcount == 1)
+        return;
+
+    z_condvar_t cv;
+    z_condvar_init(&cv);
+    *drained = &cv;
+    while (*refcount > 1)
+        z_condvar_wait(&cv, &zn->mutex_refcount);
+    *drained = NULL;
+    z_condvar_free(&cv);
+}
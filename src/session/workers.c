@@ -0,0 +1,516 @@
+//
+// Copyright (c) 2022 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+#include <string.h>
+#include "zenoh-pico/config.h"
+#include "zenoh-pico/session/resource.h"
+#include "zenoh-pico/session/subscription.h"
+#include "zenoh-pico/session/utils.h"
+#include "zenoh-pico/session/workers.h"
+#include "zenoh-pico/transport/link/tx.h"
+#include "zenoh-pico/utils/logging.h"
+
+// The slots are one more than the queue length for the sample being dispatched
+#define _ZN_RX_WORKER_SLOTS (ZN_RX_WORKER_QUEUE_LEN + 1)
+
+void __zn_rx_sample_release(_zn_rx_sample_t *s)
+{
+    // Only what did not fit in the storage of the slot has been allocated
+    if (s->key.rname != (z_str_t)s->storage)
+        z_free(s->key.rname);
+    s->key.rname = NULL;
+    _z_bytes_clear(&s->payload);
+}
+
+void *_zn_rx_worker_task(void *arg)
+{
+    _zn_rx_worker_t *w = (_zn_rx_worker_t *)arg;
+
+    // The queue is drained before the worker stops
+    _zn_rx_sample_t *s = (_zn_rx_sample_t *)z_mqueue_pull(w->queue);
+    while (s != NULL)
+    {
+        _zn_trigger_subscriptions((zn_session_t *)w->zn, s->key, s->payload);
+
+        __zn_rx_sample_release(s);
+        z_mqueue_push(w->free, s);
+        s = (_zn_rx_sample_t *)z_mqueue_pull(w->queue);
+    }
+
+    return NULL;
+}
+
+int __zn_rx_worker_init(_zn_rx_worker_t *w, zn_session_t *zn)
+{
+    w->zn = zn;
+    w->queue = z_mqueue_make(ZN_RX_WORKER_QUEUE_LEN);
+    w->free = z_mqueue_make(_ZN_RX_WORKER_SLOTS);
+    w->slots = (_zn_rx_sample_t *)z_malloc(_ZN_RX_WORKER_SLOTS * sizeof(_zn_rx_sample_t));
+    w->storage = (uint8_t *)z_malloc(_ZN_RX_WORKER_SLOTS * ZN_RX_WORKER_SLOT_SIZE);
+    for (size_t i = 0; i < _ZN_RX_WORKER_SLOTS; i++)
+    {
+        _zn_rx_sample_t *s = &w->slots[i];
+        s->key.rid = ZN_RESOURCE_ID_NONE;
+        s->key.rname = NULL;
+        _z_bytes_reset(&s->payload);
+        s->storage = &w->storage[i * ZN_RX_WORKER_SLOT_SIZE];
+        z_mqueue_push(w->free, s);
+    }
+
+    return z_task_init(&w->task, NULL, _zn_rx_worker_task, w);
+}
+
+void __zn_rx_worker_clear(_zn_rx_worker_t *w)
+{
+    z_mqueue_free(&w->queue);
+    z_mqueue_free(&w->free);
+    z_free(w->slots);
+    z_free(w->storage);
+}
+
+int _zn_rx_workers_start(zn_session_t *zn, size_t len)
+{
+    _zn_rx_workers_t *ws = &zn->rx_workers;
+    ws->workers = (_zn_rx_worker_t *)z_malloc(len * sizeof(_zn_rx_worker_t));
+    ws->len = 0;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        _zn_rx_worker_t *w = &ws->workers[i];
+        if (__zn_rx_worker_init(w, zn) != 0)
+        {
+            __zn_rx_worker_clear(w);
+            goto ERR;
+        }
+
+        ws->len++;
+    }
+
+    return 0;
+
+ERR:
+    _Z_ERROR("Unable to start the RX workers\n");
+    _zn_rx_workers_stop(zn);
+    _zn_rx_workers_clear(zn);
+    return -1;
+}
+
+void _zn_rx_workers_stop(zn_session_t *zn)
+{
+    // Pending samples are still dispatched, new ones are dropped
+    _zn_rx_workers_t *ws = &zn->rx_workers;
+    for (size_t i = 0; i < ws->len; i++)
+    {
+        z_mqueue_close(ws->workers[i].queue);
+        z_mqueue_close(ws->workers[i].free);
+    }
+
+    for (size_t i = 0; i < ws->len; i++)
+        z_task_join(&ws->workers[i].task);
+}
+
+void _zn_rx_workers_clear(zn_session_t *zn)
+{
+    _zn_rx_workers_t *ws = &zn->rx_workers;
+    for (size_t i = 0; i < ws->len; i++)
+        __zn_rx_worker_clear(&ws->workers[i]);
+
+    z_free(ws->workers);
+    ws->workers = NULL;
+    ws->len = 0;
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - zn->rwlock_resources (read)
+ */
+z_str_t __unsafe_zn_rx_key_prefix(zn_session_t *zn, const zn_reskey_t *reskey)
+{
+    if (reskey->rid == ZN_RESOURCE_ID_NONE)
+        return "";
+
+    return __unsafe_zn_get_resource_expanded_name(zn, _ZN_RESOURCE_REMOTE, reskey->rid);
+}
+
+size_t __zn_rx_name_hash(const char *prefix, const char *suffix)
+{
+    // FNV-1a over the fully-expanded resource name
+    uint32_t hash = 2166136261u;
+    for (const char *c = prefix; *c != '\0'; c++)
+    {
+        hash ^= (uint8_t)*c;
+        hash *= 16777619u;
+    }
+    for (const char *c = suffix; c != NULL && *c != '\0'; c++)
+    {
+        hash ^= (uint8_t)*c;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+void __zn_rx_sample_set_key(_zn_rx_sample_t *s, const char *prefix, const char *suffix)
+{
+    size_t p_len = strlen(prefix);
+    size_t s_len = suffix != NULL ? strlen(suffix) : 0;
+    size_t len = p_len + s_len + 1;
+
+    s->key.rname = len <= ZN_RX_WORKER_SLOT_SIZE ? (z_str_t)s->storage : (z_str_t)z_malloc(len);
+    memcpy(s->key.rname, prefix, p_len);
+    if (s_len > 0)
+        memcpy(s->key.rname + p_len, suffix, s_len);
+    s->key.rname[p_len + s_len] = '\0';
+}
+
+void __zn_rx_sample_set_payload(_zn_rx_sample_t *s, const z_bytes_t *payload)
+{
+    // The payload follows the resource name if it is stored in the slot as well
+    size_t used = s->key.rname == (z_str_t)s->storage ? strlen(s->key.rname) + 1 : 0;
+    if (payload->len <= ZN_RX_WORKER_SLOT_SIZE - used)
+    {
+        memcpy(s->storage + used, payload->val, payload->len);
+        s->payload = _z_bytes_wrap(s->storage + used, payload->len);
+    }
+    else
+        _z_bytes_copy(&s->payload, payload);
+}
+
+int _zn_rx_workers_push(zn_session_t *zn, const zn_reskey_t *reskey, const z_bytes_t *payload)
+{
+    _zn_rx_workers_t *ws = &zn->rx_workers;
+
+    // Declarations are handled by the read task, the key is resolved before they can change it.
+    // Data for the same resource name is dispatched in order by a single worker,
+    // whatever the form of the key it has been received with
+    z_rwlock_rdlock(&zn->rwlock_resources);
+    z_str_t prefix = __unsafe_zn_rx_key_prefix(zn, reskey);
+    size_t hash = prefix != NULL ? __zn_rx_name_hash(prefix, reskey->rname) : 0;
+    z_rwlock_unlock(&zn->rwlock_resources);
+    if (prefix == NULL)
+        return -1;
+
+    // Wait for a free slot without holding the lock, the worker may need it to dispatch a sample
+    _zn_rx_worker_t *w = &ws->workers[hash % ws->len];
+    _zn_rx_sample_t *s = (_zn_rx_sample_t *)z_mqueue_pull(w->free);
+    if (s == NULL)
+        return -1;
+
+    // The received buffers are reused once the message is handled, the sample is copied
+    // into the slot and only what does not fit in it is allocated
+    z_rwlock_rdlock(&zn->rwlock_resources);
+    prefix = __unsafe_zn_rx_key_prefix(zn, reskey);
+    if (prefix != NULL)
+        __zn_rx_sample_set_key(s, prefix, reskey->rname);
+    z_rwlock_unlock(&zn->rwlock_resources);
+    if (prefix == NULL)
+    {
+        z_mqueue_push(w->free, s);
+        return -1;
+    }
+    __zn_rx_sample_set_payload(s, payload);
+
+    if (z_mqueue_push(w->queue, s) != 0)
+    {
+        __zn_rx_sample_release(s);
+        z_mqueue_push(w->free, s);
+        return -1;
+    }
+
+    return 0;
+}
+
+/*------------------ TX queue ------------------*/
+int __zn_tx_entry_is_async(const _zn_zenoh_message_t *z_msg)
+{
+    // Only the data written by the publishers is sent asynchronously, the other
+    // messages are sent before returning such that they are not reordered
+    return _ZN_MID(z_msg->header) == _ZN_MID_DATA && z_msg->reply_context == NULL && z_msg->attachment == NULL;
+}
+
+_zn_zenoh_message_t *__zn_z_msg_data_duplicate(const _zn_zenoh_message_t *z_msg)
+{
+    // The message is written from the stack of the publisher, the data is copied
+    _zn_zenoh_message_t *dup = (_zn_zenoh_message_t *)z_malloc(sizeof(_zn_zenoh_message_t));
+    dup->header = z_msg->header;
+    dup->attachment = NULL;
+    dup->reply_context = NULL;
+    dup->body.data.key = _zn_reskey_duplicate(&z_msg->body.data.key);
+    _z_bytes_copy(&dup->body.data.payload, &z_msg->body.data.payload);
+
+    const _zn_data_info_t *info = &z_msg->body.data.info;
+    _zn_data_info_t *dup_info = &dup->body.data.info;
+    *dup_info = *info;
+    if (_ZN_HAS_FLAG(info->flags, _ZN_DATA_INFO_ENC))
+        dup_info->encoding.suffix = _z_str_clone(info->encoding.suffix);
+    if (_ZN_HAS_FLAG(info->flags, _ZN_DATA_INFO_TSTAMP))
+        _z_bytes_copy(&dup_info->tstamp.id, &info->tstamp.id);
+    if (_ZN_HAS_FLAG(info->flags, _ZN_DATA_INFO_SRC_ID))
+        _z_bytes_copy(&dup_info->source_id, &info->source_id);
+    if (_ZN_HAS_FLAG(info->flags, _ZN_DATA_INFO_RTR_ID))
+        _z_bytes_copy(&dup_info->first_router_id, &info->first_router_id);
+
+    return dup;
+}
+
+void __zn_tx_entry_free(_zn_tx_entry_t **entry)
+{
+    _zn_tx_entry_t *ptr = *entry;
+    _zn_z_msg_clear(ptr->z_msg);
+    z_free(ptr->z_msg);
+    z_free(ptr);
+    *entry = NULL;
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - q->mutex
+ */
+int __unsafe_zn_tx_queue_evict_oldest(_zn_tx_queue_t *q)
+{
+    for (size_t i = 0; i < q->len; i++)
+    {
+        _zn_tx_entry_t *e = q->entries[(q->head + i) % q->capacity];
+        if (e->done != NULL || e->cong_ctrl != zn_congestion_control_t_DROP)
+            continue;
+
+        // Close the gap left in the ring
+        for (size_t j = i; j + 1 < q->len; j++)
+            q->entries[(q->head + j) % q->capacity] = q->entries[(q->head + j + 1) % q->capacity];
+        q->len--;
+
+        __zn_tx_entry_free(&e);
+        return 0;
+    }
+
+    return -1;
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - q->mutex
+ */
+int __unsafe_zn_tx_queue_wait_room(_zn_tx_queue_t *q, int is_droppable)
+{
+    z_clock_t start = z_clock_now();
+    while (q->len == q->capacity && q->is_closed == 0)
+    {
+        if (is_droppable == 0)
+        {
+            z_condvar_wait(&q->can_push, &q->mutex);
+            continue;
+        }
+
+        if (q->policy == _ZN_TX_QUEUE_POLICY_DROP_OLDEST)
+        {
+            // Make room for the newest data, unless none of the queued messages can be dropped
+            if (__unsafe_zn_tx_queue_evict_oldest(q) == 0)
+                q->dropped++;
+            break;
+        }
+        else if (q->policy == _ZN_TX_QUEUE_POLICY_BLOCK)
+        {
+            // Wait for the writer to pull a message, up to the timeout overall
+            z_zint_t elapsed = z_clock_elapsed_ms(&start);
+            if (elapsed >= q->timeout)
+                break;
+            z_condvar_timedwait(&q->can_push, &q->mutex, (unsigned int)(q->timeout - elapsed));
+        }
+        else
+            break;
+    }
+
+    if (q->is_closed)
+    {
+        // Wake up the next writer waiting for room, if any
+        z_condvar_signal(&q->can_push);
+        return -1;
+    }
+
+    return q->len == q->capacity ? -1 : 0;
+}
+
+void *_zn_tx_queue_task(void *arg)
+{
+    _zn_tx_queue_t *q = (_zn_tx_queue_t *)arg;
+    zn_session_t *zn = (zn_session_t *)q->zn;
+
+    // The queue is drained before the writer stops
+    z_mutex_lock(&q->mutex);
+    while (1)
+    {
+        while (q->len == 0 && q->is_closed == 0)
+            z_condvar_wait(&q->can_pull, &q->mutex);
+        if (q->len == 0)
+            break;
+
+        _zn_tx_entry_t *e = q->entries[q->head];
+        q->head = (q->head + 1) % q->capacity;
+        q->len--;
+        z_condvar_signal(&q->can_push);
+        z_mutex_unlock(&q->mutex);
+
+        int res = __zn_send_z_msg(zn, e->z_msg, e->reliability, e->cong_ctrl, e->priority);
+
+        z_mutex_lock(&q->mutex);
+        if (e->done != NULL)
+        {
+            e->res = res;
+            e->is_done = 1;
+            z_condvar_signal(e->done);
+        }
+        else
+            __zn_tx_entry_free(&e);
+
+        // Push out the batch once there is nothing left to batch it with
+        if (q->len == 0)
+        {
+            z_mutex_unlock(&q->mutex);
+            _zn_flush(zn->tp);
+            z_mutex_lock(&q->mutex);
+        }
+    }
+    z_mutex_unlock(&q->mutex);
+
+    return NULL;
+}
+
+int _zn_tx_queue_start(zn_session_t *zn, size_t capacity, _zn_tx_queue_policy_t policy, z_zint_t timeout)
+{
+    _zn_tx_queue_t *q = &zn->tx_queue;
+    q->zn = zn;
+    q->entries = (_zn_tx_entry_t **)z_malloc(capacity * sizeof(_zn_tx_entry_t *));
+    q->capacity = capacity;
+    q->head = 0;
+    q->len = 0;
+    q->policy = policy;
+    q->timeout = timeout;
+    q->queued = 0;
+    q->dropped = 0;
+    q->is_closed = 0;
+    z_mutex_init(&q->mutex);
+    z_condvar_init(&q->can_push);
+    z_condvar_init(&q->can_pull);
+
+    if (z_task_init(&q->task, NULL, _zn_tx_queue_task, q) != 0)
+    {
+        _Z_ERROR("Unable to start the TX writer\n");
+        _zn_tx_queue_clear(zn);
+        return -1;
+    }
+    q->is_running = 1;
+
+    return 0;
+}
+
+void _zn_tx_queue_stop(zn_session_t *zn)
+{
+    // Pending messages are still sent, new ones are refused
+    _zn_tx_queue_t *q = &zn->tx_queue;
+    if (q->is_running == 0)
+        return;
+
+    z_mutex_lock(&q->mutex);
+    q->is_closed = 1;
+    z_condvar_signal(&q->can_pull);
+    z_condvar_signal(&q->can_push);
+    z_mutex_unlock(&q->mutex);
+
+    z_task_join(&q->task);
+    q->is_running = 0;
+}
+
+void _zn_tx_queue_clear(zn_session_t *zn)
+{
+    _zn_tx_queue_t *q = &zn->tx_queue;
+    if (q->entries == NULL)
+        return;
+
+    z_condvar_free(&q->can_pull);
+    z_condvar_free(&q->can_push);
+    z_mutex_free(&q->mutex);
+
+    z_free(q->entries);
+    q->entries = NULL;
+    q->capacity = 0;
+}
+
+int _zn_tx_queue_push(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl, zn_priority_t priority)
+{
+    _zn_tx_queue_t *q = &zn->tx_queue;
+
+    // The writer waits for its synchronous messages to be sent, they stay on its stack
+    _zn_tx_entry_t sync_entry;
+    z_condvar_t done;
+    _zn_tx_entry_t *e = &sync_entry;
+    int is_async = __zn_tx_entry_is_async(z_msg);
+    if (is_async)
+    {
+        e = (_zn_tx_entry_t *)z_malloc(sizeof(_zn_tx_entry_t));
+        e->z_msg = __zn_z_msg_data_duplicate(z_msg);
+        e->done = NULL;
+    }
+    else
+    {
+        z_condvar_init(&done);
+        e->z_msg = z_msg;
+        e->done = &done;
+        e->is_done = 0;
+        e->res = -1;
+    }
+    e->reliability = reliability;
+    e->cong_ctrl = cong_ctrl;
+    e->priority = priority;
+
+    int res = 0;
+    z_mutex_lock(&q->mutex);
+    if (__unsafe_zn_tx_queue_wait_room(q, is_async && cong_ctrl == zn_congestion_control_t_DROP) != 0)
+    {
+        if (q->is_closed)
+        {
+            res = -1;
+        }
+        else
+        {
+            _Z_INFO("Dropping zenoh message because the TX queue is full\n");
+            q->dropped++;
+        }
+
+        if (is_async)
+            __zn_tx_entry_free(&e);
+        goto EXIT_TX_QUEUE_PUSH;
+    }
+
+    q->entries[(q->head + q->len) % q->capacity] = e;
+    q->len++;
+    q->queued++;
+    z_condvar_signal(&q->can_pull);
+
+    if (is_async == 0)
+    {
+        while (e->is_done == 0)
+            z_condvar_wait(&done, &q->mutex);
+        res = e->res;
+    }
+
+EXIT_TX_QUEUE_PUSH:
+    z_mutex_unlock(&q->mutex);
+    if (is_async == 0)
+        z_condvar_free(&done);
+
+    return res;
+}
@@ -20,6 +20,7 @@
 extern "C"
 {
 #include "zenoh-pico/config.h"
+#include "zenoh-pico/link/endpoint.h"
 #include "zenoh-pico/system/platform.h"
 #include "zenoh-pico/utils/logging.h"
 #include "zenoh-pico/collections/string.h"
@@ -100,7 +101,7 @@ size_t _zn_read_exact_tcp(void *sock_arg, uint8_t *ptr, size_t len)
             return rb;
 
         n -= rb;
-        ptr = ptr + (len - n);
+        ptr = ptr + rb;
     } while (n > 0);
 
     return len;
@@ -208,7 +209,7 @@ size_t _zn_read_exact_udp_unicast(void *sock_arg, uint8_t *ptr, size_t len)
             return rb;
 
         n -= rb;
-        ptr = ptr + (len - n);
+        ptr = ptr + rb;
     } while (n > 0);
 
     return len;
@@ -273,7 +274,7 @@ void _zn_close_udp_multicast(void *sockrecv_arg, void *socksend_arg, void *arg)
     }
 }
 
-size_t _zn_read_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *laddr_arg, z_bytes_t *addr)
+size_t _zn_read_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *laddr_arg, _zn_link_addr_t *addr)
 {
     WiFiUDP *sock = (WiFiUDP *)sock_arg;
 
@@ -297,20 +298,19 @@ size_t _zn_read_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *la
         IPAddress rip = sock->remoteIP();
         uint16_t rport = sock->remotePort();
 
-        *addr = _z_bytes_make(strlen((const char*)&rip[0]) + strlen((const char*)&rip[1]) + strlen((const char*)&rip[2]) + strlen((const char*)&rip[3]) + sizeof(uint16_t));
-        int offset = 0;
+        _zn_link_addr_reset(addr);
         for (int i = 0; i < 4; i++)
         {
-            memcpy((uint8_t *)addr->val + offset, &rip[i], strlen((const char*)&rip[i]));
-            offset += strlen((const char*)&rip[i]);
+            uint8_t b = rip[i];
+            _zn_link_addr_append(addr, &b, sizeof(uint8_t));
         }
-        memcpy((uint8_t *)addr->val + offset, &rport, sizeof(uint16_t));
+        _zn_link_addr_append(addr, &rport, sizeof(uint16_t));
     }
 
     return psize;
 }
 
-size_t _zn_read_exact_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *laddr_arg, z_bytes_t *addr)
+size_t _zn_read_exact_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *laddr_arg, _zn_link_addr_t *addr)
 {
     size_t n = len;
     size_t rb = 0;
@@ -322,7 +322,7 @@ size_t _zn_read_exact_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, vo
             return rb;
 
         n -= rb;
-        ptr = ptr + (len - n);
+        ptr = ptr + rb;
     } while (n > 0);
 
     return len;
@@ -92,6 +92,16 @@ void z_task_free(z_task_t **task)
     *task = NULL;
 }
 
+z_task_t z_task_self(void)
+{
+    return NULL;
+}
+
+int z_task_eq(const z_task_t *left, const z_task_t *right)
+{
+    return *left == *right;
+}
+
 /*------------------ Mutex ------------------*/
 int z_mutex_init(z_mutex_t *m)
 {
@@ -118,6 +128,32 @@ int z_mutex_unlock(z_mutex_t *m)
     return 0;
 }
 
+/*------------------ RWLock ------------------*/
+int z_rwlock_init(z_rwlock_t *rw)
+{
+    return 0;
+}
+
+int z_rwlock_free(z_rwlock_t *rw)
+{
+    return 0;
+}
+
+int z_rwlock_rdlock(z_rwlock_t *rw)
+{
+    return 0;
+}
+
+int z_rwlock_wrlock(z_rwlock_t *rw)
+{
+    return 0;
+}
+
+int z_rwlock_unlock(z_rwlock_t *rw)
+{
+    return 0;
+}
+
 /*------------------ Condvar ------------------*/
 int z_condvar_init(z_condvar_t *cv)
 {
@@ -139,6 +175,11 @@ int z_condvar_wait(z_condvar_t *cv, z_mutex_t *m)
     return 0;
 }
 
+int z_condvar_timedwait(z_condvar_t *cv, z_mutex_t *m, unsigned int time)
+{
+    return 0;
+}
+
 /*------------------ Sleep ------------------*/
 int z_sleep_us(unsigned int time)
 {
@@ -16,6 +16,7 @@
 #include <string.h>
 
 #include "zenoh-pico/config.h"
+#include "zenoh-pico/link/endpoint.h"
 #include "zenoh-pico/system/platform.h"
 #include "zenoh-pico/utils/logging.h"
 #include "zenoh-pico/collections/string.h"
@@ -138,7 +139,7 @@ size_t _zn_read_exact_tcp(void *sock_arg, uint8_t *ptr, size_t len)
             return rb;
 
         n -= rb;
-        ptr = ptr + (len - n);
+        ptr = ptr + rb;
     } while (n > 0);
 
     return len;
@@ -246,7 +247,7 @@ size_t _zn_read_exact_udp_unicast(void *sock_arg, uint8_t *ptr, size_t len)
             return rb;
 
         n -= rb;
-        ptr = ptr + (len - n);
+        ptr = ptr + rb;
     } while (n > 0);
 
     return len;
@@ -475,7 +476,7 @@ void _zn_close_udp_multicast(void *sockrecv_arg, void *socksend_arg, void *raddr
     }
 }
 
-size_t _zn_read_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *arg, z_bytes_t *addr)
+size_t _zn_read_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *arg, _zn_link_addr_t *addr)
 {
     __zn_net_socket *sock = (__zn_net_socket *)sock_arg;
     struct addrinfo *laddr = (struct addrinfo *)arg;
@@ -500,9 +501,9 @@ size_t _zn_read_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *ar
                 // If addr is not NULL, it means that the raddr was requested by the upper-layers
                 if (addr != NULL)
                 {
-                    *addr = _z_bytes_make(sizeof(in_addr_t) + sizeof(in_port_t));
-                    memcpy((void *)addr->val, &b->sin_addr.s_addr, sizeof(in_addr_t));
-                    memcpy((void *)(addr->val + sizeof(in_addr_t)), &b->sin_port, sizeof(in_port_t));
+                    _zn_link_addr_reset(addr);
+                    _zn_link_addr_append(addr, &b->sin_addr.s_addr, sizeof(in_addr_t));
+                    _zn_link_addr_append(addr, &b->sin_port, sizeof(in_port_t));
                 }
                 break;
             }
@@ -516,9 +517,9 @@ size_t _zn_read_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *ar
                 // If addr is not NULL, it means that the raddr was requested by the upper-layers
                 if (addr != NULL)
                 {
-                    *addr = _z_bytes_make(sizeof(struct in6_addr) + sizeof(in_port_t));
-                    memcpy((void *)addr->val, &b->sin6_addr.s6_addr, sizeof(struct in6_addr));
-                    memcpy((void *)(addr->val + sizeof(struct in6_addr)), &b->sin6_port, sizeof(in_port_t));
+                    _zn_link_addr_reset(addr);
+                    _zn_link_addr_append(addr, &b->sin6_addr.s6_addr, sizeof(struct in6_addr));
+                    _zn_link_addr_append(addr, &b->sin6_port, sizeof(in_port_t));
                 }
                 break;
             }
@@ -528,7 +529,7 @@ size_t _zn_read_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *ar
     return rb;
 }
 
-size_t _zn_read_exact_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *arg, z_bytes_t *addr)
+size_t _zn_read_exact_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *arg, _zn_link_addr_t *addr)
 {
     size_t n = len;
     size_t rb = 0;
@@ -540,7 +541,7 @@ size_t _zn_read_exact_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, vo
             return rb;
 
         n -= rb;
-        ptr = ptr + (len - n);
+        ptr = ptr + rb;
     } while (n > 0);
 
     return len;
@@ -110,6 +110,16 @@ void z_task_free(z_task_t **task)
     *task = NULL;
 }
 
+z_task_t z_task_self(void)
+{
+    return xTaskGetCurrentTaskHandle();
+}
+
+int z_task_eq(const z_task_t *left, const z_task_t *right)
+{
+    return *left == *right;
+}
+
 /*------------------ Mutex ------------------*/
 int z_mutex_init(z_mutex_t *m)
 {
@@ -136,6 +146,32 @@ int z_mutex_unlock(z_mutex_t *m)
     return pthread_mutex_unlock(m);
 }
 
+/*------------------ RWLock ------------------*/
+int z_rwlock_init(z_rwlock_t *rw)
+{
+    return pthread_mutex_init(rw, NULL);
+}
+
+int z_rwlock_free(z_rwlock_t *rw)
+{
+    return pthread_mutex_destroy(rw);
+}
+
+int z_rwlock_rdlock(z_rwlock_t *rw)
+{
+    return pthread_mutex_lock(rw);
+}
+
+int z_rwlock_wrlock(z_rwlock_t *rw)
+{
+    return pthread_mutex_lock(rw);
+}
+
+int z_rwlock_unlock(z_rwlock_t *rw)
+{
+    return pthread_mutex_unlock(rw);
+}
+
 /*------------------ Condvar ------------------*/
 int z_condvar_init(z_condvar_t *cv)
 {
@@ -157,6 +193,21 @@ int z_condvar_wait(z_condvar_t *cv, z_mutex_t *m)
     return pthread_cond_wait(cv, m);
 }
 
+int z_condvar_timedwait(z_condvar_t *cv, z_mutex_t *m, unsigned int time)
+{
+    struct timespec abstime;
+    clock_gettime(CLOCK_REALTIME, &abstime);
+    abstime.tv_sec += time / 1000;
+    abstime.tv_nsec += (long)(time % 1000) * 1000000;
+    if (abstime.tv_nsec >= 1000000000)
+    {
+        abstime.tv_sec++;
+        abstime.tv_nsec -= 1000000000;
+    }
+
+    return pthread_cond_timedwait(cv, m, &abstime);
+}
+
 /*------------------ Sleep ------------------*/
 int z_sleep_us(unsigned int time)
 {
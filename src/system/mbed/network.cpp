@@ -20,6 +20,7 @@ extern "C"
 #include <string.h>
 
 #include "zenoh-pico/config.h"
+#include "zenoh-pico/link/endpoint.h"
 #include "zenoh-pico/system/platform.h"
 #include "zenoh-pico/utils/logging.h"
 #include "zenoh-pico/collections/string.h"
@@ -97,7 +98,7 @@ size_t _zn_read_exact_tcp(void *sock_arg, uint8_t *ptr, size_t len)
             return rb;
 
         n -= rb;
-        ptr = ptr + (len - n);
+        ptr = ptr + rb;
     } while (n > 0);
 
     return len;
@@ -183,7 +184,7 @@ size_t _zn_read_exact_udp_unicast(void *sock_arg, uint8_t *ptr, size_t len)
             return rb;
 
         n -= rb;
-        ptr = ptr + (len - n);
+        ptr = ptr + rb;
     } while (n > 0);
 
     return len;
@@ -266,7 +267,7 @@ void _zn_close_udp_multicast(void *sockrecv_arg, void *socksend_arg, void *raddr
     }
 }
 
-size_t _zn_read_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *laddr_arg, z_bytes_t *addr)
+size_t _zn_read_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *laddr_arg, _zn_link_addr_t *addr)
 {
     UDPSocket *sock = (UDPSocket *)sock_arg;
     SocketAddress raddr;
@@ -280,18 +281,18 @@ size_t _zn_read_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *la
 
         if (raddr.get_ip_version() == NSAPI_IPv4)
         {
-            *addr = _z_bytes_make(NSAPI_IPv4_BYTES + sizeof(uint16_t));
-            memcpy((void *)addr->val, raddr.get_ip_bytes(), NSAPI_IPv4_BYTES);
+            _zn_link_addr_reset(addr);
+            _zn_link_addr_append(addr, raddr.get_ip_bytes(), NSAPI_IPv4_BYTES);
             uint16_t port = raddr.get_port();
-            memcpy((void *)(addr->val + NSAPI_IPv4_BYTES), &port, sizeof(uint16_t));
+            _zn_link_addr_append(addr, &port, sizeof(uint16_t));
             break;
         }
         else if (raddr.get_ip_version() == NSAPI_IPv6)
         {
-            *addr = _z_bytes_make(NSAPI_IPv6_BYTES + sizeof(uint16_t));
-            memcpy((void *)addr->val, raddr.get_ip_bytes(), NSAPI_IPv6_BYTES);
+            _zn_link_addr_reset(addr);
+            _zn_link_addr_append(addr, raddr.get_ip_bytes(), NSAPI_IPv6_BYTES);
             uint16_t port = raddr.get_port();
-            memcpy((void *)(addr->val + NSAPI_IPv6_BYTES), &port, sizeof(uint16_t));
+            _zn_link_addr_append(addr, &port, sizeof(uint16_t));
             break;
         }
     } while (1);
@@ -299,7 +300,7 @@ size_t _zn_read_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *la
     return rb;
 }
 
-size_t _zn_read_exact_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *arg, z_bytes_t *addr)
+size_t _zn_read_exact_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *arg, _zn_link_addr_t *addr)
 {
     size_t n = len;
     size_t rb = 0;
@@ -311,7 +312,7 @@ size_t _zn_read_exact_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, vo
             return rb;
 
         n -= rb;
-        ptr = ptr + (len - n);
+        ptr = ptr + rb;
     } while (n > 0);
 
     return len;
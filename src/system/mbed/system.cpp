@@ -90,6 +90,17 @@ void z_task_free(z_task_t **task)
     *task = NULL;
 }
 
+z_task_t z_task_self(void)
+{
+    // The thread ID, not the Thread object created by z_task_init
+    return (z_task_t)ThisThread::get_id();
+}
+
+int z_task_eq(const z_task_t *left, const z_task_t *right)
+{
+    return *left == *right;
+}
+
 /*------------------ Mutex ------------------*/
 int z_mutex_init(z_mutex_t *m)
 {
@@ -120,6 +131,38 @@ int z_mutex_unlock(z_mutex_t *m)
     return 0;
 }
 
+/*------------------ RWLock ------------------*/
+int z_rwlock_init(z_rwlock_t *rw)
+{
+    // Readers are serialized, no reader-writer lock in Mbed OS
+    *rw = new Mutex();
+    return 0;
+}
+
+int z_rwlock_free(z_rwlock_t *rw)
+{
+    delete ((Mutex*)*rw);
+    return 0;
+}
+
+int z_rwlock_rdlock(z_rwlock_t *rw)
+{
+    ((Mutex*)*rw)->lock();
+    return 0;
+}
+
+int z_rwlock_wrlock(z_rwlock_t *rw)
+{
+    ((Mutex*)*rw)->lock();
+    return 0;
+}
+
+int z_rwlock_unlock(z_rwlock_t *rw)
+{
+    ((Mutex*)*rw)->unlock();
+    return 0;
+}
+
 /*------------------ Condvar ------------------*/
 int z_condvar_init(z_condvar_t *cv)
 {
@@ -145,6 +188,12 @@ int z_condvar_wait(z_condvar_t *cv, z_mutex_t *m)
     return 0;
 }
 
+int z_condvar_timedwait(z_condvar_t *cv, z_mutex_t *m, unsigned int time)
+{
+    *cv = new ConditionVariable(*((Mutex*)*m));
+    return ((ConditionVariable*)*cv)->wait_for(time) ? -1 : 0;
+}
+
 /*------------------ Sleep ------------------*/
 int z_sleep_us(unsigned int time)
 {
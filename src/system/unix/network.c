@@ -12,6 +12,10 @@
 //   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
 //
 
+#if defined(ZENOH_LINUX)
+#define _GNU_SOURCE // For recvmmsg and sendmmsg
+#endif
+
 #include <errno.h>
 #include <unistd.h>
 #include <string.h>
@@ -21,8 +25,13 @@
 #include <netdb.h>
 #include <sys/ioctl.h>
 #include <sys/types.h>
+#include <sys/uio.h>
+#if defined(ZENOH_LINUX)
+#include <netinet/udp.h>
+#endif
 
 #include "zenoh-pico/config.h"
+#include "zenoh-pico/link/endpoint.h"
 #include "zenoh-pico/system/platform.h"
 #include "zenoh-pico/collections/string.h"
 #include "zenoh-pico/utils/logging.h"
@@ -30,8 +39,184 @@
 typedef struct
 {
     int _fd;
+#if defined(Z_LINK_BATCH)
+    int _has_gso; // Cleared once a segmentation offload write failed
+#endif
 } __zn_net_socket;
 
+/*------------------ Vectored send ------------------*/
+#if ZN_LINK_TCP == 1 || ZN_LINK_UDP_UNICAST == 1 || ZN_LINK_UDP_MULTICAST == 1
+static ssize_t __zn_sendv(__zn_net_socket *sock, const z_bytes_t *iov, size_t iovcnt, const struct sockaddr *addr, socklen_t addrlen)
+{
+    if (iovcnt > Z_LINK_SENDV_IOV_MAX)
+        iovcnt = Z_LINK_SENDV_IOV_MAX;
+
+    struct iovec vec[Z_LINK_SENDV_IOV_MAX];
+    for (size_t i = 0; i < iovcnt; i++)
+    {
+        vec[i].iov_base = (void *)iov[i].val;
+        vec[i].iov_len = iov[i].len;
+    }
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_name = (void *)addr;
+    msg.msg_namelen = addrlen;
+    msg.msg_iov = vec;
+    msg.msg_iovlen = iovcnt;
+
+#if defined(ZENOH_LINUX)
+    return sendmsg(sock->_fd, &msg, MSG_NOSIGNAL);
+#else
+    return sendmsg(sock->_fd, &msg, 0);
+#endif
+}
+#endif
+
+#if defined(Z_LINK_BATCH)
+/*------------------ Batched datagrams ------------------*/
+#if !defined(UDP_SEGMENT)
+#define UDP_SEGMENT 103
+#endif
+
+// The largest UDP payload over IPv4
+#define __ZN_UDP_GSO_LEN_MAX 65507
+
+ssize_t __zn_recvmmsg(__zn_net_socket *sock, uint8_t **bufs, size_t len, size_t *lens, size_t n, struct sockaddr_storage *raddrs)
+{
+    if (n > Z_LINK_BATCH_MAX)
+        n = Z_LINK_BATCH_MAX;
+
+    struct mmsghdr msgs[Z_LINK_BATCH_MAX];
+    struct iovec vec[Z_LINK_BATCH_MAX];
+    memset(msgs, 0, n * sizeof(struct mmsghdr));
+    for (size_t i = 0; i < n; i++)
+    {
+        vec[i].iov_base = bufs[i];
+        vec[i].iov_len = len;
+        msgs[i].msg_hdr.msg_iov = &vec[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        if (raddrs != NULL)
+        {
+            msgs[i].msg_hdr.msg_name = &raddrs[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+        }
+    }
+
+    // Block until the first datagram is received, then take the ones already queued
+    int rb = recvmmsg(sock->_fd, msgs, n, MSG_WAITFORONE, NULL);
+    if (rb < 0)
+        return -1;
+
+    for (int i = 0; i < rb; i++)
+        lens[i] = msgs[i].msg_len;
+
+    return rb;
+}
+
+// Returns the number of datagrams written, 0 if they cannot be segmented by the kernel
+ssize_t __zn_send_gso(__zn_net_socket *sock, const z_bytes_t *iov, const size_t *iovcnts, size_t n, const struct sockaddr *addr, socklen_t addrlen)
+{
+    // All the datagrams but the last one must have the same length, the last one can be shorter
+    struct iovec vec[Z_LINK_BATCH_MAX * Z_LINK_SENDV_IOV_MAX];
+    size_t iovlen = 0;
+    size_t seg = 0;
+    size_t total = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        size_t dlen = 0;
+        for (size_t j = 0; j < iovcnts[i]; j++, iovlen++)
+        {
+            vec[iovlen].iov_base = (void *)iov[iovlen].val;
+            vec[iovlen].iov_len = iov[iovlen].len;
+            dlen += iov[iovlen].len;
+        }
+
+        if (i == 0)
+            seg = dlen;
+        if (dlen == 0 || dlen > seg || (dlen < seg && i < n - 1))
+            return 0;
+        total += dlen;
+    }
+    if (total > __ZN_UDP_GSO_LEN_MAX || seg > UINT16_MAX)
+        return 0;
+
+    union
+    {
+        char buf[CMSG_SPACE(sizeof(uint16_t))];
+        struct cmsghdr align;
+    } ctrl;
+    memset(&ctrl, 0, sizeof(ctrl));
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_name = (void *)addr;
+    msg.msg_namelen = addrlen;
+    msg.msg_iov = vec;
+    msg.msg_iovlen = iovlen;
+    msg.msg_control = ctrl.buf;
+    msg.msg_controllen = sizeof(ctrl.buf);
+
+    struct cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+    cm->cmsg_level = IPPROTO_UDP;
+    cm->cmsg_type = UDP_SEGMENT;
+    cm->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+    uint16_t gso_size = (uint16_t)seg;
+    memcpy(CMSG_DATA(cm), &gso_size, sizeof(uint16_t));
+
+    if (sendmsg(sock->_fd, &msg, MSG_NOSIGNAL) < 0)
+        return -1;
+
+    return n;
+}
+
+ssize_t __zn_sendmmsg(__zn_net_socket *sock, const z_bytes_t *iov, const size_t *iovcnts, size_t n, const struct sockaddr *addr, socklen_t addrlen)
+{
+    if (n > Z_LINK_BATCH_MAX)
+        n = Z_LINK_BATCH_MAX;
+
+    // Let the kernel split a single write into datagrams (i.e. UDP GSO)
+    if (n > 1 && sock->_has_gso)
+    {
+        ssize_t wb = __zn_send_gso(sock, iov, iovcnts, n, addr, addrlen);
+        if (wb > 0)
+            return wb;
+
+        // The offload is not supported by the kernel, the device or the route (e.g. the segments
+        // exceed the MTU), other errors (e.g. ENOBUFS) are transient and reported as such
+        if (wb < 0)
+        {
+            if (errno != EINVAL && errno != EOPNOTSUPP && errno != EIO)
+                return -1;
+
+            _Z_DEBUG("UDP segmentation offload failed, using sendmmsg\n");
+            sock->_has_gso = 0;
+        }
+    }
+
+    struct mmsghdr msgs[Z_LINK_BATCH_MAX];
+    struct iovec vec[Z_LINK_BATCH_MAX * Z_LINK_SENDV_IOV_MAX];
+    memset(msgs, 0, n * sizeof(struct mmsghdr));
+    size_t iovlen = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        size_t iovcnt = iovcnts[i] > Z_LINK_SENDV_IOV_MAX ? Z_LINK_SENDV_IOV_MAX : iovcnts[i];
+        msgs[i].msg_hdr.msg_name = (void *)addr;
+        msgs[i].msg_hdr.msg_namelen = addrlen;
+        msgs[i].msg_hdr.msg_iov = &vec[iovlen];
+        msgs[i].msg_hdr.msg_iovlen = iovcnt;
+        for (size_t j = 0; j < iovcnt; j++, iovlen++)
+        {
+            vec[iovlen].iov_base = (void *)iov[j].val;
+            vec[iovlen].iov_len = iov[j].len;
+        }
+        iov += iovcnts[i];
+    }
+
+    return sendmmsg(sock->_fd, msgs, n, MSG_NOSIGNAL);
+}
+#endif
+
 
 #if ZN_LINK_TCP == 1
 
@@ -132,6 +317,7 @@ void _zn_close_tcp(void *sock_arg)
 size_t _zn_read_tcp(void *sock_arg, uint8_t *ptr, size_t len)
 {
     __zn_net_socket *sock = (__zn_net_socket *)sock_arg;
+
     ssize_t rb = recv(sock->_fd, ptr, len, 0);
     if (rb < 0)
         return SIZE_MAX;
@@ -151,7 +337,7 @@ size_t _zn_read_exact_tcp(void *sock_arg, uint8_t *ptr, size_t len)
             return rb;
 
         n -= rb;
-        ptr = ptr + (len - n);
+        ptr = ptr + rb;
     } while (n > 0);
 
     return len;
@@ -160,12 +346,27 @@ size_t _zn_read_exact_tcp(void *sock_arg, uint8_t *ptr, size_t len)
 size_t _zn_send_tcp(void *sock_arg, const uint8_t *ptr, size_t len)
 {
     __zn_net_socket *sock = (__zn_net_socket *)sock_arg;
+
 #if defined(ZENOH_LINUX)
     return send(sock->_fd, ptr, len, MSG_NOSIGNAL);
 #else
     return send(sock->_fd, ptr, len, 0);
 #endif
 }
+
+size_t _zn_sendv_tcp(void *sock_arg, const z_bytes_t *iov, size_t iovcnt)
+{
+    __zn_net_socket *sock = (__zn_net_socket *)sock_arg;
+    return __zn_sendv(sock, iov, iovcnt, NULL, 0);
+}
+
+#if defined(Z_EVENT_LOOP)
+int _zn_get_fd_tcp(void *sock_arg)
+{
+    __zn_net_socket *sock = (__zn_net_socket *)sock_arg;
+    return sock->_fd;
+}
+#endif
 #endif
 
 #if ZN_LINK_UDP_UNICAST == 1 || ZN_LINK_UDP_MULTICAST == 1
@@ -211,6 +412,9 @@ void *_zn_open_udp_unicast(void *arg, unsigned long tout)
     setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (char *)&tv, sizeof(tv));
 
     ret->_fd = sock;
+#if defined(Z_LINK_BATCH)
+    ret->_has_gso = 1;
+#endif
     return ret;
 
 _ZN_OPEN_UDP_UNICAST_ERROR_1:
@@ -267,7 +471,7 @@ size_t _zn_read_exact_udp_unicast(void *sock_arg, uint8_t *ptr, size_t len)
             return rb;
 
         n -= rb;
-        ptr = ptr + (len - n);
+        ptr = ptr + rb;
     } while (n > 0);
 
     return len;
@@ -280,6 +484,47 @@ size_t _zn_send_udp_unicast(void *sock_arg, const uint8_t *ptr, size_t len, void
 
     return sendto(sock->_fd, ptr, len, 0, raddr->ai_addr, raddr->ai_addrlen);
 }
+
+size_t _zn_sendv_udp_unicast(void *sock_arg, const z_bytes_t *iov, size_t iovcnt, void *raddr_arg)
+{
+    __zn_net_socket *sock = (__zn_net_socket *)sock_arg;
+    struct addrinfo *raddr = (struct addrinfo *)raddr_arg;
+
+    return __zn_sendv(sock, iov, iovcnt, raddr->ai_addr, raddr->ai_addrlen);
+}
+
+#if defined(Z_LINK_BATCH)
+size_t _zn_read_batch_udp_unicast(void *sock_arg, uint8_t **bufs, size_t len, size_t *lens, size_t n)
+{
+    __zn_net_socket *sock = (__zn_net_socket *)sock_arg;
+
+    ssize_t rb = __zn_recvmmsg(sock, bufs, len, lens, n, NULL);
+    if (rb < 0)
+        return SIZE_MAX;
+
+    return rb;
+}
+
+size_t _zn_sendv_batch_udp_unicast(void *sock_arg, const z_bytes_t *iov, const size_t *iovcnts, size_t n, void *raddr_arg)
+{
+    __zn_net_socket *sock = (__zn_net_socket *)sock_arg;
+    struct addrinfo *raddr = (struct addrinfo *)raddr_arg;
+
+    ssize_t wb = __zn_sendmmsg(sock, iov, iovcnts, n, raddr->ai_addr, raddr->ai_addrlen);
+    if (wb < 0)
+        return SIZE_MAX;
+
+    return wb;
+}
+#endif
+
+#if defined(Z_EVENT_LOOP)
+int _zn_get_fd_udp_unicast(void *sock_arg)
+{
+    __zn_net_socket *sock = (__zn_net_socket *)sock_arg;
+    return sock->_fd;
+}
+#endif
 #endif
 
 #if ZN_LINK_UDP_MULTICAST == 1
@@ -373,6 +618,9 @@ void *_zn_open_udp_multicast(void *arg_1, void **arg_2, unsigned long tout, cons
 //#endif
 
     ret->_fd = sock;
+#if defined(Z_LINK_BATCH)
+    ret->_has_gso = 1;
+#endif
     return ret;
 
 _ZN_OPEN_UDP_MULTICAST_ERROR_3:
@@ -451,6 +699,9 @@ void *_zn_listen_udp_multicast(void *arg, unsigned long tout, const z_str_t ifac
         goto _ZN_LISTEN_UDP_MULTICAST_ERROR_2;
 
     ret->_fd = sock;
+#if defined(Z_LINK_BATCH)
+    ret->_has_gso = 1;
+#endif
     return ret;
 
 _ZN_LISTEN_UDP_MULTICAST_ERROR_2:
@@ -502,7 +753,43 @@ void _zn_close_udp_multicast(void *sockrecv_arg, void *socksend_arg, void *raddr
     }
 }
 
-size_t _zn_read_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *arg, z_bytes_t *addr)
+// Datagrams looped back from the local endpoint are not received
+int __zn_udp_multicast_is_local(const struct addrinfo *laddr, const struct sockaddr_storage *raddr)
+{
+    if (laddr->ai_family == AF_INET)
+    {
+        struct sockaddr_in *a = ((struct sockaddr_in *)laddr->ai_addr);
+        struct sockaddr_in *b = ((struct sockaddr_in *)raddr);
+        return a->sin_port == b->sin_port && a->sin_addr.s_addr == b->sin_addr.s_addr;
+    }
+    else if (laddr->ai_family == AF_INET6)
+    {
+        struct sockaddr_in6 *a = ((struct sockaddr_in6 *)laddr->ai_addr);
+        struct sockaddr_in6 *b = ((struct sockaddr_in6 *)raddr);
+        return a->sin6_port == b->sin6_port && memcmp(a->sin6_addr.s6_addr, b->sin6_addr.s6_addr, sizeof(struct in6_addr)) == 0;
+    }
+
+    return 1;
+}
+
+void __zn_udp_multicast_addr_encode(const struct addrinfo *laddr, const struct sockaddr_storage *raddr, _zn_link_addr_t *addr)
+{
+    _zn_link_addr_reset(addr);
+    if (laddr->ai_family == AF_INET)
+    {
+        struct sockaddr_in *b = ((struct sockaddr_in *)raddr);
+        _zn_link_addr_append(addr, &b->sin_addr.s_addr, sizeof(in_addr_t));
+        _zn_link_addr_append(addr, &b->sin_port, sizeof(in_port_t));
+    }
+    else if (laddr->ai_family == AF_INET6)
+    {
+        struct sockaddr_in6 *b = ((struct sockaddr_in6 *)raddr);
+        _zn_link_addr_append(addr, &b->sin6_addr.s6_addr, sizeof(struct in6_addr));
+        _zn_link_addr_append(addr, &b->sin6_port, sizeof(in_port_t));
+    }
+}
+
+size_t _zn_read_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *arg, _zn_link_addr_t *addr)
 {
     __zn_net_socket *sock = (__zn_net_socket *)sock_arg;
     struct addrinfo *laddr = (struct addrinfo *)arg;
@@ -517,45 +804,16 @@ size_t _zn_read_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *ar
 
         if (rb < 0)
             return SIZE_MAX;
+    } while (__zn_udp_multicast_is_local(laddr, &raddr));
 
-        if (laddr->ai_family == AF_INET)
-        {
-            struct sockaddr_in *a = ((struct sockaddr_in *)laddr->ai_addr);
-            struct sockaddr_in *b = ((struct sockaddr_in *)&raddr);
-            if (!(a->sin_port == b->sin_port && a->sin_addr.s_addr == b->sin_addr.s_addr))
-            {
-                // If addr is not NULL, it means that the raddr was requested by the upper-layers
-                if (addr != NULL)
-                {
-                    *addr = _z_bytes_make(sizeof(in_addr_t) + sizeof(in_port_t));
-                    memcpy((void *)addr->val, &b->sin_addr.s_addr, sizeof(in_addr_t));
-                    memcpy((void *)(addr->val + sizeof(in_addr_t)), &b->sin_port, sizeof(in_port_t));
-                }
-                break;
-            }
-        }
-        else if (laddr->ai_family == AF_INET6)
-        {
-            struct sockaddr_in6 *a = ((struct sockaddr_in6 *)laddr->ai_addr);
-            struct sockaddr_in6 *b = ((struct sockaddr_in6 *)&raddr);
-            if (!(a->sin6_port == b->sin6_port && memcmp(a->sin6_addr.s6_addr, b->sin6_addr.s6_addr, sizeof(struct in6_addr)) == 0))
-            {
-                // If addr is not NULL, it means that the raddr was requested by the upper-layers
-                if (addr != NULL)
-                {
-                    *addr = _z_bytes_make(sizeof(struct in6_addr) + sizeof(in_port_t));
-                    memcpy((void *)addr->val, &b->sin6_addr.s6_addr, sizeof(struct in6_addr));
-                    memcpy((void *)(addr->val + sizeof(struct in6_addr)), &b->sin6_port, sizeof(in_port_t));
-                }
-                break;
-            }
-        }
-    } while (1);
+    // If addr is not NULL, it means that the raddr was requested by the upper-layers
+    if (addr != NULL)
+        __zn_udp_multicast_addr_encode(laddr, &raddr, addr);
 
     return rb;
 }
 
-size_t _zn_read_exact_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *arg, z_bytes_t *addr)
+size_t _zn_read_exact_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *arg, _zn_link_addr_t *addr)
 {
     size_t n = len;
     size_t rb = 0;
@@ -567,7 +825,7 @@ size_t _zn_read_exact_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, vo
             return rb;
 
         n -= rb;
-        ptr = ptr + (len - n);
+        ptr = ptr + rb;
     } while (n > 0);
 
     return len;
@@ -581,6 +839,64 @@ size_t _zn_send_udp_multicast(void *sock_arg, const uint8_t *ptr, size_t len, vo
     return sendto(sock->_fd, ptr, len, 0, raddr->ai_addr, raddr->ai_addrlen);
 }
 
+size_t _zn_sendv_udp_multicast(void *sock_arg, const z_bytes_t *iov, size_t iovcnt, void *raddr_arg)
+{
+    __zn_net_socket *sock = (__zn_net_socket *)sock_arg;
+    struct addrinfo *raddr = (struct addrinfo *)raddr_arg;
+
+    return __zn_sendv(sock, iov, iovcnt, raddr->ai_addr, raddr->ai_addrlen);
+}
+
+#if defined(Z_LINK_BATCH)
+size_t _zn_read_batch_udp_multicast(void *sock_arg, uint8_t **bufs, size_t len, size_t *lens, size_t n, void *arg, _zn_link_addr_t *addrs)
+{
+    __zn_net_socket *sock = (__zn_net_socket *)sock_arg;
+    struct addrinfo *laddr = (struct addrinfo *)arg;
+    struct sockaddr_storage raddrs[Z_LINK_BATCH_MAX];
+
+    size_t k = 0;
+    do
+    {
+        ssize_t rb = __zn_recvmmsg(sock, bufs, len, lens, n, raddrs);
+        if (rb < 0)
+            return SIZE_MAX;
+
+        // Move the datagrams received from the other endpoints in front of the local ones
+        for (size_t i = 0; i < (size_t)rb; i++)
+        {
+            if (__zn_udp_multicast_is_local(laddr, &raddrs[i]))
+                continue;
+
+            if (k != i)
+            {
+                uint8_t *buf = bufs[k];
+                bufs[k] = bufs[i];
+                bufs[i] = buf;
+                lens[k] = lens[i];
+            }
+
+            // If addrs is not NULL, it means that the raddrs were requested by the upper-layers
+            if (addrs != NULL)
+                __zn_udp_multicast_addr_encode(laddr, &raddrs[i], &addrs[k]);
+            k++;
+        }
+    } while (k == 0);
+
+    return k;
+}
+
+size_t _zn_sendv_batch_udp_multicast(void *sock_arg, const z_bytes_t *iov, const size_t *iovcnts, size_t n, void *raddr_arg)
+{
+    __zn_net_socket *sock = (__zn_net_socket *)sock_arg;
+    struct addrinfo *raddr = (struct addrinfo *)raddr_arg;
+
+    ssize_t wb = __zn_sendmmsg(sock, iov, iovcnts, n, raddr->ai_addr, raddr->ai_addrlen);
+    if (wb < 0)
+        return SIZE_MAX;
+
+    return wb;
+}
+#endif
 #endif
 
 #if ZN_LINK_BLUETOOTH == 1
@@ -0,0 +1,444 @@
+//
+// Copyright (c) 2022 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+#include "zenoh-pico/config.h"
+#include "zenoh-pico/system/link/shm.h"
+
+#if ZN_LINK_SHM == 1 && defined(Z_LINK_SHM)
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#if (ZN_LINK_SHM_RING_SIZE & (ZN_LINK_SHM_RING_SIZE - 1)) != 0 || ZN_LINK_SHM_RING_SIZE > (1U << 31)
+#error "ZN_LINK_SHM_RING_SIZE must be a power of two, and at most 2^31"
+#endif
+
+#define __ZN_SHM_PREFIX "/zenoh-pico-"
+#define __ZN_SHM_MAGIC 0x7a6e702d73686d01ULL
+#define __ZN_SHM_CACHE_LINE 64
+
+// Number of times the rings are checked before waiting on a futex, for the ends to meet without
+// syscalls. There is no spinning on a single CPU, where the other end cannot run meanwhile.
+#define __ZN_SHM_SPIN 512
+
+// The ends attached to a segment
+#define __ZN_SHM_CREATOR 0x01
+#define __ZN_SHM_ATTACHER 0x02
+#define __ZN_SHM_CLOSED 0x04
+
+/*------------------ Segment layout ------------------*/
+// A single producer single consumer byte ring. The positions count the bytes ever written and read,
+// modulo 2^32. A waiting end sleeps on a doorbell, rung by the other end when it moves a position.
+typedef struct
+{
+    uint32_t head;            // Written by the producer
+    uint32_t head_bell;       // Rung for the consumer
+    uint32_t is_head_awaited; // Set by the consumer before sleeping on head_bell
+    uint8_t _pad0[__ZN_SHM_CACHE_LINE - 3 * sizeof(uint32_t)];
+
+    uint32_t tail;            // Written by the consumer
+    uint32_t tail_bell;       // Rung for the producer
+    uint32_t is_tail_awaited; // Set by the producer before sleeping on tail_bell
+    uint8_t _pad1[__ZN_SHM_CACHE_LINE - 3 * sizeof(uint32_t)];
+} __zn_shm_ring_t;
+
+// The segment holds this header followed by the data of both rings. The creator writes into the
+// first ring and reads from the second one.
+typedef struct
+{
+    uint64_t magic; // Written last by the creator, once the segment is initialized
+    uint32_t size;
+    uint32_t sides;
+    uint32_t is_closed[2];
+    uint8_t _pad[__ZN_SHM_CACHE_LINE - sizeof(uint64_t) - 4 * sizeof(uint32_t)];
+
+    __zn_shm_ring_t rings[2];
+} __zn_shm_header_t;
+
+typedef struct
+{
+    __zn_shm_header_t *_hdr;
+    size_t _len;
+    int _side; // 0 for the creator, 1 for the attacher
+    uint32_t _mask;
+    unsigned long _tout;
+    int _spin;
+
+    __zn_shm_ring_t *_tx;
+    uint8_t *_tx_data;
+    uint32_t _tx_head; // Bytes written but not published yet are past _tx->head
+
+    __zn_shm_ring_t *_rx;
+    uint8_t *_rx_data;
+
+    z_str_t _name; // Only kept by the creator, to remove it if no one attached
+} __zn_shm_socket;
+
+z_str_t __zn_shm_name(const z_str_t name)
+{
+    // A single path component, as required for portable POSIX shared memory names
+    size_t len = strlen(name);
+    if (len == 0 || len + sizeof(__ZN_SHM_PREFIX) > NAME_MAX || strchr(name, '/') != NULL)
+        return NULL;
+
+    z_str_t path = (z_str_t)z_malloc(len + sizeof(__ZN_SHM_PREFIX));
+    strcpy(path, __ZN_SHM_PREFIX);
+    strcat(path, name);
+    return path;
+}
+
+__zn_shm_socket *__zn_shm_socket_make(void *ptr, size_t len, int side, unsigned long tout)
+{
+    __zn_shm_socket *sock = (__zn_shm_socket *)z_malloc(sizeof(__zn_shm_socket));
+    memset(sock, 0, sizeof(__zn_shm_socket));
+
+    __zn_shm_header_t *hdr = (__zn_shm_header_t *)ptr;
+    uint8_t *data = (uint8_t *)ptr + sizeof(__zn_shm_header_t);
+    sock->_hdr = hdr;
+    sock->_len = len;
+    sock->_side = side;
+    sock->_mask = hdr->size - 1;
+    sock->_tout = tout * 1000;
+    sock->_spin = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? __ZN_SHM_SPIN : 0;
+    sock->_tx = &hdr->rings[side];
+    sock->_tx_data = data + (size_t)side * hdr->size;
+    sock->_tx_head = __atomic_load_n(&sock->_tx->head, __ATOMIC_RELAXED);
+    sock->_rx = &hdr->rings[1 - side];
+    sock->_rx_data = data + (size_t)(1 - side) * hdr->size;
+    return sock;
+}
+
+/*------------------ Wait and wake ------------------*/
+void __zn_shm_pause(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+int __zn_shm_is_peer_closed(const __zn_shm_socket *sock)
+{
+    return __atomic_load_n(&sock->_hdr->is_closed[1 - sock->_side], __ATOMIC_ACQUIRE);
+}
+
+void __zn_shm_ring(uint32_t *bell)
+{
+    __atomic_add_fetch(bell, 1, __ATOMIC_RELEASE);
+    syscall(SYS_futex, bell, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+/**
+ * Wait for a ring position to move away from a known value, or for the other end to close.
+ *
+ * Returns 0 if so, or -1 once the timeout of the socket elapsed.
+ */
+int __zn_shm_wait(const __zn_shm_socket *sock, uint32_t *pos, uint32_t val, uint32_t *bell, uint32_t *is_awaited)
+{
+    for (int i = 0; i < sock->_spin; i++)
+    {
+        if (__atomic_load_n(pos, __ATOMIC_ACQUIRE) != val || __zn_shm_is_peer_closed(sock))
+            return 0;
+        __zn_shm_pause();
+    }
+
+    z_clock_t start = z_clock_now();
+    while (1)
+    {
+        // The other end either sees the flag and rings, or has moved the position before it is read
+        uint32_t rung = __atomic_load_n(bell, __ATOMIC_ACQUIRE);
+        __atomic_store_n(is_awaited, 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (__atomic_load_n(pos, __ATOMIC_ACQUIRE) != val || __zn_shm_is_peer_closed(sock))
+            break;
+
+        unsigned long elapsed = z_clock_elapsed_ms(&start);
+        if (elapsed >= sock->_tout)
+        {
+            __atomic_store_n(is_awaited, 0, __ATOMIC_RELAXED);
+            return -1;
+        }
+
+        struct timespec ts;
+        ts.tv_sec = (sock->_tout - elapsed) / 1000;
+        ts.tv_nsec = ((sock->_tout - elapsed) % 1000) * 1000000;
+        syscall(SYS_futex, bell, FUTEX_WAIT, rung, &ts, NULL, 0);
+    }
+
+    __atomic_store_n(is_awaited, 0, __ATOMIC_RELAXED);
+    return 0;
+}
+
+/*------------------ Segment ------------------*/
+void *_zn_listen_shm(const z_str_t name, unsigned long tout)
+{
+    z_str_t path = __zn_shm_name(name);
+    if (path == NULL)
+        goto ERR1;
+
+    int fd = shm_open(path, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    if (fd < 0)
+        goto ERR2;
+
+    size_t len = sizeof(__zn_shm_header_t) + 2 * (size_t)ZN_LINK_SHM_RING_SIZE;
+    if (ftruncate(fd, len) < 0)
+        goto ERR3;
+
+    // The pages are zeroed, hence the rings are empty and no end is closed
+    void *ptr = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED)
+        goto ERR3;
+    close(fd);
+
+    __zn_shm_header_t *hdr = (__zn_shm_header_t *)ptr;
+    hdr->size = ZN_LINK_SHM_RING_SIZE;
+    hdr->sides = __ZN_SHM_CREATOR;
+    __atomic_store_n(&hdr->magic, __ZN_SHM_MAGIC, __ATOMIC_RELEASE);
+
+    __zn_shm_socket *sock = __zn_shm_socket_make(ptr, len, 0, tout);
+    sock->_name = path;
+    return sock;
+
+ERR3:
+    close(fd);
+    shm_unlink(path);
+ERR2:
+    z_free(path);
+ERR1:
+    return NULL;
+}
+
+void *_zn_open_shm(const z_str_t name, unsigned long tout)
+{
+    z_str_t path = __zn_shm_name(name);
+    if (path == NULL)
+        goto ERR1;
+
+    int fd = shm_open(path, O_RDWR, 0);
+    if (fd < 0)
+        goto ERR2;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(__zn_shm_header_t))
+        goto ERR3;
+
+    size_t len = (size_t)st.st_size;
+    void *ptr = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED)
+        goto ERR3;
+    close(fd);
+
+    // The segment must be fully initialized, and not attached yet
+    __zn_shm_header_t *hdr = (__zn_shm_header_t *)ptr;
+    if (__atomic_load_n(&hdr->magic, __ATOMIC_ACQUIRE) != __ZN_SHM_MAGIC)
+        goto ERR4;
+
+    uint32_t size = hdr->size;
+    if (size == 0 || (size & (size - 1)) != 0 || len != sizeof(__zn_shm_header_t) + 2 * (size_t)size)
+        goto ERR4;
+
+    uint32_t sides = __ZN_SHM_CREATOR;
+    if (!__atomic_compare_exchange_n(&hdr->sides, &sides, __ZN_SHM_CREATOR | __ZN_SHM_ATTACHER, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        goto ERR4;
+
+    // Both ends hold the segment, the name can be reused
+    shm_unlink(path);
+    z_free(path);
+
+    return __zn_shm_socket_make(ptr, len, 1, tout);
+
+ERR4:
+    munmap(ptr, len);
+    goto ERR2;
+ERR3:
+    close(fd);
+ERR2:
+    z_free(path);
+ERR1:
+    return NULL;
+}
+
+void _zn_close_shm(void *sock_arg)
+{
+    __zn_shm_socket *sock = (__zn_shm_socket *)sock_arg;
+    if (sock == NULL)
+        return;
+
+    // Wake up the other end, its reads and writes fail once it sees the flag
+    __atomic_store_n(&sock->_hdr->is_closed[sock->_side], 1, __ATOMIC_RELEASE);
+    __zn_shm_ring(&sock->_tx->head_bell);
+    __zn_shm_ring(&sock->_rx->tail_bell);
+
+    // Remove the name if no one attached meanwhile, it has been removed by the attacher otherwise
+    if (sock->_name != NULL)
+    {
+        uint32_t sides = __ZN_SHM_CREATOR;
+        if (__atomic_compare_exchange_n(&sock->_hdr->sides, &sides, __ZN_SHM_CREATOR | __ZN_SHM_CLOSED, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            shm_unlink(sock->_name);
+        z_free(sock->_name);
+    }
+
+    munmap(sock->_hdr, sock->_len);
+    z_free(sock);
+}
+
+/*------------------ Reads ------------------*/
+size_t _zn_read_shm(void *sock_arg, uint8_t *ptr, size_t len)
+{
+    __zn_shm_socket *sock = (__zn_shm_socket *)sock_arg;
+    __zn_shm_ring_t *rx = sock->_rx;
+
+    uint32_t tail = __atomic_load_n(&rx->tail, __ATOMIC_RELAXED);
+    uint32_t head = __atomic_load_n(&rx->head, __ATOMIC_ACQUIRE);
+    if (head == tail)
+    {
+        if (__zn_shm_wait(sock, &rx->head, tail, &rx->head_bell, &rx->is_head_awaited) < 0)
+            return SIZE_MAX;
+
+        // The bytes written before closing are still read
+        head = __atomic_load_n(&rx->head, __ATOMIC_ACQUIRE);
+        if (head == tail)
+            return 0;
+    }
+
+    size_t n = head - tail;
+    if (n > len)
+        n = len;
+
+    // The bytes may wrap around the end of the ring
+    size_t pos = tail & sock->_mask;
+    size_t first = sock->_mask + 1 - pos;
+    if (first > n)
+        first = n;
+    memcpy(ptr, sock->_rx_data + pos, first);
+    memcpy(ptr + first, sock->_rx_data, n - first);
+
+    __atomic_store_n(&rx->tail, tail + (uint32_t)n, __ATOMIC_RELEASE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&rx->is_tail_awaited, __ATOMIC_RELAXED))
+        __zn_shm_ring(&rx->tail_bell);
+
+    return n;
+}
+
+size_t _zn_read_exact_shm(void *sock_arg, uint8_t *ptr, size_t len)
+{
+    size_t n = len;
+    size_t rb = 0;
+
+    do
+    {
+        rb = _zn_read_shm(sock_arg, ptr, n);
+        if (rb == SIZE_MAX || rb == 0)
+            return SIZE_MAX;
+
+        n -= rb;
+        ptr = ptr + rb;
+    } while (n > 0);
+
+    return len;
+}
+
+/*------------------ Writes ------------------*/
+void __zn_shm_publish(__zn_shm_socket *sock)
+{
+    __zn_shm_ring_t *tx = sock->_tx;
+
+    __atomic_store_n(&tx->head, sock->_tx_head, __ATOMIC_RELEASE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&tx->is_head_awaited, __ATOMIC_RELAXED))
+        __zn_shm_ring(&tx->head_bell);
+}
+
+/**
+ * Copy bytes into the ring, publishing them whenever it is full to wait for the reader.
+ *
+ * The last bytes copied are left unpublished. Returns 0, or -1 if the other end closed or did
+ * not read anything before the timeout of the socket.
+ */
+int __zn_shm_write(__zn_shm_socket *sock, const uint8_t *ptr, size_t len)
+{
+    __zn_shm_ring_t *tx = sock->_tx;
+    size_t size = (size_t)sock->_mask + 1;
+
+    while (len > 0)
+    {
+        if (__zn_shm_is_peer_closed(sock))
+            return -1;
+
+        uint32_t tail = __atomic_load_n(&tx->tail, __ATOMIC_ACQUIRE);
+        size_t space = size - (uint32_t)(sock->_tx_head - tail);
+        if (space == 0)
+        {
+            __zn_shm_publish(sock);
+            if (__zn_shm_wait(sock, &tx->tail, tail, &tx->tail_bell, &tx->is_tail_awaited) < 0)
+                return -1;
+            continue;
+        }
+
+        size_t n = len < space ? len : space;
+        size_t pos = sock->_tx_head & sock->_mask;
+        size_t first = size - pos;
+        if (first > n)
+            first = n;
+        memcpy(sock->_tx_data + pos, ptr, first);
+        memcpy(sock->_tx_data, ptr + first, n - first);
+
+        sock->_tx_head += (uint32_t)n;
+        ptr = ptr + n;
+        len -= n;
+    }
+
+    return 0;
+}
+
+size_t _zn_send_shm(void *sock_arg, const uint8_t *ptr, size_t len)
+{
+    __zn_shm_socket *sock = (__zn_shm_socket *)sock_arg;
+
+    int res = __zn_shm_write(sock, ptr, len);
+    __zn_shm_publish(sock);
+    if (res < 0)
+        return SIZE_MAX;
+
+    return len;
+}
+
+size_t _zn_sendv_shm(void *sock_arg, const z_bytes_t *iov, size_t iovcnt)
+{
+    __zn_shm_socket *sock = (__zn_shm_socket *)sock_arg;
+
+    // The slices are published at once, the reader is woken up a single time
+    size_t len = 0;
+    int res = 0;
+    for (size_t i = 0; i < iovcnt && res == 0; i++)
+    {
+        res = __zn_shm_write(sock, iov[i].val, iov[i].len);
+        len += iov[i].len;
+    }
+    __zn_shm_publish(sock);
+    if (res < 0)
+        return SIZE_MAX;
+
+    return len;
+}
+#endif
@@ -12,10 +12,16 @@
 //   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
 //
 
+#include <errno.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <sys/time.h>
 #include <sys/random.h>
+#if defined(ZENOH_LINUX)
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#endif
 #include "zenoh-pico/system/platform.h"
 
 /*------------------ Random ------------------*/
@@ -116,6 +122,16 @@ void z_task_free(z_task_t **task)
     *task = NULL;
 }
 
+z_task_t z_task_self(void)
+{
+    return pthread_self();
+}
+
+int z_task_eq(const z_task_t *left, const z_task_t *right)
+{
+    return pthread_equal(*left, *right) != 0;
+}
+
 /*------------------ Mutex ------------------*/
 int z_mutex_init(z_mutex_t *m)
 {
@@ -142,6 +158,32 @@ int z_mutex_unlock(z_mutex_t *m)
     return pthread_mutex_unlock(m);
 }
 
+/*------------------ RWLock ------------------*/
+int z_rwlock_init(z_rwlock_t *rw)
+{
+    return pthread_rwlock_init(rw, 0);
+}
+
+int z_rwlock_free(z_rwlock_t *rw)
+{
+    return pthread_rwlock_destroy(rw);
+}
+
+int z_rwlock_rdlock(z_rwlock_t *rw)
+{
+    return pthread_rwlock_rdlock(rw);
+}
+
+int z_rwlock_wrlock(z_rwlock_t *rw)
+{
+    return pthread_rwlock_wrlock(rw);
+}
+
+int z_rwlock_unlock(z_rwlock_t *rw)
+{
+    return pthread_rwlock_unlock(rw);
+}
+
 /*------------------ Condvar ------------------*/
 int z_condvar_init(z_condvar_t *cv)
 {
@@ -163,6 +205,21 @@ int z_condvar_wait(z_condvar_t *cv, z_mutex_t *m)
     return pthread_cond_wait(cv, m);
 }
 
+int z_condvar_timedwait(z_condvar_t *cv, z_mutex_t *m, unsigned int time)
+{
+    struct timespec abstime;
+    clock_gettime(CLOCK_REALTIME, &abstime);
+    abstime.tv_sec += time / 1000;
+    abstime.tv_nsec += (long)(time % 1000) * 1000000;
+    if (abstime.tv_nsec >= 1000000000)
+    {
+        abstime.tv_sec++;
+        abstime.tv_nsec -= 1000000000;
+    }
+
+    return pthread_cond_timedwait(cv, m, &abstime);
+}
+
 /*------------------ Sleep ------------------*/
 int z_sleep_us(unsigned int time)
 {
@@ -248,3 +305,96 @@ unsigned long z_time_elapsed_s(z_time_t *time)
     unsigned long elapsed = now.tv_sec - time->tv_sec;
     return elapsed;
 }
+
+#if defined(Z_EVENT_LOOP)
+/*------------------ Poller ------------------*/
+#define __Z_POLLER_MAX_EVENTS 32
+
+int z_poller_init(z_poller_t *p)
+{
+    p->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (p->epoll_fd < 0)
+        return -1;
+
+    p->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (p->timer_fd < 0)
+        goto ERR;
+
+    // The timer is told apart from the sockets by its NULL argument
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+    if (epoll_ctl(p->epoll_fd, EPOLL_CTL_ADD, p->timer_fd, &ev) < 0)
+    {
+        close(p->timer_fd);
+        goto ERR;
+    }
+
+    return 0;
+
+ERR:
+    close(p->epoll_fd);
+    return -1;
+}
+
+int z_poller_free(z_poller_t *p)
+{
+    close(p->timer_fd);
+    return close(p->epoll_fd);
+}
+
+int z_poller_fd(const z_poller_t *p)
+{
+    return p->epoll_fd;
+}
+
+int z_poller_add(z_poller_t *p, int fd, void *arg)
+{
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = arg;
+    return epoll_ctl(p->epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+}
+
+int z_poller_remove(z_poller_t *p, int fd)
+{
+    return epoll_ctl(p->epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+}
+
+int z_poller_set_timer(z_poller_t *p, unsigned long time)
+{
+    // A zero time disarms the timer
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = time / 1000;
+    its.it_value.tv_nsec = (time % 1000) * 1000000;
+    return timerfd_settime(p->timer_fd, 0, &its, NULL);
+}
+
+int z_poller_wait(z_poller_t *p, void **args, size_t len, int timeout)
+{
+    if (len > __Z_POLLER_MAX_EVENTS)
+        len = __Z_POLLER_MAX_EVENTS;
+
+    struct epoll_event evs[__Z_POLLER_MAX_EVENTS];
+    int n = epoll_wait(p->epoll_fd, evs, len, timeout);
+    if (n < 0)
+        return errno == EINTR ? 0 : -1;
+
+    size_t ready = 0;
+    for (int i = 0; i < n; i++)
+    {
+        if (evs[i].data.ptr == NULL)
+        {
+            // Acknowledge the timer expiration, the caller checks its deadlines anyway
+            uint64_t expirations;
+            ssize_t rb = read(p->timer_fd, &expirations, sizeof(expirations));
+            (void)(rb);
+        }
+        else
+            args[ready++] = evs[i].data.ptr;
+    }
+
+    return ready;
+}
+#endif
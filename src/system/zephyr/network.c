@@ -16,6 +16,7 @@
 #include <sys/socket.h>
 
 #include "zenoh-pico/config.h"
+#include "zenoh-pico/link/endpoint.h"
 #include "zenoh-pico/system/platform.h"
 #include "zenoh-pico/utils/logging.h"
 #include "zenoh-pico/collections/string.h"
@@ -134,7 +135,7 @@ size_t _zn_read_exact_tcp(void *sock_arg, uint8_t *ptr, size_t len)
             return rb;
 
         n -= rb;
-        ptr = ptr + (len - n);
+        ptr = ptr + rb;
     } while (n > 0);
 
     return len;
@@ -242,7 +243,7 @@ size_t _zn_read_exact_udp_unicast(void *sock_arg, uint8_t *ptr, size_t len)
             return rb;
 
         n -= rb;
-        ptr = ptr + (len - n);
+        ptr = ptr + rb;
     } while (n > 0);
 
     return len;
@@ -493,7 +494,7 @@ _ZN_CLOSE_UDP_MULTICAST_ERROR_1:
     }
 }
 
-size_t _zn_read_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *arg, z_bytes_t *addr)
+size_t _zn_read_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *arg, _zn_link_addr_t *addr)
 {
     __zn_net_socket *sock = (__zn_net_socket *)sock_arg;
     struct addrinfo *laddr = (struct addrinfo *)arg;
@@ -518,9 +519,9 @@ size_t _zn_read_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *ar
                 // If addr is not NULL, it means that the raddr was requested by the upper-layers
                 if (addr != NULL)
                 {
-                    *addr = _z_bytes_make(sizeof(uint32_t) + sizeof(uint16_t));
-                    memcpy((void *)addr->val, &b->sin_addr.s_addr, sizeof(uint32_t));
-                    memcpy((void *)(addr->val + sizeof(uint32_t)), &b->sin_port, sizeof(uint16_t));
+                    _zn_link_addr_reset(addr);
+                    _zn_link_addr_append(addr, &b->sin_addr.s_addr, sizeof(uint32_t));
+                    _zn_link_addr_append(addr, &b->sin_port, sizeof(uint16_t));
                 }
                 break;
             }
@@ -534,9 +535,9 @@ size_t _zn_read_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *ar
                 // If addr is not NULL, it means that the raddr was requested by the upper-layers
                 if (addr != NULL)
                 {
-                    *addr = _z_bytes_make((sizeof(uint32_t) * 4) + sizeof(uint16_t));
-                    memcpy((void *)addr->val, &b->sin6_addr.s6_addr, sizeof(uint32_t) * 4);
-                    memcpy((void *)(addr->val + (sizeof(uint32_t) * 4)), &b->sin6_port, sizeof(uint16_t));
+                    _zn_link_addr_reset(addr);
+                    _zn_link_addr_append(addr, &b->sin6_addr.s6_addr, sizeof(uint32_t) * 4);
+                    _zn_link_addr_append(addr, &b->sin6_port, sizeof(uint16_t));
                 }
                 break;
             }
@@ -546,7 +547,7 @@ size_t _zn_read_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *ar
     return rb;
 }
 
-size_t _zn_read_exact_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *arg, z_bytes_t *addr)
+size_t _zn_read_exact_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, void *arg, _zn_link_addr_t *addr)
 {
     size_t n = len;
     size_t rb = 0;
@@ -558,7 +559,7 @@ size_t _zn_read_exact_udp_multicast(void *sock_arg, uint8_t *ptr, size_t len, vo
             return rb;
 
         n -= rb;
-        ptr = ptr + (len - n);
+        ptr = ptr + rb;
     } while (n > 0);
 
     return len;
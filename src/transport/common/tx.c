@@ -49,22 +49,62 @@ void __unsafe_zn_finalize_wbuf(_z_wbuf_t *buf, int is_streamed)
     }
 }
 
-_zn_transport_message_t __zn_frame_header(zn_reliability_t reliability, int is_fragment, int is_final, z_zint_t sn)
+_zn_transport_message_t __zn_frame_header(zn_reliability_t reliability, zn_priority_t priority, int is_fragment, int is_final, z_zint_t sn)
 {
     // Create the frame session message that carries the zenoh message
     int is_reliable = reliability == zn_reliability_t_RELIABLE;
 
     _zn_transport_message_t t_msg = _zn_t_msg_make_frame_header(sn, is_reliable, is_fragment, is_final);
+    t_msg.body.frame.priority = priority;
 
     return t_msg;
 }
 
+int __zn_zenoh_message_exceeds(const _zn_zenoh_message_t *z_msg, size_t space)
+{
+    // Only data messages carry payloads large enough to be worth checking beforehand
+    return _ZN_MID(z_msg->header) == _ZN_MID_DATA && z_msg->body.data.payload.len >= space;
+}
+
+int __zn_siphon_fragment(_z_wbuf_t *dst, _z_wbuf_t *src, size_t length)
+{
+    if (dst->is_expandable == 0)
+        return _z_wbuf_siphon(dst, src, length);
+
+    while (length > 0)
+    {
+        _z_iosli_t *ios = _z_wbuf_get_iosli(src, src->r_idx);
+        size_t readable = _z_iosli_readable(ios);
+        if (readable == 0)
+        {
+            if (src->r_idx == src->w_idx)
+                return -1;
+            src->r_idx++;
+            continue;
+        }
+
+        // User buffers referenced by the source are referenced by the fragment as well
+        size_t to_move = readable <= length ? readable : length;
+        int res;
+        if (ios->is_alloc == 0)
+            res = _z_wbuf_wrap_bytes(dst, ios->buf + ios->r_pos, 0, to_move);
+        else
+            res = _z_wbuf_write_bytes(dst, ios->buf + ios->r_pos, 0, to_move);
+        if (res != 0)
+            return -1;
+
+        ios->r_pos += to_move;
+        length -= to_move;
+    }
+    return 0;
+}
+
 /**
  * This function is unsafe because it operates in potentially concurrent data.
  * Make sure that the following mutexes are locked before calling this function:
  *  - ztu->mutex_tx
  */
-int __unsafe_zn_serialize_zenoh_fragment(_z_wbuf_t *dst, _z_wbuf_t *src, zn_reliability_t reliability, size_t sn)
+int __unsafe_zn_serialize_zenoh_fragment(_z_wbuf_t *dst, _z_wbuf_t *src, zn_reliability_t reliability, zn_priority_t priority, size_t sn, size_t mtu)
 {
     // Assume first that this is not the final fragment
     int is_final = 0;
@@ -73,13 +113,17 @@ int __unsafe_zn_serialize_zenoh_fragment(_z_wbuf_t *dst, _z_wbuf_t *src, zn_reli
         // Mark the buffer for the writing operation
         size_t w_pos = _z_wbuf_get_wpos(dst);
         // Get the frame header
-        _zn_transport_message_t f_hdr = __zn_frame_header(reliability, 1, is_final, sn);
+        _zn_transport_message_t f_hdr = __zn_frame_header(reliability, priority, 1, is_final, sn);
         // Encode the frame header
         int res = _zn_transport_message_encode(dst, &f_hdr);
         if (res == 0)
         {
-            size_t space_left = _z_wbuf_space_left(dst);
+            size_t len = _z_wbuf_len(dst);
+            size_t space_left = mtu > len ? mtu - len : 0;
             size_t bytes_left = _z_wbuf_len(src);
+            if (space_left == 0)
+                return -1;
+
             // Check if it is really the final fragment
             if (!is_final && (bytes_left <= space_left))
             {
@@ -91,15 +135,91 @@ int __unsafe_zn_serialize_zenoh_fragment(_z_wbuf_t *dst, _z_wbuf_t *src, zn_reli
             }
             // Write the fragment
             size_t to_copy = bytes_left <= space_left ? bytes_left : space_left;
-            return _z_wbuf_siphon(dst, src, to_copy);
+            return __zn_siphon_fragment(dst, src, to_copy);
         }
         else
         {
-            return 0;
+            return -1;
         }
     } while (1);
 }
 
+int __zn_link_can_send_vectored(const _zn_link_t *zl, const _zn_zenoh_message_t *z_msg)
+{
+    if (zl->writev_f == NULL)
+        return 0;
+
+    // Copying small payloads into the batch is cheaper than gathering them
+    return _ZN_MID(z_msg->header) == _ZN_MID_DATA && z_msg->body.data.payload.len > ZN_TX_VECTORED_THRESHOLD;
+}
+
+int __zn_link_can_batch_fragments(const _zn_link_t *zl)
+{
+    // The fragments are gathered straight from the user buffers, hence the vectored writes
+    return zl->writev_f != NULL && zl->writev_batch_f != NULL && zl->is_streamed == 0;
+}
+
+/*------------------ Fragment batching helpers ------------------*/
+void _zn_fragment_batch_init(_zn_fragment_batch_t *fb)
+{
+    fb->len = 0;
+    fb->made = 0;
+}
+
+_z_wbuf_t *_zn_fragment_batch_next(_zn_fragment_batch_t *fb)
+{
+    // Buffers are made on first use and reset by __unsafe_zn_prepare_wbuf afterwards
+    _z_wbuf_t *wbf = &fb->bufs[fb->len];
+    if (fb->len == fb->made)
+    {
+        *wbf = _z_wbuf_make(ZN_IOSLICE_SIZE, 1);
+        fb->made++;
+    }
+    fb->len++;
+    return wbf;
+}
+
+int _zn_fragment_batch_is_full(const _zn_fragment_batch_t *fb)
+{
+    return fb->len == _ZN_LINK_BATCH_MAX;
+}
+
+int _zn_fragment_batch_send(_zn_fragment_batch_t *fb, const _zn_link_t *zl)
+{
+    int res = _zn_link_send_wbufs(zl, fb->bufs, fb->len);
+    fb->len = 0;
+    return res;
+}
+
+void _zn_fragment_batch_clear(_zn_fragment_batch_t *fb)
+{
+    for (size_t i = 0; i < fb->made; i++)
+        _z_wbuf_clear(&fb->bufs[i]);
+    fb->len = 0;
+    fb->made = 0;
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - ztu->mutex_tx
+ */
+int __unsafe_zn_serialize_zenoh_frame_vectored(_z_wbuf_t *dst, const _zn_transport_message_t *f_hdr, const _zn_zenoh_message_t *z_msg, int is_streamed, size_t mtu)
+{
+    // The destination buffer is expandable, hence large payloads are wrapped rather than copied
+    __unsafe_zn_prepare_wbuf(dst, is_streamed);
+
+    _ZN_EC(_zn_transport_message_encode(dst, f_hdr))
+    _ZN_EC(_zn_zenoh_message_encode(dst, z_msg))
+
+    // The frame must fit in a single batch, otherwise it needs to be fragmented
+    if (_z_wbuf_len(dst) > mtu)
+        return -1;
+
+    __unsafe_zn_finalize_wbuf(dst, is_streamed);
+    return 0;
+}
+
 int _zn_send_t_msg(_zn_transport_t *zt, const _zn_transport_message_t *t_msg)
 {
     if (zt->type == _ZN_TRANSPORT_UNICAST_TYPE)
@@ -110,6 +230,17 @@ int _zn_send_t_msg(_zn_transport_t *zt, const _zn_transport_message_t *t_msg)
         return -1;
 }
 
+int _zn_flush(_zn_transport_t *zt)
+{
+    if (zt->type == _ZN_TRANSPORT_UNICAST_TYPE)
+        return _zn_unicast_flush(&zt->transport.unicast);
+    else if (zt->type == _ZN_TRANSPORT_MULTICAST_TYPE)
+        // Multicast transports do not batch, every message is sent right away
+        return 0;
+    else
+        return -1;
+}
+
 int _zn_link_send_t_msg(const _zn_link_t *zl, const _zn_transport_message_t *t_msg)
 {
     // Create and prepare the buffer to serialize the message on
@@ -15,25 +15,12 @@
 #include "zenoh-pico/session/utils.h"
 #include "zenoh-pico/transport/utils.h"
 #include "zenoh-pico/transport/link/rx.h"
+#include "zenoh-pico/transport/link/task/lease.h"
 #include "zenoh-pico/utils/logging.h"
 #include "zenoh-pico/config.h"
 
-_zn_transport_peer_entry_t *_zn_find_peer_entry(_zn_transport_peer_entry_list_t *l, z_bytes_t *remote_addr)
-{
-    for (; l != NULL; l = l->tail)
-    {
-        if (((_zn_transport_peer_entry_t *)l->val)->remote_addr.len != remote_addr->len)
-            continue;
-
-        if (memcmp(((_zn_transport_peer_entry_t *)l->val)->remote_addr.val, remote_addr->val, remote_addr->len) == 0)
-            return l->val;
-    }
-
-    return NULL;
-}
-
 /*------------------ Reception helper ------------------*/
-void _zn_multicast_recv_t_msg_na(_zn_transport_multicast_t *ztm, _zn_transport_message_result_t *r, z_bytes_t *addr)
+void _zn_multicast_recv_t_msg_na(_zn_transport_multicast_t *ztm, _zn_transport_message_result_t *r, _zn_link_addr_t *addr)
 {
     _Z_DEBUG(">> recv session msg\n");
     r->tag = _z_res_t_OK;
@@ -93,7 +80,7 @@ EXIT_SRCV_PROC:
     z_mutex_unlock(&ztm->mutex_rx);
 }
 
-_zn_transport_message_result_t _zn_multicast_recv_t_msg(_zn_transport_multicast_t *ztm, z_bytes_t *addr)
+_zn_transport_message_result_t _zn_multicast_recv_t_msg(_zn_transport_multicast_t *ztm, _zn_link_addr_t *addr)
 {
     _zn_transport_message_result_t r;
 
@@ -101,13 +88,45 @@ _zn_transport_message_result_t _zn_multicast_recv_t_msg(_zn_transport_multicast_
     return r;
 }
 
-int _zn_multicast_handle_transport_message(_zn_transport_multicast_t *ztm, _zn_transport_message_t *t_msg, z_bytes_t *addr)
+int __zn_multicast_update_rx_sn(_zn_transport_peer_entry_t *entry, uint8_t header, zn_priority_t priority, z_zint_t sn)
+{
+    // Each priority has its own SNs if the peer supports QoS
+    _zn_coundit_sn_t *sns = _zn_conduit_sn_list_get(&entry->sn_rx_sns, priority);
+    if (_ZN_HAS_FLAG(header, _ZN_FLAG_T_R))
+    {
+        // @TODO: amend once reliability is in place. For the time being only
+        //        monothonic SNs are ensured
+        if (_zn_sn_precedes(entry->sn_resolution_half, sns->reliable, sn))
+            sns->reliable = sn;
+        else
+        {
+            _zn_defrag_buf_reset(&entry->dbuf_reliable[priority]);
+            _Z_INFO("Reliable message dropped because it is out of order");
+            return -1;
+        }
+    }
+    else
+    {
+        if (_zn_sn_precedes(entry->sn_resolution_half, sns->best_effort, sn))
+            sns->best_effort = sn;
+        else
+        {
+            _zn_defrag_buf_reset(&entry->dbuf_best_effort[priority]);
+            _Z_INFO("Best effort message dropped because it is out of order");
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int _zn_multicast_handle_transport_message(_zn_transport_multicast_t *ztm, _zn_transport_message_t *t_msg, _zn_link_addr_t *addr)
 {
     // Acquire and keep the lock
     z_mutex_lock(&ztm->mutex_peer);
 
     // Mark the session that we have received data from this peer
-    _zn_transport_peer_entry_t *entry = _zn_find_peer_entry(ztm->peers, addr);
+    _zn_transport_peer_entry_t *entry = _zn_transport_peer_table_get(&ztm->peers, addr);
     switch (_ZN_MID(t_msg->header))
     {
     case _ZN_MID_SCOUT:
@@ -146,7 +165,7 @@ int _zn_multicast_handle_transport_message(_zn_transport_multicast_t *ztm, _zn_t
         if (entry == NULL) // New peer
         {
             entry = (_zn_transport_peer_entry_t *)z_malloc(sizeof(_zn_transport_peer_entry_t));
-            entry->remote_addr = _z_bytes_duplicate(addr);
+            entry->remote_addr = *addr;
             entry->remote_pid = _z_bytes_duplicate(&t_msg->body.join.pid);
             if (_ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_S))
                 entry->sn_resolution = t_msg->body.join.sn_resolution;
@@ -157,20 +176,19 @@ int _zn_multicast_handle_transport_message(_zn_transport_multicast_t *ztm, _zn_t
             _zn_conduit_sn_list_copy(&entry->sn_rx_sns, &t_msg->body.join.next_sns);
             _zn_conduit_sn_list_decrement(entry->sn_resolution, &entry->sn_rx_sns);
 
-#if ZN_DYNAMIC_MEMORY_ALLOCATION == 1
-            entry->dbuf_reliable = _z_wbuf_make(0, 1);
-            entry->dbuf_best_effort = _z_wbuf_make(0, 1);
-#else
-            entry->dbuf_reliable = _z_wbuf_make(ZN_FRAG_MAX_SIZE, 0);
-            entry->dbuf_best_effort = _z_wbuf_make(ZN_FRAG_MAX_SIZE, 0);
-#endif
+            // Slots of the shared pool are checked out on the first fragment
+            for (int i = 0; i < ZN_PRIORITIES_NUM; i++)
+            {
+                entry->dbuf_reliable[i] = _zn_defrag_buf_make(&ztm->dbuf_pool);
+                entry->dbuf_best_effort[i] = _zn_defrag_buf_make(&ztm->dbuf_pool);
+            }
 
             // Update lease time (set as ms during)
             entry->lease = t_msg->body.join.lease;
-            entry->next_lease = entry->lease;
             entry->received = 1;
 
-            ztm->peers = _zn_transport_peer_entry_list_push(ztm->peers, entry);
+            if (__unsafe_znp_multicast_lease_add(ztm, entry) != 0)
+                _zn_transport_peer_entry_elem_free((void **)&entry);
         }
         else // Existing peer
         {
@@ -179,7 +197,7 @@ int _zn_multicast_handle_transport_message(_zn_transport_multicast_t *ztm, _zn_t
             // Check if the sn resolution remains the same
             if (_ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_S) && (entry->sn_resolution != t_msg->body.join.sn_resolution))
             {
-                _zn_transport_peer_entry_list_drop_filter(ztm->peers, _zn_transport_peer_entry_eq, entry);
+                __unsafe_znp_multicast_lease_remove(ztm, entry);
                 break;
             }
 
@@ -188,7 +206,7 @@ int _zn_multicast_handle_transport_message(_zn_transport_multicast_t *ztm, _zn_t
             _zn_conduit_sn_list_decrement(entry->sn_resolution, &entry->sn_rx_sns);
 
             // Update lease time (set as ms during)
-            entry->lease = t_msg->body.join.lease;
+            __unsafe_znp_multicast_lease_set(ztm, entry, t_msg->body.join.lease);
         }
         break;
     }
@@ -206,7 +224,7 @@ int _zn_multicast_handle_transport_message(_zn_transport_multicast_t *ztm, _zn_t
             if (entry->remote_pid.len != t_msg->body.close.pid.len || memcmp(entry->remote_pid.val, t_msg->body.close.pid.val, entry->remote_pid.len) != 0)
                 break;
         }
-        ztm->peers = _zn_transport_peer_entry_list_drop_filter(ztm->peers, _zn_transport_peer_entry_eq, entry);
+        __unsafe_znp_multicast_lease_remove(ztm, entry);
 
         break;
     }
@@ -247,62 +265,30 @@ int _zn_multicast_handle_transport_message(_zn_transport_multicast_t *ztm, _zn_t
         entry->received = 1;
 
         // Check if the SN is correct
-        if (_ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_R))
-        {
-            // @TODO: amend once reliability is in place. For the time being only
-            //        monothonic SNs are ensured
-            if (_zn_sn_precedes(entry->sn_resolution_half, entry->sn_rx_sns.val.plain.reliable, t_msg->body.frame.sn))
-                entry->sn_rx_sns.val.plain.reliable = t_msg->body.frame.sn;
-            else
-            {
-                _z_wbuf_clear(&entry->dbuf_reliable);
-                _Z_INFO("Reliable message dropped because it is out of order");
-                break;
-            }
-        }
-        else
-        {
-            if (_zn_sn_precedes(entry->sn_resolution_half, entry->sn_rx_sns.val.plain.best_effort, t_msg->body.frame.sn))
-                entry->sn_rx_sns.val.plain.best_effort = t_msg->body.frame.sn;
-            else
-            {
-                _z_wbuf_clear(&entry->dbuf_best_effort);
-                _Z_INFO("Best effort message dropped because it is out of order");
-                break;
-            }
-        }
+        zn_priority_t priority = t_msg->body.frame.priority;
+        if (__zn_multicast_update_rx_sn(entry, t_msg->header, priority, t_msg->body.frame.sn) != 0)
+            break;
 
         if (_ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_F))
         {
             // Select the right defragmentation buffer
-            _z_wbuf_t *dbuf = _ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_R) ? &entry->dbuf_reliable : &entry->dbuf_best_effort;
+            _zn_defrag_buf_t *dbuf = _ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_R) ? &entry->dbuf_reliable[priority] : &entry->dbuf_best_effort[priority];
 
-            uint8_t drop = 0;
-            if (_z_wbuf_len(dbuf) + t_msg->body.frame.payload.fragment.len > ZN_FRAG_MAX_SIZE)
-            {
-                // Filling the wbuf capacity as a way to signling the last fragment to reset the dbuf
-                // Otherwise, last (smaller) fragments can be understood as a complete message
-                _z_wbuf_write_bytes(dbuf, t_msg->body.frame.payload.fragment.val, 0, _z_wbuf_space_left(dbuf));
-                drop = 1;
-            }
-            else
-            {
-                // Add the fragment to the defragmentation buffer
-                _z_wbuf_write_bytes(dbuf, t_msg->body.frame.payload.fragment.val, 0, t_msg->body.frame.payload.fragment.len);
-            }
+            // Add the fragment to the defragmentation buffer, the whole message is dropped on failure
+            int res = _zn_defrag_buf_push(dbuf, &t_msg->body.frame.payload.fragment);
 
             // Check if this is the last fragment
             if (_ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_E))
             {
-                // Drop message if it is bigger the max buffer size
-                if (drop == 1)
+                // Drop message if it could not be reassembled
+                if (res != 0)
                 {
-                    _z_wbuf_reset(dbuf);
+                    _zn_defrag_buf_reset(dbuf);
                     break;
                 }
 
                 // Convert the defragmentation buffer into a decoding buffer
-                _z_zbuf_t zbf = _z_wbuf_to_zbuf(dbuf);
+                _z_zbuf_t zbf = _zn_defrag_buf_to_zbuf(dbuf);
 
                 // Decode the zenoh message
                 _zn_zenoh_message_result_t r_zm = _zn_zenoh_message_decode(&zbf);
@@ -318,8 +304,8 @@ int _zn_multicast_handle_transport_message(_zn_transport_multicast_t *ztm, _zn_t
 
                 // Free the decoding buffer
                 _z_zbuf_clear(&zbf);
-                // Reset the defragmentation buffer
-                _z_wbuf_reset(dbuf);
+                // Return the defragmentation buffer to the pool
+                _zn_defrag_buf_reset(dbuf);
             }
         }
         else
@@ -342,3 +328,49 @@ int _zn_multicast_handle_transport_message(_zn_transport_multicast_t *ztm, _zn_t
     z_mutex_unlock(&ztm->mutex_peer);
     return _z_res_t_OK;
 }
+
+int _zn_multicast_handle_streamed_transport_message(_zn_transport_multicast_t *ztm, _zn_transport_message_t *t_msg, _z_zbuf_t *zbf, _zn_link_addr_t *addr)
+{
+    if (_ZN_MID(t_msg->header) != _ZN_MID_FRAME || _ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_F))
+        return _zn_multicast_handle_transport_message(ztm, t_msg, addr);
+
+    // Acquire and keep the lock
+    z_mutex_lock(&ztm->mutex_peer);
+
+    _Z_INFO("Received _ZN_FRAME message\n");
+    // Mark the session that we have received data from this peer
+    _zn_transport_peer_entry_t *entry = _zn_transport_peer_table_get(&ztm->peers, addr);
+    if (entry == NULL)
+        goto EXIT_FRAME;
+    entry->received = 1;
+
+    // Check if the SN is correct, otherwise skip the whole frame
+    if (__zn_multicast_update_rx_sn(entry, t_msg->header, t_msg->body.frame.priority, t_msg->body.frame.sn) != 0)
+        goto EXIT_FRAME;
+
+    // Decode and handle the zenoh messages, one by one
+    _zn_zenoh_message_result_t r_zm;
+    while (_z_zbuf_len(zbf))
+    {
+        // Mark the reading position of the iobfer
+        size_t r_pos = _z_zbuf_get_rpos(zbf);
+        _zn_zenoh_message_decode_na(zbf, &r_zm);
+        if (r_zm.tag != _z_res_t_OK)
+        {
+            // Restore the reading position of the iobfer
+            _z_zbuf_set_rpos(zbf, r_pos);
+            break;
+        }
+
+        _zn_handle_zenoh_message(ztm->session, &r_zm.value.zenoh_message);
+        _zn_z_msg_clear(&r_zm.value.zenoh_message);
+    }
+
+    z_mutex_unlock(&ztm->mutex_peer);
+    return _z_res_t_OK;
+
+EXIT_FRAME:
+    _z_zbuf_set_rpos(zbf, _z_zbuf_get_wpos(zbf));
+    z_mutex_unlock(&ztm->mutex_peer);
+    return _z_res_t_OK;
+}
@@ -18,142 +18,178 @@
 #include "zenoh-pico/transport/link/task/lease.h"
 #include "zenoh-pico/utils/logging.h"
 
-z_zint_t _zn_get_minimum_lease(_zn_transport_peer_entry_list_t *peers, z_zint_t local_lease)
+int _znp_multicast_send_keep_alive(_zn_transport_multicast_t *ztm)
 {
-    z_zint_t ret = local_lease;
+    z_bytes_t pid = _z_bytes_wrap(((zn_session_t *)ztm->session)->tp_manager->local_pid.val, ((zn_session_t *)ztm->session)->tp_manager->local_pid.len);
+    _zn_transport_message_t t_msg = _zn_t_msg_make_keep_alive(pid);
 
-    _zn_transport_peer_entry_list_t *it = peers;
-    while (it != NULL)
-    {
-        z_zint_t lease = ((_zn_transport_peer_entry_t *)it->val)->lease;
-        if (lease < ret)
-            ret = lease;
+    return _zn_multicast_send_t_msg(ztm, &t_msg);
+}
+
+z_zint_t _znp_multicast_lease_now(_zn_transport_multicast_t *ztm)
+{
+    return z_clock_elapsed_ms(&ztm->lease_epoch);
+}
 
-        it = it->tail;
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - ztm->mutex_peer
+ */
+z_zint_t __unsafe_znp_multicast_min_lease(_zn_transport_multicast_t *ztm)
+{
+    // Walk the peers only once the one holding the shortest lease is gone
+    if (ztm->is_peers_min_lease_stale == 1)
+    {
+        ztm->peers_min_lease = SIZE_MAX;
+        for (size_t i = 0; i < _zn_transport_peer_table_capacity(&ztm->peers); i++)
+        {
+            _zn_transport_peer_entry_t *entry = _zn_transport_peer_table_at(&ztm->peers, i);
+            if (entry != NULL && entry->lease < ztm->peers_min_lease)
+                ztm->peers_min_lease = entry->lease;
+        }
+        ztm->is_peers_min_lease_stale = 0;
     }
 
-    return ret;
+    return ztm->peers_min_lease < ztm->lease ? ztm->peers_min_lease : ztm->lease;
 }
 
-z_zint_t _zn_get_next_lease(_zn_transport_peer_entry_list_t *peers)
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - ztm->mutex_peer
+ */
+int __unsafe_znp_multicast_lease_add(_zn_transport_multicast_t *ztm, _zn_transport_peer_entry_t *entry)
 {
-    z_zint_t ret = SIZE_MAX;
+    entry->next_lease = _znp_multicast_lease_now(ztm) + entry->lease;
+    if (_zn_transport_peer_heap_push(&ztm->lease_heap, entry) != 0)
+        return -1;
 
-    _zn_transport_peer_entry_list_t *it = peers;
-    while (it != NULL)
+    if (_zn_transport_peer_table_insert(&ztm->peers, entry) != 0)
     {
-        z_zint_t next_lease = ((_zn_transport_peer_entry_t *)it->val)->next_lease;
-        if (next_lease < ret)
-            ret = next_lease;
-
-        it = it->tail;
+        _zn_transport_peer_heap_remove(&ztm->lease_heap, entry);
+        return -1;
     }
 
-    return ret;
+    if (entry->lease < ztm->peers_min_lease)
+        ztm->peers_min_lease = entry->lease;
+
+    return 0;
 }
 
-int _znp_multicast_send_keep_alive(_zn_transport_multicast_t *ztm)
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - ztm->mutex_peer
+ */
+void __unsafe_znp_multicast_lease_set(_zn_transport_multicast_t *ztm, _zn_transport_peer_entry_t *entry, z_zint_t lease)
 {
-    z_bytes_t pid = _z_bytes_wrap(((zn_session_t *)ztm->session)->tp_manager->local_pid.val, ((zn_session_t *)ztm->session)->tp_manager->local_pid.len);
-    _zn_transport_message_t t_msg = _zn_t_msg_make_keep_alive(pid);
+    // The current deadline is kept, the new lease applies from the next one
+    if (lease < ztm->peers_min_lease)
+        ztm->peers_min_lease = lease;
+    else if (lease != entry->lease && entry->lease == ztm->peers_min_lease)
+        ztm->is_peers_min_lease_stale = 1;
 
-    return _zn_multicast_send_t_msg(ztm, &t_msg);
+    entry->lease = lease;
 }
 
-void *_znp_multicast_lease_task(void *arg)
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - ztm->mutex_peer
+ */
+void __unsafe_znp_multicast_lease_remove(_zn_transport_multicast_t *ztm, _zn_transport_peer_entry_t *entry)
 {
-    _zn_transport_multicast_t *ztm = (_zn_transport_multicast_t *)arg;
+    if (entry->lease == ztm->peers_min_lease)
+        ztm->is_peers_min_lease_stale = 1;
 
-    ztm->lease_task_running = 1;
+    _zn_transport_peer_heap_remove(&ztm->lease_heap, entry);
+    _zn_transport_peer_table_remove(&ztm->peers, entry);
+}
+
+void _znp_multicast_lease_init(_zn_transport_multicast_t *ztm, _znp_multicast_lease_timers_t *timers)
+{
     ztm->transmitted = 0;
 
-    // From all peers, get the next lease time (minimum)
-    z_zint_t next_lease = _zn_get_minimum_lease(ztm->peers, ztm->lease);
-    z_zint_t next_keep_alive = next_lease / ZN_TRANSPORT_LEASE_EXPIRE_FACTOR;
-    z_zint_t next_join = ZN_JOIN_INTERVAL;
+    z_zint_t now = _znp_multicast_lease_now(ztm);
+    z_mutex_lock(&ztm->mutex_peer);
+    timers->next_keep_alive = now + __unsafe_znp_multicast_min_lease(ztm) / ZN_TRANSPORT_LEASE_EXPIRE_FACTOR;
+    z_mutex_unlock(&ztm->mutex_peer);
+    timers->next_join = now + ZN_JOIN_INTERVAL;
+}
 
-    _zn_transport_peer_entry_list_t *it = NULL;
-    while (ztm->lease_task_running)
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - ztm->mutex_peer
+ */
+void __unsafe_znp_multicast_lease_process(_zn_transport_multicast_t *ztm, _znp_multicast_lease_timers_t *timers, z_zint_t now, z_zint_t *interval)
+{
+    // Only the peers whose lease is over are visited, the earliest first
+    _zn_transport_peer_entry_t *entry = _zn_transport_peer_heap_top(&ztm->lease_heap);
+    while (entry != NULL && entry->next_lease <= now)
     {
-        z_mutex_lock(&ztm->mutex_peer);
-        if (next_lease <= 0)
+        if (entry->received == 1)
         {
-            it = ztm->peers;
-            while (it != NULL)
-            {
-                _zn_transport_peer_entry_t *entry = it->val;
-                if (entry->received == 1)
-                {
-                    // Reset the lease parameters
-                    entry->received = 0;
-                    entry->next_lease = entry->lease;
-                    it = it->tail;
-                }
-                else
-                {
-                    _Z_INFO("Remove peer from know list because it has expired after %zums\n", entry->lease);
-                    ztm->peers = _zn_transport_peer_entry_list_drop_filter(ztm->peers, _zn_transport_peer_entry_eq, entry);
-                    it = ztm->peers;
-                }
-            }
+            // Reset the lease parameters
+            entry->received = 0;
+            entry->next_lease = now + entry->lease;
+            _zn_transport_peer_heap_update(&ztm->lease_heap, entry);
         }
-
-        if (next_join <= 0)
+        else
         {
-            _znp_multicast_send_join(ztm);
-            ztm->transmitted = 1;
-
-            // Reset the join parameters
-            next_join = ZN_JOIN_INTERVAL;
+            _Z_INFO("Remove peer from know list because it has expired after %zums\n", entry->lease);
+            __unsafe_znp_multicast_lease_remove(ztm, entry);
         }
 
-        if (next_keep_alive <= 0)
-        {
-            // Check if need to send a keep alive
-            if (ztm->transmitted == 0)
-                _znp_multicast_send_keep_alive(ztm);
+        entry = _zn_transport_peer_heap_top(&ztm->lease_heap);
+    }
 
-            // Reset the keep alive parameters
-            ztm->transmitted = 0;
-            next_keep_alive = _zn_get_minimum_lease(ztm->peers, ztm->lease) / ZN_TRANSPORT_LEASE_EXPIRE_FACTOR;
-        }
+    if (timers->next_join <= now)
+    {
+        _znp_multicast_send_join(ztm);
+        ztm->transmitted = 1;
 
-        // Compute the target interval to sleep
-        z_zint_t interval;
-        if (next_lease > 0)
-        {
-            interval = next_lease;
-            if (next_keep_alive < interval)
-                interval = next_keep_alive;
-            if (next_join < interval)
-                interval = next_join;
-        }
-        else
-        {
-            interval = next_keep_alive;
-            if (next_join < interval)
-                interval = next_join;
-        }
+        // Reset the join parameters
+        timers->next_join = now + ZN_JOIN_INTERVAL;
+    }
 
-        z_mutex_unlock(&ztm->mutex_peer);
+    if (timers->next_keep_alive <= now)
+    {
+        // Check if need to send a keep alive
+        if (ztm->transmitted == 0)
+            _znp_multicast_send_keep_alive(ztm);
 
-        // The keep alive and lease intervals are expressed in milliseconds
-        z_sleep_ms(interval);
+        // Reset the keep alive parameters
+        ztm->transmitted = 0;
+        timers->next_keep_alive = now + __unsafe_znp_multicast_min_lease(ztm) / ZN_TRANSPORT_LEASE_EXPIRE_FACTOR;
+    }
 
-        // Decrement all intervals
+    // Sleep until the earliest deadline
+    z_zint_t next = timers->next_join < timers->next_keep_alive ? timers->next_join : timers->next_keep_alive;
+    if (entry != NULL && entry->next_lease < next)
+        next = entry->next_lease;
+    *interval = next > now ? next - now : 0;
+}
+
+void *_znp_multicast_lease_task(void *arg)
+{
+    _zn_transport_multicast_t *ztm = (_zn_transport_multicast_t *)arg;
+
+    ztm->lease_task_running = 1;
+
+    _znp_multicast_lease_timers_t timers;
+    _znp_multicast_lease_init(ztm, &timers);
+    while (ztm->lease_task_running)
+    {
+        z_zint_t interval;
         z_mutex_lock(&ztm->mutex_peer);
-        it = ztm->peers;
-        while (it != NULL)
-        {
-            _zn_transport_peer_entry_t *entry = it->val;
-            entry->next_lease -= interval;
-            it = it->tail;
-        }
-        next_lease = _zn_get_next_lease(ztm->peers);
-        next_keep_alive -= interval;
-        next_join -= interval;
+        __unsafe_znp_multicast_lease_process(ztm, &timers, _znp_multicast_lease_now(ztm), &interval);
         z_mutex_unlock(&ztm->mutex_peer);
+
+        // The keep alive and lease intervals are expressed in milliseconds
+        z_sleep_ms(interval);
     }
 
     return 0;
-}
\ No newline at end of file
+}
@@ -18,7 +18,8 @@
 
 int _znp_multicast_read(_zn_transport_multicast_t *ztm)
 {
-    z_bytes_t addr;
+    _zn_link_addr_t addr;
+    _zn_link_addr_reset(&addr);
     _zn_transport_message_result_t r_s = _zn_multicast_recv_t_msg(ztm, &addr);
     if (r_s.tag == _z_res_t_ERR)
         goto ERR;
@@ -32,21 +33,76 @@ ERR:
     return _z_res_t_ERR;
 }
 
+/**
+ * Decode and handle all the transport messages held by a buffer, received from ``addr``.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - ztm->mutex_rx
+ */
+int __unsafe_znp_multicast_handle_zbuf(_zn_transport_multicast_t *ztm, _z_zbuf_t *zbuf, _zn_link_addr_t *addr)
+{
+    _zn_transport_message_result_t r;
+
+    while (_z_zbuf_len(zbuf) > 0)
+    {
+        // Decode one session message, the zenoh messages of a frame are decoded while handling it
+        _zn_transport_message_decode_streamed_na(zbuf, &r);
+
+        if (r.tag == _z_res_t_OK)
+        {
+            int res = _zn_multicast_handle_streamed_transport_message(ztm, &r.value.transport_message, zbuf, addr);
+
+            if (res == _z_res_t_OK)
+                _zn_t_msg_clear(&r.value.transport_message);
+            else
+                return -1;
+        }
+        else
+        {
+            _Z_ERROR("Connection closed due to malformed message\n");
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Decode and handle the transport messages held by the datagrams of the last batched read.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - ztm->mutex_rx
+ */
+int __unsafe_znp_multicast_handle_rx_batch(_zn_transport_multicast_t *ztm)
+{
+    _zn_link_rx_batch_t *batch = ztm->rx_batch;
+    for (size_t i = 0; i < batch->len; i++)
+    {
+        _z_zbuf_t zbuf;
+        zbuf.ios = _z_iosli_wrap(batch->bufs[i], batch->lens[i], 0, batch->lens[i]);
+        if (__unsafe_znp_multicast_handle_zbuf(ztm, &zbuf, &batch->addrs[i]) != 0)
+            return -1;
+    }
+
+    return 0;
+}
+
 void *_znp_multicast_read_task(void *arg)
 {
     _zn_transport_multicast_t *ztm = (_zn_transport_multicast_t *)arg;
 
     ztm->read_task_running = 1;
 
-    _zn_transport_message_result_t r;
-
     // Acquire and keep the lock
     z_mutex_lock(&ztm->mutex_rx);
 
     // Prepare the buffer
     _z_zbuf_reset(&ztm->zbuf);
 
-    z_bytes_t addr = _z_bytes_wrap(NULL, 0);
+    _zn_link_addr_t addr;
+    _zn_link_addr_reset(&addr);
     while (ztm->read_task_running)
     {
         // Read bytes from socket to the main buffer
@@ -57,10 +113,7 @@ void *_znp_multicast_read_task(void *arg)
             {
                 _zn_link_recv_zbuf(ztm->link, &ztm->zbuf, &addr);
                 if (_z_zbuf_len(&ztm->zbuf) < _ZN_MSG_LEN_ENC_SIZE)
-                {
-                    _z_bytes_clear(&addr);
                     continue;
-                }
             }
 
             for (int i = 0; i < _ZN_MSG_LEN_ENC_SIZE; i++)
@@ -76,6 +129,16 @@ void *_znp_multicast_read_task(void *arg)
                 }
             }
         }
+        else if (ztm->rx_batch != NULL)
+        {
+            // Read several datagrams at once, each of them holds whole messages
+            if (_zn_link_recv_batch(ztm->link, ztm->rx_batch, 1) == SIZE_MAX)
+                continue;
+
+            if (__unsafe_znp_multicast_handle_rx_batch(ztm) != 0)
+                goto EXIT_RECV_LOOP;
+            continue;
+        }
         else
         {
             to_read = _zn_link_recv_zbuf(ztm->link, &ztm->zbuf, &addr);
@@ -85,30 +148,8 @@ void *_znp_multicast_read_task(void *arg)
 
         // Wrap the main buffer for to_read bytes
         _z_zbuf_t zbuf = _z_zbuf_view(&ztm->zbuf, to_read);
-
-        while (_z_zbuf_len(&zbuf) > 0)
-        {
-            // Decode one session message
-            _zn_transport_message_decode_na(&zbuf, &r);
-
-            if (r.tag == _z_res_t_OK)
-            {
-                int res = _zn_multicast_handle_transport_message(ztm, &r.value.transport_message, &addr);
-
-                if (res == _z_res_t_OK)
-                {
-                    _zn_t_msg_clear(&r.value.transport_message);
-                    _z_bytes_clear(&addr);
-                }
-                else
-                    goto EXIT_RECV_LOOP;
-            }
-            else
-            {
-                _Z_ERROR("Connection closed due to malformed message\n");
-                goto EXIT_RECV_LOOP;
-            }
-        }
+        if (__unsafe_znp_multicast_handle_zbuf(ztm, &zbuf, &addr) != 0)
+            goto EXIT_RECV_LOOP;
 
         // Move the read position of the read buffer
         _z_zbuf_set_rpos(&ztm->zbuf, _z_zbuf_get_rpos(&ztm->zbuf) + to_read);
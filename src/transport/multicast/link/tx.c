@@ -22,19 +22,20 @@
  * Make sure that the following mutexes are locked before calling this function:
  *  - ztm->mutex_inner
  */
-z_zint_t __unsafe_zn_multicast_get_sn(_zn_transport_multicast_t *ztm, zn_reliability_t reliability)
+z_zint_t __unsafe_zn_multicast_get_sn(_zn_transport_multicast_t *ztm, zn_reliability_t reliability, zn_priority_t priority)
 {
     z_zint_t sn;
+    _zn_coundit_sn_t *sns = _zn_conduit_sn_list_get(&ztm->sn_tx_sns, priority);
     // Get the sequence number and update it in modulo operation
     if (reliability == zn_reliability_t_RELIABLE)
     {
-        sn = ztm->sn_tx_reliable;
-        ztm->sn_tx_reliable = (ztm->sn_tx_reliable + 1) % ztm->sn_resolution;
+        sn = sns->reliable;
+        sns->reliable = (sns->reliable + 1) % ztm->sn_resolution;
     }
     else
     {
-        sn = ztm->sn_tx_best_effort;
-        ztm->sn_tx_best_effort = (ztm->sn_tx_best_effort + 1) % ztm->sn_resolution;
+        sn = sns->best_effort;
+        sns->best_effort = (sns->best_effort + 1) % ztm->sn_resolution;
     }
     return sn;
 }
@@ -71,38 +72,68 @@ int _zn_multicast_send_t_msg(_zn_transport_multicast_t *ztm, const _zn_transport
     return res;
 }
 
-int _zn_multicast_send_z_msg(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl)
+int _zn_multicast_send_z_msg(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl, zn_priority_t priority)
 {
     _Z_DEBUG(">> send zenoh message\n");
 
     _zn_transport_multicast_t *ztm = &zn->tp->transport.multicast;
 
-    // Acquire the lock and drop the message if needed
+    // Wait for the turn of the priority and drop the message if needed
     if (cong_ctrl == zn_congestion_control_t_BLOCK)
     {
-        z_mutex_lock(&ztm->mutex_tx);
+        _zn_tx_scheduler_acquire(&ztm->tx_scheduler, priority);
     }
     else
     {
-        int locked = z_mutex_trylock(&ztm->mutex_tx);
-        if (locked != 0)
+        int acquired = _zn_tx_scheduler_try_acquire(&ztm->tx_scheduler, priority);
+        if (acquired != 0)
         {
             _Z_INFO("Dropping zenoh message because of congestion control\n");
-            // We failed to acquire the lock, drop the message
+            // We failed to get the turn, drop the message
             return 0;
         }
     }
+    z_mutex_lock(&ztm->mutex_tx);
+
+    // Without QoS all the priorities share the default conduit
+    if (ztm->sn_tx_sns.is_qos == 0)
+        priority = ZN_PRIORITY_DEFAULT;
+
+    int res = 0;
 
     // Prepare the buffer eventually reserving space for the message length
     __unsafe_zn_prepare_wbuf(&ztm->wbuf, ztm->link->is_streamed);
 
     // Get the next sequence number
-    z_zint_t sn = __unsafe_zn_multicast_get_sn(ztm, reliability);
+    z_zint_t sn = __unsafe_zn_multicast_get_sn(ztm, reliability, priority);
     // Create the frame header that carries the zenoh message
-    _zn_transport_message_t t_msg = __zn_frame_header(reliability, 0, 0, sn);
+    _zn_transport_message_t t_msg = __zn_frame_header(reliability, priority, 0, 0, sn);
+
+    // Messages known not to fit in the batch are fragmented straight away
+    int is_fragmented = __zn_zenoh_message_exceeds(z_msg, _z_wbuf_space_left(&ztm->wbuf));
+
+    // Send large payloads straight from the user buffer if the link supports vectored writes
+    if (!is_fragmented && __zn_link_can_send_vectored(ztm->link, z_msg))
+    {
+        _z_wbuf_t vbf = _z_wbuf_make(ZN_IOSLICE_SIZE, 1);
+        res = __unsafe_zn_serialize_zenoh_frame_vectored(&vbf, &t_msg, z_msg, ztm->link->is_streamed, _z_wbuf_capacity(&ztm->wbuf));
+        if (res == 0)
+        {
+            // Send the wbuf on the socket
+            res = _zn_link_send_wbuf(ztm->link, &vbf);
+            if (res == 0)
+                ztm->transmitted = 1;
+
+            _z_wbuf_clear(&vbf);
+            goto EXIT_ZSND_PROC;
+        }
+
+        // The message does not fit in a single batch, fall back to fragmentation
+        _z_wbuf_clear(&vbf);
+    }
 
     // Encode the frame header
-    int res = _zn_transport_message_encode(&ztm->wbuf, &t_msg);
+    res = _zn_transport_message_encode(&ztm->wbuf, &t_msg);
     if (res != 0)
     {
         _Z_INFO("Dropping zenoh message because the session frame can not be encoded\n");
@@ -110,7 +141,7 @@ int _zn_multicast_send_z_msg(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_re
     }
 
     // Encode the zenoh message
-    res = _zn_zenoh_message_encode(&ztm->wbuf, z_msg);
+    res = is_fragmented ? -1 : _zn_zenoh_message_encode(&ztm->wbuf, z_msg);
     if (res == 0)
     {
         // Write the message legnth in the reserved space if needed
@@ -124,10 +155,19 @@ int _zn_multicast_send_z_msg(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_re
     else
     {
         // The message does not fit in the current batch, let's fragment it
-        // Create an expandable wbuf for fragmentation
-        _z_wbuf_t fbf = _z_wbuf_make(ZN_IOSLICE_SIZE, 1);
+        // Fragments are gathered straight from the user buffers if the link supports vectored writes,
+        // otherwise they are copied into the batch
+        size_t mtu = _z_wbuf_capacity(&ztm->wbuf);
+        _z_wbuf_t vbf = _z_wbuf_make(ZN_IOSLICE_SIZE, 1);
+        _z_wbuf_t *dst = ztm->link->writev_f != NULL ? &vbf : &ztm->wbuf;
 
-        // Encode the message on the expandable wbuf
+        // Several fragments are written at once if the link supports batched writes
+        int is_batching = __zn_link_can_batch_fragments(ztm->link);
+        _zn_fragment_batch_t fb;
+        _zn_fragment_batch_init(&fb);
+
+        // Encode the message once on an expandable wbuf: large payloads are referenced, not copied
+        _z_wbuf_t fbf = _z_wbuf_make(ZN_IOSLICE_SIZE, 1);
         res = _zn_zenoh_message_encode(&fbf, z_msg);
         if (res != 0)
         {
@@ -141,14 +181,17 @@ int _zn_multicast_send_z_msg(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_re
         {
             // Get the fragment sequence number
             if (!is_first)
-                sn = __unsafe_zn_multicast_get_sn(ztm, reliability);
+                sn = __unsafe_zn_multicast_get_sn(ztm, reliability, priority);
             is_first = 0;
 
             // Clear the buffer for serialization
-            __unsafe_zn_prepare_wbuf(&ztm->wbuf, ztm->link->is_streamed);
+            // The slices referencing the user buffers are dropped, the allocated ones are reused
+            if (is_batching)
+                dst = _zn_fragment_batch_next(&fb);
+            __unsafe_zn_prepare_wbuf(dst, ztm->link->is_streamed);
 
             // Serialize one fragment
-            res = __unsafe_zn_serialize_zenoh_fragment(&ztm->wbuf, &fbf, reliability, sn);
+            res = __unsafe_zn_serialize_zenoh_fragment(dst, &fbf, reliability, priority, sn, mtu);
             if (res != 0)
             {
                 _Z_INFO("Dropping zenoh message because it can not be fragmented\n");
@@ -156,10 +199,15 @@ int _zn_multicast_send_z_msg(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_re
             }
 
             // Write the message length in the reserved space if needed
-            __unsafe_zn_finalize_wbuf(&ztm->wbuf, ztm->link->is_streamed);
+            __unsafe_zn_finalize_wbuf(dst, ztm->link->is_streamed);
 
-            // Send the wbuf on the socket
-            res = _zn_link_send_wbuf(ztm->link, &ztm->wbuf);
+            // Send the wbuf on the socket, batched fragments once there is no more room for them
+            if (!is_batching)
+                res = _zn_link_send_wbuf(ztm->link, dst);
+            else if (_zn_fragment_batch_is_full(&fb) || _z_wbuf_len(&fbf) == 0)
+                res = _zn_fragment_batch_send(&fb, ztm->link);
+            else
+                continue;
             if (res != 0)
             {
                 _Z_INFO("Dropping zenoh message because it can not sent\n");
@@ -171,13 +219,109 @@ int _zn_multicast_send_z_msg(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_re
         }
 
     EXIT_FRAG_PROC:
-        // Free the fragmentation buffer memory
+        // Free the fragmentation buffers memory
+        _zn_fragment_batch_clear(&fb);
+        _z_wbuf_clear(&vbf);
         _z_wbuf_clear(&fbf);
     }
 
 EXIT_ZSND_PROC:
-    // Release the lock
+    // Release the lock and hand the turn over
     z_mutex_unlock(&ztm->mutex_tx);
+    _zn_tx_scheduler_release(&ztm->tx_scheduler);
 
     return res;
-}
\ No newline at end of file
+}
+
+uint8_t *_zn_multicast_loan_z_msg(zn_session_t *zn, const _zn_zenoh_message_t *z_msg, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl, zn_priority_t priority)
+{
+    _Z_DEBUG(">> loan zenoh message\n");
+
+    _zn_transport_multicast_t *ztm = &zn->tp->transport.multicast;
+
+    // Wait for the turn of the priority and drop the message if needed
+    if (cong_ctrl == zn_congestion_control_t_BLOCK)
+    {
+        _zn_tx_scheduler_acquire(&ztm->tx_scheduler, priority);
+    }
+    else
+    {
+        int acquired = _zn_tx_scheduler_try_acquire(&ztm->tx_scheduler, priority);
+        if (acquired != 0)
+        {
+            _Z_INFO("Dropping zenoh message because of congestion control\n");
+            // We failed to get the turn, drop the message
+            return NULL;
+        }
+    }
+    z_mutex_lock(&ztm->mutex_tx);
+
+    // Without QoS all the priorities share the default conduit
+    if (ztm->sn_tx_sns.is_qos == 0)
+        priority = ZN_PRIORITY_DEFAULT;
+
+    // Prepare the buffer eventually reserving space for the message length
+    __unsafe_zn_prepare_wbuf(&ztm->wbuf, ztm->link->is_streamed);
+
+    // Get the next sequence number, restoring it if the loan fails
+    _zn_coundit_sn_t sns = *_zn_conduit_sn_list_get(&ztm->sn_tx_sns, priority);
+    z_zint_t sn = __unsafe_zn_multicast_get_sn(ztm, reliability, priority);
+    // Create the frame header that carries the zenoh message
+    _zn_transport_message_t t_msg = __zn_frame_header(reliability, priority, 0, 0, sn);
+
+    // Encode the frame header and the zenoh message up to its payload
+    uint8_t *payload = NULL;
+    if (_zn_transport_message_encode(&ztm->wbuf, &t_msg) != 0 || _zn_zenoh_message_encode_loan(&ztm->wbuf, z_msg, &payload) != 0)
+    {
+        _Z_INFO("Dropping zenoh message because the payload does not fit in a single batch\n");
+        *_zn_conduit_sn_list_get(&ztm->sn_tx_sns, priority) = sns;
+        z_mutex_unlock(&ztm->mutex_tx);
+        _zn_tx_scheduler_release(&ztm->tx_scheduler);
+        return NULL;
+    }
+
+    // Keep what is needed to revert the message if it is aborted
+    ztm->loan_priority = priority;
+    ztm->loan_sns = sns;
+
+    // The lock and the turn are released when the message is committed or aborted
+    return payload;
+}
+
+int _zn_multicast_commit_z_msg(zn_session_t *zn)
+{
+    _Z_DEBUG(">> commit zenoh message\n");
+
+    _zn_transport_multicast_t *ztm = &zn->tp->transport.multicast;
+
+    // Write the message length in the reserved space if needed
+    __unsafe_zn_finalize_wbuf(&ztm->wbuf, ztm->link->is_streamed);
+
+    // Send the wbuf on the socket
+    int res = _zn_link_send_wbuf(ztm->link, &ztm->wbuf);
+    if (res == 0)
+        ztm->transmitted = 1;
+
+    // Release the lock and the turn acquired when loaning the message
+    z_mutex_unlock(&ztm->mutex_tx);
+    _zn_tx_scheduler_release(&ztm->tx_scheduler);
+
+    return res;
+}
+
+int _zn_multicast_abort_z_msg(zn_session_t *zn)
+{
+    _Z_DEBUG(">> abort zenoh message\n");
+
+    _zn_transport_multicast_t *ztm = &zn->tp->transport.multicast;
+
+    // Drop the loaned message and give its sequence number back
+    __unsafe_zn_prepare_wbuf(&ztm->wbuf, ztm->link->is_streamed);
+    *_zn_conduit_sn_list_get(&ztm->sn_tx_sns, ztm->loan_priority) = ztm->loan_sns;
+
+    // Release the lock and the turn acquired when loaning the message
+    z_mutex_unlock(&ztm->mutex_tx);
+    _zn_tx_scheduler_release(&ztm->tx_scheduler);
+
+    return 0;
+}
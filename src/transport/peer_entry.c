@@ -17,17 +17,24 @@
 
 void _zn_transport_peer_entry_clear(_zn_transport_peer_entry_t *src)
 {
-    _z_wbuf_clear(&src->dbuf_reliable);
-    _z_wbuf_clear(&src->dbuf_best_effort);
+    for (int i = 0; i < ZN_PRIORITIES_NUM; i++)
+    {
+        _zn_defrag_buf_reset(&src->dbuf_reliable[i]);
+        _zn_defrag_buf_reset(&src->dbuf_best_effort[i]);
+    }
 
     _z_bytes_clear(&src->remote_pid);
-    _z_bytes_clear(&src->remote_addr);
+    _zn_link_addr_reset(&src->remote_addr);
 }
 
 void _zn_transport_peer_entry_copy(_zn_transport_peer_entry_t *dst, const _zn_transport_peer_entry_t *src)
 {
-    _z_wbuf_copy(&dst->dbuf_reliable, &src->dbuf_reliable);
-    _z_wbuf_copy(&dst->dbuf_best_effort, &src->dbuf_best_effort);
+    // Slots are not shared, a message being reassembled is not copied
+    for (int i = 0; i < ZN_PRIORITIES_NUM; i++)
+    {
+        dst->dbuf_reliable[i] = _zn_defrag_buf_make(src->dbuf_reliable[i].pool);
+        dst->dbuf_best_effort[i] = _zn_defrag_buf_make(src->dbuf_best_effort[i].pool);
+    }
 
     dst->sn_resolution = src->sn_resolution;
     dst->sn_resolution_half = src->sn_resolution_half;
@@ -35,10 +42,11 @@ void _zn_transport_peer_entry_copy(_zn_transport_peer_entry_t *dst, const _zn_tr
 
     dst->lease = src->lease;
     dst->next_lease = src->next_lease;
+    dst->lease_index = src->lease_index;
     dst->received = src->received;
 
     _z_bytes_copy(&dst->remote_pid, &src->remote_pid);
-    _z_bytes_copy(&dst->remote_addr, &src->remote_addr);
+    dst->remote_addr = src->remote_addr;
 }
 
 size_t _zn_transport_peer_entry_size(const _zn_transport_peer_entry_t *src)
@@ -57,3 +65,242 @@ int _zn_transport_peer_entry_eq(const _zn_transport_peer_entry_t *left, const _z
 
     return 1; // True
 }
+
+/*------------------ Peer table ------------------*/
+_zn_transport_peer_table_t _zn_transport_peer_table_make(size_t capacity)
+{
+    _zn_transport_peer_table_t t;
+    t.capacity = capacity;
+    t.len = 0;
+    t.used = 0;
+    t.slots = (_zn_transport_peer_slot_t *)z_malloc(capacity * sizeof(_zn_transport_peer_slot_t));
+    if (t.slots == NULL)
+        t.capacity = 0;
+    else
+        memset(t.slots, 0, capacity * sizeof(_zn_transport_peer_slot_t));
+
+    return t;
+}
+
+void _zn_transport_peer_table_clear(_zn_transport_peer_table_t *t)
+{
+    for (size_t i = 0; i < t->capacity; i++)
+    {
+        if (t->slots[i].entry != NULL)
+            _zn_transport_peer_entry_elem_free((void **)&t->slots[i].entry);
+    }
+
+    z_free(t->slots);
+    t->slots = NULL;
+    t->capacity = 0;
+    t->len = 0;
+    t->used = 0;
+}
+
+// Return the slot of the address, or the first free slot of its probe chain if it is not in the table
+_zn_transport_peer_slot_t *__zn_transport_peer_table_find(const _zn_transport_peer_table_t *t, const _zn_link_addr_t *addr)
+{
+    size_t mask = t->capacity - 1;
+    for (size_t i = _zn_link_addr_hash(addr) & mask;; i = (i + 1) & mask)
+    {
+        _zn_transport_peer_slot_t *slot = &t->slots[i];
+        if (slot->is_used == 0)
+            return slot;
+        if (slot->entry != NULL && _zn_link_addr_eq(&slot->addr, addr))
+            return slot;
+    }
+}
+
+int __zn_transport_peer_table_rehash(_zn_transport_peer_table_t *t)
+{
+    // Double the capacity if more than half of it would be taken by the peers, otherwise only drop the removed slots
+    size_t capacity = (t->len + 1) * 2 > t->capacity ? t->capacity * 2 : t->capacity;
+    if (capacity == 0)
+        capacity = ZN_MULTICAST_PEER_TABLE_CAPACITY;
+    _zn_transport_peer_table_t r = _zn_transport_peer_table_make(capacity);
+    if (r.slots == NULL)
+        return -1;
+
+    for (size_t i = 0; i < t->capacity; i++)
+    {
+        _zn_transport_peer_slot_t *slot = &t->slots[i];
+        if (slot->entry == NULL)
+            continue;
+
+        _zn_transport_peer_slot_t *rslot = __zn_transport_peer_table_find(&r, &slot->addr);
+        *rslot = *slot;
+        r.len++;
+        r.used++;
+    }
+
+    z_free(t->slots);
+    *t = r;
+    return 0;
+}
+
+_zn_transport_peer_entry_t *_zn_transport_peer_table_get(const _zn_transport_peer_table_t *t, const _zn_link_addr_t *addr)
+{
+    if (t->len == 0)
+        return NULL;
+
+    return __zn_transport_peer_table_find(t, addr)->entry;
+}
+
+int _zn_transport_peer_table_insert(_zn_transport_peer_table_t *t, _zn_transport_peer_entry_t *entry)
+{
+    // Keep at least half of the slots free, so the probe chains remain short
+    if ((t->used + 1) * 2 > t->capacity && __zn_transport_peer_table_rehash(t) != 0)
+        return -1;
+
+    _zn_transport_peer_slot_t *slot = __zn_transport_peer_table_find(t, &entry->remote_addr);
+    if (slot->entry != NULL)
+        return -1;
+
+    slot->addr = entry->remote_addr;
+    slot->entry = entry;
+    slot->is_used = 1;
+    t->len++;
+    t->used++;
+    return 0;
+}
+
+void _zn_transport_peer_table_remove(_zn_transport_peer_table_t *t, _zn_transport_peer_entry_t *entry)
+{
+    if (t->len == 0)
+        return;
+
+    // The slot stays used, so the peers further in the probe chain remain reachable
+    _zn_transport_peer_slot_t *slot = __zn_transport_peer_table_find(t, &entry->remote_addr);
+    if (slot->entry != entry)
+        return;
+
+    _zn_transport_peer_entry_elem_free((void **)&slot->entry);
+    t->len--;
+}
+
+size_t _zn_transport_peer_table_len(const _zn_transport_peer_table_t *t)
+{
+    return t->len;
+}
+
+size_t _zn_transport_peer_table_capacity(const _zn_transport_peer_table_t *t)
+{
+    return t->capacity;
+}
+
+_zn_transport_peer_entry_t *_zn_transport_peer_table_at(const _zn_transport_peer_table_t *t, size_t i)
+{
+    return t->slots[i].entry;
+}
+
+/*------------------ Peer heap ------------------*/
+_zn_transport_peer_heap_t _zn_transport_peer_heap_make(size_t capacity)
+{
+    _zn_transport_peer_heap_t h;
+    h.capacity = capacity;
+    h.len = 0;
+    h.vals = (_zn_transport_peer_entry_t **)z_malloc(capacity * sizeof(_zn_transport_peer_entry_t *));
+    if (h.vals == NULL)
+        h.capacity = 0;
+
+    return h;
+}
+
+void _zn_transport_peer_heap_clear(_zn_transport_peer_heap_t *h)
+{
+    // The peers are owned by the peer table
+    z_free(h->vals);
+    h->vals = NULL;
+    h->capacity = 0;
+    h->len = 0;
+}
+
+void __zn_transport_peer_heap_set(_zn_transport_peer_heap_t *h, size_t i, _zn_transport_peer_entry_t *entry)
+{
+    h->vals[i] = entry;
+    entry->lease_index = i;
+}
+
+void __zn_transport_peer_heap_sift_up(_zn_transport_peer_heap_t *h, size_t i)
+{
+    _zn_transport_peer_entry_t *entry = h->vals[i];
+    while (i > 0)
+    {
+        size_t parent = (i - 1) / 2;
+        if (h->vals[parent]->next_lease <= entry->next_lease)
+            break;
+
+        __zn_transport_peer_heap_set(h, i, h->vals[parent]);
+        i = parent;
+    }
+    __zn_transport_peer_heap_set(h, i, entry);
+}
+
+void __zn_transport_peer_heap_sift_down(_zn_transport_peer_heap_t *h, size_t i)
+{
+    _zn_transport_peer_entry_t *entry = h->vals[i];
+    while (2 * i + 1 < h->len)
+    {
+        size_t child = 2 * i + 1;
+        if (child + 1 < h->len && h->vals[child + 1]->next_lease < h->vals[child]->next_lease)
+            child++;
+        if (entry->next_lease <= h->vals[child]->next_lease)
+            break;
+
+        __zn_transport_peer_heap_set(h, i, h->vals[child]);
+        i = child;
+    }
+    __zn_transport_peer_heap_set(h, i, entry);
+}
+
+int _zn_transport_peer_heap_push(_zn_transport_peer_heap_t *h, _zn_transport_peer_entry_t *entry)
+{
+    if (h->len == h->capacity)
+    {
+        size_t capacity = h->capacity == 0 ? ZN_MULTICAST_PEER_TABLE_CAPACITY : h->capacity * 2;
+        _zn_transport_peer_entry_t **vals = (_zn_transport_peer_entry_t **)z_realloc(h->vals, capacity * sizeof(_zn_transport_peer_entry_t *));
+        if (vals == NULL)
+            return -1;
+
+        h->vals = vals;
+        h->capacity = capacity;
+    }
+
+    h->vals[h->len] = entry;
+    h->len++;
+    __zn_transport_peer_heap_sift_up(h, h->len - 1);
+    return 0;
+}
+
+void _zn_transport_peer_heap_update(_zn_transport_peer_heap_t *h, _zn_transport_peer_entry_t *entry)
+{
+    size_t i = entry->lease_index;
+    __zn_transport_peer_heap_sift_up(h, i);
+    if (h->vals[i] == entry)
+        __zn_transport_peer_heap_sift_down(h, i);
+}
+
+void _zn_transport_peer_heap_remove(_zn_transport_peer_heap_t *h, _zn_transport_peer_entry_t *entry)
+{
+    size_t i = entry->lease_index;
+    if (i >= h->len || h->vals[i] != entry)
+        return;
+
+    // Move the last peer in place of the removed one and restore the order from there
+    h->len--;
+    if (i == h->len)
+        return;
+
+    __zn_transport_peer_heap_set(h, i, h->vals[h->len]);
+    _zn_transport_peer_heap_update(h, h->vals[i]);
+}
+
+_zn_transport_peer_entry_t *_zn_transport_peer_heap_top(const _zn_transport_peer_heap_t *h)
+{
+    return h->len == 0 ? NULL : h->vals[0];
+}
+
+size_t _zn_transport_peer_heap_len(const _zn_transport_peer_heap_t *h)
+{
+    return h->len;
+}
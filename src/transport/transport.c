@@ -55,6 +55,17 @@ int _zn_send_close(_zn_transport_t *zt, uint8_t reason, int link_only)
         return -1;
 }
 
+int __zn_link_is_retransmitting(const _zn_link_t *zl)
+{
+    return ZN_UDP_UNICAST_RELIABILITY == 1 && zl->is_reliable == 0 && zl->is_streamed == 0;
+}
+
+// Datagrams are received several at a time if the link supports it
+int __zn_link_is_batching_rx(const _zn_link_t *zl)
+{
+    return zl->read_batch_f != NULL && zl->is_streamed == 0;
+}
+
 _zn_transport_t *_zn_transport_unicast_new(_zn_link_t *link, _zn_transport_unicast_establish_param_t param)
 {
     _zn_transport_t *zt = (_zn_transport_t *)z_malloc(sizeof(_zn_transport_t));
@@ -63,32 +74,40 @@ _zn_transport_t *_zn_transport_unicast_new(_zn_link_t *link, _zn_transport_unica
     // Initialize the mutexes
     z_mutex_init(&zt->transport.unicast.mutex_tx);
     z_mutex_init(&zt->transport.unicast.mutex_rx);
+    _zn_tx_scheduler_init(&zt->transport.unicast.tx_scheduler);
+    z_condvar_init(&zt->transport.unicast.cond_tx_window);
+    zt->transport.unicast.has_rx_task = 0;
 
     // Initialize the read and write buffers
     uint16_t mtu = link->mtu < ZN_BATCH_SIZE ? link->mtu : ZN_BATCH_SIZE;
     zt->transport.unicast.wbuf = _z_wbuf_make(mtu, 0);
     zt->transport.unicast.zbuf = _z_zbuf_make(ZN_BATCH_SIZE);
+    zt->transport.unicast.rx_batch = __zn_link_is_batching_rx(link) ? _zn_link_rx_batch_make() : NULL;
 
-    // Initialize the defragmentation buffers
-#if ZN_DYNAMIC_MEMORY_ALLOCATION == 1
-    zt->transport.unicast.dbuf_reliable = _z_wbuf_make(0, 1);
-    zt->transport.unicast.dbuf_best_effort = _z_wbuf_make(0, 1);
-#else
-    zt->transport.unicast.dbuf_reliable = _z_wbuf_make(ZN_FRAG_MAX_SIZE, 0);
-    zt->transport.unicast.dbuf_best_effort = _z_wbuf_make(ZN_FRAG_MAX_SIZE, 0);
-#endif
+    // Initialize the defragmentation buffers, slots are checked out on the first fragment
+    zt->transport.unicast.dbuf_pool = _zn_defrag_pool_make(ZN_DEFRAG_POOL_SLOTS);
+    for (int i = 0; i < ZN_PRIORITIES_NUM; i++)
+    {
+        zt->transport.unicast.dbuf_reliable[i] = _zn_defrag_buf_make(&zt->transport.unicast.dbuf_pool);
+        zt->transport.unicast.dbuf_best_effort[i] = _zn_defrag_buf_make(&zt->transport.unicast.dbuf_pool);
+    }
+
+    // Reliable frames are acknowledged by the transport only if the link does not do it
+    zt->transport.unicast.is_retransmitting = __zn_link_is_retransmitting(link);
 
     // Set default SN resolution
     zt->transport.unicast.sn_resolution = param.sn_resolution;
     zt->transport.unicast.sn_resolution_half = param.sn_resolution / 2;
 
-    // The initial SN at TX side
-    zt->transport.unicast.sn_tx_reliable = param.initial_sn_tx;
-    zt->transport.unicast.sn_tx_best_effort = param.initial_sn_tx;
-
-    // The initial SN at RX side
-    zt->transport.unicast.sn_rx_reliable = param.initial_sn_rx;
-    zt->transport.unicast.sn_rx_best_effort = param.initial_sn_rx;
+    // The initial SN at TX and RX side, the retransmissions only track the plain conduit
+    uint8_t is_qos = param.is_qos == 1 && zt->transport.unicast.is_retransmitting == 0;
+    zt->transport.unicast.sn_tx_sns = _zn_conduit_sn_list_make(is_qos, param.initial_sn_tx);
+    zt->transport.unicast.sn_rx_sns = _zn_conduit_sn_list_make(is_qos, param.initial_sn_rx);
+    size_t tx_window = zt->transport.unicast.is_retransmitting ? ZN_TX_RETRANSMISSION_WINDOW : 0;
+    size_t rx_window = zt->transport.unicast.is_retransmitting ? ZN_RX_REORDERING_WINDOW : 0;
+    zt->transport.unicast.tx_window = _zn_frame_window_make(tx_window, param.initial_sn_tx);
+    zt->transport.unicast.rx_window = _zn_frame_window_make(rx_window, _zn_sn_increment(param.sn_resolution, param.initial_sn_rx));
+    zt->transport.unicast.sn_rx_acked = zt->transport.unicast.rx_window.base;
 
     // Tasks
     zt->transport.unicast.read_task_running = 0;
@@ -100,6 +119,15 @@ _zn_transport_t *_zn_transport_unicast_new(_zn_link_t *link, _zn_transport_unica
     zt->transport.unicast.received = 0;
     zt->transport.unicast.transmitted = 0;
 
+    // Batching
+    zt->transport.unicast.batch_reliability = zn_reliability_t_BEST_EFFORT;
+    zt->transport.unicast.batch_priority = ZN_PRIORITY_DEFAULT;
+    zt->transport.unicast.batch_sn = 0;
+#if ZN_TX_BATCHING == 1
+    zt->transport.unicast.batch_is_open = 0;
+    z_condvar_init(&zt->transport.unicast.cond_batch_open);
+#endif
+
     // Remote peer PID
     _z_bytes_move(&zt->transport.unicast.remote_pid, &param.remote_pid);
 
@@ -121,21 +149,29 @@ _zn_transport_t *_zn_transport_multicast_new(_zn_link_t *link, _zn_transport_mul
     z_mutex_init(&zt->transport.multicast.mutex_tx);
     z_mutex_init(&zt->transport.multicast.mutex_rx);
     z_mutex_init(&zt->transport.multicast.mutex_peer);
+    _zn_tx_scheduler_init(&zt->transport.multicast.tx_scheduler);
 
     // Initialize the read and write buffers
     uint16_t mtu = link->mtu < ZN_BATCH_SIZE ? link->mtu : ZN_BATCH_SIZE;
     zt->transport.multicast.wbuf = _z_wbuf_make(mtu, 0);
     zt->transport.multicast.zbuf = _z_zbuf_make(ZN_BATCH_SIZE);
+    zt->transport.multicast.rx_batch = __zn_link_is_batching_rx(link) ? _zn_link_rx_batch_make() : NULL;
 
     // Set default SN resolution
     zt->transport.multicast.sn_resolution = param.sn_resolution;
     zt->transport.multicast.sn_resolution_half = param.sn_resolution / 2;
     // The initial SN at TX side
-    zt->transport.multicast.sn_tx_reliable = param.initial_sn_tx;
-    zt->transport.multicast.sn_tx_best_effort = param.initial_sn_tx;
+    zt->transport.multicast.sn_tx_sns = _zn_conduit_sn_list_make(param.is_qos, param.initial_sn_tx);
+
+    // Initialize peer table and lease deadlines
+    zt->transport.multicast.peers = _zn_transport_peer_table_make(ZN_MULTICAST_PEER_TABLE_CAPACITY);
+    zt->transport.multicast.lease_heap = _zn_transport_peer_heap_make(ZN_MULTICAST_PEER_TABLE_CAPACITY);
+    zt->transport.multicast.lease_epoch = z_clock_now();
+    zt->transport.multicast.peers_min_lease = SIZE_MAX;
+    zt->transport.multicast.is_peers_min_lease_stale = 0;
 
-    // Initialize peer list
-    zt->transport.multicast.peers = _zn_transport_peer_entry_list_new();
+    // Initialize the defragmentation buffers shared by the peers
+    zt->transport.multicast.dbuf_pool = _zn_defrag_pool_make(ZN_DEFRAG_POOL_SLOTS);
 
     // Tasks
     zt->transport.multicast.read_task_running = 0;
@@ -162,7 +198,7 @@ _zn_transport_unicast_establish_param_result_t _zn_transport_unicast_open_client
     uint8_t version = ZN_PROTO_VERSION;
     z_zint_t whatami = ZN_CLIENT;
     z_zint_t sn_resolution = ZN_SN_RESOLUTION;
-    int is_qos = 0;
+    int is_qos = ZN_TRANSPORT_QOS == 1 && !__zn_link_is_retransmitting(zl);
 
     z_bytes_t pid = _z_bytes_wrap(local_pid.val, local_pid.len);
     _zn_transport_message_t ism = _zn_t_msg_make_init_syn(version, whatami, sn_resolution, pid, is_qos);
@@ -201,6 +237,9 @@ _zn_transport_unicast_establish_param_result_t _zn_transport_unicast_open_client
                     goto ERR_2;
             }
 
+            // QoS is enabled only if both ends support it
+            param.is_qos = is_qos && _ZN_HAS_FLAG(iam.body.init.options, _ZN_OPT_INIT_QOS);
+
             // The initial SN at TX side
             z_random_fill(&param.initial_sn_tx, sizeof(param.initial_sn_tx));
             param.initial_sn_tx = param.initial_sn_tx % param.sn_resolution;
@@ -300,16 +339,12 @@ _zn_transport_multicast_establish_param_result_t _zn_transport_multicast_open_pe
 {
     _zn_transport_multicast_establish_param_result_t ret;
     _zn_transport_multicast_establish_param_t param;
-    param.is_qos = 0; // FIXME: make transport aware of qos configuration
+    param.is_qos = ZN_TRANSPORT_QOS;
     param.initial_sn_tx = 0;
     param.sn_resolution = ZN_SN_RESOLUTION;
 
     // Explicitly send a JOIN message upon startup
-    // FIXME: make transport aware of qos configuration
-    _zn_conduit_sn_list_t next_sns;
-    next_sns.is_qos = 0;
-    next_sns.val.plain.best_effort = param.initial_sn_tx;
-    next_sns.val.plain.reliable = param.initial_sn_tx;
+    _zn_conduit_sn_list_t next_sns = _zn_conduit_sn_list_make(param.is_qos, param.initial_sn_tx);
 
     z_bytes_t pid = _z_bytes_wrap(local_pid.val, local_pid.len);
     _zn_transport_message_t jsm = _zn_t_msg_make_join(ZN_PROTO_VERSION, ZN_PEER, ZN_TRANSPORT_LEASE, param.sn_resolution, pid, next_sns);
@@ -365,12 +400,25 @@ void _zn_transport_unicast_clear(_zn_transport_unicast_t *ztu)
     // Clean up the mutexes
     z_mutex_free(&ztu->mutex_tx);
     z_mutex_free(&ztu->mutex_rx);
+    _zn_tx_scheduler_clear(&ztu->tx_scheduler);
+    z_condvar_free(&ztu->cond_tx_window);
+#if ZN_TX_BATCHING == 1
+    z_condvar_free(&ztu->cond_batch_open);
+#endif
 
     // Clean up the buffers
     _z_wbuf_clear(&ztu->wbuf);
     _z_zbuf_clear(&ztu->zbuf);
-    _z_wbuf_clear(&ztu->dbuf_reliable);
-    _z_wbuf_clear(&ztu->dbuf_best_effort);
+    if (ztu->rx_batch != NULL)
+        _zn_link_rx_batch_free(&ztu->rx_batch);
+    for (int i = 0; i < ZN_PRIORITIES_NUM; i++)
+    {
+        _zn_defrag_buf_reset(&ztu->dbuf_reliable[i]);
+        _zn_defrag_buf_reset(&ztu->dbuf_best_effort[i]);
+    }
+    _zn_defrag_pool_clear(&ztu->dbuf_pool);
+    _zn_frame_window_clear(&ztu->tx_window);
+    _zn_frame_window_clear(&ztu->rx_window);
 
     // Clean up PIDs
     _z_bytes_clear(&ztu->remote_pid);
@@ -397,13 +445,18 @@ void _zn_transport_multicast_clear(_zn_transport_multicast_t *ztm)
     z_mutex_free(&ztm->mutex_tx);
     z_mutex_free(&ztm->mutex_rx);
     z_mutex_free(&ztm->mutex_peer);
+    _zn_tx_scheduler_clear(&ztm->tx_scheduler);
 
     // Clean up the buffers
     _z_wbuf_clear(&ztm->wbuf);
     _z_zbuf_clear(&ztm->zbuf);
+    if (ztm->rx_batch != NULL)
+        _zn_link_rx_batch_free(&ztm->rx_batch);
 
-    // Clean up peer list
-    _zn_transport_peer_entry_list_free(&ztm->peers);
+    // Clean up peer table and lease deadlines
+    _zn_transport_peer_heap_clear(&ztm->lease_heap);
+    _zn_transport_peer_table_clear(&ztm->peers);
+    _zn_defrag_pool_clear(&ztm->dbuf_pool);
 
     if (ztm->link != NULL)
         _zn_link_free((_zn_link_t **)&ztm->link);
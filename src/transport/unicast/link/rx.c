@@ -14,6 +14,7 @@
 
 #include "zenoh-pico/session/utils.h"
 #include "zenoh-pico/transport/link/rx.h"
+#include "zenoh-pico/transport/link/tx.h"
 #include "zenoh-pico/transport/utils.h"
 #include "zenoh-pico/utils/logging.h"
 
@@ -89,6 +90,227 @@ _zn_transport_message_result_t _zn_unicast_recv_t_msg(_zn_transport_unicast_t *z
     return r;
 }
 
+int __zn_unicast_update_rx_sn(_zn_transport_unicast_t *ztu, uint8_t header, zn_priority_t priority, z_zint_t sn)
+{
+    // Each priority has its own SNs if QoS is enabled
+    _zn_coundit_sn_t *sns = _zn_conduit_sn_list_get(&ztu->sn_rx_sns, priority);
+    if (_ZN_HAS_FLAG(header, _ZN_FLAG_T_R))
+    {
+        // Without retransmissions only monothonic SNs are ensured
+        if (_zn_sn_precedes(ztu->sn_resolution_half, sns->reliable, sn))
+        {
+            sns->reliable = sn;
+        }
+        else
+        {
+            _zn_defrag_buf_reset(&ztu->dbuf_reliable[priority]);
+            _Z_INFO("Reliable message dropped because it is out of order\n");
+            return -1;
+        }
+    }
+    else
+    {
+        if (_zn_sn_precedes(ztu->sn_resolution_half, sns->best_effort, sn))
+        {
+            sns->best_effort = sn;
+        }
+        else
+        {
+            _zn_defrag_buf_reset(&ztu->dbuf_best_effort[priority]);
+            _Z_INFO("Best effort message dropped because it is out of order\n");
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+void __zn_unicast_handle_frame(_zn_transport_unicast_t *ztu, _zn_transport_message_t *t_msg, _z_zbuf_t *zbf)
+{
+    if (_ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_F))
+    {
+        // Select the right defragmentation buffer
+        zn_priority_t priority = t_msg->body.frame.priority;
+        _zn_defrag_buf_t *dbuf = _ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_R) ? &ztu->dbuf_reliable[priority] : &ztu->dbuf_best_effort[priority];
+
+        // Add the fragment to the defragmentation buffer, the whole message is dropped on failure
+        int res = _zn_defrag_buf_push(dbuf, &t_msg->body.frame.payload.fragment);
+
+        // Check if this is the last fragment
+        if (_ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_E))
+        {
+            // Drop message if it could not be reassembled
+            if (res != 0)
+            {
+                _zn_defrag_buf_reset(dbuf);
+                return;
+            }
+
+            // Convert the defragmentation buffer into a decoding buffer
+            _z_zbuf_t zbf = _zn_defrag_buf_to_zbuf(dbuf);
+
+            // Decode the zenoh message
+            _zn_zenoh_message_result_t r_zm = _zn_zenoh_message_decode(&zbf);
+            if (r_zm.tag == _z_res_t_OK)
+            {
+                _zn_zenoh_message_t d_zm = r_zm.value.zenoh_message;
+                _zn_handle_zenoh_message(ztu->session, &d_zm);
+
+                // Clear must be explicitly called for fragmented zenoh messages.
+                // Non-fragmented zenoh messages are released when their transport message is released.
+                _zn_z_msg_clear(&d_zm);
+            }
+
+            // Free the decoding buffer
+            _z_zbuf_clear(&zbf);
+            // Return the defragmentation buffer to the pool
+            _zn_defrag_buf_reset(dbuf);
+        }
+
+        return;
+    }
+
+    // Handle all the decoded zenoh message, one by one
+    unsigned int len = _z_vec_len(&t_msg->body.frame.payload.messages);
+    for (unsigned int i = 0; i < len; i++)
+        _zn_handle_zenoh_message(ztu->session, (_zn_zenoh_message_t *)_z_vec_get(&t_msg->body.frame.payload.messages, i));
+
+    if (zbf == NULL)
+        return;
+
+    // Decode and handle the zenoh messages left in the buffer, one by one
+    _zn_zenoh_message_result_t r_zm;
+    while (_z_zbuf_len(zbf))
+    {
+        // Mark the reading position of the iobfer
+        size_t r_pos = _z_zbuf_get_rpos(zbf);
+        _zn_zenoh_message_decode_na(zbf, &r_zm);
+        if (r_zm.tag != _z_res_t_OK)
+        {
+            // Restore the reading position of the iobfer
+            _z_zbuf_set_rpos(zbf, r_pos);
+            break;
+        }
+
+        _zn_handle_zenoh_message(ztu->session, &r_zm.value.zenoh_message);
+        _zn_z_msg_clear(&r_zm.value.zenoh_message);
+    }
+}
+
+int __zn_unicast_send_ack_nack(_zn_transport_unicast_t *ztu, z_zint_t sn)
+{
+    // Flag the missing frames preceding the given SN that fit in the mask
+    z_zint_t count = _zn_sn_distance(ztu->sn_resolution, ztu->rx_window.base, sn);
+    if (count > ztu->sn_resolution_half)
+        count = 0;
+
+    z_zint_t mask = 0;
+    for (z_zint_t i = 0; i < count && i < sizeof(z_zint_t) * 8; i++)
+    {
+        z_bytes_t *frame = _zn_frame_window_get(&ztu->rx_window, ztu->sn_resolution, (ztu->rx_window.base + i) % ztu->sn_resolution);
+        if (frame == NULL)
+            break;
+        if (_z_bytes_is_empty(frame))
+            mask |= (z_zint_t)1 << i;
+    }
+
+    ztu->sn_rx_acked = ztu->rx_window.base;
+    _zn_transport_message_t t_msg = _zn_t_msg_make_ack_nack(ztu->rx_window.base, mask);
+    return _zn_unicast_send_t_msg(ztu, &t_msg);
+}
+
+void __zn_unicast_handle_reliable_frame(_zn_transport_unicast_t *ztu, _zn_transport_message_t *t_msg, _z_zbuf_t *zbf)
+{
+    z_zint_t sn = t_msg->body.frame.sn;
+    z_zint_t offset = _zn_sn_distance(ztu->sn_resolution, ztu->rx_window.base, sn);
+    if (offset > ztu->sn_resolution_half)
+    {
+        _Z_INFO("Reliable message dropped because it has already been received\n");
+        goto EXIT_RELIABLE_FRAME;
+    }
+    if (offset >= ztu->rx_window.capacity)
+    {
+        _Z_INFO("Reliable message dropped because it is out of the reordering window\n");
+        goto EXIT_RELIABLE_FRAME;
+    }
+
+    if (offset > 0)
+    {
+        // Keep the frame until the frames preceding it are retransmitted
+        z_bytes_t *frame = _zn_frame_window_get(&ztu->rx_window, ztu->sn_resolution, sn);
+        if (!_z_bytes_is_empty(frame))
+            goto EXIT_RELIABLE_FRAME;
+
+        _z_wbuf_t wbf = _z_wbuf_make(ZN_IOSLICE_SIZE, 1);
+        _zn_transport_message_encode(&wbf, t_msg);
+        if (zbf != NULL)
+            _z_wbuf_write_bytes(&wbf, _z_zbuf_get_rptr(zbf), 0, _z_zbuf_len(zbf));
+        _zn_frame_window_put(&ztu->rx_window, ztu->sn_resolution, sn, &wbf);
+        _z_wbuf_clear(&wbf);
+
+        // Ask for the missing frames as soon as a new gap shows up
+        z_bytes_t *previous = _zn_frame_window_get(&ztu->rx_window, ztu->sn_resolution, _zn_sn_decrement(ztu->sn_resolution, sn));
+        if (_z_bytes_is_empty(previous))
+            __zn_unicast_send_ack_nack(ztu, sn);
+
+        goto EXIT_RELIABLE_FRAME;
+    }
+
+    // Handle the expected frame
+    ztu->sn_rx_sns.val.plain.reliable = sn;
+    _zn_frame_window_advance(&ztu->rx_window, ztu->sn_resolution, 1);
+    __zn_unicast_handle_frame(ztu, t_msg, zbf);
+
+    // Handle the frames that were waiting for it
+    z_bytes_t *frame = _zn_frame_window_get(&ztu->rx_window, ztu->sn_resolution, ztu->rx_window.base);
+    while (frame != NULL && !_z_bytes_is_empty(frame))
+    {
+        z_bytes_t bs;
+        _z_bytes_move(&bs, frame);
+        ztu->sn_rx_sns.val.plain.reliable = ztu->rx_window.base;
+        _zn_frame_window_advance(&ztu->rx_window, ztu->sn_resolution, 1);
+
+        _z_zbuf_t r_zbf;
+        r_zbf.ios = _z_iosli_wrap(bs.val, bs.len, 0, bs.len);
+        _zn_transport_message_result_t r_tm;
+        _zn_transport_message_decode_streamed_na(&r_zbf, &r_tm);
+        if (r_tm.tag == _z_res_t_OK)
+        {
+            __zn_unicast_handle_frame(ztu, &r_tm.value.transport_message, &r_zbf);
+            _zn_t_msg_clear(&r_tm.value.transport_message);
+        }
+        _z_bytes_clear(&bs);
+
+        frame = _zn_frame_window_get(&ztu->rx_window, ztu->sn_resolution, ztu->rx_window.base);
+    }
+
+    // Acknowledge the received frames every half window
+    if (_zn_sn_distance(ztu->sn_resolution, ztu->sn_rx_acked, ztu->rx_window.base) >= ztu->rx_window.capacity / 2)
+        __zn_unicast_send_ack_nack(ztu, ztu->rx_window.base);
+
+EXIT_RELIABLE_FRAME:
+    if (zbf != NULL)
+        _z_zbuf_set_rpos(zbf, _z_zbuf_get_wpos(zbf));
+}
+
+void __zn_unicast_handle_frame_message(_zn_transport_unicast_t *ztu, _zn_transport_message_t *t_msg, _z_zbuf_t *zbf)
+{
+    if (ztu->is_retransmitting == 1 && _ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_R))
+    {
+        // Reliable frames are reordered and retransmitted if missing
+        __zn_unicast_handle_reliable_frame(ztu, t_msg, zbf);
+    }
+    else if (__zn_unicast_update_rx_sn(ztu, t_msg->header, t_msg->body.frame.priority, t_msg->body.frame.sn) == 0)
+    {
+        __zn_unicast_handle_frame(ztu, t_msg, zbf);
+    }
+    else if (zbf != NULL)
+    {
+        // Skip the whole frame
+        _z_zbuf_set_rpos(zbf, _z_zbuf_get_wpos(zbf));
+    }
+}
+
 int _zn_unicast_handle_transport_message(_zn_transport_unicast_t *ztu, _zn_transport_message_t *t_msg)
 {
     switch (_ZN_MID(t_msg->header))
@@ -125,13 +347,28 @@ int _zn_unicast_handle_transport_message(_zn_transport_unicast_t *ztu, _zn_trans
 
     case _ZN_MID_SYNC:
     {
-        _Z_INFO("Handling of Sync messages not implemented\n");
+        if (ztu->is_retransmitting == 0 || !_ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_R))
+        {
+            _Z_INFO("Handling of Sync messages not implemented\n");
+            break;
+        }
+
+        _Z_INFO("Received ZN_SYNC message\n");
+        // Acknowledge the frames received so far and ask for the missing ones
+        __zn_unicast_send_ack_nack(ztu, t_msg->body.sync.sn);
         break;
     }
 
     case _ZN_MID_ACK_NACK:
     {
-        _Z_INFO("Handling of AckNack messages not implemented\n");
+        if (ztu->is_retransmitting == 0)
+        {
+            _Z_INFO("Handling of AckNack messages not implemented\n");
+            break;
+        }
+
+        _Z_INFO("Received ZN_ACK_NACK message\n");
+        _zn_unicast_handle_ack_nack(ztu, &t_msg->body.ack_nack);
         break;
     }
 
@@ -150,95 +387,7 @@ int _zn_unicast_handle_transport_message(_zn_transport_unicast_t *ztu, _zn_trans
     case _ZN_MID_FRAME:
     {
         _Z_INFO("Received ZN_FRAME message\n");
-        // Check if the SN is correct
-        if (_ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_R))
-        {
-            // @TODO: amend once reliability is in place. For the time being only
-            //        monothonic SNs are ensured
-            if (_zn_sn_precedes(ztu->sn_resolution_half, ztu->sn_rx_reliable, t_msg->body.frame.sn))
-            {
-                ztu->sn_rx_reliable = t_msg->body.frame.sn;
-            }
-            else
-            {
-                _z_wbuf_clear(&ztu->dbuf_reliable);
-                _Z_INFO("Reliable message dropped because it is out of order\n");
-                break;
-            }
-        }
-        else
-        {
-            if (_zn_sn_precedes(ztu->sn_resolution_half, ztu->sn_rx_best_effort, t_msg->body.frame.sn))
-            {
-                ztu->sn_rx_best_effort = t_msg->body.frame.sn;
-            }
-            else
-            {
-                _z_wbuf_clear(&ztu->dbuf_best_effort);
-                _Z_INFO("Best effort message dropped because it is out of order\n");
-                break;
-            }
-        }
-
-        if (_ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_F))
-        {
-            // Select the right defragmentation buffer
-            _z_wbuf_t *dbuf = _ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_R) ? &ztu->dbuf_reliable : &ztu->dbuf_best_effort;
-
-            uint8_t drop = 0;
-            if (_z_wbuf_len(dbuf) + t_msg->body.frame.payload.fragment.len > ZN_FRAG_MAX_SIZE)
-            {
-                // Filling the wbuf capacity as a way to signling the last fragment to reset the dbuf
-                // Otherwise, last (smaller) fragments can be understood as a complete message
-                _z_wbuf_write_bytes(dbuf, t_msg->body.frame.payload.fragment.val, 0, _z_wbuf_space_left(dbuf));
-                drop = 1;
-            }
-            else
-            {
-                // Add the fragment to the defragmentation buffer
-                _z_wbuf_write_bytes(dbuf, t_msg->body.frame.payload.fragment.val, 0, t_msg->body.frame.payload.fragment.len);
-            }
-
-            // Check if this is the last fragment
-            if (_ZN_HAS_FLAG(t_msg->header, _ZN_FLAG_T_E))
-            {
-                // Drop message if it is bigger the max buffer size
-                if (drop == 1)
-                {
-                    _z_wbuf_reset(dbuf);
-                    break;
-                }
-
-                // Convert the defragmentation buffer into a decoding buffer
-                _z_zbuf_t zbf = _z_wbuf_to_zbuf(dbuf);
-
-                // Decode the zenoh message
-                _zn_zenoh_message_result_t r_zm = _zn_zenoh_message_decode(&zbf);
-                if (r_zm.tag == _z_res_t_OK)
-                {
-                    _zn_zenoh_message_t d_zm = r_zm.value.zenoh_message;
-                    _zn_handle_zenoh_message(ztu->session, &d_zm);
-
-                    // Clear must be explicitly called for fragmented zenoh messages.
-                    // Non-fragmented zenoh messages are released when their transport message is released.
-                    _zn_z_msg_clear(&d_zm);
-                }
-
-                // Free the decoding buffer
-                _z_zbuf_clear(&zbf);
-                // Reset the defragmentation buffer
-                _z_wbuf_reset(dbuf);
-            }
-
-            break;
-        }
-        else
-        {
-            // Handle all the zenoh message, one by one
-            unsigned int len = _z_vec_len(&t_msg->body.frame.payload.messages);
-            for (unsigned int i = 0; i < len; i++)
-                _zn_handle_zenoh_message(ztu->session, (_zn_zenoh_message_t *)_z_vec_get(&t_msg->body.frame.payload.messages, i));
-        }
+        __zn_unicast_handle_frame_message(ztu, t_msg, NULL);
         break;
     }
 
@@ -251,3 +400,14 @@ int _zn_unicast_handle_transport_message(_zn_transport_unicast_t *ztu, _zn_trans
 
     return _z_res_t_OK;
 }
+
+int _zn_unicast_handle_streamed_transport_message(_zn_transport_unicast_t *ztu, _zn_transport_message_t *t_msg, _z_zbuf_t *zbf)
+{
+    if (_ZN_MID(t_msg->header) != _ZN_MID_FRAME)
+        return _zn_unicast_handle_transport_message(ztu, t_msg);
+
+    _Z_INFO("Received ZN_FRAME message\n");
+    __zn_unicast_handle_frame_message(ztu, t_msg, zbf);
+
+    return _z_res_t_OK;
+}
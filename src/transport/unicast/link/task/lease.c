@@ -27,64 +27,109 @@ int _znp_unicast_send_keep_alive(_zn_transport_unicast_t *ztu)
     return _zn_unicast_send_t_msg(ztu, &t_msg);
 }
 
-void *_znp_unicast_lease_task(void *arg)
+void _znp_unicast_lease_init(_zn_transport_unicast_t *ztu, _znp_unicast_lease_timers_t *timers)
 {
-    _zn_transport_unicast_t *ztu = (_zn_transport_unicast_t *)arg;
-
-    ztu->lease_task_running = 1;
     ztu->received = 0;
     ztu->transmitted = 0;
 
-    z_zint_t next_lease = ztu->lease;
-    z_zint_t next_keep_alive = ztu->lease / ZN_TRANSPORT_LEASE_EXPIRE_FACTOR;
-    while (ztu->lease_task_running)
+    timers->next_lease = ztu->lease;
+    timers->next_keep_alive = ztu->lease / ZN_TRANSPORT_LEASE_EXPIRE_FACTOR;
+    timers->next_sync = ZN_SYNC_INTERVAL;
+}
+
+int _znp_unicast_lease_process(_zn_transport_unicast_t *ztu, _znp_unicast_lease_timers_t *timers, z_zint_t *interval)
+{
+    // Push out any batch that has been lingering for too long
+    _zn_unicast_flush_lingering(ztu);
+
+    if (timers->next_lease <= 0)
     {
-        if (next_lease <= 0)
+        // Check if received data
+        if (ztu->received == 1)
         {
-            // Check if received data
-            if (ztu->received == 1)
-            {
-                // Reset the lease parameters
-                ztu->received = 0;
-            }
-            else
-            {
-                _Z_INFO("Closing session because it has expired after %zums\n", ztu->lease);
-                _zn_transport_unicast_close(ztu, _ZN_CLOSE_EXPIRED);
-                return 0;
-            }
-
-            next_lease = ztu->lease;
+            // Reset the lease parameters
+            ztu->received = 0;
         }
-
-        if (next_keep_alive <= 0)
+        else
         {
-            // Check if need to send a keep alive
-            if (ztu->transmitted == 0)
-                _znp_unicast_send_keep_alive(ztu);
-
-            // Reset the keep alive parameters
-            ztu->transmitted = 0;
-            next_keep_alive = ztu->lease / ZN_TRANSPORT_LEASE_EXPIRE_FACTOR;
+            _Z_INFO("Closing session because it has expired after %zums\n", ztu->lease);
+            _zn_transport_unicast_close(ztu, _ZN_CLOSE_EXPIRED);
+            return -1;
         }
 
-        // Compute the target interval
-        z_zint_t interval;
-        if (next_lease > 0)
-        {
-            interval = next_lease;
-            if (next_keep_alive < interval)
-                interval = next_keep_alive;
-        }
-        else
-            interval = next_keep_alive;
+        timers->next_lease = ztu->lease;
+    }
 
-        // The keep alive and lease intervals are expressed in milliseconds
-        z_sleep_ms(interval);
+    if (timers->next_keep_alive <= 0)
+    {
+        // Check if need to send a keep alive
+        if (ztu->transmitted == 0)
+            _znp_unicast_send_keep_alive(ztu);
 
-        next_lease -= interval;
-        next_keep_alive -= interval;
+        // Reset the keep alive parameters
+        ztu->transmitted = 0;
+        timers->next_keep_alive = ztu->lease / ZN_TRANSPORT_LEASE_EXPIRE_FACTOR;
+    }
+
+    if (ztu->is_retransmitting == 1 && timers->next_sync <= 0)
+    {
+        // Solicit the acknowledgment of the reliable frames sent so far
+        _zn_unicast_sync(ztu);
+        timers->next_sync = ZN_SYNC_INTERVAL;
+    }
+
+    // Compute the target interval
+    if (timers->next_lease > 0)
+    {
+        *interval = timers->next_lease;
+        if (timers->next_keep_alive < *interval)
+            *interval = timers->next_keep_alive;
+    }
+    else
+        *interval = timers->next_keep_alive;
+
+    // Wake up often enough to retransmit the missing reliable frames
+    if (ztu->is_retransmitting == 1 && timers->next_sync < *interval)
+        *interval = timers->next_sync;
+
+#if ZN_TX_BATCHING == 1
+    // Wake up in time to push out the open batch, an idle transport keeps its interval
+    if (ZN_TX_BATCH_LINGER_MS < *interval && _zn_unicast_is_batch_open(ztu))
+        *interval = ZN_TX_BATCH_LINGER_MS;
+#endif
+
+    return 0;
+}
+
+void _znp_unicast_lease_elapse(_zn_transport_unicast_t *ztu, _znp_unicast_lease_timers_t *timers, z_zint_t elapsed)
+{
+    // Timers that are overdue are left at zero
+    timers->next_lease = elapsed < timers->next_lease ? timers->next_lease - elapsed : 0;
+    timers->next_keep_alive = elapsed < timers->next_keep_alive ? timers->next_keep_alive - elapsed : 0;
+    if (ztu->is_retransmitting == 1)
+        timers->next_sync = elapsed < timers->next_sync ? timers->next_sync - elapsed : 0;
+}
+
+void *_znp_unicast_lease_task(void *arg)
+{
+    _zn_transport_unicast_t *ztu = (_zn_transport_unicast_t *)arg;
+
+    ztu->lease_task_running = 1;
+
+    _znp_unicast_lease_timers_t timers;
+    _znp_unicast_lease_init(ztu, &timers);
+    while (ztu->lease_task_running)
+    {
+        z_zint_t interval;
+        if (_znp_unicast_lease_process(ztu, &timers, &interval) != 0)
+            return 0;
+
+        // The keep alive and lease intervals are expressed in milliseconds,
+        // the wait is cut short when a batch is opened
+        z_clock_t start = z_clock_now();
+        _zn_unicast_wait_batch(ztu, (unsigned int)interval);
+        _znp_unicast_lease_elapse(ztu, &timers, z_clock_elapsed_ms(&start));
     }
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,188 @@
+//
+// Copyright (c) 2022 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+#include "zenoh-pico/transport/link/task/reactor.h"
+#include "zenoh-pico/transport/link/task/read.h"
+#include "zenoh-pico/transport/link/tx.h"
+#include "zenoh-pico/utils/logging.h"
+
+#if defined(Z_EVENT_LOOP)
+
+#define _ZNP_REACTOR_MAX_EVENTS 32
+
+int _znp_reactor_entry_eq(const _znp_reactor_entry_t *left, const _znp_reactor_entry_t *right)
+{
+    return left->ztu == right->ztu;
+}
+
+void __znp_reactor_unpoll(_znp_reactor_t *r, _znp_reactor_entry_t *e)
+{
+    if (e->is_polled == 0)
+        return;
+
+    z_poller_remove(&r->poller, e->fd);
+    e->is_polled = 0;
+}
+
+void __znp_reactor_process_timers(_znp_reactor_t *r)
+{
+    z_zint_t now = z_clock_elapsed_ms(&r->start);
+    z_zint_t next = 0;
+    int is_armed = 0;
+
+    _znp_reactor_entry_list_t *xs = r->entries;
+    while (xs != NULL)
+    {
+        _znp_reactor_entry_t *e = _znp_reactor_entry_list_head(xs);
+        xs = _znp_reactor_entry_list_tail(xs);
+        if (e->is_expired == 1)
+            continue;
+
+        _znp_unicast_lease_elapse(e->ztu, &e->timers, now - e->last);
+        e->last = now;
+
+        z_zint_t interval;
+        if (_znp_unicast_lease_process(e->ztu, &e->timers, &interval) != 0)
+        {
+            // The transport has expired and has been closed
+            __znp_reactor_unpoll(r, e);
+            e->is_expired = 1;
+            continue;
+        }
+
+        if (is_armed == 0 || interval < next)
+            next = interval;
+        is_armed = 1;
+    }
+
+    // A zero time disarms the timer, the overdue events are handled on the next round
+    if (is_armed == 1 && next == 0)
+        next = 1;
+    z_poller_set_timer(&r->poller, next);
+}
+
+int _znp_reactor_init(_znp_reactor_t *r)
+{
+    if (z_poller_init(&r->poller) != 0)
+    {
+        _Z_ERROR("Unable to create the reactor poller\n");
+        return -1;
+    }
+
+    r->entries = _znp_reactor_entry_list_new();
+    r->start = z_clock_now();
+
+    return 0;
+}
+
+void _znp_reactor_clear(_znp_reactor_t *r)
+{
+    // The transports are left as they are, they are closed by their sessions
+    _znp_reactor_entry_list_free(&r->entries);
+    z_poller_free(&r->poller);
+}
+
+int _znp_reactor_add(_znp_reactor_t *r, _zn_transport_t *zt)
+{
+    if (zt->type != _ZN_TRANSPORT_UNICAST_TYPE)
+        return -1;
+
+    // The transport cannot be driven by its own tasks at the same time
+    _zn_transport_unicast_t *ztu = &zt->transport.unicast;
+    if (ztu->link->fd_f == NULL || ztu->read_task != NULL || ztu->lease_task != NULL)
+        return -1;
+
+    _znp_reactor_entry_t key;
+    key.ztu = ztu;
+    if (_znp_reactor_entry_list_find(r->entries, _znp_reactor_entry_eq, &key) != NULL)
+        return -1;
+
+    _znp_reactor_entry_t *e = (_znp_reactor_entry_t *)z_malloc(sizeof(_znp_reactor_entry_t));
+    e->ztu = ztu;
+    e->fd = ztu->link->fd_f(ztu->link);
+    e->last = z_clock_elapsed_ms(&r->start);
+    e->is_polled = 1;
+    e->is_expired = 0;
+    e->is_rx_task = 0;
+    _znp_unicast_lease_init(ztu, &e->timers);
+
+    // Prepare the buffer
+    z_mutex_lock(&ztu->mutex_rx);
+    _z_zbuf_reset(&ztu->zbuf);
+    z_mutex_unlock(&ztu->mutex_rx);
+
+    if (z_poller_add(&r->poller, e->fd, e) != 0)
+    {
+        z_free(e);
+        return -1;
+    }
+    r->entries = _znp_reactor_entry_list_push(r->entries, e);
+
+    // Arm the timer for the lease events of the new transport
+    __znp_reactor_process_timers(r);
+
+    return 0;
+}
+
+int _znp_reactor_remove(_znp_reactor_t *r, _zn_transport_t *zt)
+{
+    _znp_reactor_entry_t key;
+    key.ztu = &zt->transport.unicast;
+
+    _znp_reactor_entry_list_t *xs = _znp_reactor_entry_list_find(r->entries, _znp_reactor_entry_eq, &key);
+    if (xs == NULL)
+        return -1;
+
+    _znp_reactor_entry_t *e = _znp_reactor_entry_list_head(xs);
+    __znp_reactor_unpoll(r, e);
+
+    // The task processing the reactor no longer handles the acknowledgments of the transport
+    if (e->is_rx_task == 1)
+        _zn_unicast_set_rx_task(e->ztu, 0);
+    r->entries = _znp_reactor_entry_list_drop_filter(r->entries, _znp_reactor_entry_eq, &key);
+
+    return 0;
+}
+
+int _znp_reactor_process(_znp_reactor_t *r, int timeout)
+{
+    void *ready[_ZNP_REACTOR_MAX_EVENTS];
+    int n = z_poller_wait(&r->poller, ready, _ZNP_REACTOR_MAX_EVENTS, timeout);
+    if (n < 0)
+        return -1;
+
+    for (int i = 0; i < n; i++)
+    {
+        _znp_reactor_entry_t *e = (_znp_reactor_entry_t *)ready[i];
+        if (e->is_rx_task == 0)
+        {
+            // The acknowledgments of the transport are handled by the task processing the reactor
+            _zn_unicast_set_rx_task(e->ztu, 1);
+            e->is_rx_task = 1;
+        }
+
+        if (e->is_polled == 1 && _znp_unicast_read_ready(e->ztu) != 0)
+        {
+            // Stop reading from the link as the read task would, the lease expires in the meantime
+            __znp_reactor_unpoll(r, e);
+        }
+    }
+
+    // Handle the lease events that are due, including the ones timing out the transports
+    __znp_reactor_process_timers(r);
+
+    return 0;
+}
+
+#endif
@@ -14,6 +14,7 @@
 
 #include "zenoh-pico/transport/link/task/read.h"
 #include "zenoh-pico/transport/link/rx.h"
+#include "zenoh-pico/transport/link/tx.h"
 #include "zenoh-pico/utils/logging.h"
 
 int _znp_unicast_read(_zn_transport_unicast_t *ztu)
@@ -31,16 +32,94 @@ ERR:
     return _z_res_t_ERR;
 }
 
+/**
+ * Decode and handle all the transport messages held by a buffer.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - ztu->mutex_rx
+ */
+int __unsafe_znp_unicast_handle_view(_zn_transport_unicast_t *ztu, _z_zbuf_t *zbuf)
+{
+    _zn_transport_message_result_t r;
+
+    while (_z_zbuf_len(zbuf) > 0)
+    {
+        // Mark the session that we have received data
+        ztu->received = 1;
+
+        // Decode one session message, the zenoh messages of a frame are decoded while handling it
+        _zn_transport_message_decode_streamed_na(zbuf, &r);
+
+        if (r.tag == _z_res_t_OK)
+        {
+            int res = _zn_unicast_handle_streamed_transport_message(ztu, &r.value.transport_message, zbuf);
+            if (res == _z_res_t_OK)
+                _zn_t_msg_clear(&r.value.transport_message);
+            else
+                return -1;
+        }
+        else
+        {
+            _Z_ERROR("Connection closed due to malformed message\n");
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Decode and handle the transport messages held by the next ``to_read`` bytes of the read buffer.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - ztu->mutex_rx
+ */
+int __unsafe_znp_unicast_handle_zbuf(_zn_transport_unicast_t *ztu, size_t to_read)
+{
+    // Wrap the main buffer for to_read bytes
+    _z_zbuf_t zbuf = _z_zbuf_view(&ztu->zbuf, to_read);
+    if (__unsafe_znp_unicast_handle_view(ztu, &zbuf) != 0)
+        return -1;
+
+    // Move the read position of the read buffer
+    _z_zbuf_set_rpos(&ztu->zbuf, _z_zbuf_get_rpos(&ztu->zbuf) + to_read);
+    _z_zbuf_compact(&ztu->zbuf);
+
+    return 0;
+}
+
+/**
+ * Decode and handle the transport messages held by the datagrams of the last batched read.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - ztu->mutex_rx
+ */
+int __unsafe_znp_unicast_handle_rx_batch(_zn_transport_unicast_t *ztu)
+{
+    _zn_link_rx_batch_t *batch = ztu->rx_batch;
+    for (size_t i = 0; i < batch->len; i++)
+    {
+        _z_zbuf_t zbuf;
+        zbuf.ios = _z_iosli_wrap(batch->bufs[i], batch->lens[i], 0, batch->lens[i]);
+        if (__unsafe_znp_unicast_handle_view(ztu, &zbuf) != 0)
+            return -1;
+    }
+
+    return 0;
+}
+
 void *_znp_unicast_read_task(void *arg)
 {
     _zn_transport_unicast_t *ztu = (_zn_transport_unicast_t *)arg;
 
     ztu->read_task_running = 1;
 
-    _zn_transport_message_result_t r;
-
     // Acquire and keep the lock
     z_mutex_lock(&ztu->mutex_rx);
+    _zn_unicast_set_rx_task(ztu, 1);
 
     // Prepare the buffer
     _z_zbuf_reset(&ztu->zbuf);
@@ -71,6 +150,16 @@ void *_znp_unicast_read_task(void *arg)
                 }
             }
         }
+        else if (ztu->rx_batch != NULL)
+        {
+            // Read several datagrams at once, each of them holds whole messages
+            if (_zn_link_recv_batch(ztu->link, ztu->rx_batch, 0) == SIZE_MAX)
+                continue;
+
+            if (__unsafe_znp_unicast_handle_rx_batch(ztu) != 0)
+                goto EXIT_RECV_LOOP;
+            continue;
+        }
         else
         {
             to_read = _zn_link_recv_zbuf(ztu->link, &ztu->zbuf, NULL);
@@ -78,44 +167,70 @@ void *_znp_unicast_read_task(void *arg)
                 continue;
         }
 
-        // Wrap the main buffer for to_read bytes
-        _z_zbuf_t zbuf = _z_zbuf_view(&ztu->zbuf, to_read);
-
-        while (_z_zbuf_len(&zbuf) > 0)
-        {
-            // Mark the session that we have received data
-            ztu->received = 1;
-
-            // Decode one session message
-            _zn_transport_message_decode_na(&zbuf, &r);
-
-            if (r.tag == _z_res_t_OK)
-            {
-                int res = _zn_unicast_handle_transport_message(ztu, &r.value.transport_message);
-                if (res == _z_res_t_OK)
-                    _zn_t_msg_clear(&r.value.transport_message);
-                else
-                    goto EXIT_RECV_LOOP;
-            }
-            else
-            {
-                _Z_ERROR("Connection closed due to malformed message\n");
-                goto EXIT_RECV_LOOP;
-            }
-        }
-
-        // Move the read position of the read buffer
-        _z_zbuf_set_rpos(&ztu->zbuf, _z_zbuf_get_rpos(&ztu->zbuf) + to_read);
-        _z_zbuf_compact(&ztu->zbuf);
+        if (__unsafe_znp_unicast_handle_zbuf(ztu, to_read) != 0)
+            goto EXIT_RECV_LOOP;
     }
 
 EXIT_RECV_LOOP:
     if (ztu)
     {
         ztu->read_task_running = 0;
+        _zn_unicast_set_rx_task(ztu, 0);
         // Release the lock
         z_mutex_unlock(&ztu->mutex_rx);
     }
 
     return 0;
 }
+
+int _znp_unicast_read_ready(_zn_transport_unicast_t *ztu)
+{
+    int res = 0;
+    z_mutex_lock(&ztu->mutex_rx);
+
+    if (ztu->rx_batch != NULL)
+    {
+        // Take the datagrams already received, the first one is known to be there
+        if (_zn_link_recv_batch(ztu->link, ztu->rx_batch, 0) == SIZE_MAX)
+        {
+            _Z_INFO("Connection closed by the remote end\n");
+            res = -1;
+        }
+        else
+            res = __unsafe_znp_unicast_handle_rx_batch(ztu);
+
+        z_mutex_unlock(&ztu->mutex_rx);
+        return res;
+    }
+
+    // Read once, the link is known to be readable and must not block
+    size_t rb = _zn_link_recv_zbuf(ztu->link, &ztu->zbuf, NULL);
+    if (rb == SIZE_MAX || (rb == 0 && ztu->link->is_streamed == 1))
+    {
+        _Z_INFO("Connection closed by the remote end\n");
+        res = -1;
+    }
+    else if (ztu->link->is_streamed == 1)
+    {
+        // Handle the complete messages, the last one may be completed by the next read
+        while (res == 0 && _z_zbuf_len(&ztu->zbuf) >= _ZN_MSG_LEN_ENC_SIZE)
+        {
+            size_t to_read = 0;
+            for (int i = 0; i < _ZN_MSG_LEN_ENC_SIZE; i++)
+                to_read |= _z_zbuf_read(&ztu->zbuf) << (i * 8);
+
+            if (_z_zbuf_len(&ztu->zbuf) < to_read)
+            {
+                _z_zbuf_set_rpos(&ztu->zbuf, _z_zbuf_get_rpos(&ztu->zbuf) - _ZN_MSG_LEN_ENC_SIZE);
+                break;
+            }
+
+            res = __unsafe_znp_unicast_handle_zbuf(ztu, to_read);
+        }
+    }
+    else
+        res = __unsafe_znp_unicast_handle_zbuf(ztu, rb);
+
+    z_mutex_unlock(&ztu->mutex_rx);
+    return res;
+}
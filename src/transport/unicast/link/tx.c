@@ -22,23 +22,293 @@
  * Make sure that the following mutexes are locked before calling this function:
  *  - ztu->mutex_inner
  */
-z_zint_t __unsafe_zn_unicast_get_sn(_zn_transport_unicast_t *ztu, zn_reliability_t reliability)
+z_zint_t __unsafe_zn_unicast_get_sn(_zn_transport_unicast_t *ztu, zn_reliability_t reliability, zn_priority_t priority)
 {
     z_zint_t sn;
+    _zn_coundit_sn_t *sns = _zn_conduit_sn_list_get(&ztu->sn_tx_sns, priority);
     // Get the sequence number and update it in modulo operation
     if (reliability == zn_reliability_t_RELIABLE)
     {
-        sn = ztu->sn_tx_reliable;
-        ztu->sn_tx_reliable = (ztu->sn_tx_reliable + 1) % ztu->sn_resolution;
+        sn = sns->reliable;
+        sns->reliable = (sns->reliable + 1) % ztu->sn_resolution;
     }
     else
     {
-        sn = ztu->sn_tx_best_effort;
-        ztu->sn_tx_best_effort = (ztu->sn_tx_best_effort + 1) % ztu->sn_resolution;
+        sn = sns->best_effort;
+        sns->best_effort = (sns->best_effort + 1) % ztu->sn_resolution;
     }
     return sn;
 }
 
+/*------------------ Retransmission helpers ------------------*/
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - ztu->mutex_tx
+ */
+void __unsafe_zn_unicast_keep_frame(_zn_transport_unicast_t *ztu, const _z_wbuf_t *wbf, zn_reliability_t reliability, z_zint_t sn)
+{
+    // Keep a copy of the reliable frames until they are acknowledged
+    if (ztu->is_retransmitting == 1 && reliability == zn_reliability_t_RELIABLE)
+        _zn_frame_window_put(&ztu->tx_window, ztu->sn_resolution, sn, wbf);
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - ztu->mutex_tx
+ */
+int __unsafe_zn_unicast_send_frame(_zn_transport_unicast_t *ztu, const _z_wbuf_t *wbf, zn_reliability_t reliability, z_zint_t sn)
+{
+    __unsafe_zn_unicast_keep_frame(ztu, wbf, reliability, sn);
+
+    // Send the wbuf on the socket
+    int res = _zn_link_send_wbuf(ztu->link, wbf);
+    if (res == 0)
+        ztu->transmitted = 1;
+
+    return res;
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - ztu->mutex_tx
+ */
+int __unsafe_zn_unicast_send_sync(_zn_transport_unicast_t *ztu)
+{
+    // Push out any open batch, its frame has already been given a SN
+    __unsafe_zn_unicast_flush(ztu);
+
+    // Announce the next reliable SN and the number of unacknowledged frames
+    z_zint_t count = _zn_sn_distance(ztu->sn_resolution, ztu->tx_window.base, ztu->sn_tx_sns.val.plain.reliable);
+    _zn_transport_message_t t_msg = _zn_t_msg_make_sync(ztu->sn_tx_sns.val.plain.reliable, 1, count);
+
+    // Prepare the buffer eventually reserving space for the message length
+    __unsafe_zn_prepare_wbuf(&ztu->wbuf, ztu->link->is_streamed);
+
+    int res = _zn_transport_message_encode(&ztu->wbuf, &t_msg);
+    if (res == 0)
+    {
+        // Write the message length in the reserved space if needed
+        __unsafe_zn_finalize_wbuf(&ztu->wbuf, ztu->link->is_streamed);
+        // Send the wbuf on the socket
+        res = _zn_link_send_wbuf(ztu->link, &ztu->wbuf);
+    }
+
+    return res;
+}
+
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - ztu->mutex_tx
+ */
+int __unsafe_zn_unicast_is_tx_window_full(const _zn_transport_unicast_t *ztu, zn_reliability_t reliability)
+{
+    if (ztu->is_retransmitting == 0 || reliability != zn_reliability_t_RELIABLE)
+        return 0;
+
+    return _zn_sn_distance(ztu->sn_resolution, ztu->tx_window.base, ztu->sn_tx_sns.val.plain.reliable) >= ztu->tx_window.capacity;
+}
+
+/**
+ * Wait until a new reliable frame fits in the retransmission window.
+ * The lock is temporarily released while waiting for the remote end to acknowledge.
+ *
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - ztu->mutex_tx
+ */
+int __unsafe_zn_unicast_wait_tx_window(_zn_transport_unicast_t *ztu, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl)
+{
+    if (!__unsafe_zn_unicast_is_tx_window_full(ztu, reliability))
+        return 0;
+
+    // The acknowledgments are handled by the RX task, it would wait for itself
+    z_task_t self = z_task_self();
+    if (cong_ctrl == zn_congestion_control_t_DROP || (ztu->has_rx_task && z_task_eq(&ztu->rx_task, &self)))
+    {
+        _Z_INFO("Dropping zenoh message because the retransmission window is full\n");
+        return -1;
+    }
+
+    z_clock_t start = z_clock_now();
+    z_zint_t elapsed = 0;
+    z_zint_t next_sync = 0;
+    while (__unsafe_zn_unicast_is_tx_window_full(ztu, reliability))
+    {
+        // Give up after a lease period, the session is expiring anyway
+        if (elapsed >= ztu->lease)
+        {
+            _Z_INFO("Dropping zenoh message because the retransmission window is full\n");
+            return -1;
+        }
+
+        // Solicit an acknowledgment every sync interval
+        if (elapsed >= next_sync)
+        {
+            __unsafe_zn_unicast_send_sync(ztu);
+            next_sync = elapsed + ZN_SYNC_INTERVAL;
+        }
+
+        z_zint_t timeout = (next_sync < ztu->lease ? next_sync : ztu->lease) - elapsed;
+        z_condvar_timedwait(&ztu->cond_tx_window, &ztu->mutex_tx, (unsigned int)timeout);
+        elapsed = z_clock_elapsed_ms(&start);
+
+        // Push out any batch that has been opened in the meantime
+        __unsafe_zn_unicast_flush(ztu);
+    }
+
+    // The signal wakes up a single waiter, pass it on to the next one
+    z_condvar_signal(&ztu->cond_tx_window);
+
+    return 0;
+}
+
+/**
+ * Record whether the calling task is handling the received messages.
+ */
+void _zn_unicast_set_rx_task(_zn_transport_unicast_t *ztu, int is_rx_task)
+{
+    z_mutex_lock(&ztu->mutex_tx);
+    ztu->rx_task = z_task_self();
+    ztu->has_rx_task = is_rx_task;
+    z_mutex_unlock(&ztu->mutex_tx);
+}
+
+int _zn_unicast_sync(_zn_transport_unicast_t *ztu)
+{
+    int res = 0;
+    z_mutex_lock(&ztu->mutex_tx);
+    if (ztu->is_retransmitting == 1 && ztu->tx_window.base != ztu->sn_tx_sns.val.plain.reliable)
+        res = __unsafe_zn_unicast_send_sync(ztu);
+    z_mutex_unlock(&ztu->mutex_tx);
+
+    return res;
+}
+
+int _zn_unicast_handle_ack_nack(_zn_transport_unicast_t *ztu, const _zn_ack_nack_t *ack_nack)
+{
+    if (ztu->is_retransmitting == 0)
+        return 0;
+
+    z_mutex_lock(&ztu->mutex_tx);
+
+    // Release the frames preceding the acknowledged SN, ignore stale acknowledgments
+    z_zint_t unacked = _zn_sn_distance(ztu->sn_resolution, ztu->tx_window.base, ztu->sn_tx_sns.val.plain.reliable);
+    z_zint_t acked = _zn_sn_distance(ztu->sn_resolution, ztu->tx_window.base, ack_nack->sn);
+    if (acked > unacked)
+        goto EXIT_ACK_NACK;
+    _zn_frame_window_advance(&ztu->tx_window, ztu->sn_resolution, acked);
+    if (acked > 0)
+        z_condvar_signal(&ztu->cond_tx_window);
+
+    // Retransmit the frames the remote end is missing
+    for (size_t i = 0; i < sizeof(z_zint_t) * 8; i++)
+    {
+        if ((ack_nack->mask & ((z_zint_t)1 << i)) == 0)
+            continue;
+
+        z_bytes_t *frame = _zn_frame_window_get(&ztu->tx_window, ztu->sn_resolution, (ack_nack->sn + i) % ztu->sn_resolution);
+        if (frame == NULL || _z_bytes_is_empty(frame))
+            continue;
+
+        _Z_DEBUG("Retransmitting reliable frame with SN %zu\n", (ack_nack->sn + i) % ztu->sn_resolution);
+        if (ztu->link->write_all_f(ztu->link, frame->val, frame->len) == SIZE_MAX)
+            break;
+        ztu->transmitted = 1;
+    }
+
+EXIT_ACK_NACK:
+    z_mutex_unlock(&ztu->mutex_tx);
+    return 0;
+}
+
+/*------------------ Batching helper ------------------*/
+/**
+ * This function is unsafe because it operates in potentially concurrent data.
+ * Make sure that the following mutexes are locked before calling this function:
+ *  - ztu->mutex_tx
+ */
+int __unsafe_zn_unicast_flush(_zn_transport_unicast_t *ztu)
+{
+#if ZN_TX_BATCHING == 1
+    if (ztu->batch_is_open == 0)
+        return 0;
+
+    // Close the frame before sending it
+    ztu->batch_is_open = 0;
+
+    // Write the message length in the reserved space if needed
+    __unsafe_zn_finalize_wbuf(&ztu->wbuf, ztu->link->is_streamed);
+
+    // Send the wbuf on the socket
+    return __unsafe_zn_unicast_send_frame(ztu, &ztu->wbuf, ztu->batch_reliability, ztu->batch_sn);
+#else
+    (void)(ztu);
+    return 0;
+#endif
+}
+
+int _zn_unicast_flush(_zn_transport_unicast_t *ztu)
+{
+    z_mutex_lock(&ztu->mutex_tx);
+    int res = __unsafe_zn_unicast_flush(ztu);
+    z_mutex_unlock(&ztu->mutex_tx);
+
+    return res;
+}
+
+int _zn_unicast_flush_lingering(_zn_transport_unicast_t *ztu)
+{
+    int res = 0;
+#if ZN_TX_BATCHING == 1
+    z_mutex_lock(&ztu->mutex_tx);
+    if (ztu->batch_is_open == 1 && z_clock_elapsed_ms(&ztu->batch_opened) >= ZN_TX_BATCH_LINGER_MS)
+        res = __unsafe_zn_unicast_flush(ztu);
+    z_mutex_unlock(&ztu->mutex_tx);
+#else
+    (void)(ztu);
+#endif
+    return res;
+}
+
+int _zn_unicast_is_batch_open(_zn_transport_unicast_t *ztu)
+{
+    int is_open = 0;
+#if ZN_TX_BATCHING == 1
+    z_mutex_lock(&ztu->mutex_tx);
+    is_open = ztu->batch_is_open;
+    z_mutex_unlock(&ztu->mutex_tx);
+#else
+    (void)(ztu);
+#endif
+    return is_open;
+}
+
+void _zn_unicast_wait_batch(_zn_transport_unicast_t *ztu, unsigned int time)
+{
+#if ZN_TX_BATCHING == 1
+    z_mutex_lock(&ztu->mutex_tx);
+    if (ztu->batch_is_open == 0)
+    {
+        // Wake up early if a batch is opened in the meantime
+        z_condvar_timedwait(&ztu->cond_batch_open, &ztu->mutex_tx, time);
+        z_mutex_unlock(&ztu->mutex_tx);
+        return;
+    }
+    z_mutex_unlock(&ztu->mutex_tx);
+
+    // A batch opened after the wait time was computed still has to be pushed out in time
+    if (ZN_TX_BATCH_LINGER_MS < time)
+        time = ZN_TX_BATCH_LINGER_MS;
+#else
+    (void)(ztu);
+#endif
+    z_sleep_ms(time);
+}
+
 int _zn_unicast_send_t_msg(_zn_transport_unicast_t *ztu, const _zn_transport_message_t *t_msg)
 {
     _Z_DEBUG(">> send session message\n");
@@ -46,6 +316,9 @@ int _zn_unicast_send_t_msg(_zn_transport_unicast_t *ztu, const _zn_transport_mes
     // Acquire the lock
     z_mutex_lock(&ztu->mutex_tx);
 
+    // Push out any open batch to preserve the message ordering
+    __unsafe_zn_unicast_flush(ztu);
+
     // Prepare the buffer eventually reserving space for the message length
     __unsafe_zn_prepare_wbuf(&ztu->wbuf, ztu->link->is_streamed);
 
@@ -71,38 +344,104 @@ int _zn_unicast_send_t_msg(_zn_transport_unicast_t *ztu, const _zn_transport_mes
     return res;
 }
 
-int _zn_unicast_send_z_msg(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl)
+int _zn_unicast_send_z_msg(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl, zn_priority_t priority)
 {
     _Z_DEBUG(">> send zenoh message\n");
 
     _zn_transport_unicast_t *ztu = &zn->tp->transport.unicast;
 
-    // Acquire the lock and drop the message if needed
+    // Wait for the turn of the priority and drop the message if needed
     if (cong_ctrl == zn_congestion_control_t_BLOCK)
     {
-        z_mutex_lock(&ztu->mutex_tx);
+        _zn_tx_scheduler_acquire(&ztu->tx_scheduler, priority);
     }
     else
     {
-        int locked = z_mutex_trylock(&ztu->mutex_tx);
-        if (locked != 0)
+        int acquired = _zn_tx_scheduler_try_acquire(&ztu->tx_scheduler, priority);
+        if (acquired != 0)
         {
             _Z_INFO("Dropping zenoh message because of congestion control\n");
-            // We failed to acquire the lock, drop the message
+            // We failed to get the turn, drop the message
             return 0;
         }
     }
+    z_mutex_lock(&ztu->mutex_tx);
+
+    // Without QoS all the priorities share the default conduit
+    if (ztu->sn_tx_sns.is_qos == 0)
+        priority = ZN_PRIORITY_DEFAULT;
+
+    int res = 0;
+
+#if ZN_TX_BATCHING == 1
+    if (ztu->batch_is_open == 1)
+    {
+        // Large payloads are not copied into the batch if they can be sent straight from the user buffer
+        // or if they are known not to fit in it
+        if (ztu->batch_reliability == reliability && ztu->batch_priority == priority && !__zn_link_can_send_vectored(ztu->link, z_msg) &&
+            !__zn_zenoh_message_exceeds(z_msg, _z_wbuf_space_left(&ztu->wbuf)))
+        {
+            // Try to append the zenoh message to the open frame
+            size_t w_pos = _z_wbuf_get_wpos(&ztu->wbuf);
+            res = _zn_zenoh_message_encode(&ztu->wbuf, z_msg);
+            if (res == 0)
+            {
+                // Push the batch out if it has been lingering for too long
+                if (z_clock_elapsed_ms(&ztu->batch_opened) >= ZN_TX_BATCH_LINGER_MS)
+                    res = __unsafe_zn_unicast_flush(ztu);
+                goto EXIT_ZSND_PROC;
+            }
+
+            // Revert the partially encoded message
+            _z_wbuf_set_wpos(&ztu->wbuf, w_pos);
+        }
+
+        // The message can not be appended, push out the open batch
+        res = __unsafe_zn_unicast_flush(ztu);
+        if (res != 0)
+        {
+            _Z_INFO("Dropping zenoh message because the open batch can not be sent\n");
+            goto EXIT_ZSND_PROC;
+        }
+    }
+#endif
+
+    // Make room for the frame in the retransmission window if needed
+    res = __unsafe_zn_unicast_wait_tx_window(ztu, reliability, cong_ctrl);
+    if (res != 0)
+        goto EXIT_ZSND_PROC;
 
     // Prepare the buffer eventually reserving space for the message length
     __unsafe_zn_prepare_wbuf(&ztu->wbuf, ztu->link->is_streamed);
 
     // Get the next sequence number
-    z_zint_t sn = __unsafe_zn_unicast_get_sn(ztu, reliability);
+    z_zint_t sn = __unsafe_zn_unicast_get_sn(ztu, reliability, priority);
     // Create the frame header that carries the zenoh message
-    _zn_transport_message_t t_msg = __zn_frame_header(reliability, 0, 0, sn);
+    _zn_transport_message_t t_msg = __zn_frame_header(reliability, priority, 0, 0, sn);
+
+    // Messages known not to fit in the batch are fragmented straight away
+    int is_fragmented = __zn_zenoh_message_exceeds(z_msg, _z_wbuf_space_left(&ztu->wbuf));
+
+    // Send large payloads straight from the user buffer if the link supports vectored writes
+    if (!is_fragmented && __zn_link_can_send_vectored(ztu->link, z_msg))
+    {
+        _z_wbuf_t vbf = _z_wbuf_make(ZN_IOSLICE_SIZE, 1);
+        res = __unsafe_zn_serialize_zenoh_frame_vectored(&vbf, &t_msg, z_msg, ztu->link->is_streamed, _z_wbuf_capacity(&ztu->wbuf));
+        if (res == 0)
+        {
+            // Send the wbuf on the socket
+            res = __unsafe_zn_unicast_send_frame(ztu, &vbf, reliability, sn);
+
+            _z_wbuf_clear(&vbf);
+            goto EXIT_ZSND_PROC;
+        }
+
+        // The message does not fit in a single batch, fall back to fragmentation
+        _z_wbuf_clear(&vbf);
+    }
 
     // Encode the frame header
-    int res = _zn_transport_message_encode(&ztu->wbuf, &t_msg);
+    res = _zn_transport_message_encode(&ztu->wbuf, &t_msg);
     if (res != 0)
     {
         _Z_INFO("Dropping zenoh message because the session frame can not be encoded\n");
@@ -110,24 +449,41 @@ int _zn_unicast_send_z_msg(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_reli
     }
 
     // Encode the zenoh message
-    res = _zn_zenoh_message_encode(&ztu->wbuf, z_msg);
+    res = is_fragmented ? -1 : _zn_zenoh_message_encode(&ztu->wbuf, z_msg);
     if (res == 0)
     {
+#if ZN_TX_BATCHING == 1
+        // Keep the frame open so that following messages can be appended to it
+        ztu->batch_is_open = 1;
+        ztu->batch_reliability = reliability;
+        ztu->batch_priority = priority;
+        ztu->batch_sn = sn;
+        ztu->batch_opened = z_clock_now();
+        z_condvar_signal(&ztu->cond_batch_open);
+#else
         // Write the message legnth in the reserved space if needed
         __unsafe_zn_finalize_wbuf(&ztu->wbuf, ztu->link->is_streamed);
 
         // Send the wbuf on the socket
-        res = _zn_link_send_wbuf(ztu->link, &ztu->wbuf);
-        if (res == 0)
-            ztu->transmitted = 1;
+        res = __unsafe_zn_unicast_send_frame(ztu, &ztu->wbuf, reliability, sn);
+#endif
     }
     else
     {
         // The message does not fit in the current batch, let's fragment it
-        // Create an expandable wbuf for fragmentation
-        _z_wbuf_t fbf = _z_wbuf_make(ZN_IOSLICE_SIZE, 1);
+        // Fragments are gathered straight from the user buffers if the link supports vectored writes,
+        // otherwise they are copied into the batch
+        size_t mtu = _z_wbuf_capacity(&ztu->wbuf);
+        _z_wbuf_t vbf = _z_wbuf_make(ZN_IOSLICE_SIZE, 1);
+        _z_wbuf_t *dst = ztu->link->writev_f != NULL ? &vbf : &ztu->wbuf;
+
+        // Several fragments are written at once if the link supports batched writes
+        int is_batching = __zn_link_can_batch_fragments(ztu->link);
+        _zn_fragment_batch_t fb;
+        _zn_fragment_batch_init(&fb);
 
-        // Encode the message on the expandable wbuf
+        // Encode the message once on an expandable wbuf: large payloads are referenced, not copied
+        _z_wbuf_t fbf = _z_wbuf_make(ZN_IOSLICE_SIZE, 1);
         res = _zn_zenoh_message_encode(&fbf, z_msg);
         if (res != 0)
         {
@@ -141,14 +497,34 @@ int _zn_unicast_send_z_msg(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_reli
         {
             // Get the fragment sequence number
             if (!is_first)
-                sn = __unsafe_zn_unicast_get_sn(ztu, reliability);
+            {
+                // The pending fragments must be sent for the remote end to acknowledge them
+                if (fb.len > 0 && __unsafe_zn_unicast_is_tx_window_full(ztu, reliability))
+                {
+                    res = _zn_fragment_batch_send(&fb, ztu->link);
+                    if (res != 0)
+                    {
+                        _Z_INFO("Dropping zenoh message because it can not sent\n");
+                        goto EXIT_FRAG_PROC;
+                    }
+                    ztu->transmitted = 1;
+                }
+
+                res = __unsafe_zn_unicast_wait_tx_window(ztu, reliability, cong_ctrl);
+                if (res != 0)
+                    goto EXIT_FRAG_PROC;
+                sn = __unsafe_zn_unicast_get_sn(ztu, reliability, priority);
+            }
             is_first = 0;
 
             // Clear the buffer for serialization
-            __unsafe_zn_prepare_wbuf(&ztu->wbuf, ztu->link->is_streamed);
+            // The slices referencing the user buffers are dropped, the allocated ones are reused
+            if (is_batching)
+                dst = _zn_fragment_batch_next(&fb);
+            __unsafe_zn_prepare_wbuf(dst, ztu->link->is_streamed);
 
             // Serialize one fragment
-            res = __unsafe_zn_serialize_zenoh_fragment(&ztu->wbuf, &fbf, reliability, sn);
+            res = __unsafe_zn_serialize_zenoh_fragment(dst, &fbf, reliability, priority, sn, mtu);
             if (res != 0)
             {
                 _Z_INFO("Dropping zenoh message because it can not be fragmented\n");
@@ -156,28 +532,189 @@ int _zn_unicast_send_z_msg(zn_session_t *zn, _zn_zenoh_message_t *z_msg, zn_reli
             }
 
             // Write the message length in the reserved space if needed
-            __unsafe_zn_finalize_wbuf(&ztu->wbuf, ztu->link->is_streamed);
+            __unsafe_zn_finalize_wbuf(dst, ztu->link->is_streamed);
 
-            // Send the wbuf on the socket
-            res = _zn_link_send_wbuf(ztu->link, &ztu->wbuf);
+            // Send the wbuf on the socket, batched fragments once there is no more room for them
+            if (is_batching)
+            {
+                __unsafe_zn_unicast_keep_frame(ztu, dst, reliability, sn);
+                if (!_zn_fragment_batch_is_full(&fb) && _z_wbuf_len(&fbf) > 0)
+                    continue;
+
+                res = _zn_fragment_batch_send(&fb, ztu->link);
+                if (res == 0)
+                    ztu->transmitted = 1;
+            }
+            else
+                res = __unsafe_zn_unicast_send_frame(ztu, dst, reliability, sn);
             if (res != 0)
             {
                 _Z_INFO("Dropping zenoh message because it can not sent\n");
                 goto EXIT_FRAG_PROC;
             }
-
-            // Mark the session that we have transmitted data
-            ztu->transmitted = 1;
         }
 
     EXIT_FRAG_PROC:
-        // Free the fragmentation buffer memory
+        // Free the fragmentation buffers memory
+        _zn_fragment_batch_clear(&fb);
+        _z_wbuf_clear(&vbf);
         _z_wbuf_clear(&fbf);
     }
 
 EXIT_ZSND_PROC:
-    // Release the lock
+    // Release the lock and hand the turn over
+    z_mutex_unlock(&ztu->mutex_tx);
+    _zn_tx_scheduler_release(&ztu->tx_scheduler);
+
+    return res;
+}
+
+uint8_t *_zn_unicast_loan_z_msg(zn_session_t *zn, const _zn_zenoh_message_t *z_msg, zn_reliability_t reliability, zn_congestion_control_t cong_ctrl, zn_priority_t priority)
+{
+    _Z_DEBUG(">> loan zenoh message\n");
+
+    _zn_transport_unicast_t *ztu = &zn->tp->transport.unicast;
+
+    // Wait for the turn of the priority and drop the message if needed
+    if (cong_ctrl == zn_congestion_control_t_BLOCK)
+    {
+        _zn_tx_scheduler_acquire(&ztu->tx_scheduler, priority);
+    }
+    else
+    {
+        int acquired = _zn_tx_scheduler_try_acquire(&ztu->tx_scheduler, priority);
+        if (acquired != 0)
+        {
+            _Z_INFO("Dropping zenoh message because of congestion control\n");
+            // We failed to get the turn, drop the message
+            return NULL;
+        }
+    }
+    z_mutex_lock(&ztu->mutex_tx);
+
+    // Without QoS all the priorities share the default conduit
+    if (ztu->sn_tx_sns.is_qos == 0)
+        priority = ZN_PRIORITY_DEFAULT;
+
+    uint8_t *payload = NULL;
+
+#if ZN_TX_BATCHING == 1
+    if (ztu->batch_is_open == 1)
+    {
+        if (ztu->batch_reliability == reliability && ztu->batch_priority == priority)
+        {
+            // Try to loan the payload from the open frame
+            size_t w_pos = _z_wbuf_get_wpos(&ztu->wbuf);
+            if (_zn_zenoh_message_encode_loan(&ztu->wbuf, z_msg, &payload) == 0)
+            {
+                // Keep what is needed to revert the message if it is aborted
+                ztu->loan_wpos = w_pos;
+                ztu->loan_sns = *_zn_conduit_sn_list_get(&ztu->sn_tx_sns, priority);
+                ztu->loan_batch_is_open = 1;
+                return payload;
+            }
+
+            // Revert the partially encoded message
+            _z_wbuf_set_wpos(&ztu->wbuf, w_pos);
+        }
+
+        // The message can not be appended, push out the open batch
+        if (__unsafe_zn_unicast_flush(ztu) != 0)
+        {
+            _Z_INFO("Dropping zenoh message because the open batch can not be sent\n");
+            goto ERR;
+        }
+    }
+#endif
+
+    // Make room for the frame in the retransmission window if needed
+    if (__unsafe_zn_unicast_wait_tx_window(ztu, reliability, cong_ctrl) != 0)
+        goto ERR;
+
+    // Prepare the buffer eventually reserving space for the message length
+    __unsafe_zn_prepare_wbuf(&ztu->wbuf, ztu->link->is_streamed);
+
+    // Get the next sequence number, restoring it if the loan fails
+    size_t w_pos = _z_wbuf_get_wpos(&ztu->wbuf);
+    _zn_coundit_sn_t sns = *_zn_conduit_sn_list_get(&ztu->sn_tx_sns, priority);
+    z_zint_t sn = __unsafe_zn_unicast_get_sn(ztu, reliability, priority);
+    // Create the frame header that carries the zenoh message
+    _zn_transport_message_t t_msg = __zn_frame_header(reliability, priority, 0, 0, sn);
+
+    // Encode the frame header and the zenoh message up to its payload
+    if (_zn_transport_message_encode(&ztu->wbuf, &t_msg) != 0 || _zn_zenoh_message_encode_loan(&ztu->wbuf, z_msg, &payload) != 0)
+    {
+        _Z_INFO("Dropping zenoh message because the payload does not fit in a single batch\n");
+        *_zn_conduit_sn_list_get(&ztu->sn_tx_sns, priority) = sns;
+        goto ERR;
+    }
+
+    // Keep track of the frame until the message is committed or aborted
+    ztu->batch_reliability = reliability;
+    ztu->batch_priority = priority;
+    ztu->batch_sn = sn;
+    ztu->loan_wpos = w_pos;
+    ztu->loan_sns = sns;
+#if ZN_TX_BATCHING == 1
+    ztu->loan_batch_is_open = 0;
+    // Keep the frame open so that following messages can be appended to it
+    ztu->batch_is_open = 1;
+    ztu->batch_opened = z_clock_now();
+    z_condvar_signal(&ztu->cond_batch_open);
+#endif
+
+    // The lock and the turn are released when the message is committed or aborted
+    return payload;
+
+ERR:
+    z_mutex_unlock(&ztu->mutex_tx);
+    _zn_tx_scheduler_release(&ztu->tx_scheduler);
+    return NULL;
+}
+
+int _zn_unicast_commit_z_msg(zn_session_t *zn)
+{
+    _Z_DEBUG(">> commit zenoh message\n");
+
+    _zn_transport_unicast_t *ztu = &zn->tp->transport.unicast;
+
+#if ZN_TX_BATCHING == 1
+    // Push the batch out if it has been lingering for too long
+    int res = 0;
+    if (z_clock_elapsed_ms(&ztu->batch_opened) >= ZN_TX_BATCH_LINGER_MS)
+        res = __unsafe_zn_unicast_flush(ztu);
+#else
+    // Write the message length in the reserved space if needed
+    __unsafe_zn_finalize_wbuf(&ztu->wbuf, ztu->link->is_streamed);
+
+    // Send the wbuf on the socket
+    int res = __unsafe_zn_unicast_send_frame(ztu, &ztu->wbuf, ztu->batch_reliability, ztu->batch_sn);
+#endif
+
+    // Release the lock and the turn acquired when loaning the message
     z_mutex_unlock(&ztu->mutex_tx);
+    _zn_tx_scheduler_release(&ztu->tx_scheduler);
 
     return res;
-}
\ No newline at end of file
+}
+
+int _zn_unicast_abort_z_msg(zn_session_t *zn)
+{
+    _Z_DEBUG(">> abort zenoh message\n");
+
+    _zn_transport_unicast_t *ztu = &zn->tp->transport.unicast;
+
+    // Drop the loaned message and give its sequence number back
+    _z_wbuf_set_wpos(&ztu->wbuf, ztu->loan_wpos);
+    *_zn_conduit_sn_list_get(&ztu->sn_tx_sns, ztu->batch_priority) = ztu->loan_sns;
+#if ZN_TX_BATCHING == 1
+    // Frames already in the batch are still sent, an empty one is discarded
+    ztu->batch_is_open = ztu->loan_batch_is_open;
+#endif
+
+    // Release the lock and the turn acquired when loaning the message
+    z_mutex_unlock(&ztu->mutex_tx);
+    _zn_tx_scheduler_release(&ztu->tx_scheduler);
+
+    return 0;
+}
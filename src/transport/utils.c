@@ -12,7 +12,11 @@
 //   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
 //
 
+#include <string.h>
+#include "zenoh-pico/system/platform.h"
 #include "zenoh-pico/transport/utils.h"
+#include "zenoh-pico/utils/logging.h"
+#include "zenoh-pico/config.h"
 
 int _zn_sn_precedes(const z_zint_t sn_resolution_half, const z_zint_t sn_left, const z_zint_t sn_right)
 {
@@ -35,6 +39,34 @@ z_zint_t _zn_sn_decrement(const z_zint_t sn_resolution, const z_zint_t sn)
         return sn - 1;
 }
 
+z_zint_t _zn_sn_distance(const z_zint_t sn_resolution, const z_zint_t sn_left, const z_zint_t sn_right)
+{
+    if (sn_right >= sn_left)
+        return sn_right - sn_left;
+    else
+        return sn_resolution - sn_left + sn_right;
+}
+
+_zn_conduit_sn_list_t _zn_conduit_sn_list_make(uint8_t is_qos, const z_zint_t sn)
+{
+    _zn_conduit_sn_list_t sns;
+    sns.is_qos = is_qos;
+    for (int i = 0; i < ZN_PRIORITIES_NUM; i++)
+    {
+        sns.val.qos[i].best_effort = sn;
+        sns.val.qos[i].reliable = sn;
+    }
+    return sns;
+}
+
+_zn_coundit_sn_t *_zn_conduit_sn_list_get(_zn_conduit_sn_list_t *sns, zn_priority_t priority)
+{
+    if (sns->is_qos == 0)
+        return &sns->val.plain;
+    else
+        return &sns->val.qos[priority];
+}
+
 void _zn_conduit_sn_list_copy(_zn_conduit_sn_list_t *dst, const _zn_conduit_sn_list_t *src)
 {
     dst->is_qos = src->is_qos;
@@ -65,7 +97,335 @@ void _zn_conduit_sn_list_decrement(const z_zint_t sn_resolution, _zn_conduit_sn_
         for (int i = 0; i < ZN_PRIORITIES_NUM; i++)
         {
             sns->val.qos[i].best_effort = _zn_sn_decrement(sn_resolution, sns->val.qos[i].best_effort);
-            sns->val.qos[i].best_effort = _zn_sn_decrement(sn_resolution, sns->val.qos[i].reliable);
+            sns->val.qos[i].reliable = _zn_sn_decrement(sn_resolution, sns->val.qos[i].reliable);
+        }
+    }
+}
+
+/*------------------ Frame window ------------------*/
+_zn_frame_window_t _zn_frame_window_make(size_t capacity, z_zint_t base)
+{
+    _zn_frame_window_t w;
+    w.slots = NULL;
+    if (capacity > 0)
+        w.slots = (z_bytes_t *)z_malloc(capacity * sizeof(z_bytes_t));
+    for (size_t i = 0; i < capacity; i++)
+        _z_bytes_reset(&w.slots[i]);
+
+    w.capacity = capacity;
+    w.head = 0;
+    w.base = base;
+    return w;
+}
+
+z_bytes_t *_zn_frame_window_get(const _zn_frame_window_t *w, const z_zint_t sn_resolution, const z_zint_t sn)
+{
+    z_zint_t offset = _zn_sn_distance(sn_resolution, w->base, sn);
+    if (offset >= w->capacity)
+        return NULL;
+
+    return &w->slots[(w->head + offset) % w->capacity];
+}
+
+int _zn_frame_window_put(_zn_frame_window_t *w, const z_zint_t sn_resolution, const z_zint_t sn, const _z_wbuf_t *wbf)
+{
+    z_bytes_t *slot = _zn_frame_window_get(w, sn_resolution, sn);
+    if (slot == NULL)
+        return -1;
+
+    // Flatten the serialized frame, it may span several slices
+    size_t len = 0;
+    for (size_t i = 0; i < _z_wbuf_len_iosli(wbf); i++)
+        len += _z_iosli_readable(_z_wbuf_get_iosli(wbf, i));
+
+    _z_bytes_clear(slot);
+    _z_bytes_init(slot, len);
+
+    len = 0;
+    for (size_t i = 0; i < _z_wbuf_len_iosli(wbf); i++)
+    {
+        z_bytes_t bs = _z_iosli_to_bytes(_z_wbuf_get_iosli(wbf, i));
+        memcpy((uint8_t *)slot->val + len, bs.val, bs.len);
+        len += bs.len;
+    }
+
+    return 0;
+}
+
+void _zn_frame_window_advance(_zn_frame_window_t *w, const z_zint_t sn_resolution, const z_zint_t count)
+{
+    if (w->capacity == 0)
+        return;
+
+    // Release the frames that slide out of the window
+    for (z_zint_t i = 0; i < count && i < w->capacity; i++)
+        _z_bytes_clear(&w->slots[(w->head + i) % w->capacity]);
+
+    w->head = (w->head + count) % w->capacity;
+    w->base = (w->base + count) % sn_resolution;
+}
+
+void _zn_frame_window_clear(_zn_frame_window_t *w)
+{
+    for (size_t i = 0; i < w->capacity; i++)
+        _z_bytes_clear(&w->slots[i]);
+
+    z_free(w->slots);
+    w->slots = NULL;
+    w->capacity = 0;
+}
+
+/*------------------ Defragmentation pool ------------------*/
+_zn_defrag_pool_t _zn_defrag_pool_make(size_t capacity)
+{
+    _zn_defrag_pool_t pool;
+    z_mutex_init(&pool.mutex);
+    pool.slots = NULL;
+    pool.states = NULL;
+    if (capacity > 0)
+    {
+        pool.slots = (_z_wbuf_t *)z_malloc(capacity * sizeof(_z_wbuf_t));
+        pool.states = (uint8_t *)z_malloc(capacity * sizeof(uint8_t));
+    }
+    for (size_t i = 0; i < capacity; i++)
+        pool.states[i] = _ZN_DEFRAG_SLOT_UNALLOCATED;
+
+    pool.capacity = capacity;
+    return pool;
+}
+
+void _zn_defrag_pool_clear(_zn_defrag_pool_t *pool)
+{
+    for (size_t i = 0; i < pool->capacity; i++)
+    {
+        if (pool->states[i] != _ZN_DEFRAG_SLOT_UNALLOCATED)
+            _z_wbuf_clear(&pool->slots[i]);
+    }
+
+    z_free(pool->slots);
+    z_free(pool->states);
+    pool->slots = NULL;
+    pool->states = NULL;
+    pool->capacity = 0;
+    z_mutex_free(&pool->mutex);
+}
+
+_z_wbuf_t *__zn_defrag_pool_checkout(_zn_defrag_pool_t *pool)
+{
+    _z_wbuf_t *wbf = NULL;
+
+    z_mutex_lock(&pool->mutex);
+    // Prefer the slots that are already allocated
+    for (size_t i = 0; i < pool->capacity && wbf == NULL; i++)
+    {
+        if (pool->states[i] == _ZN_DEFRAG_SLOT_FREE)
+        {
+            pool->states[i] = _ZN_DEFRAG_SLOT_USED;
+            wbf = &pool->slots[i];
+        }
+    }
+    for (size_t i = 0; i < pool->capacity && wbf == NULL; i++)
+    {
+        if (pool->states[i] == _ZN_DEFRAG_SLOT_UNALLOCATED)
+        {
+#if ZN_DYNAMIC_MEMORY_ALLOCATION == 1
+            // The single slice grows with the reassembled message, see __zn_defrag_buf_reserve
+            pool->slots[i] = _z_wbuf_make(0, 0);
+#else
+            pool->slots[i] = _z_wbuf_make(ZN_DEFRAG_POOL_SLOT_SIZE, 0);
+#endif
+            pool->states[i] = _ZN_DEFRAG_SLOT_USED;
+            wbf = &pool->slots[i];
         }
     }
-}
\ No newline at end of file
+    z_mutex_unlock(&pool->mutex);
+
+    return wbf;
+}
+
+void __zn_defrag_pool_release(_zn_defrag_pool_t *pool, _z_wbuf_t *wbf)
+{
+    size_t i = (size_t)(wbf - pool->slots);
+
+    z_mutex_lock(&pool->mutex);
+#if ZN_DYNAMIC_MEMORY_ALLOCATION == 1
+    // Expandable buffers only keep the memory while in use
+    _z_wbuf_clear(wbf);
+    pool->states[i] = _ZN_DEFRAG_SLOT_UNALLOCATED;
+#else
+    _z_wbuf_reset(wbf);
+    pool->states[i] = _ZN_DEFRAG_SLOT_FREE;
+#endif
+    z_mutex_unlock(&pool->mutex);
+}
+
+#if ZN_DYNAMIC_MEMORY_ALLOCATION == 1
+/**
+ * Make room for **len** more bytes in the single slice of a defragmentation buffer. Its capacity
+ * is doubled, such that the reassembled message is moved a bounded number of times as it grows.
+ */
+int __zn_defrag_buf_reserve(_z_wbuf_t *wbf, size_t len)
+{
+    _z_iosli_t *ios = _z_wbuf_get_iosli(wbf, 0);
+    if (_z_iosli_writable(ios) >= len)
+        return 0;
+
+    size_t capacity = ios->capacity > 0 ? ios->capacity : ZN_IOSLICE_SIZE;
+    while (capacity < ios->w_pos + len)
+        capacity *= 2;
+    if (capacity > ZN_DEFRAG_POOL_SLOT_SIZE)
+        capacity = ZN_DEFRAG_POOL_SLOT_SIZE;
+
+    uint8_t *buf = (uint8_t *)z_realloc(ios->buf, capacity);
+    if (buf == NULL)
+        return -1;
+
+    ios->buf = buf;
+    ios->capacity = capacity;
+    wbf->capacity = capacity;
+    return 0;
+}
+#endif
+
+_zn_defrag_buf_t _zn_defrag_buf_make(_zn_defrag_pool_t *pool)
+{
+    _zn_defrag_buf_t dbuf;
+    dbuf.pool = pool;
+    dbuf.wbuf = NULL;
+    dbuf.is_dropping = 0;
+    return dbuf;
+}
+
+int _zn_defrag_buf_push(_zn_defrag_buf_t *dbuf, const z_bytes_t *fragment)
+{
+    if (dbuf->is_dropping)
+        return -1;
+
+    // Check out a slot on the first fragment of the message
+    if (dbuf->wbuf == NULL)
+    {
+        dbuf->wbuf = __zn_defrag_pool_checkout(dbuf->pool);
+        if (dbuf->wbuf == NULL)
+        {
+            _Z_INFO("Fragmented message dropped because no defragmentation buffer is available\n");
+            dbuf->is_dropping = 1;
+            return -1;
+        }
+    }
+
+    // Drop the message if it is bigger than the max buffer size
+    if (_z_wbuf_len(dbuf->wbuf) + fragment->len > ZN_DEFRAG_POOL_SLOT_SIZE)
+    {
+        _Z_INFO("Fragmented message dropped because it exceeds the defragmentation buffer size\n");
+        __zn_defrag_pool_release(dbuf->pool, dbuf->wbuf);
+        dbuf->wbuf = NULL;
+        dbuf->is_dropping = 1;
+        return -1;
+    }
+
+    if (fragment->len == 0)
+        return 0;
+
+#if ZN_DYNAMIC_MEMORY_ALLOCATION == 1
+    if (__zn_defrag_buf_reserve(dbuf->wbuf, fragment->len) != 0)
+    {
+        _Z_INFO("Fragmented message dropped because the defragmentation buffer can not grow\n");
+        __zn_defrag_pool_release(dbuf->pool, dbuf->wbuf);
+        dbuf->wbuf = NULL;
+        dbuf->is_dropping = 1;
+        return -1;
+    }
+#endif
+
+    // Add the fragment to the defragmentation buffer
+    _z_wbuf_write_bytes(dbuf->wbuf, fragment->val, 0, fragment->len);
+    return 0;
+}
+
+_z_zbuf_t _zn_defrag_buf_to_zbuf(const _zn_defrag_buf_t *dbuf)
+{
+    // The reassembled message is held in the single slice of the buffer, it is decoded in place
+    _z_iosli_t *ios = _z_wbuf_get_iosli(dbuf->wbuf, 0);
+
+    _z_zbuf_t zbf;
+    zbf.ios = _z_iosli_wrap(ios->buf, ios->capacity, ios->r_pos, ios->w_pos);
+    return zbf;
+}
+
+void _zn_defrag_buf_reset(_zn_defrag_buf_t *dbuf)
+{
+    if (dbuf->wbuf != NULL)
+        __zn_defrag_pool_release(dbuf->pool, dbuf->wbuf);
+
+    dbuf->wbuf = NULL;
+    dbuf->is_dropping = 0;
+}
+
+/*------------------ TX scheduler ------------------*/
+void _zn_tx_scheduler_init(_zn_tx_scheduler_t *s)
+{
+    z_mutex_init(&s->mutex);
+    for (int i = 0; i < ZN_PRIORITIES_NUM; i++)
+    {
+        z_condvar_init(&s->turn[i]);
+        s->waiting[i] = 0;
+    }
+    s->is_busy = 0;
+}
+
+void _zn_tx_scheduler_clear(_zn_tx_scheduler_t *s)
+{
+    for (int i = 0; i < ZN_PRIORITIES_NUM; i++)
+        z_condvar_free(&s->turn[i]);
+    z_mutex_free(&s->mutex);
+}
+
+int __unsafe_zn_tx_scheduler_is_preceded(const _zn_tx_scheduler_t *s, int priority)
+{
+    for (int i = 0; i < priority; i++)
+    {
+        if (s->waiting[i] > 0)
+            return 1;
+    }
+    return 0;
+}
+
+void _zn_tx_scheduler_acquire(_zn_tx_scheduler_t *s, zn_priority_t priority)
+{
+    z_mutex_lock(&s->mutex);
+    s->waiting[priority]++;
+    while (s->is_busy || __unsafe_zn_tx_scheduler_is_preceded(s, priority))
+        z_condvar_wait(&s->turn[priority], &s->mutex);
+    s->waiting[priority]--;
+    s->is_busy = 1;
+    z_mutex_unlock(&s->mutex);
+}
+
+int _zn_tx_scheduler_try_acquire(_zn_tx_scheduler_t *s, zn_priority_t priority)
+{
+    int res = -1;
+    z_mutex_lock(&s->mutex);
+    if (!s->is_busy && !__unsafe_zn_tx_scheduler_is_preceded(s, priority + 1))
+    {
+        s->is_busy = 1;
+        res = 0;
+    }
+    z_mutex_unlock(&s->mutex);
+    return res;
+}
+
+void _zn_tx_scheduler_release(_zn_tx_scheduler_t *s)
+{
+    z_mutex_lock(&s->mutex);
+    s->is_busy = 0;
+    // Hand the turn over to the highest priority waiting
+    for (int i = 0; i < ZN_PRIORITIES_NUM; i++)
+    {
+        if (s->waiting[i] > 0)
+        {
+            z_condvar_signal(&s->turn[i]);
+            break;
+        }
+    }
+    z_mutex_unlock(&s->mutex);
+}
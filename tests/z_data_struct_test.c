@@ -103,6 +103,19 @@ int main(void)
         assert(_z_str_intmap_len(&map) == i + 1);
     }
     assert(_z_str_intmap_len(&map) == len);
+    assert((size_t)_z_str_intmap_capacity(&map) >= len);
+
+    // Replacing a value does not change the length
+    _z_str_intmap_insert(&map, 0, _z_str_clone("0"));
+    assert(_z_str_intmap_len(&map) == len);
+
+    for (size_t i = 0; i < len; i++)
+    {
+        sprintf(s, "%zu", i);
+        z_str_t e = _z_str_intmap_get(&map, i);
+        assert(_z_str_eq(s, e));
+        (void)(e);
+    }
 
     for (size_t i = 0; i < len; i++)
     {
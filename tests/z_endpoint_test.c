@@ -15,9 +15,11 @@
 #include <assert.h>
 #include <stdio.h>
 #include <string.h>
+#include "zenoh-pico/config.h"
 #include "zenoh-pico/collections/string.h"
 #include "zenoh-pico/link/endpoint.h"
 #include "zenoh-pico/link/config/udp.h"
+#include "zenoh-pico/link/config/shm.h"
 
 int main(void)
 {
@@ -169,6 +171,19 @@ int main(void)
     eres = _zn_endpoint_from_str(s);
     assert(eres.tag == _z_res_t_ERR);
     assert(eres.value.error == _z_err_t_PARSE_STRING);
+
+#if ZN_LINK_SHM == 1
+    sprintf(s, "shm/session#%s=3", SHM_CONFIG_TOUT_STR);
+    printf("- %s\n", s);
+    eres = _zn_endpoint_from_str(s);
+    assert(eres.tag == _z_res_t_OK);
+    assert(_z_str_eq(eres.value.endpoint.locator.protocol, "shm"));
+    assert(_z_str_eq(eres.value.endpoint.locator.address, "session"));
+    assert(_z_str_intmap_len(&eres.value.endpoint.config) == 1);
+    p = _z_str_intmap_get(&eres.value.endpoint.config, SHM_CONFIG_TOUT_KEY);
+    assert(_z_str_eq(p, "3"));
+    _zn_endpoint_clear(&eres.value.endpoint);
+#endif
 #endif
 
     return 0;
@@ -16,6 +16,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "zenoh-pico/config.h"
 #include "zenoh-pico/protocol/iobuf.h"
 
 #define RUNS 1000
@@ -494,6 +495,7 @@ void wbuf_reusable_write_zbuf_read(void)
         printf("    IOSlices: %zu, RIdx: %zu, WIdx: %zu\n", _z_wbuf_len_iosli(&wbf), wbf.r_idx, wbf.w_idx);
         printf("    Written: %zu, Readable: %zu\n", len, _z_wbuf_len(&wbf));
         assert(_z_wbuf_len(&wbf) == len);
+        (void)(len);
 
         _z_zbuf_t zbf = _z_wbuf_to_zbuf(&wbf);
         assert(_z_zbuf_len(&zbf) == len);
@@ -602,6 +604,39 @@ void wbuf_add_iosli(void)
     _z_wbuf_clear(&wbf);
 }
 
+void wbuf_wrap_bytes_reset(void)
+{
+    uint8_t bytes[64];
+    for (uint8_t i = 0; i < sizeof(bytes); i++)
+        bytes[i] = i;
+
+    _z_wbuf_t wbf = _z_wbuf_make(ZN_IOSLICE_SIZE, 1);
+    printf("\n>>> WBuf => Wrap bytes and reset\n");
+    for (unsigned int j = 0; j < 4; j++)
+    {
+        // Interleave written and wrapped bytes, the wrapped ones are dropped on reset
+        size_t len = 0;
+        for (uint8_t i = 0; i < 4; i++)
+        {
+            uint8_t to_write = gen_uint8() % 8;
+            for (uint8_t k = 0; k < to_write; k++)
+                _z_wbuf_write(&wbf, i);
+            _z_wbuf_wrap_bytes(&wbf, bytes, 0, sizeof(bytes));
+            len += to_write + sizeof(bytes);
+        }
+        printf("    IOSlices: %zu, Len: %zu\n", _z_wbuf_len_iosli(&wbf), _z_wbuf_len(&wbf));
+        assert(_z_wbuf_len(&wbf) == len);
+        (void)(len);
+
+        _z_wbuf_reset(&wbf);
+        assert(_z_wbuf_len_iosli(&wbf) == 1);
+        assert(_z_wbuf_len(&wbf) == 0);
+        assert(_z_wbuf_capacity(&wbf) == ZN_IOSLICE_SIZE);
+    }
+
+    _z_wbuf_clear(&wbf);
+}
+
 /*=============================*/
 /*            Main             */
 /*=============================*/
@@ -620,6 +655,7 @@ int main(void)
         wbuf_writable_readable();
         wbuf_set_pos_wbuf_get_pos();
         wbuf_add_iosli();
+        wbuf_wrap_bytes_reset();
         // WBuf and ZBuf
         wbuf_write_zbuf_read();
         wbuf_write_zbuf_read_bytes();
@@ -0,0 +1,148 @@
+//
+// Copyright (c) 2022 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include "zenoh-pico/transport/utils.h"
+#include "zenoh-pico/config.h"
+
+#define FRAGMENT_SIZE 1024
+
+uint8_t fragment_val[FRAGMENT_SIZE];
+
+void lazy_checkout(void)
+{
+    printf("\n>> Lazy checkout\n");
+    _zn_defrag_pool_t pool = _zn_defrag_pool_make(2);
+    _zn_defrag_buf_t a = _zn_defrag_buf_make(&pool);
+    _zn_defrag_buf_t b = _zn_defrag_buf_make(&pool);
+    _zn_defrag_buf_t c = _zn_defrag_buf_make(&pool);
+
+    // No memory is held until the first fragment is received
+    for (size_t i = 0; i < pool.capacity; i++)
+        assert(pool.states[i] == _ZN_DEFRAG_SLOT_UNALLOCATED);
+    assert(a.wbuf == NULL && b.wbuf == NULL && c.wbuf == NULL);
+
+    z_bytes_t fragment = _z_bytes_wrap(fragment_val, FRAGMENT_SIZE);
+    int res = _zn_defrag_buf_push(&a, &fragment);
+    assert(res == 0);
+    res = _zn_defrag_buf_push(&a, &fragment);
+    assert(res == 0);
+    res = _zn_defrag_buf_push(&b, &fragment);
+    assert(res == 0);
+    assert(a.wbuf != NULL && b.wbuf != NULL && a.wbuf != b.wbuf);
+    assert(_z_wbuf_len(a.wbuf) == 2 * FRAGMENT_SIZE);
+
+    // The pool is exhausted: the whole message is dropped until it is reset
+    res = _zn_defrag_buf_push(&c, &fragment);
+    assert(res != 0);
+    _z_wbuf_t *a_slot = a.wbuf;
+    _zn_defrag_buf_reset(&a);
+    assert(a.wbuf == NULL);
+    res = _zn_defrag_buf_push(&c, &fragment);
+    assert(res != 0);
+    _zn_defrag_buf_reset(&c);
+
+    // The released slot is reused
+    res = _zn_defrag_buf_push(&c, &fragment);
+    assert(res == 0);
+    assert(c.wbuf == a_slot);
+    (void)(a_slot);
+    assert(_z_wbuf_len(c.wbuf) == FRAGMENT_SIZE);
+
+    _zn_defrag_buf_reset(&b);
+    _zn_defrag_buf_reset(&c);
+    _zn_defrag_pool_clear(&pool);
+    (void)(res);
+}
+
+void oversized_message(void)
+{
+    printf("\n>> Oversized message\n");
+    _zn_defrag_pool_t pool = _zn_defrag_pool_make(1);
+    _zn_defrag_buf_t a = _zn_defrag_buf_make(&pool);
+
+    z_bytes_t fragment = _z_bytes_wrap(fragment_val, FRAGMENT_SIZE);
+    int res = 0;
+    size_t len = 0;
+    while (res == 0)
+    {
+        res = _zn_defrag_buf_push(&a, &fragment);
+        if (res == 0)
+            len += FRAGMENT_SIZE;
+    }
+    assert(len <= ZN_DEFRAG_POOL_SLOT_SIZE && len + FRAGMENT_SIZE > ZN_DEFRAG_POOL_SLOT_SIZE);
+
+    // The slot is given back right away, the remaining fragments are dropped
+    assert(a.wbuf == NULL);
+    res = _zn_defrag_buf_push(&a, &fragment);
+    assert(res != 0);
+    _zn_defrag_buf_reset(&a);
+
+    // The next message is reassembled from scratch
+    res = _zn_defrag_buf_push(&a, &fragment);
+    assert(res == 0);
+    assert(_z_wbuf_len(a.wbuf) == FRAGMENT_SIZE);
+
+    _zn_defrag_buf_reset(&a);
+    _zn_defrag_pool_clear(&pool);
+}
+
+void reassembled_message(void)
+{
+    printf("\n>> Reassembled message\n");
+    _zn_defrag_pool_t pool = _zn_defrag_pool_make(1);
+    _zn_defrag_buf_t a = _zn_defrag_buf_make(&pool);
+
+    for (size_t i = 0; i < 3; i++)
+    {
+        z_bytes_t fragment = _z_bytes_wrap(fragment_val + i, FRAGMENT_SIZE - i);
+        int res = _zn_defrag_buf_push(&a, &fragment);
+        assert(res == 0);
+        (void)(res);
+    }
+
+    _z_zbuf_t zbf = _zn_defrag_buf_to_zbuf(&a);
+    assert(_z_zbuf_len(&zbf) == 3 * FRAGMENT_SIZE - 3);
+    for (size_t i = 0; i < 3; i++)
+    {
+        for (size_t j = i; j < FRAGMENT_SIZE; j++)
+        {
+            uint8_t b = _z_zbuf_read(&zbf);
+            assert(b == fragment_val[j]);
+            (void)(b);
+        }
+    }
+    // The message is decoded straight from the defragmentation buffer
+    assert(zbf.ios.is_alloc == 0);
+    assert(zbf.ios.buf == _z_wbuf_get_iosli(a.wbuf, 0)->buf);
+
+    _z_zbuf_clear(&zbf);
+    _zn_defrag_buf_reset(&a);
+    _zn_defrag_pool_clear(&pool);
+}
+
+int main(void)
+{
+    setbuf(stdout, NULL);
+    for (size_t i = 0; i < FRAGMENT_SIZE; i++)
+        fragment_val[i] = (uint8_t)i;
+
+    lazy_checkout();
+    oversized_message();
+    reassembled_message();
+
+    return 0;
+}
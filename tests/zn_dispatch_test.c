@@ -0,0 +1,350 @@
+//
+// Copyright (c) 2022 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include "zenoh-pico.h"
+#include "zenoh-pico/session/queryable.h"
+#include "zenoh-pico/session/subscription.h"
+#include "zenoh-pico/session/utils.h"
+#include "zn_test_session.h"
+
+/*------------------ Discarding link ------------------*/
+size_t discard_write(const void *arg, const uint8_t *ptr, size_t len)
+{
+    (void)(arg);
+    (void)(ptr);
+    return len;
+}
+
+zn_session_t *session_make(void)
+{
+    return test_session_make(test_link_make(discard_write, 1, 1, 0), test_session_param_default());
+}
+
+void trigger(zn_session_t *zn, char *rname)
+{
+    zn_reskey_t reskey = zn_rname(rname);
+    uint8_t val = 0;
+    int res = _zn_trigger_subscriptions(zn, reskey, _z_bytes_wrap(&val, 1));
+    assert(res == 0);
+    (void)(res);
+    _zn_reskey_clear(&reskey);
+}
+
+/*------------------ Reentrant callbacks ------------------*/
+typedef struct
+{
+    zn_session_t *zn;
+    zn_subscriber_t *sub;
+    zn_subscriber_t *declared;
+    size_t calls;
+} reentrant_ctx_t;
+
+void reentrant_handler(const zn_sample_t *sample, const void *arg)
+{
+    reentrant_ctx_t *ctx = (reentrant_ctx_t *)arg;
+    assert(sample->key.len == strlen("/test/a") && strncmp(sample->key.val, "/test/a", sample->key.len) == 0);
+    ctx->calls++;
+
+    // Declaring, writing and undeclaring from a callback does not deadlock
+    ctx->declared = zn_declare_subscriber(ctx->zn, zn_rname("/other"), zn_subinfo_default(), reentrant_handler, ctx);
+    assert(ctx->declared != NULL);
+    zn_reskey_t reskey = zn_rname("/other");
+    int res = zn_write(ctx->zn, reskey, sample->value.val, sample->value.len);
+    assert(res == 0);
+    (void)(res);
+    _zn_reskey_clear(&reskey);
+
+    // Undeclaring from the callback itself does not wait for it to return
+    zn_undeclare_subscriber(ctx->sub);
+    assert(ctx->calls == 1);
+}
+
+void reentrant_callbacks(void)
+{
+    printf("\n>> Reentrant callbacks\n");
+    zn_session_t *zn = session_make();
+
+    reentrant_ctx_t ctx;
+    ctx.zn = zn;
+    ctx.calls = 0;
+    ctx.sub = zn_declare_subscriber(zn, zn_rname("/test/*"), zn_subinfo_default(), reentrant_handler, &ctx);
+    assert(ctx.sub != NULL);
+
+    trigger(zn, "/test/a");
+    assert(ctx.calls == 1);
+
+    // The subscription undeclared by its own callback is no longer triggered
+    trigger(zn, "/test/a");
+    assert(ctx.calls == 1);
+
+    zn_undeclare_subscriber(ctx.declared);
+    z_free(ctx.declared);
+    z_free(ctx.sub);
+    _zn_session_free(&zn);
+}
+
+/*------------------ Concurrent declarations ------------------*/
+typedef struct
+{
+    zn_session_t *zn;
+    zn_subscriber_t *sub;
+    z_mutex_t mutex;
+    z_condvar_t cond;
+    int is_running;
+    int is_released;
+    int is_returned;
+    int is_undeclared;
+} blocking_ctx_t;
+
+void blocking_handler(const zn_sample_t *sample, const void *arg)
+{
+    (void)(sample);
+    blocking_ctx_t *ctx = (blocking_ctx_t *)arg;
+
+    // Keep the callback running until the other thread is done declaring
+    z_mutex_lock(&ctx->mutex);
+    ctx->is_running = 1;
+    z_condvar_signal(&ctx->cond);
+    while (!ctx->is_released)
+        z_condvar_wait(&ctx->cond, &ctx->mutex);
+    ctx->is_returned = 1;
+    z_mutex_unlock(&ctx->mutex);
+}
+
+void *blocking_dispatch(void *arg)
+{
+    blocking_ctx_t *ctx = (blocking_ctx_t *)arg;
+    trigger(ctx->zn, "/test/a");
+    return NULL;
+}
+
+void *blocking_undeclare(void *arg)
+{
+    blocking_ctx_t *ctx = (blocking_ctx_t *)arg;
+    zn_undeclare_subscriber(ctx->sub);
+
+    // The callback argument can be released once undeclared
+    z_mutex_lock(&ctx->mutex);
+    assert(ctx->is_returned);
+    ctx->is_undeclared = 1;
+    z_mutex_unlock(&ctx->mutex);
+    return NULL;
+}
+
+void query_handler(zn_query_t *query, const void *arg)
+{
+    size_t *calls = (size_t *)arg;
+    (*calls)++;
+    uint8_t val = 0;
+    zn_send_reply(query, "/test/a", &val, 1);
+}
+
+void concurrent_declarations(void)
+{
+    printf("\n>> Concurrent declarations\n");
+    zn_session_t *zn = session_make();
+
+    blocking_ctx_t ctx;
+    ctx.zn = zn;
+    z_mutex_init(&ctx.mutex);
+    z_condvar_init(&ctx.cond);
+    ctx.is_running = 0;
+    ctx.is_released = 0;
+    ctx.is_returned = 0;
+    ctx.is_undeclared = 0;
+    zn_subscriber_t *sub = zn_declare_subscriber(zn, zn_rname("/test/a"), zn_subinfo_default(), blocking_handler, &ctx);
+    assert(sub != NULL);
+    ctx.sub = sub;
+
+    z_task_t task;
+    int res = z_task_init(&task, NULL, blocking_dispatch, &ctx);
+    assert(res == 0);
+
+    z_mutex_lock(&ctx.mutex);
+    while (!ctx.is_running)
+        z_condvar_wait(&ctx.cond, &ctx.mutex);
+    z_mutex_unlock(&ctx.mutex);
+
+    // The session is not locked while the callback runs
+    size_t calls = 0;
+    zn_reskey_t reskey = zn_rname("/test/*");
+    zn_queryable_t *qle = zn_declare_queryable(zn, reskey, ZN_QUERYABLE_EVAL, query_handler, &calls);
+    assert(qle != NULL);
+    _zn_reskey_clear(&reskey);
+
+    _zn_query_t query;
+    query.key = zn_rname("/test/a");
+    query.predicate = "";
+    query.qid = 1;
+    query.target.kind = ZN_QUERYABLE_ALL_KINDS;
+    res = _zn_trigger_queryables(zn, &query);
+    assert(res == 0);
+    assert(calls == 1);
+    _zn_reskey_clear(&query.key);
+
+    zn_undeclare_queryable(qle);
+    z_free(qle);
+
+    // Undeclaring waits for the callback in progress on another thread to return
+    z_task_t undeclarer;
+    res = z_task_init(&undeclarer, NULL, blocking_undeclare, &ctx);
+    assert(res == 0);
+    z_sleep_ms(100);
+
+    z_mutex_lock(&ctx.mutex);
+    assert(!ctx.is_undeclared);
+    ctx.is_released = 1;
+    z_condvar_signal(&ctx.cond);
+    z_mutex_unlock(&ctx.mutex);
+
+    res = z_task_join(&undeclarer);
+    assert(res == 0);
+    assert(ctx.is_undeclared);
+    z_free(sub);
+
+    res = z_task_join(&task);
+    assert(res == 0);
+    (void)(res);
+
+    z_condvar_free(&ctx.cond);
+    z_mutex_free(&ctx.mutex);
+    _zn_session_free(&zn);
+}
+
+/*------------------ Ring subscribers ------------------*/
+#define RING_LEN 4
+
+void trigger_val(zn_session_t *zn, char *rname, uint8_t val)
+{
+    zn_reskey_t reskey = zn_rname(rname);
+    int res = _zn_trigger_subscriptions(zn, reskey, _z_bytes_wrap(&val, 1));
+    assert(res == 0);
+    (void)(res);
+    _zn_reskey_clear(&reskey);
+}
+
+void drop_oldest_ring(void)
+{
+    printf("\n>> Drop oldest ring\n");
+    zn_session_t *zn = session_make();
+    zn_subscriber_t *sub = zn_declare_ring_subscriber(zn, zn_rname("/test/*"), zn_subinfo_default(), RING_LEN, zn_ring_policy_t_DROP_OLDEST);
+    assert(sub != NULL);
+
+    zn_sample_t sample;
+    int res = zn_subscriber_try_recv(sub, &sample);
+    assert(res != 0);
+
+    // Only the most recent samples are kept
+    for (uint8_t i = 0; i < 2 * RING_LEN; i++)
+        trigger_val(zn, "/test/a", i);
+
+    for (uint8_t i = RING_LEN; i < 2 * RING_LEN; i++)
+    {
+        res = zn_subscriber_try_recv(sub, &sample);
+        assert(res == 0);
+        assert(sample.key.len == strlen("/test/a") && strncmp(sample.key.val, "/test/a", sample.key.len) == 0);
+        assert(sample.value.len == 1 && sample.value.val[0] == i);
+    }
+    res = zn_subscriber_try_recv(sub, &sample);
+    assert(res != 0);
+
+    // Samples larger than a slot are dropped
+    uint8_t large[ZN_RING_SUBSCRIBER_MAX_PAYLOAD_LEN + 1] = {0};
+    zn_reskey_t reskey = zn_rname("/test/a");
+    res = _zn_trigger_subscriptions(zn, reskey, _z_bytes_wrap(large, sizeof(large)));
+    assert(res == 0);
+    _zn_reskey_clear(&reskey);
+    res = zn_subscriber_try_recv(sub, &sample);
+    assert(res != 0);
+
+    // The samples not received are dropped along with the subscription
+    trigger_val(zn, "/test/a", 0);
+    zn_undeclare_subscriber(sub);
+    z_free(sub);
+
+    // A callback subscriber has no ring
+    sub = zn_declare_subscriber(zn, zn_rname("/test/a"), zn_subinfo_default(), blocking_handler, NULL);
+    assert(sub != NULL);
+    res = zn_subscriber_try_recv(sub, &sample);
+    assert(res != 0);
+    (void)(res);
+    zn_undeclare_subscriber(sub);
+    z_free(sub);
+
+    _zn_session_free(&zn);
+}
+
+typedef struct
+{
+    zn_session_t *zn;
+    uint8_t len;
+} ring_producer_t;
+
+void *ring_produce(void *arg)
+{
+    ring_producer_t *p = (ring_producer_t *)arg;
+    for (uint8_t i = 0; i < p->len; i++)
+        trigger_val(p->zn, "/test/a", i);
+    return NULL;
+}
+
+void blocking_ring(void)
+{
+    printf("\n>> Blocking ring\n");
+    zn_session_t *zn = session_make();
+    zn_subscriber_t *sub = zn_declare_ring_subscriber(zn, zn_rname("/test/a"), zn_subinfo_default(), RING_LEN, zn_ring_policy_t_BLOCK);
+    assert(sub != NULL);
+
+    // The dispatch waits for the samples to be received, none is lost
+    ring_producer_t p = {zn, 8 * RING_LEN};
+    z_task_t task;
+    int res = z_task_init(&task, NULL, ring_produce, &p);
+    assert(res == 0);
+
+    zn_sample_t sample;
+    for (uint8_t i = 0; i < p.len; i++)
+    {
+        res = zn_subscriber_recv(sub, &sample);
+        assert(res == 0);
+        assert(sample.value.len == 1 && sample.value.val[0] == i);
+    }
+    z_task_join(&task);
+
+    // Undeclaring releases a dispatch blocked on a full ring
+    p.len = 2 * RING_LEN;
+    res = z_task_init(&task, NULL, ring_produce, &p);
+    assert(res == 0);
+    (void)(res);
+    z_sleep_ms(100);
+    zn_undeclare_subscriber(sub);
+    z_free(sub);
+    z_task_join(&task);
+
+    _zn_session_free(&zn);
+}
+
+int main(void)
+{
+    setbuf(stdout, NULL);
+
+    reentrant_callbacks();
+    concurrent_declarations();
+    drop_oldest_ring();
+    blocking_ring();
+
+    return 0;
+}
@@ -0,0 +1,287 @@
+//
+// Copyright (c) 2022 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include "zenoh-pico.h"
+#include "zenoh-pico/system/link/shm.h"
+#include "zenoh-pico/system/link/tcp.h"
+
+#define BENCH_DURATION_MS 1000
+#define BENCH_BATCH_SIZE 65535
+#define BENCH_PING_SIZE 64
+#define PORT_LEN 8
+
+/*------------------ Link ends ------------------*/
+// An end of a link, written and read through the system link API or a plain socket
+typedef struct bench_end_t
+{
+    void *sock;
+    int fd;
+    size_t (*write)(struct bench_end_t *e, const uint8_t *ptr, size_t len);
+    size_t (*read)(struct bench_end_t *e, uint8_t *ptr, size_t len);
+} bench_end_t;
+
+size_t end_write(bench_end_t *e, const uint8_t *ptr, size_t len)
+{
+    size_t n = 0;
+    while (n < len)
+    {
+        size_t wb = e->write(e, ptr + n, len - n);
+        if (wb == SIZE_MAX)
+            return SIZE_MAX;
+        n += wb;
+    }
+    return len;
+}
+
+size_t end_read(bench_end_t *e, uint8_t *ptr, size_t len)
+{
+    return e->read(e, ptr, len);
+}
+
+size_t end_read_exact(bench_end_t *e, uint8_t *ptr, size_t len)
+{
+    size_t n = 0;
+    while (n < len)
+    {
+        size_t rb = end_read(e, ptr + n, len - n);
+        if (rb == SIZE_MAX || rb == 0)
+            return SIZE_MAX;
+        n += rb;
+    }
+    return len;
+}
+
+/*------------------ Throughput ------------------*/
+typedef struct
+{
+    bench_end_t *end;
+    volatile int is_running;
+    size_t bytes;
+} bench_ctx_t;
+
+void *sink_task(void *arg)
+{
+    bench_ctx_t *ctx = (bench_ctx_t *)arg;
+    uint8_t *buf = (uint8_t *)z_malloc(BENCH_BATCH_SIZE);
+
+    size_t bytes = 0;
+    while (1)
+    {
+        size_t rb = end_read(ctx->end, buf, BENCH_BATCH_SIZE);
+        if (rb == SIZE_MAX || rb == 0)
+            break;
+        bytes += rb;
+        if (!ctx->is_running && bytes == ctx->bytes)
+            break;
+    }
+
+    z_free(buf);
+    return NULL;
+}
+
+void throughput(const char *name, bench_end_t *tx, bench_end_t *rx)
+{
+    bench_ctx_t ctx;
+    ctx.end = rx;
+    ctx.is_running = 1;
+    ctx.bytes = SIZE_MAX;
+
+    z_task_t sink;
+    z_task_init(&sink, NULL, sink_task, &ctx);
+
+    // Write batches as large as the transport ones for a fixed duration
+    uint8_t *buf = (uint8_t *)z_malloc(BENCH_BATCH_SIZE);
+    memset(buf, 0xa5, BENCH_BATCH_SIZE);
+    size_t bytes = 0;
+    z_clock_t start = z_clock_now();
+    while (z_clock_elapsed_ms(&start) < BENCH_DURATION_MS)
+    {
+        if (end_write(tx, buf, BENCH_BATCH_SIZE) != BENCH_BATCH_SIZE)
+            exit(-1);
+        bytes += BENCH_BATCH_SIZE;
+    }
+
+    // Tell the sink how much to expect, and wake it up with a last batch if it caught up already
+    ctx.bytes = bytes + BENCH_BATCH_SIZE;
+    ctx.is_running = 0;
+    if (end_write(tx, buf, BENCH_BATCH_SIZE) != BENCH_BATCH_SIZE)
+        exit(-1);
+    z_task_join(&sink);
+    unsigned long elapsed = z_clock_elapsed_ms(&start);
+    z_free(buf);
+
+    printf("%s throughput: %.2f GB/s\n", name, (double)ctx.bytes / elapsed / 1000000);
+}
+
+/*------------------ Latency ------------------*/
+void *pong_task(void *arg)
+{
+    bench_end_t *e = (bench_end_t *)arg;
+    uint8_t buf[BENCH_PING_SIZE];
+
+    // Echo until the pinging end stops
+    while (end_read_exact(e, buf, BENCH_PING_SIZE) == BENCH_PING_SIZE)
+    {
+        if (end_write(e, buf, BENCH_PING_SIZE) != BENCH_PING_SIZE)
+            break;
+        if (buf[0] == 0xff)
+            break;
+    }
+
+    return NULL;
+}
+
+void latency(const char *name, bench_end_t *ping, bench_end_t *pong)
+{
+    z_task_t ponger;
+    z_task_init(&ponger, NULL, pong_task, pong);
+
+    uint8_t buf[BENCH_PING_SIZE];
+    memset(buf, 0, BENCH_PING_SIZE);
+    size_t rounds = 0;
+    z_clock_t start = z_clock_now();
+    while (z_clock_elapsed_ms(&start) < BENCH_DURATION_MS)
+    {
+        if (end_write(ping, buf, BENCH_PING_SIZE) != BENCH_PING_SIZE || end_read_exact(ping, buf, BENCH_PING_SIZE) != BENCH_PING_SIZE)
+            exit(-1);
+        rounds++;
+    }
+    unsigned long elapsed = z_clock_elapsed_ms(&start);
+
+    // Stop the echoing end
+    buf[0] = 0xff;
+    if (end_write(ping, buf, BENCH_PING_SIZE) != BENCH_PING_SIZE || end_read_exact(ping, buf, BENCH_PING_SIZE) != BENCH_PING_SIZE)
+        exit(-1);
+    z_task_join(&ponger);
+
+    // Half of a round trip
+    printf("%s latency: %.2f us\n", name, (double)elapsed * 1000 / rounds / 2);
+}
+
+/*------------------ Links ------------------*/
+#if ZN_LINK_SHM == 1 && defined(Z_LINK_SHM)
+size_t shm_write(bench_end_t *e, const uint8_t *ptr, size_t len)
+{
+    return _zn_send_shm(e->sock, ptr, len);
+}
+
+size_t shm_read(bench_end_t *e, uint8_t *ptr, size_t len)
+{
+    return _zn_read_shm(e->sock, ptr, len);
+}
+
+void bench_shm(void)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "zn_link_bench_%d", (int)getpid());
+
+    bench_end_t a;
+    a.sock = _zn_listen_shm(name, 1);
+    a.write = shm_write;
+    a.read = shm_read;
+    bench_end_t b;
+    b.sock = _zn_open_shm(name, 1);
+    b.write = shm_write;
+    b.read = shm_read;
+    if (a.sock == NULL || b.sock == NULL)
+        exit(-1);
+
+    throughput("shm", &a, &b);
+    latency("shm", &a, &b);
+
+    _zn_close_shm(b.sock);
+    _zn_close_shm(a.sock);
+}
+#endif
+
+#if ZN_LINK_TCP == 1
+size_t tcp_write(bench_end_t *e, const uint8_t *ptr, size_t len)
+{
+    return _zn_send_tcp(e->sock, ptr, len);
+}
+
+size_t tcp_read(bench_end_t *e, uint8_t *ptr, size_t len)
+{
+    return _zn_read_tcp(e->sock, ptr, len);
+}
+
+size_t fd_write(bench_end_t *e, const uint8_t *ptr, size_t len)
+{
+    ssize_t wb = send(e->fd, ptr, len, MSG_NOSIGNAL);
+    return wb < 0 ? SIZE_MAX : (size_t)wb;
+}
+
+size_t fd_read(bench_end_t *e, uint8_t *ptr, size_t len)
+{
+    ssize_t rb = recv(e->fd, ptr, len, 0);
+    return rb < 0 ? SIZE_MAX : (size_t)rb;
+}
+
+void bench_tcp(void)
+{
+    int lfd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addrlen = sizeof(addr);
+    if (lfd < 0 || bind(lfd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(lfd, 1) < 0 || getsockname(lfd, (struct sockaddr *)&addr, &addrlen) < 0)
+        exit(-1);
+    char port[PORT_LEN];
+    snprintf(port, PORT_LEN, "%u", ntohs(addr.sin_port));
+
+    void *raddr = _zn_create_endpoint_tcp("127.0.0.1", port);
+    bench_end_t a;
+    a.sock = _zn_open_tcp(raddr, 0);
+    a.write = tcp_write;
+    a.read = tcp_read;
+    bench_end_t b;
+    b.fd = accept(lfd, NULL, NULL);
+    b.write = fd_write;
+    b.read = fd_read;
+    if (a.sock == NULL || b.fd < 0)
+        exit(-1);
+    int flag = 1;
+    setsockopt(b.fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+
+    throughput("tcp", &a, &b);
+    latency("tcp", &a, &b);
+
+    close(b.fd);
+    _zn_close_tcp(a.sock);
+    _zn_free_endpoint_tcp(raddr);
+    close(lfd);
+}
+#endif
+
+int main(void)
+{
+    setbuf(stdout, NULL);
+
+#if ZN_LINK_SHM == 1 && defined(Z_LINK_SHM)
+    bench_shm();
+#endif
+#if ZN_LINK_TCP == 1
+    bench_tcp();
+#endif
+
+    return 0;
+}
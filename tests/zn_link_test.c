@@ -0,0 +1,412 @@
+//
+// Copyright (c) 2022 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "zenoh-pico.h"
+#include "zenoh-pico/system/link/shm.h"
+#include "zenoh-pico/system/link/tcp.h"
+#include "zenoh-pico/system/link/udp.h"
+
+#define LARGE_LEN (1024 * 1024)
+#define PORT_LEN 8
+
+int peer_make(int type, char *port)
+{
+    int fd = socket(AF_INET, type, 0);
+    assert(fd >= 0);
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int res = bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+    assert(res == 0);
+
+    socklen_t addrlen = sizeof(addr);
+    res = getsockname(fd, (struct sockaddr *)&addr, &addrlen);
+    assert(res == 0);
+    (void)(res);
+    snprintf(port, PORT_LEN, "%u", ntohs(addr.sin_port));
+    return fd;
+}
+
+/*------------------ TCP ------------------*/
+typedef struct
+{
+    int fd;
+    uint8_t *buf;
+} sender_t;
+
+void *large_send(void *arg)
+{
+    sender_t *s = (sender_t *)arg;
+    size_t n = 0;
+    while (n < LARGE_LEN)
+    {
+        ssize_t wb = send(s->fd, s->buf + n, LARGE_LEN - n, 0);
+        assert(wb > 0);
+        n += wb;
+    }
+    return NULL;
+}
+
+void tcp(void)
+{
+    printf("\n>> TCP\n");
+    char port[PORT_LEN];
+    int lfd = peer_make(SOCK_STREAM, port);
+    int res = listen(lfd, 1);
+    assert(res == 0);
+
+    void *raddr = _zn_create_endpoint_tcp("127.0.0.1", port);
+    assert(raddr != NULL);
+    void *sock = _zn_open_tcp(raddr, 0);
+    assert(sock != NULL);
+    int fd = accept(lfd, NULL, NULL);
+    assert(fd >= 0);
+
+    // Writes
+    uint8_t out[] = {0, 1, 2, 3, 4, 5, 6, 7};
+    size_t wb = _zn_send_tcp(sock, out, 4);
+    assert(wb == 4);
+    z_bytes_t iov[2] = {_z_bytes_wrap(out + 4, 2), _z_bytes_wrap(out + 6, 2)};
+    wb = _zn_sendv_tcp(sock, iov, 2);
+    assert(wb == 4);
+
+    uint8_t in[sizeof(out)];
+    size_t n = 0;
+    while (n < sizeof(out))
+    {
+        ssize_t rb = recv(fd, in + n, sizeof(out) - n, 0);
+        assert(rb > 0);
+        n += rb;
+    }
+    assert(memcmp(in, out, sizeof(out)) == 0);
+
+    // Short reads keep the rest of the received bytes for the next ones
+    ssize_t sb = send(fd, out, sizeof(out), 0);
+    assert(sb == sizeof(out));
+    memset(in, 0, sizeof(in));
+    size_t rb = _zn_read_exact_tcp(sock, in, 3);
+    assert(rb == 3);
+    rb = _zn_read_exact_tcp(sock, in + 3, sizeof(out) - 3);
+    assert(rb == sizeof(out) - 3);
+    assert(memcmp(in, out, sizeof(out)) == 0);
+
+    // More bytes than the receive buffers can hold at once
+    sender_t s;
+    s.fd = fd;
+    s.buf = (uint8_t *)z_malloc(LARGE_LEN);
+    for (size_t i = 0; i < LARGE_LEN; i++)
+        s.buf[i] = (uint8_t)(i % 251);
+    z_task_t task;
+    res = z_task_init(&task, NULL, large_send, &s);
+    assert(res == 0);
+
+    uint8_t *large = (uint8_t *)z_malloc(LARGE_LEN);
+    rb = _zn_read_exact_tcp(sock, large, LARGE_LEN);
+    assert(rb == LARGE_LEN);
+    assert(memcmp(large, s.buf, LARGE_LEN) == 0);
+    z_task_join(&task);
+    z_free(large);
+    z_free(s.buf);
+
+    // The end of the connection is reported as an empty read
+    close(fd);
+    rb = _zn_read_tcp(sock, in, sizeof(in));
+    assert(rb == 0);
+    (void)(rb);
+    (void)(wb);
+    (void)(sb);
+    (void)(res);
+
+    _zn_close_tcp(sock);
+    _zn_free_endpoint_tcp(raddr);
+    close(lfd);
+}
+
+/*------------------ UDP ------------------*/
+void udp(void)
+{
+    printf("\n>> UDP\n");
+    char port[PORT_LEN];
+    int fd = peer_make(SOCK_DGRAM, port);
+
+    void *raddr = _zn_create_endpoint_udp("127.0.0.1", port);
+    assert(raddr != NULL);
+    void *sock = _zn_open_udp_unicast(raddr, 1);
+    assert(sock != NULL);
+
+    // Writes
+    uint8_t out[] = {0, 1, 2, 3, 4, 5, 6, 7};
+    size_t wb = _zn_send_udp_unicast(sock, out, 4, raddr);
+    assert(wb == 4);
+    z_bytes_t iov[2] = {_z_bytes_wrap(out + 4, 2), _z_bytes_wrap(out + 6, 2)};
+    wb = _zn_sendv_udp_unicast(sock, iov, 2, raddr);
+    assert(wb == 4);
+
+    struct sockaddr_storage caddr;
+    socklen_t caddrlen = sizeof(caddr);
+    uint8_t in[sizeof(out)];
+    ssize_t sb = recvfrom(fd, in, sizeof(in), 0, (struct sockaddr *)&caddr, &caddrlen);
+    assert(sb == 4 && memcmp(in, out, 4) == 0);
+    sb = recv(fd, in, sizeof(in), 0);
+    assert(sb == 4 && memcmp(in, out + 4, 4) == 0);
+
+    // A read returns a single datagram, the bytes not fitting in it are discarded
+    sb = sendto(fd, out, sizeof(out), 0, (struct sockaddr *)&caddr, caddrlen);
+    assert(sb == sizeof(out));
+    sb = sendto(fd, out + 2, 2, 0, (struct sockaddr *)&caddr, caddrlen);
+    assert(sb == 2);
+    size_t rb = _zn_read_udp_unicast(sock, in, 3);
+    assert(rb == 3 && memcmp(in, out, 3) == 0);
+    rb = _zn_read_udp_unicast(sock, in, sizeof(in));
+    assert(rb == 2 && memcmp(in, out + 2, 2) == 0);
+
+    // Reads time out once nothing is received
+    z_clock_t start = z_clock_now();
+    rb = _zn_read_udp_unicast(sock, in, sizeof(in));
+    assert(rb == SIZE_MAX);
+    assert(z_clock_elapsed_ms(&start) >= 900);
+    (void)(start);
+    (void)(rb);
+    (void)(wb);
+    (void)(sb);
+
+    _zn_close_udp_unicast(sock);
+    _zn_free_endpoint_udp(raddr);
+    close(fd);
+}
+
+#if defined(Z_LINK_BATCH)
+void udp_batch(void)
+{
+    printf("\n>> UDP batches\n");
+    char port[PORT_LEN];
+    int fd = peer_make(SOCK_DGRAM, port);
+
+    void *raddr = _zn_create_endpoint_udp("127.0.0.1", port);
+    assert(raddr != NULL);
+    void *sock = _zn_open_udp_unicast(raddr, 1);
+    assert(sock != NULL);
+
+    // Datagrams of the same length, but the last one, are written at once
+    uint8_t out[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    z_bytes_t iov[4] = {_z_bytes_wrap(out, 2), _z_bytes_wrap(out + 2, 2), _z_bytes_wrap(out + 4, 4), _z_bytes_wrap(out + 8, 2)};
+    size_t iovcnts[3] = {2, 1, 1};
+    size_t wb = _zn_sendv_batch_udp_unicast(sock, iov, iovcnts, 3, raddr);
+    assert(wb == 3);
+
+    // Datagrams of any length are written at once as well
+    size_t odd_iovcnts[3] = {1, 2, 1};
+    wb = _zn_sendv_batch_udp_unicast(sock, iov, odd_iovcnts, 3, raddr);
+    assert(wb == 3);
+
+    // The peer receives the datagrams as they have been written
+    struct sockaddr_storage caddr;
+    socklen_t caddrlen = sizeof(caddr);
+    uint8_t in[sizeof(out)];
+    ssize_t sb = recvfrom(fd, in, sizeof(in), 0, (struct sockaddr *)&caddr, &caddrlen);
+    assert(sb == 4 && memcmp(in, out, 4) == 0);
+    sb = recv(fd, in, sizeof(in), 0);
+    assert(sb == 4 && memcmp(in, out + 4, 4) == 0);
+    sb = recv(fd, in, sizeof(in), 0);
+    assert(sb == 2 && memcmp(in, out + 8, 2) == 0);
+    sb = recv(fd, in, sizeof(in), 0);
+    assert(sb == 2 && memcmp(in, out, 2) == 0);
+    sb = recv(fd, in, sizeof(in), 0);
+    assert(sb == 6 && memcmp(in, out + 2, 6) == 0);
+    sb = recv(fd, in, sizeof(in), 0);
+    assert(sb == 2 && memcmp(in, out + 8, 2) == 0);
+
+    // The datagrams already received are read at once, one per buffer
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        sb = sendto(fd, out + i, i + 1, 0, (struct sockaddr *)&caddr, caddrlen);
+        assert(sb == i + 1);
+    }
+
+    uint8_t bufs_mem[3][sizeof(out)];
+    uint8_t *bufs[3] = {bufs_mem[0], bufs_mem[1], bufs_mem[2]};
+    size_t lens[3];
+    size_t n = 0;
+    while (n < 3)
+    {
+        size_t rb = _zn_read_batch_udp_unicast(sock, &bufs[n], sizeof(out), &lens[n], 3 - n);
+        assert(rb != SIZE_MAX && rb > 0);
+        n += rb;
+    }
+    for (uint8_t i = 0; i < 3; i++)
+        assert(lens[i] == (size_t)i + 1 && memcmp(bufs[i], out + i, i + 1) == 0);
+
+    // Reads time out once nothing is received
+    size_t rb = _zn_read_batch_udp_unicast(sock, bufs, sizeof(out), lens, 3);
+    assert(rb == SIZE_MAX);
+    (void)(rb);
+    (void)(wb);
+    (void)(sb);
+
+    _zn_close_udp_unicast(sock);
+    _zn_free_endpoint_udp(raddr);
+    close(fd);
+}
+#endif
+
+/*------------------ Shared memory ------------------*/
+#if ZN_LINK_SHM == 1 && defined(Z_LINK_SHM)
+typedef struct
+{
+    void *sock;
+    uint8_t *buf;
+} shm_sender_t;
+
+void *shm_large_send(void *arg)
+{
+    shm_sender_t *s = (shm_sender_t *)arg;
+
+    // Vectored writes larger than the ring, split at odd offsets
+    size_t n = 0;
+    while (n < LARGE_LEN)
+    {
+        size_t len = LARGE_LEN - n < 300007 ? LARGE_LEN - n : 300007;
+        z_bytes_t iov[2] = {_z_bytes_wrap(s->buf + n, len / 3), _z_bytes_wrap(s->buf + n + len / 3, len - len / 3)};
+        size_t wb = _zn_sendv_shm(s->sock, iov, 2);
+        assert(wb == len);
+        (void)(wb);
+        n += len;
+    }
+    return NULL;
+}
+
+void shm(void)
+{
+    printf("\n>> Shared memory\n");
+    char name[32];
+    snprintf(name, sizeof(name), "zn_link_test_%d", (int)getpid());
+
+    // Names are a single path component
+    assert(_zn_listen_shm("", 1) == NULL);
+    assert(_zn_listen_shm("a/b", 1) == NULL);
+
+    // Nothing to attach to before the segment is created, and a segment is created once
+    assert(_zn_open_shm(name, 1) == NULL);
+    void *lsock = _zn_listen_shm(name, 1);
+    assert(lsock != NULL);
+    assert(_zn_listen_shm(name, 1) == NULL);
+
+    // Bytes written before the other end attaches are kept
+    uint8_t out[] = {0, 1, 2, 3, 4, 5, 6, 7};
+    size_t wb = _zn_send_shm(lsock, out, 4);
+    assert(wb == 4);
+
+    void *sock = _zn_open_shm(name, 1);
+    assert(sock != NULL);
+
+    // A segment is attached once, its name is then free again
+    assert(_zn_open_shm(name, 1) == NULL);
+    void *other = _zn_listen_shm(name, 1);
+    assert(other != NULL);
+    _zn_close_shm(other);
+
+    z_bytes_t iov[2] = {_z_bytes_wrap(out + 4, 2), _z_bytes_wrap(out + 6, 2)};
+    wb = _zn_sendv_shm(lsock, iov, 2);
+    assert(wb == 4);
+
+    uint8_t in[sizeof(out)];
+    size_t rb = _zn_read_exact_shm(sock, in, sizeof(out));
+    assert(rb == sizeof(out));
+    assert(memcmp(in, out, sizeof(out)) == 0);
+
+    // Both directions, short reads keep the rest of the written bytes for the next ones
+    wb = _zn_send_shm(sock, out, sizeof(out));
+    assert(wb == sizeof(out));
+    memset(in, 0, sizeof(in));
+    rb = _zn_read_shm(lsock, in, 3);
+    assert(rb == 3);
+    rb = _zn_read_exact_shm(lsock, in + 3, sizeof(out) - 3);
+    assert(rb == sizeof(out) - 3);
+    assert(memcmp(in, out, sizeof(out)) == 0);
+
+    // More bytes than the ring can hold at once
+    shm_sender_t s;
+    s.sock = lsock;
+    s.buf = (uint8_t *)z_malloc(LARGE_LEN);
+    for (size_t i = 0; i < LARGE_LEN; i++)
+        s.buf[i] = (uint8_t)(i % 251);
+    for (int i = 0; i < 3; i++)
+    {
+        z_task_t task;
+        int res = z_task_init(&task, NULL, shm_large_send, &s);
+        assert(res == 0);
+        (void)(res);
+
+        uint8_t *large = (uint8_t *)z_malloc(LARGE_LEN);
+        rb = _zn_read_exact_shm(sock, large, LARGE_LEN);
+        assert(rb == LARGE_LEN);
+        assert(memcmp(large, s.buf, LARGE_LEN) == 0);
+        z_task_join(&task);
+        z_free(large);
+    }
+    z_free(s.buf);
+
+    // Reads time out once nothing is written
+    z_clock_t start = z_clock_now();
+    rb = _zn_read_shm(sock, in, sizeof(in));
+    assert(rb == SIZE_MAX);
+    assert(z_clock_elapsed_ms(&start) >= 900);
+    (void)(start);
+
+    // The bytes written before closing are read, then the end of the link is reported as an empty read
+    wb = _zn_send_shm(lsock, out, sizeof(out));
+    assert(wb == sizeof(out));
+    _zn_close_shm(lsock);
+    rb = _zn_read_shm(sock, in, sizeof(in));
+    assert(rb == sizeof(out) && memcmp(in, out, sizeof(out)) == 0);
+    rb = _zn_read_shm(sock, in, sizeof(in));
+    assert(rb == 0);
+    rb = _zn_read_exact_shm(sock, in, sizeof(in));
+    assert(rb == SIZE_MAX);
+    wb = _zn_send_shm(sock, out, sizeof(out));
+    assert(wb == SIZE_MAX);
+    (void)(rb);
+    (void)(wb);
+
+    _zn_close_shm(sock);
+}
+#endif
+
+int main(void)
+{
+    setbuf(stdout, NULL);
+
+#if ZN_LINK_TCP == 1 && defined(Z_EVENT_LOOP)
+    tcp();
+#endif
+#if ZN_LINK_UDP_UNICAST == 1 && defined(Z_EVENT_LOOP)
+    udp();
+#endif
+#if ZN_LINK_UDP_UNICAST == 1 && defined(Z_LINK_BATCH)
+    udp_batch();
+#endif
+#if ZN_LINK_SHM == 1 && defined(Z_LINK_SHM)
+    shm();
+#endif
+
+    return 0;
+}
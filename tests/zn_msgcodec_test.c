@@ -1420,6 +1420,40 @@ void data_message(void)
     _z_wbuf_clear(&wbf);
 }
 
+void loaned_data_message(void)
+{
+    printf("\n>> Loaned data message\n");
+    // Loaned payloads are contiguous, as in the non-expandable transport buffers
+    _z_wbuf_t wbf = _z_wbuf_make(65535, 0);
+
+    // Initialize
+    _zn_zenoh_message_t z_msg = gen_data_message();
+    assert(_ZN_MID(z_msg.header) == _ZN_MID_DATA);
+
+    // Encode by loaning the payload and writing it in place
+    uint8_t *payload = NULL;
+    int res = _zn_zenoh_message_encode_loan(&wbf, &z_msg, &payload);
+    assert(res == 0);
+    (void)(res);
+    assert(payload != NULL);
+    memcpy(payload, z_msg.body.data.payload.val, z_msg.body.data.payload.len);
+
+    // Decode
+    _z_zbuf_t zbf = _z_wbuf_to_zbuf(&wbf);
+    _zn_zenoh_message_result_t r_zm = _zn_zenoh_message_decode(&zbf);
+    assert(r_zm.tag == _z_res_t_OK);
+
+    _zn_zenoh_message_t d_zm = r_zm.value.zenoh_message;
+    assert(d_zm.header == z_msg.header);
+    assert_eq_data_message(&z_msg.body.data, &d_zm.body.data, z_msg.header);
+
+    // Free
+    _zn_z_msg_clear(&d_zm);
+    _zn_z_msg_clear(&z_msg);
+    _z_zbuf_clear(&zbf);
+    _z_wbuf_clear(&wbf);
+}
+
 /*------------------ Pull message ------------------*/
 _zn_zenoh_message_t gen_pull_message(void)
 {
@@ -2496,6 +2530,49 @@ void frame_message(void)
     _z_wbuf_clear(&wbf);
 }
 
+void streamed_frame_message(void)
+{
+    printf("\n>> Streamed frame message\n");
+    _z_wbuf_t wbf = gen_wbuf(65535);
+
+    // Initialize
+    _zn_transport_message_t t_msg = gen_frame_message(0);
+    assert(_ZN_MID(t_msg.header) == _ZN_MID_FRAME);
+
+    _zn_frame_t e_fr = t_msg.body.frame;
+
+    // Encode
+    int res = _zn_transport_message_encode(&wbf, &t_msg);
+    assert(res == 0);
+    (void)(res);
+
+    // Decode the frame header only
+    _z_zbuf_t zbf = _z_wbuf_to_zbuf(&wbf);
+    _zn_transport_message_result_t r_tm;
+    _zn_transport_message_decode_streamed_na(&zbf, &r_tm);
+    assert(r_tm.tag == _z_res_t_OK);
+    assert(r_tm.value.transport_message.header == t_msg.header);
+    assert(r_tm.value.transport_message.body.frame.sn == e_fr.sn);
+    assert(_z_vec_len(&r_tm.value.transport_message.body.frame.payload.messages) == 0);
+
+    // Decode the zenoh messages one by one from the buffer
+    size_t len = _z_vec_len(&e_fr.payload.messages);
+    for (size_t i = 0; i < len; i++)
+    {
+        _zn_zenoh_message_result_t r_zm = _zn_zenoh_message_decode(&zbf);
+        assert(r_zm.tag == _z_res_t_OK);
+        assert_eq_zenoh_message((_zn_zenoh_message_t *)_z_vec_get(&e_fr.payload.messages, i), &r_zm.value.zenoh_message);
+        _zn_z_msg_clear(&r_zm.value.zenoh_message);
+    }
+    assert(_z_zbuf_len(&zbf) == 0);
+
+    // Free
+    _zn_t_msg_clear(&r_tm.value.transport_message);
+    _zn_t_msg_clear(&t_msg);
+    _z_zbuf_clear(&zbf);
+    _z_wbuf_clear(&wbf);
+}
+
 /*------------------ Transport Message ------------------*/
 _zn_transport_message_t gen_transport_message(int can_be_fragment)
 {
@@ -2916,6 +2993,7 @@ int main(void)
         // Zenoh messages
         declare_message();
         data_message();
+        loaned_data_message();
         pull_message();
         query_message();
         zenoh_message();
@@ -2932,6 +3010,7 @@ int main(void)
         keep_alive_message();
         ping_pong_message();
         frame_message();
+        streamed_frame_message();
         transport_message();
         batch();
         fragmentation();
@@ -111,7 +111,7 @@ int main(int argc, z_str_t *argv)
         {
             sprintf(s1_res, "%s%d", uri, i);
             zn_reskey_t rk = zn_rname(s1_res);
-            zn_write_ext(s1, rk, payload, len, Z_ENCODING_DEFAULT, Z_DATA_KIND_DEFAULT, zn_congestion_control_t_BLOCK);
+            zn_write_ext(s1, rk, payload, len, Z_ENCODING_DEFAULT, Z_DATA_KIND_DEFAULT, zn_congestion_control_t_BLOCK, ZN_PRIORITY_DEFAULT);
             printf("Wrote data from session 1: %lu %zu b\t(%u/%u)\n", rk.rid, len, n * SET + (i + 1), total);
             _zn_reskey_clear(&rk);
         }
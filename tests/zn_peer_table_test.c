@@ -0,0 +1,244 @@
+//
+// Copyright (c) 2022 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include "zenoh-pico.h"
+#include "zenoh-pico/session/utils.h"
+#include "zenoh-pico/transport/link/rx.h"
+#include "zenoh-pico/transport/link/task/lease.h"
+#include "zn_test_session.h"
+
+#define PEER_NUM 200
+#define LEASE_PEER_NUM 2000
+#define LEASE 1000
+
+/*------------------ Multicast session ------------------*/
+size_t written;
+
+size_t sink_write(const void *arg, const uint8_t *ptr, size_t len)
+{
+    (void)(arg);
+    (void)(ptr);
+    written++;
+    return len;
+}
+
+zn_session_t *session_make(void)
+{
+    return test_session_make(test_link_make(sink_write, 0, 0, 1), test_session_param_default());
+}
+
+/*------------------ Peers ------------------*/
+// An IPv4 address and a port, as reported by the UDP multicast link
+_zn_link_addr_t addr_make(uint16_t i)
+{
+    uint8_t ip[4] = {192, 168, (uint8_t)(i >> 8), (uint8_t)i};
+    uint16_t port = 7447;
+
+    _zn_link_addr_t addr;
+    _zn_link_addr_reset(&addr);
+    _zn_link_addr_append(&addr, ip, sizeof(ip));
+    _zn_link_addr_append(&addr, &port, sizeof(port));
+    return addr;
+}
+
+void join_with_lease(_zn_transport_multicast_t *ztm, uint16_t i, z_zint_t lease)
+{
+    uint8_t pid[2] = {(uint8_t)(i >> 8), (uint8_t)i};
+    _zn_transport_message_t t_msg = _zn_t_msg_make_join(ZN_PROTO_VERSION, ZN_PEER, lease, ZN_SN_RESOLUTION,
+                                                        _z_bytes_wrap(pid, sizeof(pid)), _zn_conduit_sn_list_make(0, 0));
+    _zn_link_addr_t addr = addr_make(i);
+    int res = _zn_multicast_handle_transport_message(ztm, &t_msg, &addr);
+    assert(res == 0);
+    (void)(res);
+}
+
+void join(_zn_transport_multicast_t *ztm, uint16_t i)
+{
+    join_with_lease(ztm, i, ZN_TRANSPORT_LEASE);
+}
+
+void keep_alive(_zn_transport_multicast_t *ztm, uint16_t i)
+{
+    uint8_t pid[2] = {(uint8_t)(i >> 8), (uint8_t)i};
+    _zn_transport_message_t t_msg = _zn_t_msg_make_keep_alive(_z_bytes_wrap(pid, sizeof(pid)));
+    _zn_link_addr_t addr = addr_make(i);
+    int res = _zn_multicast_handle_transport_message(ztm, &t_msg, &addr);
+    assert(res == 0);
+    (void)(res);
+}
+
+void close_peer(_zn_transport_multicast_t *ztm, uint16_t i)
+{
+    uint8_t pid[2] = {(uint8_t)(i >> 8), (uint8_t)i};
+    _zn_transport_message_t t_msg = _zn_t_msg_make_close(_ZN_CLOSE_GENERIC, _z_bytes_wrap(pid, sizeof(pid)), 0);
+    _zn_link_addr_t addr = addr_make(i);
+    int res = _zn_multicast_handle_transport_message(ztm, &t_msg, &addr);
+    assert(res == 0);
+    (void)(res);
+}
+
+int is_known(_zn_transport_multicast_t *ztm, uint16_t i)
+{
+    _zn_link_addr_t addr = addr_make(i);
+    _zn_transport_peer_entry_t *entry = _zn_transport_peer_table_get(&ztm->peers, &addr);
+    if (entry == NULL)
+        return 0;
+
+    assert(_zn_link_addr_eq(&entry->remote_addr, &addr));
+    assert(entry->remote_pid.len == 2 && entry->remote_pid.val[0] == (uint8_t)(i >> 8) && entry->remote_pid.val[1] == (uint8_t)i);
+    return 1;
+}
+
+void peer_table(void)
+{
+    printf("\n>> Peer table\n");
+    zn_session_t *zn = session_make();
+    _zn_transport_multicast_t *ztm = &zn->tp->transport.multicast;
+
+    // The table grows with the peers joining
+    for (uint16_t i = 0; i < PEER_NUM; i++)
+        join(ztm, i);
+    assert(_zn_transport_peer_table_len(&ztm->peers) == PEER_NUM);
+    assert(_zn_transport_peer_table_capacity(&ztm->peers) >= 2 * PEER_NUM);
+    for (uint16_t i = 0; i < PEER_NUM; i++)
+        assert(is_known(ztm, i));
+    assert(!is_known(ztm, PEER_NUM));
+
+    // The addresses are compared on their whole length
+    _zn_link_addr_t addr = addr_make(0);
+    addr.len--;
+    assert(_zn_transport_peer_table_get(&ztm->peers, &addr) == NULL);
+
+    // Joining again does not add the peer twice
+    join(ztm, 0);
+    assert(_zn_transport_peer_table_len(&ztm->peers) == PEER_NUM);
+
+    // The peers further in the probe chains remain reachable once others are closed
+    for (uint16_t i = 0; i < PEER_NUM; i += 2)
+        close_peer(ztm, i);
+    assert(_zn_transport_peer_table_len(&ztm->peers) == PEER_NUM / 2);
+    for (uint16_t i = 0; i < PEER_NUM; i++)
+        assert(is_known(ztm, i) == i % 2);
+
+    // The closed peers join again without growing the table
+    size_t capacity = _zn_transport_peer_table_capacity(&ztm->peers);
+    for (int n = 0; n < 4; n++)
+    {
+        for (uint16_t i = 0; i < PEER_NUM; i += 2)
+            join(ztm, i);
+        for (uint16_t i = 0; i < PEER_NUM; i += 2)
+            close_peer(ztm, i);
+    }
+    for (uint16_t i = 0; i < PEER_NUM; i += 2)
+        join(ztm, i);
+    assert(_zn_transport_peer_table_len(&ztm->peers) == PEER_NUM);
+    assert(_zn_transport_peer_table_capacity(&ztm->peers) == capacity);
+    for (uint16_t i = 0; i < PEER_NUM; i++)
+        assert(is_known(ztm, i));
+
+    // All the peers are walked
+    size_t len = 0;
+    for (size_t i = 0; i < _zn_transport_peer_table_capacity(&ztm->peers); i++)
+    {
+        if (_zn_transport_peer_table_at(&ztm->peers, i) != NULL)
+            len++;
+    }
+    assert(len == PEER_NUM);
+    (void)(len);
+    (void)(capacity);
+
+    _zn_session_free(&zn);
+}
+
+/*------------------ Leases ------------------*/
+z_zint_t process(_zn_transport_multicast_t *ztm, _znp_multicast_lease_timers_t *timers, z_zint_t now)
+{
+    z_zint_t interval;
+    z_mutex_lock(&ztm->mutex_peer);
+    __unsafe_znp_multicast_lease_process(ztm, timers, now, &interval);
+    z_mutex_unlock(&ztm->mutex_peer);
+    return interval;
+}
+
+void leases(void)
+{
+    printf("\n>> Leases\n");
+    zn_session_t *zn = session_make();
+    _zn_transport_multicast_t *ztm = &zn->tp->transport.multicast;
+
+    for (uint16_t i = 0; i < LEASE_PEER_NUM; i++)
+        join_with_lease(ztm, i, LEASE);
+    assert(_zn_transport_peer_heap_len(&ztm->lease_heap) == LEASE_PEER_NUM);
+    _znp_multicast_lease_timers_t timers;
+    _znp_multicast_lease_init(ztm, &timers);
+    z_zint_t start = _znp_multicast_lease_now(ztm);
+
+    // Nothing is due before the first keep alive, whose period follows the shortest lease
+    written = 0;
+    z_zint_t interval = process(ztm, &timers, start);
+    assert(interval > 0 && interval <= LEASE / ZN_TRANSPORT_LEASE_EXPIRE_FACTOR);
+    assert(written == 0);
+
+    z_zint_t now = start + LEASE / 2;
+    interval = process(ztm, &timers, now);
+    assert(written == 1);
+    assert(interval <= LEASE / ZN_TRANSPORT_LEASE_EXPIRE_FACTOR);
+
+    // The peers heard of during their lease are kept
+    now = start + 3 * LEASE / 2;
+    process(ztm, &timers, now);
+    assert(_zn_transport_peer_table_len(&ztm->peers) == LEASE_PEER_NUM);
+
+    // The others are dropped at once once their lease is over
+    for (uint16_t i = 1; i < LEASE_PEER_NUM; i += 2)
+        keep_alive(ztm, i);
+    written = 0;
+    process(ztm, &timers, now + LEASE);
+    assert(_zn_transport_peer_table_len(&ztm->peers) == LEASE_PEER_NUM / 2);
+    assert(_zn_transport_peer_heap_len(&ztm->lease_heap) == LEASE_PEER_NUM / 2);
+    for (uint16_t i = 0; i < LEASE_PEER_NUM; i++)
+        assert(is_known(ztm, i) == i % 2);
+
+    // The JOIN message sent meanwhile stands in for the keep alive
+    assert(now + LEASE >= start + ZN_JOIN_INTERVAL);
+    assert(written == 1);
+
+    // A peer leaving early is no longer scheduled
+    close_peer(ztm, 1);
+    assert(_zn_transport_peer_heap_len(&ztm->lease_heap) == LEASE_PEER_NUM / 2 - 1);
+    now = start + 10 * LEASE;
+    process(ztm, &timers, now);
+    assert(_zn_transport_peer_table_len(&ztm->peers) == 0);
+    assert(_zn_transport_peer_heap_top(&ztm->lease_heap) == NULL);
+
+    // The keep alive period is restored once the peers are gone
+    interval = process(ztm, &timers, now + ZN_JOIN_INTERVAL);
+    assert(interval > LEASE / ZN_TRANSPORT_LEASE_EXPIRE_FACTOR);
+    (void)(interval);
+
+    _zn_session_free(&zn);
+}
+
+int main(void)
+{
+    setbuf(stdout, NULL);
+
+    peer_table();
+    leases();
+
+    return 0;
+}
@@ -0,0 +1,301 @@
+//
+// Copyright (c) 2022 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include "zenoh-pico.h"
+#include "zenoh-pico/protocol/msgcodec.h"
+#include "zenoh-pico/session/utils.h"
+#include "zenoh-pico/transport/link/rx.h"
+#include "zenoh-pico/transport/link/tx.h"
+#include "zenoh-pico/transport/utils.h"
+#include "zn_test_session.h"
+
+#define LARGE_MSG_SIZE 150000
+#define QUEUE_LEN 16
+
+/*------------------ Scheduler ------------------*/
+typedef struct
+{
+    _zn_tx_scheduler_t *s;
+    zn_priority_t priority;
+    zn_priority_t *order;
+    size_t *order_len;
+} writer_t;
+
+void *writer_task(void *arg)
+{
+    writer_t *w = (writer_t *)arg;
+    _zn_tx_scheduler_acquire(w->s, w->priority);
+    w->order[(*w->order_len)++] = w->priority;
+    _zn_tx_scheduler_release(w->s);
+    return NULL;
+}
+
+void wait_for_writer(_zn_tx_scheduler_t *s, zn_priority_t priority)
+{
+    int is_waiting = 0;
+    while (!is_waiting)
+    {
+        z_mutex_lock(&s->mutex);
+        is_waiting = s->waiting[priority] > 0;
+        z_mutex_unlock(&s->mutex);
+        if (!is_waiting)
+            z_sleep_ms(1);
+    }
+}
+
+void scheduler_order(void)
+{
+    printf("\n>> Scheduler order\n");
+    _zn_tx_scheduler_t s;
+    _zn_tx_scheduler_init(&s);
+
+    zn_priority_t order[2];
+    size_t order_len = 0;
+    writer_t low = {&s, zn_priority_t_BACKGROUND, order, &order_len};
+    writer_t high = {&s, zn_priority_t_REAL_TIME, order, &order_len};
+
+    // The writers queue up behind the current one, the lowest priority first
+    _zn_tx_scheduler_acquire(&s, zn_priority_t_DATA);
+    z_task_t low_task;
+    z_task_t high_task;
+    z_task_init(&low_task, NULL, writer_task, &low);
+    wait_for_writer(&s, low.priority);
+    z_task_init(&high_task, NULL, writer_task, &high);
+    wait_for_writer(&s, high.priority);
+
+    // Congested writers give up while the turn is taken
+    int res = _zn_tx_scheduler_try_acquire(&s, zn_priority_t_CONTROL);
+    assert(res != 0);
+
+    // The highest priority goes first
+    _zn_tx_scheduler_release(&s);
+    z_task_join(&low_task);
+    z_task_join(&high_task);
+    assert(order_len == 2);
+    assert(order[0] == zn_priority_t_REAL_TIME);
+    assert(order[1] == zn_priority_t_BACKGROUND);
+
+    res = _zn_tx_scheduler_try_acquire(&s, zn_priority_t_BACKGROUND);
+    assert(res == 0);
+    (void)(res);
+    _zn_tx_scheduler_release(&s);
+
+    _zn_tx_scheduler_clear(&s);
+}
+
+/*------------------ Datagram link ------------------*/
+typedef struct
+{
+    z_bytes_t datagrams[QUEUE_LEN];
+    size_t len;
+} datagram_queue_t;
+
+_zn_link_t *link_a;
+datagram_queue_t queue_a; // Datagrams sent by A
+datagram_queue_t queue_b; // Datagrams sent by B
+
+size_t datagram_write(const void *arg, const uint8_t *ptr, size_t len)
+{
+    datagram_queue_t *q = arg == link_a ? &queue_a : &queue_b;
+    assert(q->len < QUEUE_LEN);
+
+    z_bytes_t bs = _z_bytes_wrap(ptr, len);
+    _z_bytes_copy(&q->datagrams[q->len], &bs);
+    q->len++;
+    return len;
+}
+
+_zn_link_t *datagram_link_make(void)
+{
+    return test_link_make(datagram_write, 1, 0, 0);
+}
+
+zn_session_t *session_make(_zn_link_t *zl, uint8_t is_qos)
+{
+    test_session_param_t param = test_session_param_default();
+    param.initial_sn_rx = ZN_SN_RESOLUTION - 1;
+    param.is_qos = is_qos;
+    return test_session_make(zl, param);
+}
+
+void queue_clear(datagram_queue_t *q)
+{
+    for (size_t i = 0; i < q->len; i++)
+        _z_bytes_clear(&q->datagrams[i]);
+    q->len = 0;
+}
+
+void deliver(zn_session_t *zn, const z_bytes_t *datagram)
+{
+    _z_zbuf_t zbf;
+    zbf.ios = _z_iosli_wrap(datagram->val, datagram->len, 0, datagram->len);
+    while (_z_zbuf_len(&zbf) > 0)
+    {
+        _zn_transport_message_result_t r;
+        _zn_transport_message_decode_na(&zbf, &r);
+        assert(r.tag == _z_res_t_OK);
+        _zn_unicast_handle_transport_message(&zn->tp->transport.unicast, &r.value.transport_message);
+        _zn_t_msg_clear(&r.value.transport_message);
+    }
+}
+
+zn_priority_t frame_priority(const z_bytes_t *datagram)
+{
+    _z_zbuf_t zbf;
+    zbf.ios = _z_iosli_wrap(datagram->val, datagram->len, 0, datagram->len);
+    _zn_transport_message_result_t r;
+    _zn_transport_message_decode_na(&zbf, &r);
+    assert(r.tag == _z_res_t_OK);
+    assert(_ZN_MID(r.value.transport_message.header) == _ZN_MID_FRAME);
+    zn_priority_t priority = r.value.transport_message.body.frame.priority;
+    _zn_t_msg_clear(&r.value.transport_message);
+    return priority;
+}
+
+int write_flush(zn_session_t *zn, const uint8_t *payload, size_t len, zn_priority_t priority)
+{
+    zn_reskey_t reskey = zn_rname("/test");
+    int res = zn_write_ext(zn, reskey, payload, len, Z_ENCODING_DEFAULT, Z_DATA_KIND_DEFAULT, zn_congestion_control_t_BLOCK, priority);
+    _zn_unicast_flush(&zn->tp->transport.unicast);
+    _zn_reskey_clear(&reskey);
+    return res;
+}
+
+/*------------------ Subscriber ------------------*/
+size_t small_received;
+size_t large_received;
+
+void data_handler(const zn_sample_t *sample, const void *arg)
+{
+    (void)(arg);
+    if (sample->value.len == LARGE_MSG_SIZE)
+    {
+        for (size_t i = 0; i < LARGE_MSG_SIZE; i++)
+            assert(sample->value.val[i] == (uint8_t)i);
+        large_received++;
+    }
+    else
+    {
+        assert(sample->value.len == 1);
+        small_received++;
+    }
+}
+
+/*------------------ Conduits ------------------*/
+void qos_conduits(void)
+{
+    printf("\n>> QoS conduits\n");
+    link_a = datagram_link_make();
+    zn_session_t *zn_a = session_make(link_a, 1);
+    zn_session_t *zn_b = session_make(datagram_link_make(), 1);
+    _zn_transport_unicast_t *ztu_a = &zn_a->tp->transport.unicast;
+
+    zn_subscriber_t *sub = zn_declare_subscriber(zn_b, zn_rname("/test"), zn_subinfo_default(), data_handler, NULL);
+    assert(sub != NULL);
+    queue_clear(&queue_b);
+
+    // Every priority has its own SNs
+    uint8_t val = 0;
+    int res = write_flush(zn_a, &val, 1, zn_priority_t_REAL_TIME);
+    assert(res == 0);
+    res = write_flush(zn_a, &val, 1, zn_priority_t_REAL_TIME);
+    assert(res == 0);
+    res = write_flush(zn_a, &val, 1, ZN_PRIORITY_DEFAULT);
+    assert(res == 0);
+    assert(ztu_a->sn_tx_sns.val.qos[zn_priority_t_REAL_TIME].reliable == 2);
+    assert(ztu_a->sn_tx_sns.val.qos[ZN_PRIORITY_DEFAULT].reliable == 1);
+    assert(ztu_a->sn_tx_sns.val.qos[zn_priority_t_BACKGROUND].reliable == 0);
+
+    // Only the frames with a non-default priority are decorated
+    assert(queue_a.len == 3);
+    assert(queue_a.datagrams[0].val[0] == _ZN_PRIORITY_HEADER(zn_priority_t_REAL_TIME));
+    assert(frame_priority(&queue_a.datagrams[0]) == zn_priority_t_REAL_TIME);
+    assert(_ZN_MID(queue_a.datagrams[2].val[0]) == _ZN_MID_FRAME);
+    assert(frame_priority(&queue_a.datagrams[2]) == ZN_PRIORITY_DEFAULT);
+    for (size_t i = 0; i < queue_a.len; i++)
+        deliver(zn_b, &queue_a.datagrams[i]);
+    queue_clear(&queue_a);
+    assert(small_received == 3);
+
+    // A high priority message overtakes the fragments of a background one
+    uint8_t *large = (uint8_t *)z_malloc(LARGE_MSG_SIZE);
+    for (size_t i = 0; i < LARGE_MSG_SIZE; i++)
+        large[i] = (uint8_t)i;
+    res = write_flush(zn_a, large, LARGE_MSG_SIZE, zn_priority_t_BACKGROUND);
+    assert(res == 0);
+    size_t fragments = queue_a.len;
+    assert(fragments > 1);
+    res = write_flush(zn_a, &val, 1, zn_priority_t_CONTROL);
+    assert(res == 0);
+    assert(queue_a.len == fragments + 1);
+
+    deliver(zn_b, &queue_a.datagrams[0]);
+    deliver(zn_b, &queue_a.datagrams[fragments]);
+    assert(small_received == 4);
+    for (size_t i = 1; i < fragments; i++)
+        deliver(zn_b, &queue_a.datagrams[i]);
+    queue_clear(&queue_a);
+    assert(large_received == 1);
+    z_free(large);
+    (void)(ztu_a);
+    (void)(res);
+
+    zn_undeclare_subscriber(sub);
+    z_free(sub);
+    queue_clear(&queue_b);
+    _zn_session_free(&zn_a);
+    _zn_session_free(&zn_b);
+}
+
+void plain_conduit(void)
+{
+    printf("\n>> Plain conduit\n");
+    link_a = datagram_link_make();
+    zn_session_t *zn_a = session_make(link_a, 0);
+    _zn_transport_unicast_t *ztu_a = &zn_a->tp->transport.unicast;
+
+    // Without QoS the priorities share the same SNs and frames are not decorated
+    uint8_t val = 0;
+    int res = write_flush(zn_a, &val, 1, zn_priority_t_REAL_TIME);
+    assert(res == 0);
+    res = write_flush(zn_a, &val, 1, zn_priority_t_BACKGROUND);
+    assert(res == 0);
+    (void)(res);
+    assert(ztu_a->sn_tx_sns.val.plain.reliable == 2);
+    (void)(ztu_a);
+
+    assert(queue_a.len == 2);
+    for (size_t i = 0; i < queue_a.len; i++)
+    {
+        assert(_ZN_MID(queue_a.datagrams[i].val[0]) == _ZN_MID_FRAME);
+        assert(frame_priority(&queue_a.datagrams[i]) == ZN_PRIORITY_DEFAULT);
+    }
+    queue_clear(&queue_a);
+
+    _zn_session_free(&zn_a);
+}
+
+int main(void)
+{
+    setbuf(stdout, NULL);
+
+    scheduler_order();
+    qos_conduits();
+    plain_conduit();
+
+    return 0;
+}
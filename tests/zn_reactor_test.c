@@ -0,0 +1,181 @@
+//
+// Copyright (c) 2022 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include "zenoh-pico.h"
+#include "zenoh-pico/session/utils.h"
+#include "zn_test_session.h"
+
+#if defined(Z_EVENT_LOOP)
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#define LEASE 100
+#define MSG_NUM 3
+
+/*------------------ Socket pair link ------------------*/
+size_t pair_write(const void *arg, const uint8_t *ptr, size_t len)
+{
+    const test_link_t *tl = (const test_link_t *)arg;
+    ssize_t wb = send(tl->fd, ptr, len, MSG_NOSIGNAL);
+    return wb < 0 ? SIZE_MAX : (size_t)wb;
+}
+
+size_t pair_read(const void *arg, uint8_t *ptr, size_t len, _zn_link_addr_t *addr)
+{
+    (void)(addr);
+    const test_link_t *tl = (const test_link_t *)arg;
+    ssize_t rb = recv(tl->fd, ptr, len, 0);
+    return rb < 0 ? SIZE_MAX : (size_t)rb;
+}
+
+int pair_fd(const void *arg)
+{
+    return ((const test_link_t *)arg)->fd;
+}
+
+zn_session_t *session_make(int fd)
+{
+    _zn_link_t *zl = test_link_make(pair_write, 1, 1, 0);
+    ((test_link_t *)zl)->fd = fd;
+    zl->read_f = pair_read;
+    zl->fd_f = pair_fd;
+
+    test_session_param_t param = test_session_param_default();
+    param.initial_sn_rx = ZN_SN_RESOLUTION - 1;
+    param.lease = LEASE;
+    return test_session_make(zl, param);
+}
+
+/*------------------ Event loop ------------------*/
+size_t received;
+
+void data_handler(const zn_sample_t *sample, const void *arg)
+{
+    (void)(arg);
+    (void)(sample);
+    assert(sample->value.len == 1);
+    assert(sample->value.val[0] == received);
+    received++;
+}
+
+int is_expired(znp_reactor_t *r, zn_session_t *zn)
+{
+    _znp_reactor_entry_t key;
+    key.ztu = &zn->tp->transport.unicast;
+    _znp_reactor_entry_list_t *xs = _znp_reactor_entry_list_find(r->entries, _znp_reactor_entry_eq, &key);
+    assert(xs != NULL);
+    return _znp_reactor_entry_list_head(xs)->is_expired;
+}
+
+void run(znp_reactor_t *r, unsigned long duration)
+{
+    z_clock_t start = z_clock_now();
+    while (z_clock_elapsed_ms(&start) < duration)
+    {
+        int res = znp_process_events(r, 10);
+        assert(res == 0);
+        (void)(res);
+    }
+}
+
+void event_loop(void)
+{
+    printf("\n>> Event loop\n");
+    int sv[2];
+    int res = socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+    assert(res == 0);
+    zn_session_t *zn_a = session_make(sv[0]);
+    zn_session_t *zn_b = session_make(sv[1]);
+
+    znp_reactor_t *r = znp_reactor_new();
+    assert(r != NULL);
+    res = znp_reactor_add(r, zn_a);
+    assert(res == 0);
+    res = znp_reactor_add(r, zn_b);
+    assert(res == 0);
+
+    // A session is driven by a single reactor
+    res = znp_reactor_add(r, zn_a);
+    assert(res != 0);
+
+    zn_subscriber_t *sub = zn_declare_subscriber(zn_a, zn_rname("/test"), zn_subinfo_default(), data_handler, NULL);
+    assert(sub != NULL);
+    znp_flush(zn_a);
+
+    // The reactor fd becomes readable once data is received
+    zn_reskey_t reskey = zn_rname("/test");
+    for (uint8_t i = 0; i < MSG_NUM; i++)
+    {
+        res = zn_write(zn_b, reskey, &i, 1);
+        assert(res == 0);
+    }
+    znp_flush(zn_b);
+    _zn_reskey_clear(&reskey);
+
+    struct pollfd pfd;
+    pfd.fd = znp_reactor_fd(r);
+    pfd.events = POLLIN;
+    res = poll(&pfd, 1, 1000);
+    assert(res == 1 && (pfd.revents & POLLIN));
+
+    for (int i = 0; i < 100 && received < MSG_NUM; i++)
+    {
+        res = znp_process_events(r, 10);
+        assert(res == 0);
+    }
+    assert(received == MSG_NUM);
+
+    // The keep alive messages maintain the leases
+    run(r, 3 * LEASE);
+    assert(!is_expired(r, zn_a));
+    assert(!is_expired(r, zn_b));
+
+    // The lease of A expires once B is no longer driven
+    assert(zn_b->tp->transport.unicast.has_rx_task == 1);
+    res = znp_reactor_remove(r, zn_b);
+    assert(res == 0);
+    assert(zn_b->tp->transport.unicast.has_rx_task == 0);
+    res = znp_reactor_remove(r, zn_b);
+    assert(res != 0);
+    run(r, 3 * LEASE);
+    assert(is_expired(r, zn_a));
+
+    res = znp_reactor_remove(r, zn_a);
+    assert(res == 0);
+    (void)(res);
+    znp_reactor_free(&r);
+    assert(r == NULL);
+
+    z_free(sub);
+    _zn_session_free(&zn_a);
+    _zn_session_free(&zn_b);
+    close(sv[0]);
+    close(sv[1]);
+}
+#endif
+
+int main(void)
+{
+    setbuf(stdout, NULL);
+
+#if defined(Z_EVENT_LOOP)
+    event_loop();
+#endif
+
+    return 0;
+}
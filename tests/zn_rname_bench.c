@@ -0,0 +1,91 @@
+//
+// Copyright (c) 2022 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "zenoh-pico/protocol/utils.h"
+#include "zenoh-pico/system/platform.h"
+
+#define RNAME_LEN 64
+#define MATCHES 1000000
+
+void bench(size_t len)
+{
+    // One subscription out of ten is a wildcard
+    z_str_t *rnames = (z_str_t *)z_malloc(len * sizeof(z_str_t));
+    for (size_t i = 0; i < len; i++)
+    {
+        rnames[i] = (z_str_t)z_malloc(RNAME_LEN);
+        if (i % 10 == 9)
+            snprintf(rnames[i], RNAME_LEN, "/bench/%zu/**", i);
+        else if (i % 10 == 8)
+            snprintf(rnames[i], RNAME_LEN, "/bench/*/%zu", i);
+        else
+            snprintf(rnames[i], RNAME_LEN, "/bench/%zu/value", i);
+    }
+
+    _zn_rname_index_t idx;
+    _zn_rname_index_init(&idx);
+    for (size_t i = 0; i < len; i++)
+        _zn_rname_index_insert(&idx, rnames[i], rnames[i]);
+
+    char key[RNAME_LEN];
+    size_t rounds = MATCHES / len > 0 ? MATCHES / len : 1;
+
+    // Pairwise matching against every subscription
+    size_t p_matches = 0;
+    z_clock_t start = z_clock_now();
+    for (size_t r = 0; r < rounds; r++)
+    {
+        snprintf(key, RNAME_LEN, "/bench/%zu/value", r % len);
+        for (size_t i = 0; i < len; i++)
+            p_matches += zn_rname_intersect(rnames[i], key);
+    }
+    unsigned long p_elapsed = z_clock_elapsed_us(&start);
+
+    // Single traversal of the index
+    size_t i_matches = 0;
+    start = z_clock_now();
+    for (size_t r = 0; r < rounds; r++)
+    {
+        snprintf(key, RNAME_LEN, "/bench/%zu/value", r % len);
+        _z_list_t *xs = _zn_rname_index_match(&idx, key);
+        i_matches += _z_list_len(xs);
+        _z_list_free(&xs, _zn_noop_free);
+    }
+    unsigned long i_elapsed = z_clock_elapsed_us(&start);
+
+    if (p_matches != i_matches)
+    {
+        printf("Mismatching results for %zu subscriptions: %zu vs %zu\n", len, p_matches, i_matches);
+        exit(-1);
+    }
+
+    printf("%zu subscriptions, %zu matches: pairwise %.3f us/match, index %.3f us/match\n",
+           len, rounds, (double)p_elapsed / rounds, (double)i_elapsed / rounds);
+
+    _zn_rname_index_clear(&idx);
+    for (size_t i = 0; i < len; i++)
+        z_free(rnames[i]);
+    z_free(rnames);
+}
+
+int main(void)
+{
+    bench(10);
+    bench(1000);
+    bench(100000);
+
+    return 0;
+}
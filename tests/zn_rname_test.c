@@ -15,6 +15,14 @@
 #include <assert.h>
 #include "zenoh-pico/protocol/utils.h"
 
+#define PATTERNS_LEN 24
+#define RNAMES_LEN 14
+
+int ptr_eq(const void *left, const void *right)
+{
+    return left == right;
+}
+
 int main(void)
 {
     assert(zn_rname_intersect("/", "/"));
@@ -68,5 +76,41 @@ int main(void)
     assert(!zn_rname_intersect("/x/c*", "/x/abc*"));
     assert(!zn_rname_intersect("/x/*d", "/x/*e"));
 
+    // The index must match exactly the pairwise intersection
+    char *patterns[PATTERNS_LEN] = {"/", "/a", "/a/", "/a/b", "/*", "/*/", "/ab*", "/ab*d", "/ab/*",
+                                    "/a/*/c/*/e", "/a/**/d/**/l", "/a/*b/c/*d/e", "/ab*cd", "/**", "/**/",
+                                    "/ab/**", "/**/xyz", "/**/xyz*xyz", "/a/**/c/**/e", "/a/**/c/*/e/*",
+                                    "/x/abc", "/x/*", "/**/**", "xxx"};
+    char *rnames[RNAMES_LEN] = {"/", "/a", "/abc", "/abcd", "/ab", "/a/b/c/d/e", "/a/d/foo/l", "/a/xb/c/xd/e",
+                                "/abxxcxxcd", "/a/b/xyz/d/e/f/xyz", "/a/c/e", "/a/b/b/b/c/d/d/c/d/e/f", "/x/abc", "xxx"};
+
+    _zn_rname_index_t idx;
+    _zn_rname_index_init(&idx);
+    for (size_t i = 0; i < PATTERNS_LEN; i++)
+        _zn_rname_index_insert(&idx, patterns[i], patterns[i]);
+
+    for (size_t i = 0; i < RNAMES_LEN; i++)
+    {
+        assert(_zn_rname_index_can_match(rnames[i]));
+        _z_list_t *xs = _zn_rname_index_match(&idx, rnames[i]);
+        size_t len = 0;
+        for (size_t j = 0; j < PATTERNS_LEN; j++)
+        {
+            int is_matched = _z_list_find(xs, ptr_eq, patterns[j]) != NULL;
+            assert(is_matched == zn_rname_intersect(patterns[j], rnames[i]));
+            len += is_matched;
+        }
+        assert(_z_list_len(xs) == len);
+        _z_list_free(&xs, _zn_noop_free);
+    }
+
+    // Removing values prunes the index
+    for (size_t i = 0; i < PATTERNS_LEN; i++)
+        _zn_rname_index_remove(&idx, patterns[i], patterns[i]);
+    assert(_zn_rname_index_match(&idx, "/a/b") == NULL);
+    assert(idx.root != NULL && idx.root->vals == NULL && _z_int_void_map_is_empty(&idx.root->children));
+    _zn_rname_index_clear(&idx);
+    assert(!_zn_rname_index_can_match("/a/*"));
+
     return 0;
 }
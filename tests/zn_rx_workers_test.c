@@ -0,0 +1,199 @@
+//
+// Copyright (c) 2022 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include "zenoh-pico.h"
+#include "zenoh-pico/session/resource.h"
+#include "zenoh-pico/session/subscription.h"
+#include "zenoh-pico/session/utils.h"
+#include "zenoh-pico/session/workers.h"
+
+#define WORKERS 3
+#define KEYS 8
+#define MSG_NUM 1000
+
+/*------------------ Message queue ------------------*/
+typedef struct
+{
+    z_mqueue_t *mq;
+    size_t sum;
+} consumer_t;
+
+void *mqueue_consume(void *arg)
+{
+    consumer_t *c = (consumer_t *)arg;
+    size_t *e = (size_t *)z_mqueue_pull(c->mq);
+    while (e != NULL)
+    {
+        c->sum += *e;
+        e = (size_t *)z_mqueue_pull(c->mq);
+    }
+
+    return NULL;
+}
+
+void mqueue(void)
+{
+    printf("\n>> Message queue\n");
+    size_t vals[MSG_NUM];
+    z_mqueue_t *mq = z_mqueue_make(4);
+
+    // Two consumers drain a queue smaller than the number of messages
+    consumer_t ca = {mq, 0};
+    consumer_t cb = {mq, 0};
+    z_task_t a;
+    z_task_t b;
+    int res = z_task_init(&a, NULL, mqueue_consume, &ca);
+    assert(res == 0);
+    res = z_task_init(&b, NULL, mqueue_consume, &cb);
+    assert(res == 0);
+
+    size_t expected = 0;
+    for (size_t i = 0; i < MSG_NUM; i++)
+    {
+        vals[i] = i;
+        expected += i;
+        res = z_mqueue_push(mq, &vals[i]);
+        assert(res == 0);
+    }
+
+    // Nothing is pushed once closed, what was pushed before is consumed
+    z_mqueue_close(mq);
+    res = z_mqueue_push(mq, &vals[0]);
+    assert(res != 0);
+
+    z_task_join(&a);
+    z_task_join(&b);
+    assert(ca.sum + cb.sum == expected);
+    (void)(res);
+    (void)(expected);
+
+    z_mqueue_free(&mq);
+}
+
+/*------------------ RX workers ------------------*/
+typedef struct
+{
+    size_t received[KEYS];
+    int is_ordered;
+    z_mutex_t mutex;
+} rx_ctx_t;
+
+void data_handler(const zn_sample_t *sample, const void *arg)
+{
+    rx_ctx_t *ctx = (rx_ctx_t *)arg;
+    size_t key = (size_t)(sample->key.val[sample->key.len - 1] - '0');
+    size_t val;
+    memcpy(&val, sample->value.val, sizeof(size_t));
+
+    z_mutex_lock(&ctx->mutex);
+    if (ctx->received[key] != val)
+        ctx->is_ordered = 0;
+    ctx->received[key]++;
+    z_mutex_unlock(&ctx->mutex);
+}
+
+_zn_subscriber_t *subscriber_make(zn_session_t *zn, char *rname, rx_ctx_t *ctx)
+{
+    _zn_subscriber_t *sub = (_zn_subscriber_t *)z_malloc(sizeof(_zn_subscriber_t));
+    sub->id = _zn_get_entity_id(zn);
+    sub->rname = _z_str_clone(rname);
+    sub->key.rid = ZN_RESOURCE_ID_NONE;
+    sub->key.rname = _z_str_clone(rname);
+    sub->info = zn_subinfo_default();
+    sub->callback = data_handler;
+    sub->arg = ctx;
+    sub->arg_drop = NULL;
+    return sub;
+}
+
+void rx_workers(void)
+{
+    printf("\n>> RX workers\n");
+    rx_ctx_t ctx;
+    memset(&ctx, 0, sizeof(rx_ctx_t));
+    ctx.is_ordered = 1;
+    z_mutex_init(&ctx.mutex);
+
+    zn_session_t *zn = _zn_session_init();
+    char rname[] = "/test/0";
+    for (size_t k = 0; k < KEYS; k++)
+    {
+        rname[strlen(rname) - 1] = (char)('0' + k);
+        int res = _zn_register_subscription(zn, _ZN_RESOURCE_IS_LOCAL, subscriber_make(zn, rname, &ctx));
+        assert(res == 0);
+        (void)(res);
+    }
+
+    // A remote resource used as a prefix by half of the samples
+    _zn_resource_t *r = (_zn_resource_t *)z_malloc(sizeof(_zn_resource_t));
+    r->id = 1;
+    r->key.rid = ZN_RESOURCE_ID_NONE;
+    r->key.rname = _z_str_clone("/test/");
+    r->rname = NULL;
+    r->subs = _z_vec_make(0);
+    r->is_subs_valid = 0;
+    int res = _zn_register_resource(zn, _ZN_RESOURCE_REMOTE, r);
+    assert(res == 0);
+
+    res = _zn_rx_workers_start(zn, WORKERS);
+    assert(res == 0);
+    assert(zn->rx_workers.len == WORKERS);
+
+    // The samples are copied, the buffers can be reused right away
+    uint8_t large[ZN_RX_WORKER_SLOT_SIZE + 1];
+    memset(large, 0, sizeof(large));
+    for (size_t i = 0; i < MSG_NUM; i++)
+    {
+        for (size_t k = 0; k < KEYS; k++)
+        {
+            // The same key is received both as a full name and prefixed by a RID
+            rname[strlen(rname) - 1] = (char)('0' + k);
+            zn_reskey_t reskey = i % 2 == 0 ? zn_rname(rname) : zn_rid_with_suffix(1, rname + strlen("/test/"));
+
+            // Some payloads do not fit in the storage of a slot
+            memcpy(large, &i, sizeof(size_t));
+            z_bytes_t payload = i % 3 == 0 ? _z_bytes_wrap(large, sizeof(large)) : _z_bytes_wrap((const uint8_t *)&i, sizeof(size_t));
+            res = _zn_rx_workers_push(zn, &reskey, &payload);
+            assert(res == 0);
+            _zn_reskey_clear(&reskey);
+        }
+    }
+
+    // Forgetting the prefix does not affect the samples already received
+    _zn_unregister_resource(zn, _ZN_RESOURCE_REMOTE, r);
+    (void)(res);
+
+    // The pending samples are dispatched before the session is freed
+    _zn_session_free(&zn);
+
+    // Each key is dispatched in order by a single worker
+    assert(ctx.is_ordered);
+    for (size_t k = 0; k < KEYS; k++)
+        assert(ctx.received[k] == MSG_NUM);
+
+    z_mutex_free(&ctx.mutex);
+}
+
+int main(void)
+{
+    setbuf(stdout, NULL);
+
+    mqueue();
+    rx_workers();
+
+    return 0;
+}
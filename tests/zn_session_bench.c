@@ -0,0 +1,155 @@
+//
+// Copyright (c) 2022 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "zenoh-pico.h"
+#include "zenoh-pico/session/resource.h"
+#include "zenoh-pico/session/subscription.h"
+#include "zenoh-pico/session/utils.h"
+
+#define BENCH_RID 1
+#define BENCH_DURATION_MS 1000
+#define MAX_THREADS 8
+
+typedef struct
+{
+    zn_session_t *zn;
+    volatile int is_running;
+    size_t ops[MAX_THREADS];
+} bench_ctx_t;
+
+typedef struct
+{
+    bench_ctx_t *ctx;
+    size_t idx;
+} bench_arg_t;
+
+void data_handler(const zn_sample_t *sample, const void *arg)
+{
+    (void)(sample);
+    (void)(arg);
+}
+
+_zn_subscriber_t *subscriber_make(zn_session_t *zn, char *rname)
+{
+    _zn_subscriber_t *sub = (_zn_subscriber_t *)z_malloc(sizeof(_zn_subscriber_t));
+    sub->id = _zn_get_entity_id(zn);
+    sub->rname = _z_str_clone(rname);
+    sub->key.rid = ZN_RESOURCE_ID_NONE;
+    sub->key.rname = _z_str_clone(rname);
+    sub->info = zn_subinfo_default();
+    sub->callback = data_handler;
+    sub->arg = NULL;
+    sub->arg_drop = NULL;
+    return sub;
+}
+
+void *dispatch_task(void *arg)
+{
+    bench_arg_t *ba = (bench_arg_t *)arg;
+    bench_ctx_t *ctx = ba->ctx;
+
+    // Alternate between RID only keys and keys with a suffix
+    zn_reskey_t rid_key = zn_rid(BENCH_RID);
+    zn_reskey_t suffix_key = zn_rid_with_suffix(BENCH_RID, "/1");
+    uint8_t val = 0;
+    z_bytes_t payload = _z_bytes_wrap(&val, 1);
+
+    size_t ops = 0;
+    while (ctx->is_running)
+    {
+        _zn_trigger_subscriptions(ctx->zn, (ops % 2) == 0 ? rid_key : suffix_key, payload);
+        ops++;
+    }
+
+    _zn_reskey_clear(&suffix_key);
+    ctx->ops[ba->idx] = ops;
+    return NULL;
+}
+
+void *declare_task(void *arg)
+{
+    bench_ctx_t *ctx = (bench_ctx_t *)arg;
+
+    // Keep declaring and undeclaring a subscription in the background
+    while (ctx->is_running)
+    {
+        _zn_subscriber_t *sub = subscriber_make(ctx->zn, "/declared/value");
+        if (_zn_register_subscription(ctx->zn, _ZN_RESOURCE_IS_LOCAL, sub) != 0)
+            exit(-1);
+        z_sleep_ms(1);
+        _zn_unregister_subscription(ctx->zn, _ZN_RESOURCE_IS_LOCAL, sub);
+    }
+
+    return NULL;
+}
+
+void bench(zn_session_t *zn, size_t threads)
+{
+    bench_ctx_t ctx;
+    ctx.zn = zn;
+    ctx.is_running = 1;
+
+    z_task_t declarer;
+    z_task_t dispatchers[MAX_THREADS];
+    bench_arg_t args[MAX_THREADS];
+    z_task_init(&declarer, NULL, declare_task, &ctx);
+    for (size_t i = 0; i < threads; i++)
+    {
+        args[i].ctx = &ctx;
+        args[i].idx = i;
+        z_task_init(&dispatchers[i], NULL, dispatch_task, &args[i]);
+    }
+
+    z_sleep_ms(BENCH_DURATION_MS);
+    ctx.is_running = 0;
+
+    size_t ops = 0;
+    for (size_t i = 0; i < threads; i++)
+    {
+        z_task_join(&dispatchers[i]);
+        ops += ctx.ops[i];
+    }
+    z_task_join(&declarer);
+
+    printf("%zu dispatching threads: %.0f dispatches/s\n", threads, (double)ops * 1000 / BENCH_DURATION_MS);
+}
+
+int main(void)
+{
+    zn_session_t *zn = _zn_session_init();
+
+    // A remote resource matched by local subscriptions
+    _zn_resource_t *res = (_zn_resource_t *)z_malloc(sizeof(_zn_resource_t));
+    res->id = BENCH_RID;
+    res->key.rid = ZN_RESOURCE_ID_NONE;
+    res->key.rname = _z_str_clone("/bench/value");
+    res->rname = NULL;
+    res->subs = _z_vec_make(0);
+    res->is_subs_valid = 0;
+    if (_zn_register_resource(zn, _ZN_RESOURCE_REMOTE, res) != 0)
+        exit(-1);
+
+    if (_zn_register_subscription(zn, _ZN_RESOURCE_IS_LOCAL, subscriber_make(zn, "/bench/value")) != 0)
+        exit(-1);
+    if (_zn_register_subscription(zn, _ZN_RESOURCE_IS_LOCAL, subscriber_make(zn, "/bench/value/1")) != 0)
+        exit(-1);
+
+    for (size_t threads = 1; threads <= MAX_THREADS; threads *= 2)
+        bench(zn, threads);
+
+    _zn_session_free(&zn);
+    return 0;
+}
@@ -0,0 +1,115 @@
+//
+// Copyright (c) 2022 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+#ifndef ZENOH_PICO_TESTS_ZN_TEST_SESSION_H
+#define ZENOH_PICO_TESTS_ZN_TEST_SESSION_H
+
+#include <string.h>
+#include "zenoh-pico.h"
+#include "zenoh-pico/session/utils.h"
+
+// Fake links and sessions shared by the tests. Each test is built from a
+// single source file, so the definitions live in this header.
+
+/*------------------ Fake link ------------------*/
+typedef struct
+{
+    _zn_link_t link;
+    int fd; // The descriptor returned by the test's fd_f, -1 if unused
+} test_link_t;
+
+void test_link_noop(void *arg)
+{
+    (void)(arg);
+}
+
+/**
+ * Make a link writing through the test's callback, the other callbacks
+ * being left NULL for the test to set. The link is owned by the transport
+ * it is given to.
+ */
+_zn_link_t *test_link_make(_zn_f_link_write write_f, uint8_t is_reliable, uint8_t is_streamed, uint8_t is_multicast)
+{
+    test_link_t *tl = (test_link_t *)z_malloc(sizeof(test_link_t));
+    memset(tl, 0, sizeof(test_link_t));
+    tl->fd = -1;
+
+    _zn_link_t *zl = &tl->link;
+    zl->close_f = test_link_noop;
+    zl->free_f = test_link_noop;
+    zl->write_f = write_f;
+    zl->write_all_f = write_f;
+    zl->writev_f = NULL;
+    zl->mtu = 65535;
+    zl->is_reliable = is_reliable;
+    zl->is_streamed = is_streamed;
+    zl->is_multicast = is_multicast;
+    return zl;
+}
+
+/*------------------ Fake session ------------------*/
+typedef struct
+{
+    z_zint_t sn_resolution;
+    z_zint_t initial_sn_tx;
+    z_zint_t initial_sn_rx; // Unicast only
+    z_zint_t lease;         // Unicast only
+    uint8_t is_qos;
+} test_session_param_t;
+
+test_session_param_t test_session_param_default(void)
+{
+    test_session_param_t param;
+    param.sn_resolution = ZN_SN_RESOLUTION;
+    param.initial_sn_tx = 0;
+    param.initial_sn_rx = 0;
+    param.lease = ZN_TRANSPORT_LEASE;
+    param.is_qos = 0;
+    return param;
+}
+
+/**
+ * Make a session over an already established transport on the given link,
+ * unicast or multicast depending on the link.
+ */
+zn_session_t *test_session_make(_zn_link_t *zl, test_session_param_t param)
+{
+    zn_session_t *zn = _zn_session_init();
+    if (zl->is_multicast)
+    {
+        _zn_transport_multicast_establish_param_t mp;
+        mp.sn_resolution = param.sn_resolution;
+        mp.initial_sn_tx = param.initial_sn_tx;
+        mp.is_qos = param.is_qos;
+
+        zn->tp = _zn_transport_multicast_new(zl, mp);
+        zn->tp->transport.multicast.session = zn;
+    }
+    else
+    {
+        _zn_transport_unicast_establish_param_t up;
+        _z_bytes_reset(&up.remote_pid);
+        up.sn_resolution = param.sn_resolution;
+        up.initial_sn_tx = param.initial_sn_tx;
+        up.initial_sn_rx = param.initial_sn_rx;
+        up.lease = param.lease;
+        up.is_qos = param.is_qos;
+
+        zn->tp = _zn_transport_unicast_new(zl, up);
+        zn->tp->transport.unicast.session = zn;
+    }
+    return zn;
+}
+
+#endif /* ZENOH_PICO_TESTS_ZN_TEST_SESSION_H */
@@ -0,0 +1,177 @@
+//
+// Copyright (c) 2022 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include "zenoh-pico.h"
+#include "zenoh-pico/protocol/msgcodec.h"
+#include "zenoh-pico/session/utils.h"
+#include "zenoh-pico/transport/link/task/lease.h"
+#include "zenoh-pico/transport/link/tx.h"
+#include "zn_test_session.h"
+
+// This test is linked to a library built with ZN_TX_BATCHING == 1
+#define MSG_NUM 3
+#define LEASE 1000
+
+/*------------------ Frame counting link ------------------*/
+z_mutex_t frames_mutex;
+size_t frames;   // The frames written on the link
+size_t messages; // The zenoh messages they carry
+
+size_t frame_write(const void *arg, const uint8_t *ptr, size_t len)
+{
+    (void)(arg);
+    _z_zbuf_t zbf;
+    zbf.ios = _z_iosli_wrap(ptr, len, 0, len);
+    _zn_transport_message_result_t r;
+    _zn_transport_message_decode_na(&zbf, &r);
+    assert(r.tag == _z_res_t_OK);
+
+    // The keep alives sent by the lease task are not counted
+    if (_ZN_MID(r.value.transport_message.header) == _ZN_MID_FRAME)
+    {
+        z_mutex_lock(&frames_mutex);
+        frames++;
+        messages += _zn_zenoh_message_vec_len(&r.value.transport_message.body.frame.payload.messages);
+        z_mutex_unlock(&frames_mutex);
+    }
+    _zn_t_msg_clear(&r.value.transport_message);
+    return len;
+}
+
+void check_frames(size_t f, size_t m)
+{
+    z_mutex_lock(&frames_mutex);
+    assert(frames == f);
+    assert(messages == m);
+    (void)(f);
+    (void)(m);
+    z_mutex_unlock(&frames_mutex);
+}
+
+zn_session_t *session_make(void)
+{
+    frames = 0;
+    messages = 0;
+
+    test_session_param_t param = test_session_param_default();
+    param.lease = LEASE;
+    return test_session_make(test_link_make(frame_write, 1, 0, 0), param);
+}
+
+void write_val(zn_session_t *zn, uint8_t val)
+{
+    zn_reskey_t reskey = zn_rname("/test");
+    int res = zn_write(zn, reskey, &val, 1);
+    assert(res == 0);
+    (void)(res);
+    _zn_reskey_clear(&reskey);
+}
+
+/*------------------ Tests ------------------*/
+void single_frame(void)
+{
+    printf("\n>> Single frame\n");
+    zn_session_t *zn = session_make();
+
+    // The writes are appended to the open batch
+    for (uint8_t i = 0; i < MSG_NUM; i++)
+        write_val(zn, i);
+    check_frames(0, 0);
+
+    // They all leave in one frame
+    int res = znp_flush(zn);
+    assert(res == 0);
+    (void)(res);
+    check_frames(1, MSG_NUM);
+
+    _zn_session_free(&zn);
+}
+
+void linger_flush(void)
+{
+    printf("\n>> Linger flush\n");
+    zn_session_t *zn = session_make();
+    _zn_transport_unicast_t *ztu = &zn->tp->transport.unicast;
+
+    _znp_unicast_lease_timers_t timers;
+    _znp_unicast_lease_init(ztu, &timers);
+
+    // An idle transport wakes up for its lease events only
+    z_zint_t interval;
+    int res = _znp_unicast_lease_process(ztu, &timers, &interval);
+    assert(res == 0);
+    assert(interval == (z_zint_t)(LEASE / ZN_TRANSPORT_LEASE_EXPIRE_FACTOR));
+
+    // An open batch shortens the interval to the linger time
+    write_val(zn, 0);
+    res = _znp_unicast_lease_process(ztu, &timers, &interval);
+    assert(res == 0);
+    assert(interval == ZN_TX_BATCH_LINGER_MS);
+    check_frames(0, 0);
+
+    // The batch is pushed out once it has lingered long enough
+    z_sleep_ms(ZN_TX_BATCH_LINGER_MS);
+    _znp_unicast_lease_elapse(ztu, &timers, ZN_TX_BATCH_LINGER_MS);
+    res = _znp_unicast_lease_process(ztu, &timers, &interval);
+    assert(res == 0);
+    (void)(res);
+    check_frames(1, 1);
+    assert(interval > ZN_TX_BATCH_LINGER_MS);
+
+    _zn_session_free(&zn);
+}
+
+void lease_task_wakeup(void)
+{
+    printf("\n>> Lease task wake up\n");
+    zn_session_t *zn = session_make();
+    int res = znp_start_lease_task(zn);
+    assert(res == 0);
+    (void)(res);
+
+    // Let the idle lease task go to sleep for a keep alive interval
+    z_sleep_ms(ZN_TX_BATCH_LINGER_MS);
+    write_val(zn, 0);
+
+    // Opening the batch wakes the lease task up well before its next lease event
+    size_t f = 0;
+    for (int i = 0; i < 10 && f == 0; i++)
+    {
+        z_sleep_ms(ZN_TX_BATCH_LINGER_MS);
+        z_mutex_lock(&frames_mutex);
+        f = frames;
+        z_mutex_unlock(&frames_mutex);
+    }
+    check_frames(1, 1);
+
+    znp_stop_lease_task(zn);
+    _zn_session_free(&zn);
+}
+
+int main(void)
+{
+    setbuf(stdout, NULL);
+    z_mutex_init(&frames_mutex);
+
+    single_frame();
+    linger_flush();
+    lease_task_wakeup();
+
+    z_mutex_free(&frames_mutex);
+
+    return 0;
+}
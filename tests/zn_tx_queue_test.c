@@ -0,0 +1,297 @@
+//
+// Copyright (c) 2022 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include "zenoh-pico.h"
+#include "zenoh-pico/protocol/msgcodec.h"
+#include "zenoh-pico/session/utils.h"
+#include "zenoh-pico/session/workers.h"
+#include "zn_test_session.h"
+
+#define CAPACITY 4
+#define SENT_LEN 64
+#define DECLARE_MARK 0xFF
+
+/*------------------ Gated link ------------------*/
+// The link blocks the writer task until the gate is opened
+z_mutex_t gate_mutex;
+z_condvar_t gate_cond;
+int is_gate_open;
+int is_writing;
+uint8_t sent[SENT_LEN]; // The data values sent, DECLARE_MARK for the declarations
+size_t sent_len;
+
+void record(const uint8_t *ptr, size_t len)
+{
+    _z_zbuf_t zbf;
+    zbf.ios = _z_iosli_wrap(ptr, len, 0, len);
+    _zn_transport_message_result_t r;
+    _zn_transport_message_decode_na(&zbf, &r);
+    assert(r.tag == _z_res_t_OK);
+    assert(_ZN_MID(r.value.transport_message.header) == _ZN_MID_FRAME);
+
+    _zn_zenoh_message_vec_t *msgs = &r.value.transport_message.body.frame.payload.messages;
+    for (size_t i = 0; i < _zn_zenoh_message_vec_len(msgs); i++)
+    {
+        _zn_zenoh_message_t *z_msg = _zn_zenoh_message_vec_get(msgs, i);
+        assert(sent_len < SENT_LEN);
+        if (_ZN_MID(z_msg->header) == _ZN_MID_DATA)
+            sent[sent_len++] = z_msg->body.data.payload.val[0];
+        else
+            sent[sent_len++] = DECLARE_MARK;
+    }
+    _zn_t_msg_clear(&r.value.transport_message);
+}
+
+size_t gated_write(const void *arg, const uint8_t *ptr, size_t len)
+{
+    (void)(arg);
+    z_mutex_lock(&gate_mutex);
+    is_writing = 1;
+    while (!is_gate_open)
+        z_condvar_wait(&gate_cond, &gate_mutex);
+    record(ptr, len);
+    z_mutex_unlock(&gate_mutex);
+    return len;
+}
+
+void gate_set(int is_open)
+{
+    z_mutex_lock(&gate_mutex);
+    is_gate_open = is_open;
+    is_writing = 0;
+    z_condvar_signal(&gate_cond);
+    z_mutex_unlock(&gate_mutex);
+}
+
+// Wait for the writer task to be blocked in the link
+void gate_wait_writer(void)
+{
+    int is_blocked = 0;
+    while (!is_blocked)
+    {
+        z_mutex_lock(&gate_mutex);
+        is_blocked = is_writing;
+        z_mutex_unlock(&gate_mutex);
+        if (!is_blocked)
+            z_sleep_ms(1);
+    }
+}
+
+zn_session_t *session_make(_zn_tx_queue_policy_t policy, z_zint_t timeout)
+{
+    zn_session_t *zn = test_session_make(test_link_make(gated_write, 1, 0, 0), test_session_param_default());
+
+    int res = _zn_tx_queue_start(zn, CAPACITY, policy, timeout);
+    assert(res == 0);
+    (void)(res);
+
+    sent_len = 0;
+    return zn;
+}
+
+void write_val(zn_session_t *zn, uint8_t val)
+{
+    zn_reskey_t reskey = zn_rname("/test");
+    int res = zn_write(zn, reskey, &val, 1);
+    assert(res == 0);
+    (void)(res);
+    _zn_reskey_clear(&reskey);
+}
+
+void check_counters(zn_session_t *zn, size_t queued, size_t dropped)
+{
+    size_t q;
+    size_t d;
+    int res = znp_tx_queue_counters(zn, &q, &d);
+    assert(res == 0);
+    assert(q == queued);
+    assert(d == dropped);
+    (void)(res);
+    (void)(queued);
+    (void)(dropped);
+}
+
+// Keep the writer busy with a first message and fill up the queue behind it
+void fill(zn_session_t *zn)
+{
+    gate_set(0);
+    write_val(zn, 0);
+    gate_wait_writer();
+    for (uint8_t i = 1; i <= CAPACITY; i++)
+        write_val(zn, i);
+}
+
+void drain(zn_session_t *zn)
+{
+    gate_set(1);
+    _zn_tx_queue_stop(zn);
+}
+
+/*------------------ Drop policies ------------------*/
+void drop_newest(void)
+{
+    printf("\n>> Drop newest\n");
+    zn_session_t *zn = session_make(_ZN_TX_QUEUE_POLICY_DROP_NEWEST, 0);
+    fill(zn);
+
+    // The data written while the queue is full is dropped
+    write_val(zn, CAPACITY + 1);
+    write_val(zn, CAPACITY + 2);
+    check_counters(zn, CAPACITY + 1, 2);
+
+    // Loaned data would overtake the queued data
+    zn_reskey_t reskey = zn_rname("/test");
+    assert(zn_write_loan(zn, reskey, 1) == NULL);
+    _zn_reskey_clear(&reskey);
+
+    drain(zn);
+    assert(sent_len == CAPACITY + 1);
+    for (uint8_t i = 0; i <= CAPACITY; i++)
+        assert(sent[i] == i);
+
+    _zn_session_free(&zn);
+}
+
+void drop_oldest(void)
+{
+    printf("\n>> Drop oldest\n");
+    zn_session_t *zn = session_make(_ZN_TX_QUEUE_POLICY_DROP_OLDEST, 0);
+    fill(zn);
+
+    // The oldest queued data makes room for the newest
+    write_val(zn, CAPACITY + 1);
+    write_val(zn, CAPACITY + 2);
+    check_counters(zn, CAPACITY + 3, 2);
+
+    drain(zn);
+    assert(sent_len == CAPACITY + 1);
+    assert(sent[0] == 0);
+    for (uint8_t i = 1; i <= CAPACITY; i++)
+        assert(sent[i] == i + 2);
+
+    _zn_session_free(&zn);
+}
+
+void *write_task(void *arg)
+{
+    write_val((zn_session_t *)arg, CAPACITY + 2);
+    return NULL;
+}
+
+void block_timeout(void)
+{
+    printf("\n>> Block with timeout\n");
+    zn_session_t *zn = session_make(_ZN_TX_QUEUE_POLICY_BLOCK, 10);
+    fill(zn);
+
+    // The data is dropped once the timeout expires
+    z_clock_t start = z_clock_now();
+    write_val(zn, CAPACITY + 1);
+    assert(z_clock_elapsed_ms(&start) >= 10);
+    (void)(start);
+    check_counters(zn, CAPACITY + 1, 1);
+    gate_set(1);
+    _zn_tx_queue_stop(zn);
+    _zn_session_free(&zn);
+
+    // The data is queued as soon as there is room for it
+    zn = session_make(_ZN_TX_QUEUE_POLICY_BLOCK, 1000 * 1000);
+    fill(zn);
+    z_task_t task;
+    int res = z_task_init(&task, NULL, write_task, zn);
+    assert(res == 0);
+    z_sleep_ms(20);
+    gate_set(1);
+    res = z_task_join(&task);
+    assert(res == 0);
+    (void)(res);
+
+    drain(zn);
+    check_counters(zn, CAPACITY + 2, 0);
+    assert(sent_len == CAPACITY + 2);
+    assert(sent[CAPACITY + 1] == CAPACITY + 2);
+
+    _zn_session_free(&zn);
+}
+
+/*------------------ Ordering ------------------*/
+typedef struct
+{
+    zn_session_t *zn;
+    zn_subscriber_t *sub;
+} declare_ctx_t;
+
+void data_handler(const zn_sample_t *sample, const void *arg)
+{
+    (void)(sample);
+    (void)(arg);
+}
+
+void *declare_task(void *arg)
+{
+    declare_ctx_t *ctx = (declare_ctx_t *)arg;
+    ctx->sub = zn_declare_subscriber(ctx->zn, zn_rname("/test"), zn_subinfo_default(), data_handler, NULL);
+    return NULL;
+}
+
+void sync_order(void)
+{
+    printf("\n>> Synchronous messages order\n");
+    zn_session_t *zn = session_make(_ZN_TX_QUEUE_POLICY_DROP_NEWEST, 0);
+    fill(zn);
+
+    // The declaration waits for the data queued before it to be sent
+    declare_ctx_t ctx = {zn, NULL};
+    z_task_t task;
+    int res = z_task_init(&task, NULL, declare_task, &ctx);
+    assert(res == 0);
+    z_sleep_ms(20);
+    gate_set(1);
+    res = z_task_join(&task);
+    assert(res == 0);
+    (void)(res);
+    assert(ctx.sub != NULL);
+
+    zn_undeclare_subscriber(ctx.sub);
+    z_free(ctx.sub);
+    drain(zn);
+
+    assert(sent_len > CAPACITY + 1);
+    for (uint8_t i = 0; i <= CAPACITY; i++)
+        assert(sent[i] == i);
+    for (size_t i = CAPACITY + 1; i < sent_len; i++)
+        assert(sent[i] == DECLARE_MARK);
+
+    _zn_session_free(&zn);
+}
+
+int main(void)
+{
+    setbuf(stdout, NULL);
+    z_mutex_init(&gate_mutex);
+    z_condvar_init(&gate_cond);
+
+    drop_newest();
+    drop_oldest();
+    block_timeout();
+    sync_order();
+
+    z_condvar_free(&gate_cond);
+    z_mutex_free(&gate_mutex);
+
+    return 0;
+}
@@ -0,0 +1,325 @@
+//
+// Copyright (c) 2022 ZettaScale Technology
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0, or the Apache License, Version 2.0
+// which is available at https://www.apache.org/licenses/LICENSE-2.0.
+//
+// SPDX-License-Identifier: EPL-2.0 OR Apache-2.0
+//
+// Contributors:
+//   ZettaScale Zenoh Team, <zenoh@zettascale.tech>
+//
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include "zenoh-pico.h"
+#include "zenoh-pico/protocol/msgcodec.h"
+#include "zenoh-pico/session/utils.h"
+#include "zenoh-pico/transport/link/rx.h"
+#include "zenoh-pico/transport/link/tx.h"
+#include "zn_test_session.h"
+
+#define MSG_NUM 200
+#define LARGE_MSG_NUM 4
+#define LARGE_MSG_SIZE 150000
+#define QUEUE_LEN 256
+#define SN_RESOLUTION 64
+#define SLICE_NUM 24
+
+/*------------------ Lossy datagram link ------------------*/
+typedef struct
+{
+    z_bytes_t datagrams[QUEUE_LEN];
+    size_t len;
+} datagram_queue_t;
+
+_zn_link_t *link_a;
+_zn_link_t *link_b;
+datagram_queue_t queue_a; // Datagrams sent by A
+datagram_queue_t queue_b; // Datagrams sent by B
+
+size_t datagram_write(const void *arg, const uint8_t *ptr, size_t len)
+{
+    datagram_queue_t *q = arg == link_a ? &queue_a : &queue_b;
+    assert(q->len < QUEUE_LEN);
+
+    z_bytes_t bs = _z_bytes_wrap(ptr, len);
+    _z_bytes_copy(&q->datagrams[q->len], &bs);
+    q->len++;
+    return len;
+}
+
+size_t datagram_writev(const void *arg, const z_bytes_t *iov, size_t iovcnt)
+{
+    // Gather the slices into a single datagram
+    size_t len = 0;
+    for (size_t i = 0; i < iovcnt; i++)
+        len += iov[i].len;
+
+    uint8_t *buf = (uint8_t *)z_malloc(len);
+    len = 0;
+    for (size_t i = 0; i < iovcnt; i++)
+    {
+        memcpy(buf + len, iov[i].val, iov[i].len);
+        len += iov[i].len;
+    }
+
+    size_t wb = datagram_write(arg, buf, len);
+    z_free(buf);
+    return wb;
+}
+
+size_t batch_writes;
+
+size_t datagram_writev_batch(const void *arg, const z_bytes_t *iov, const size_t *iovcnts, size_t n)
+{
+    batch_writes++;
+    for (size_t i = 0; i < n; i++)
+    {
+        datagram_writev(arg, iov, iovcnts[i]);
+        iov += iovcnts[i];
+    }
+    return n;
+}
+
+_zn_link_t *datagram_link_make(void)
+{
+    return test_link_make(datagram_write, 0, 0, 0);
+}
+
+zn_session_t *session_make(_zn_link_t *zl, z_zint_t initial_sn_tx, z_zint_t initial_sn_rx)
+{
+    test_session_param_t param = test_session_param_default();
+    param.sn_resolution = SN_RESOLUTION;
+    param.initial_sn_tx = initial_sn_tx;
+    param.initial_sn_rx = initial_sn_rx;
+    zn_session_t *zn = test_session_make(zl, param);
+
+    // Enable the retransmissions regardless of ZN_UDP_UNICAST_RELIABILITY
+    _zn_transport_unicast_t *ztu = &zn->tp->transport.unicast;
+    ztu->is_retransmitting = 1;
+    _zn_frame_window_clear(&ztu->tx_window);
+    _zn_frame_window_clear(&ztu->rx_window);
+    ztu->tx_window = _zn_frame_window_make(ZN_TX_RETRANSMISSION_WINDOW, ztu->sn_tx_sns.val.plain.reliable);
+    ztu->rx_window = _zn_frame_window_make(ZN_RX_REORDERING_WINDOW, _zn_sn_increment(SN_RESOLUTION, ztu->sn_rx_sns.val.plain.reliable));
+    ztu->sn_rx_acked = ztu->rx_window.base;
+
+    return zn;
+}
+
+/*------------------ Delivery ------------------*/
+void deliver(zn_session_t *zn, const z_bytes_t *datagram, int is_streamed)
+{
+    _zn_transport_unicast_t *ztu = &zn->tp->transport.unicast;
+    _z_zbuf_t zbf;
+    zbf.ios = _z_iosli_wrap(datagram->val, datagram->len, 0, datagram->len);
+    while (_z_zbuf_len(&zbf) > 0)
+    {
+        _zn_transport_message_result_t r;
+        if (is_streamed)
+        {
+            _zn_transport_message_decode_streamed_na(&zbf, &r);
+            assert(r.tag == _z_res_t_OK);
+            _zn_unicast_handle_streamed_transport_message(ztu, &r.value.transport_message, &zbf);
+        }
+        else
+        {
+            _zn_transport_message_decode_na(&zbf, &r);
+            assert(r.tag == _z_res_t_OK);
+            _zn_unicast_handle_transport_message(ztu, &r.value.transport_message);
+        }
+        _zn_t_msg_clear(&r.value.transport_message);
+    }
+}
+
+size_t delivered;
+size_t dropped;
+
+// Deliver all the queued datagrams, dropping one every 5 and swapping pairs of them
+void pump(datagram_queue_t *q, zn_session_t *dst, int is_lossy)
+{
+    datagram_queue_t in = *q;
+    q->len = 0;
+
+    for (size_t i = 0; i < in.len; i++)
+    {
+        size_t j = i;
+        if (is_lossy && i + 1 < in.len && (delivered % 7) == 3)
+        {
+            // Deliver the next datagram first
+            z_bytes_t tmp = in.datagrams[i];
+            in.datagrams[i] = in.datagrams[i + 1];
+            in.datagrams[i + 1] = tmp;
+        }
+
+        delivered++;
+        if (is_lossy && (delivered % 5) == 0)
+            dropped++;
+        else
+            deliver(dst, &in.datagrams[j], delivered % 2);
+
+        _z_bytes_clear(&in.datagrams[j]);
+    }
+}
+
+/*------------------ Subscriber ------------------*/
+uint8_t received[MSG_NUM];
+size_t received_len;
+size_t large_received_len;
+
+void data_handler(const zn_sample_t *sample, const void *arg)
+{
+    (void)(arg);
+    if (sample->value.len == LARGE_MSG_SIZE)
+    {
+        // Large messages are fragmented
+        for (size_t i = 0; i < LARGE_MSG_SIZE; i++)
+            assert(sample->value.val[i] == (uint8_t)(i + large_received_len));
+        large_received_len++;
+        return;
+    }
+
+    assert(sample->value.len == 1);
+    assert(received_len < MSG_NUM);
+    received[received_len++] = sample->value.val[0];
+}
+
+// Exchange datagrams until all the reliable frames sent by A are acknowledged
+void settle(zn_session_t *zn_a, zn_session_t *zn_b)
+{
+    _zn_transport_unicast_t *ztu_a = &zn_a->tp->transport.unicast;
+    for (int i = 0; i < 100 && ztu_a->tx_window.base != ztu_a->sn_tx_sns.val.plain.reliable; i++)
+    {
+        _zn_unicast_sync(ztu_a);
+        pump(&queue_a, zn_b, 1);
+        pump(&queue_b, zn_a, 1);
+    }
+}
+
+int main(void)
+{
+    setbuf(stdout, NULL);
+
+    link_a = datagram_link_make();
+    link_b = datagram_link_make();
+    zn_session_t *zn_a = session_make(link_a, 10, 41);
+    zn_session_t *zn_b = session_make(link_b, 42, 9);
+
+    zn_subscriber_t *sub = zn_declare_subscriber(zn_b, zn_rname("/test"), zn_subinfo_default(), data_handler, NULL);
+    assert(sub != NULL);
+    _zn_unicast_flush(&zn_b->tp->transport.unicast);
+    pump(&queue_b, zn_a, 0);
+
+    zn_reskey_t reskey = zn_rname("/test");
+    _zn_transport_unicast_t *ztu_a = &zn_a->tp->transport.unicast;
+    for (size_t i = 0; i < MSG_NUM; i++)
+    {
+        // Keep the sender within its retransmission window
+        while (_zn_sn_distance(SN_RESOLUTION, ztu_a->tx_window.base, ztu_a->sn_tx_sns.val.plain.reliable) >= ZN_TX_RETRANSMISSION_WINDOW)
+        {
+            _zn_unicast_sync(ztu_a);
+            pump(&queue_a, zn_b, 1);
+            pump(&queue_b, zn_a, 1);
+        }
+
+        uint8_t val = (uint8_t)i;
+        int res = zn_write(zn_a, reskey, &val, 1);
+        assert(res == 0);
+        (void)(res);
+        _zn_unicast_flush(ztu_a);
+
+        pump(&queue_a, zn_b, 1);
+        pump(&queue_b, zn_a, 1);
+    }
+
+    // Recover the tail losses
+    settle(zn_a, zn_b);
+
+    printf("Delivered %zu datagrams, dropped %zu\n", delivered, dropped);
+    assert(dropped > 0);
+
+    // All the messages are received once and in order despite the losses
+    assert(received_len == MSG_NUM);
+    for (size_t i = 0; i < MSG_NUM; i++)
+        assert(received[i] == (uint8_t)i);
+
+    // All the frames have been acknowledged
+    assert(ztu_a->tx_window.base == ztu_a->sn_tx_sns.val.plain.reliable);
+    for (size_t i = 0; i < ztu_a->tx_window.capacity; i++)
+        assert(_z_bytes_is_empty(&ztu_a->tx_window.slots[i]));
+
+    // An aborted loan sends nothing and gives its SN back
+    z_zint_t sn = ztu_a->sn_tx_sns.val.plain.reliable;
+    uint8_t *loan = zn_write_loan(zn_a, reskey, 1);
+    assert(loan != NULL);
+    *loan = 0xff;
+    int res = zn_write_abort(zn_a);
+    assert(res == 0);
+    (void)(res);
+    _zn_unicast_flush(ztu_a);
+    assert(queue_a.len == 0);
+    assert(ztu_a->sn_tx_sns.val.plain.reliable == sn);
+    (void)(sn);
+
+    // Large messages are fragmented, with and without vectored and batched writes
+    uint8_t *large = (uint8_t *)z_malloc(LARGE_MSG_SIZE);
+    for (size_t i = 0; i < LARGE_MSG_NUM; i++)
+    {
+        for (size_t j = 0; j < LARGE_MSG_SIZE; j++)
+            large[j] = (uint8_t)(j + i);
+
+        link_a->writev_f = i % 2 == 0 ? NULL : datagram_writev;
+        link_a->writev_batch_f = i == LARGE_MSG_NUM - 1 ? datagram_writev_batch : NULL;
+        int res = zn_write(zn_a, reskey, large, LARGE_MSG_SIZE);
+        assert(res == 0);
+        (void)(res);
+        _zn_unicast_flush(ztu_a);
+
+        settle(zn_a, zn_b);
+        assert(large_received_len == i + 1);
+    }
+    link_a->writev_f = NULL;
+    link_a->writev_batch_f = NULL;
+#if defined(Z_LINK_BATCH)
+    // The fragments of a message are written at once
+    assert(batch_writes == 1);
+#endif
+    z_free(large);
+    _zn_reskey_clear(&reskey);
+
+    // A datagram made of more slices than a single write can take is still written at once
+    uint8_t bytes[2 * SLICE_NUM];
+    for (size_t i = 0; i < sizeof(bytes); i++)
+        bytes[i] = (uint8_t)i;
+    _z_wbuf_t wbf = _z_wbuf_make(ZN_IOSLICE_SIZE, 1);
+    for (size_t i = 0; i < SLICE_NUM; i++)
+    {
+        _z_wbuf_write(&wbf, bytes[2 * i]);
+        _z_wbuf_wrap_bytes(&wbf, bytes + 2 * i + 1, 0, 1);
+    }
+    for (int i = 0; i < 2; i++)
+    {
+        link_a->writev_f = i == 0 ? NULL : datagram_writev;
+        int res = _zn_link_send_wbuf(link_a, &wbf);
+        assert(res == 0);
+        (void)(res);
+        assert(queue_a.len == 1);
+        assert(queue_a.datagrams[0].len == sizeof(bytes) && memcmp(queue_a.datagrams[0].val, bytes, sizeof(bytes)) == 0);
+        _z_bytes_clear(&queue_a.datagrams[0]);
+        queue_a.len = 0;
+    }
+    link_a->writev_f = NULL;
+    _z_wbuf_clear(&wbf);
+
+    zn_undeclare_subscriber(sub);
+    _zn_unicast_flush(&zn_b->tp->transport.unicast);
+    pump(&queue_b, zn_a, 0);
+
+    _zn_session_free(&zn_a);
+    _zn_session_free(&zn_b);
+
+    return 0;
+}